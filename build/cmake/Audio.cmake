@@ -107,7 +107,9 @@ else()
     add_dependencies(rainbow openal-soft libogg libvorbis)
     set(AUDIO_LIBRARIES vorbisfile vorbis ogg)
   else()
-    find_package(OpenAL REQUIRED)
+    if(NOT USE_SOFTWARE_MIXER)
+      find_package(OpenAL REQUIRED)
+    endif()
     pkg_check_modules(VORBIS REQUIRED ogg vorbis vorbisfile)
     set(AUDIO_INCLUDE_DIRS ${VORBIS_INCLUDE_DIRS})
     set(AUDIO_LIBRARIES ${VORBIS_LDFLAGS})
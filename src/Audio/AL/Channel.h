@@ -5,36 +5,49 @@
 #ifndef AUDIO_AL_CHANNEL_H_
 #define AUDIO_AL_CHANNEL_H_
 
-#include <algorithm>
-#include <array>
-
 #include "Audio/AL/Sound.h"
+#include "Math/Vec2.h"
 
 namespace rainbow { namespace audio
 {
-    struct Sound;
-
+    /// <summary>
+    ///   A playing sound, as seen from the main thread.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Playback state is tracked here and changes take effect immediately
+    ///     as far as the main thread is concerned. OpenAL sources are only
+    ///     ever touched by the audio thread, which catches up shortly after.
+    ///   </para>
+    ///   <para>
+    ///     There are more channels than sources. A channel without a source
+    ///     is virtual: it is inaudible, but its position keeps advancing so
+    ///     that it can resume where it would have been once a source frees
+    ///     up, or once it outranks a channel that has one.
+    ///   </para>
+    /// </remarks>
     struct Channel
     {
-    public:
-        static constexpr int kNumBuffers = 3;
-
-        Channel(uint32_t id, uint32_t* buffers)
-            : id_(id), buffers_({}), sound_(nullptr)
+        enum class State
         {
-            std::copy_n(buffers, kNumBuffers, buffers_.data());
-        }
-
-        auto buffers() { return buffers_.data(); }
-        auto id() const { return id_; }
-
-        auto sound() const { return sound_; }
-        void set_sound(Sound* sound) { sound_ = sound; }
-
-    private:
-        const uint32_t id_;
-        std::array<uint32_t, kNumBuffers> buffers_;
-        Sound* sound_;
+            Stopped,
+            Playing,
+            Paused,
+        };
+
+        static constexpr int kDefaultPriority = 0;
+        static constexpr int kVirtual = -1;
+
+        Sound* sound = nullptr;
+        State state = State::Stopped;
+        int source = kVirtual;  ///< Index of the source playing this channel.
+        int priority = kDefaultPriority;
+        int loop_count = 0;
+        float volume = 1.0f;
+        Vec2f world_position;
+        double elapsed = 0.0;  ///< Seconds played, including while virtual.
+
+        bool is_virtual() const { return source == kVirtual; }
     };
 }}  // namespace rainbow::audio
 
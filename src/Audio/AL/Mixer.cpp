@@ -4,6 +4,8 @@
 
 #include "Audio/AL/Mixer.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 
 #include "Platform/Macros.h"
@@ -18,43 +20,84 @@
 #   include <AL/alc.h>
 #endif
 
+#include "Audio/AL/Ranking.h"
 #include "Audio/AudioFile.h"
 #include "Audio/Mixer.h"
 #include "Common/Logging.h"
 #include "FileSystem/Path.h"
-#include "Memory/TempBuffer.h"
+
+#ifndef RAINBOW_JS
+#   define USE_AUDIO_THREAD
+#endif
 
 using rainbow::audio::ALMixer;
 using rainbow::audio::Channel;
+using rainbow::audio::Samples;
 using rainbow::audio::Sound;
 using rainbow::czstring;
 
 namespace
 {
-    constexpr size_t kAudioBufferSize = 8192;
+    using Command = ALMixer::Command;
+
+    /// <summary>
+    ///   Duration, in milliseconds, of each buffer queued on a streaming
+    ///   source. With <see cref="ALMixer::kNumBuffers"/> buffers, this is
+    ///   how long the audio thread can be held up before playback drops out.
+    /// </summary>
+    constexpr size_t kStreamBufferDuration = 100;
+
+    /// <summary>How often the audio thread refills streams.</summary>
+    constexpr std::chrono::milliseconds kUpdateInterval{10};
 
     ALMixer* al_mixer = nullptr;
 
-    auto get_channel_state(const Channel& channel)
+    auto get_source_state(ALuint source)
     {
         ALint state{};
-        alGetSourcei(channel.id(), AL_SOURCE_STATE, &state);
+        alGetSourcei(source, AL_SOURCE_STATE, &state);
         return state;
     }
 
-    auto get_channel_type(const Channel& channel)
+    constexpr bool is_fail(ALenum result) { return result != AL_NO_ERROR; }
+
+    /// <summary>
+    ///   Returns whether the channel has played for its full duration.
+    ///   Only needed for virtual channels, as sources report when they end.
+    /// </summary>
+    bool has_ended(const Channel& channel)
     {
-        ALint type{};
-        alGetSourcei(channel.id(), AL_SOURCE_TYPE, &type);
-        return type;
+        const Sound& sound = *channel.sound;
+        if (sound.frames == 0)
+            return true;
+
+        if (channel.loop_count < 0)
+            return false;
+
+        const auto played = static_cast<size_t>(channel.elapsed * sound.rate);
+        return played >= sound.frames * (channel.loop_count + 1);
     }
 
-    bool is_available(const Channel& channel)
+    auto make_command(Command::Type type)
     {
-        return get_channel_type(channel) == AL_UNDETERMINED;
+        Command command{};
+        command.type = type;
+        return command;
     }
 
-    constexpr bool is_fail(ALenum result) { return result != AL_NO_ERROR; }
+    auto get_frame_size(int format) -> size_t
+    {
+        return format == AL_FORMAT_STEREO16 ? 4 : 2;
+    }
+
+    /// <summary>
+    ///   Returns the size, in bytes, of <see cref="kStreamBufferDuration"/>
+    ///   of 16-bit audio.
+    /// </summary>
+    auto stream_buffer_size(int format, int rate) -> size_t
+    {
+        return rate * kStreamBufferDuration / 1000 * get_frame_size(format);
+    }
 }
 
 namespace std
@@ -109,7 +152,7 @@ bool ALMixer::initialize(int max_channels)
         return false;
     }
 
-    const auto buffer_count = max_channels * Channel::kNumBuffers;
+    const auto buffer_count = max_channels * kNumBuffers;
     auto buffers = std::make_unique<ALuint[]>(buffer_count);
     alGenBuffers(buffer_count, buffers.get());
     result = alGetError();
@@ -120,73 +163,85 @@ bool ALMixer::initialize(int max_channels)
         return false;
     }
 
-    channels_.reserve(max_channels);
+    sources_.resize(max_channels);
+    free_sources_.reserve(max_channels);
     for (int i = 0; i < max_channels; ++i)
     {
-        const int offset = i * Channel::kNumBuffers;
-        channels_.emplace_back(sources[i], buffers.get() + offset);
+        Source& source = sources_[i];
+        source.id = sources[i];
+        std::copy_n(buffers.get() + i * kNumBuffers,
+                    kNumBuffers,
+                    source.buffers.data());
+        source.generation = 0;
+        source.channel = nullptr;
+
+        // Hand out sources in order.
+        free_sources_.push_back(max_channels - i - 1);
     }
+    voices_.resize(max_channels);
+
+    channels_.resize(max_channels * kChannelsPerSource);
+    free_channels_.reserve(channels_.size());
+    for (auto i = channels_.rbegin(); i != channels_.rend(); ++i)
+        free_channels_.push_back(&*i);
+
+    last_process_ = std::chrono::steady_clock::now();
+
+    samples_.set_evictor([this](Samples& samples) {
+        if (samples.handle == 0)
+            return;
+
+        Command command{};
+        command.type = Command::Type::DeleteBuffer;
+        command.buffer = samples.handle;
+        post(command);
+    });
 
     device.release();
     context_ = context.release();
     al_mixer = this;
 
+#ifdef USE_AUDIO_THREAD
+    thread_ = std::thread([this] { run(); });
+#endif
+
     return true;
 }
 
 void ALMixer::process()
 {
-    auto buffer = get_temp_buffer<uint8_t>(kAudioBufferSize);
-    for (Channel& channel : channels_)
+#ifndef USE_AUDIO_THREAD
     {
-        const auto state = get_channel_state(channel);
-        const auto type = get_channel_type(channel);
-        if (type != AL_STREAMING)
-        {
-            if (type != AL_UNDETERMINED && state == AL_STOPPED)
-                stop(&channel);
-            continue;
-        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        service();
+    }
+#endif
 
-        if (state == AL_PAUSED)
-            continue;
+    Event event;
+    while (events_.pop(event))
+    {
+        const Source& source = sources_[event.source];
+        if (source.generation == event.generation && source.channel != nullptr)
+            free(*source.channel);
+    }
 
-        auto sound = channel.sound();
-        auto stream = sound->file.get();
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> elapsed = now - last_process_;
+    last_process_ = now;
+    if (suspended_)
+        return;
 
-        ALint processed{};
-        alGetSourcei(channel.id(), AL_BUFFERS_PROCESSED, &processed);
-        for (ALint i = 0; i < processed; ++i)
-        {
-            size_t length = stream->read(buffer, kAudioBufferSize);
-            if (length == 0)
-            {
-                if (sound->loop_count == 0)
-                {
-                    processed = i;
-                    stop(&channel);
-                    break;
-                }
-                else if (sound->loop_count > 0)
-                {
-                    --sound->loop_count;
-                }
-                stream->rewind();
-                length = stream->read(buffer, kAudioBufferSize);
-            }
-            ALuint bid{};
-            alSourceUnqueueBuffers(channel.id(), 1, &bid);
-            alBufferData(bid,
-                         sound->format,
-                         buffer,
-                         static_cast<ALsizei>(length),
-                         sound->rate);
-            alSourceQueueBuffers(channel.id(), 1, &bid);
-        }
+    for (Channel& channel : channels_)
+    {
+        if (channel.state != Channel::State::Playing)
+            continue;
 
-        if (processed > 0 && state == AL_STOPPED)
-            alSourcePlay(channel.id());
+        channel.elapsed += elapsed.count();
+        if (channel.is_virtual() && has_ended(channel))
+            free(channel);
     }
+
+    balance();
 }
 
 void ALMixer::suspend(bool should_suspend)
@@ -194,6 +249,8 @@ void ALMixer::suspend(bool should_suspend)
     if (context_ == nullptr)
         return;
 
+    std::lock_guard<std::mutex> lock(mutex_);
+    suspended_ = should_suspend;
     if (should_suspend)
     {
         alcSuspendContext(context_);
@@ -218,26 +275,132 @@ auto ALMixer::create_sound(czstring path) -> Sound*
     return &i->second;
 }
 
-auto ALMixer::get_channel() -> Channel*
+void ALMixer::release(Sound* sound)
 {
     for (Channel& channel : channels_)
     {
-        if (is_available(channel))
-            return &channel;
+        if (channel.sound == sound)
+            free(channel);
     }
 
-    return nullptr;
+    sounds_.erase(sound->key);
+    samples_.trim();
 }
 
-void ALMixer::release(Sound* sound)
+auto ALMixer::create_buffer(int format,
+                            const void* pcm,
+                            size_t size,
+                            int rate) -> uint32_t
 {
-    for (Channel& channel : channels_)
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    ALuint buffer{};
+    alGenBuffers(1, &buffer);
+    alBufferData(buffer, format, pcm, static_cast<ALsizei>(size), rate);
+    return buffer;
+}
+
+auto ALMixer::voice_stats() const -> VoiceStats
+{
+    VoiceStats stats;
+    for (const Channel& channel : channels_)
     {
-        if (channel.sound() == sound)
-            stop(&channel);
+        if (channel.state == Channel::State::Stopped)
+            continue;
+
+        if (channel.is_virtual())
+            ++stats.virtualised;
+        else
+            ++stats.real;
     }
+    stats.stolen = steal_count_;
+    return stats;
+}
 
-    sounds_.erase(sound->key);
+auto ALMixer::get_channel() -> Channel*
+{
+    if (free_channels_.empty())
+    {
+        Channel* victim = find_steal_victim(channels_);
+        if (victim == nullptr)
+            return nullptr;
+
+        free(*victim);
+        ++steal_count_;
+    }
+
+    Channel* channel = free_channels_.back();
+    free_channels_.pop_back();
+    return channel;
+}
+
+void ALMixer::balance()
+{
+    while (true)
+    {
+        const auto promotion =
+            find_promotion(channels_, !free_sources_.empty());
+        if (promotion.channel == nullptr)
+            return;
+
+        if (promotion.victim == nullptr)
+        {
+            const uint32_t source = free_sources_.back();
+            free_sources_.pop_back();
+            realise(*promotion.channel, source);
+        }
+        else
+        {
+            realise(*promotion.channel, virtualise(*promotion.victim));
+        }
+    }
+}
+
+void ALMixer::free(Channel& channel)
+{
+    if (channel.state == Channel::State::Stopped)
+        return;
+
+    if (!channel.is_virtual())
+        free_sources_.push_back(virtualise(channel));
+
+    channel = Channel{};
+    free_channels_.push_back(&channel);
+}
+
+void ALMixer::post(Channel& channel, Command command)
+{
+    if (channel.is_virtual())
+        return;
+
+    command.source = channel.source;
+    command.generation = sources_[channel.source].generation;
+    post(command);
+}
+
+void ALMixer::post(const Command& command)
+{
+#ifdef USE_AUDIO_THREAD
+    // Once the audio thread has stopped, nothing consumes the queue. Carry
+    // out commands in order right away instead, or tearing down a full
+    // sample cache would wait forever.
+    if (shutdown_)
+    {
+        execute_commands();
+        execute(command);
+        return;
+    }
+#endif
+
+    while (!commands_.push(command))
+    {
+#ifdef USE_AUDIO_THREAD
+        std::this_thread::yield();
+#else
+        std::lock_guard<std::mutex> lock(mutex_);
+        service();
+#endif
+    }
 }
 
 ALMixer::~ALMixer()
@@ -247,19 +410,349 @@ ALMixer::~ALMixer()
     if (context_ == nullptr)
         return;
 
+    if (thread_.joinable())
+    {
+        shutdown_ = true;
+        thread_.join();
+    }
+
+    // Carry out any remaining commands so that nothing is leaked, and make
+    // sure no voice is left reading from a sound about to be deleted.
+    execute_commands();
+
+    for (uint32_t i = 0; i < voices_.size(); ++i)
+    {
+        if (voices_[i].active)
+            stop(i);
+    }
+
+    sounds_.clear();
+    samples_.clear();
+
+    // Buffers evicted from the sample cache.
+    execute_commands();
+
     suspend(true);
 
-    for (Channel& channel : channels_)
+    for (const Source& source : sources_)
     {
-        const ALuint source = channel.id();
-        alDeleteSources(1, &source);
-        alDeleteBuffers(Channel::kNumBuffers, channel.buffers());
+        alDeleteSources(1, &source.id);
+        alDeleteBuffers(kNumBuffers, source.buffers.data());
     }
 
     std::unique_ptr<ALCdevice> device{alcGetContextsDevice(context_)};
     alcDestroyContext(context_);
 }
 
+void ALMixer::realise(Channel& channel, uint32_t source)
+{
+    Source& s = sources_[source];
+    ++s.generation;
+    s.channel = &channel;
+    channel.source = source;
+
+    const Sound& sound = *channel.sound;
+    auto command = make_command(Command::Type::Start);
+    command.file = sound.file.get();
+    command.data = sound.encoded.get();
+    command.buffer = sound.buffer;
+    command.format = sound.format;
+    command.rate = sound.rate;
+    command.count = channel.loop_count;
+    command.volume = channel.volume;
+    command.position = channel.world_position;
+
+    // Pick up where the channel would have been.
+    const auto played = static_cast<size_t>(channel.elapsed * sound.rate);
+    if (sound.frames > 0 && played > 0)
+    {
+        const auto loops = static_cast<int>(played / sound.frames);
+        command.offset = played % sound.frames;
+        if (channel.loop_count > 0)
+            command.count = std::max(channel.loop_count - loops, 0);
+    }
+
+    post(channel, command);
+    if (channel.state == Channel::State::Paused)
+        post(channel, make_command(Command::Type::Pause));
+}
+
+auto ALMixer::virtualise(Channel& channel) -> uint32_t
+{
+    const auto source = static_cast<uint32_t>(channel.source);
+    post(channel, make_command(Command::Type::Stop));
+    sources_[source].channel = nullptr;
+    channel.source = Channel::kVirtual;
+    return source;
+}
+
+void ALMixer::execute(const Command& command)
+{
+    switch (command.type)
+    {
+        case Command::Type::Start:
+            start(command);
+            return;
+        case Command::Type::DeleteBuffer:
+            alDeleteBuffers(1, &command.buffer);
+            return;
+        case Command::Type::DeleteFile:
+            delete command.file;
+            return;
+        case Command::Type::DeleteData:
+            delete command.data;
+            return;
+        default:
+            break;
+    }
+
+    // The source may have been reused since the command was posted.
+    Voice& voice = voices_[command.source];
+    if (voice.generation != command.generation)
+        return;
+
+    const ALuint source = sources_[command.source].id;
+    switch (command.type)
+    {
+        case Command::Type::Pause:
+            if (voice.active)
+                alSourcePause(source);
+            voice.paused = true;
+            break;
+        case Command::Type::Resume:
+            if (voice.active)
+                alSourcePlay(source);
+            voice.paused = false;
+            break;
+        case Command::Type::Stop:
+            stop(command.source);
+            voice.finished = false;
+            break;
+        case Command::Type::SetLoopCount:
+            // Streams are looped by rewinding the file as it runs out.
+            if (voice.file == nullptr)
+                alSourcei(source, AL_LOOPING, command.count != 0);
+            voice.loop_count = command.count;
+            break;
+        case Command::Type::SetPosition: {
+            const ALfloat pos[]{command.position.x, command.position.y, 0.0f};
+            alSourcefv(source, AL_POSITION, pos);
+            break;
+        }
+        case Command::Type::SetVolume:
+            alSourcef(source, AL_GAIN, command.volume);
+            break;
+        default:
+            break;
+    }
+}
+
+void ALMixer::execute_commands()
+{
+    for (const Command& command : deferred_)
+        execute(command);
+    deferred_.clear();
+
+    Command command;
+    while (commands_.pop(command))
+        execute(command);
+}
+
+void ALMixer::finish(uint32_t source)
+{
+    stop(source);
+    voices_[source].finished = true;
+}
+
+auto ALMixer::read(Voice& voice) -> size_t
+{
+    size_t length = voice.file->read(stream_buffer_.data(), voice.buffer_size);
+    if (length > 0 || voice.loop_count == 0)
+        return length;
+
+    if (voice.loop_count > 0)
+        --voice.loop_count;
+    voice.file->rewind();
+    return voice.file->read(stream_buffer_.data(), voice.buffer_size);
+}
+
+void ALMixer::run()
+{
+    while (!shutdown_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            service();
+        }
+        std::this_thread::sleep_for(kUpdateInterval);
+    }
+}
+
+void ALMixer::service()
+{
+    if (!suspended_)
+    {
+        update();
+        return;
+    }
+
+    // AL cannot be used while suspended. Hold on to commands until resumed
+    // so that the main thread never waits on a full queue.
+    Command command;
+    while (commands_.pop(command))
+        deferred_.push_back(command);
+}
+
+void ALMixer::start(const Command& command)
+{
+    const Source& s = sources_[command.source];
+    const ALuint source = s.id;
+
+    // Detach any buffers left over from previous playback.
+    alSourceStop(source);
+    alSourcei(source, AL_BUFFER, AL_NONE);
+
+    Voice& voice = voices_[command.source];
+    voice = Voice{};
+    voice.loop_count = command.count;
+    voice.generation = command.generation;
+    voice.active = true;
+
+    // Compressed sounds are decoded separately for every voice, so that any
+    // number of channels can play them at once.
+    IAudioFile* file = command.file;
+    if (command.data != nullptr)
+    {
+        voice.decoder = IAudioFile::open(*command.data);
+        if (!voice.decoder)
+        {
+            finish(command.source);
+            return;
+        }
+
+        file = voice.decoder.get();
+    }
+
+    if (file != nullptr)
+    {
+        voice.file = file;
+        voice.format = command.format;
+        voice.rate = command.rate;
+        voice.buffer_size = stream_buffer_size(command.format, command.rate);
+        if (stream_buffer_.size() < voice.buffer_size)
+            stream_buffer_.resize(voice.buffer_size);
+
+        voice.file->seek_frame(command.offset);
+
+        int queued = 0;
+        for (; queued < kNumBuffers; ++queued)
+        {
+            const size_t length = read(voice);
+            if (length == 0)
+            {
+                voice.draining = true;
+                break;
+            }
+
+            alBufferData(s.buffers[queued],
+                         voice.format,
+                         stream_buffer_.data(),
+                         static_cast<ALsizei>(length),
+                         voice.rate);
+        }
+        alSourceQueueBuffers(source, queued, s.buffers.data());
+        alSourcei(source, AL_LOOPING, AL_FALSE);
+    }
+    else
+    {
+        alSourcei(source, AL_BUFFER, command.buffer);
+        alSourcei(source, AL_LOOPING, command.count != 0);
+        alSourcei(source, AL_SAMPLE_OFFSET, static_cast<ALint>(command.offset));
+    }
+
+    const ALfloat pos[]{command.position.x, command.position.y, 0.0f};
+    alSourcef(source, AL_GAIN, command.volume);
+    alSourcefv(source, AL_POSITION, pos);
+    alSourcePlay(source);
+}
+
+void ALMixer::stop(uint32_t source)
+{
+    const ALuint id = sources_[source].id;
+    alSourceStop(id);
+    alSourcei(id, AL_BUFFER, AL_NONE);
+
+    Voice& voice = voices_[source];
+    voice.active = false;
+    voice.file = nullptr;
+    voice.decoder.reset();
+}
+
+void ALMixer::update()
+{
+    execute_commands();
+
+    for (uint32_t i = 0; i < voices_.size(); ++i)
+    {
+        Voice& voice = voices_[i];
+        if (voice.active)
+            update(i);
+
+        if (voice.finished && events_.push({i, voice.generation}))
+            voice.finished = false;
+    }
+}
+
+void ALMixer::update(uint32_t index)
+{
+    Voice& voice = voices_[index];
+    const ALuint source = sources_[index].id;
+    const auto state = get_source_state(source);
+    if (voice.file == nullptr || voice.draining)
+    {
+        if (state == AL_STOPPED)
+            finish(index);
+        return;
+    }
+
+    if (voice.paused)
+        return;
+
+    ALint processed{};
+    alGetSourcei(source, AL_BUFFERS_PROCESSED, &processed);
+    for (ALint i = 0; i < processed; ++i)
+    {
+        const size_t length = read(voice);
+        if (length == 0)
+        {
+            voice.draining = true;
+            break;
+        }
+
+        ALuint bid{};
+        alSourceUnqueueBuffers(source, 1, &bid);
+        alBufferData(bid,
+                     voice.format,
+                     stream_buffer_.data(),
+                     static_cast<ALsizei>(length),
+                     voice.rate);
+        alSourceQueueBuffers(source, 1, &bid);
+    }
+
+    if (state != AL_STOPPED)
+        return;
+
+    // The source ran dry before we could refill it.
+    if (voice.draining)
+    {
+        finish(index);
+        return;
+    }
+
+    underrun_count_.fetch_add(1, std::memory_order_relaxed);
+    alSourcePlay(source);
+}
+
 auto rainbow::audio::load_sound(czstring path) -> Sound*
 {
     auto sound = al_mixer->create_sound(path);
@@ -268,25 +761,32 @@ auto rainbow::audio::load_sound(czstring path) -> Sound*
 
     R_ASSERT(!sound->stream, "Sound already opened as a stream");
 
-    auto audio_file = IAudioFile::open(path);
-    if (!*audio_file)
+    auto samples = al_mixer->sample_cache().acquire(path);
+    if (!samples)
     {
         release(sound);
         return nullptr;
     }
 
     sound->format =
-        audio_file->channels() == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
-    sound->rate = audio_file->rate();
+        samples->channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    sound->rate = samples->rate;
+    sound->frames = samples->frames();
+
+    // Clips with identical contents share a single buffer.
+    if (samples->handle == 0)
+    {
+        samples->handle = al_mixer->create_buffer(sound->format,
+                                                  samples->pcm.data(),
+                                                  samples->size,
+                                                  sound->rate);
+
+        // OpenAL keeps its own copy.
+        samples->pcm = {};
+    }
 
-    const size_t size = audio_file->size();
-    auto buffer = std::make_unique<char[]>(size);
-    alGenBuffers(1, &sound->buffer);
-    alBufferData(sound->buffer,
-                 sound->format,
-                 buffer.get(),
-                 static_cast<ALsizei>(audio_file->read(buffer.get(), size)),
-                 sound->rate);
+    sound->buffer = samples->handle;
+    sound->samples = std::move(samples);
     return sound;
 }
 
@@ -297,6 +797,7 @@ auto rainbow::audio::load_stream(czstring path) -> Sound*
         return sound;
 
     R_ASSERT(sound->buffer == 0, "Sound already opened as static");
+    R_ASSERT(sound->encoded == nullptr, "Sound already opened as compressed");
 
     auto audio_file = IAudioFile::open(path);
     if (!*audio_file)
@@ -309,109 +810,151 @@ auto rainbow::audio::load_stream(czstring path) -> Sound*
     sound->format =
         audio_file->channels() == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
     sound->rate = audio_file->rate();
+    sound->frames = audio_file->size() / get_frame_size(sound->format);
     sound->file = std::move(audio_file);
     return sound;
 }
 
+auto rainbow::audio::load_compressed(czstring path) -> Sound*
+{
+    auto sound = al_mixer->create_sound(path);
+    if (sound == nullptr || sound->encoded != nullptr)
+        return sound;
+
+    R_ASSERT(sound->buffer == 0, "Sound already opened as static");
+    R_ASSERT(sound->file == nullptr, "Sound already opened as a stream");
+
+    auto data = std::make_unique<Data>(Data::load_asset(path));
+    if (!*data)
+    {
+        release(sound);
+        return nullptr;
+    }
+
+    // Only used to validate the file and read its properties. Every channel
+    // gets its own decoder.
+    auto decoder = IAudioFile::open(*data);
+    if (!decoder)
+    {
+        LOGW("'%s' cannot be decoded from memory; loading it decoded instead",
+             path);
+        release(sound);
+        return load_sound(path);
+    }
+
+    sound->stream = true;
+    sound->format =
+        decoder->channels() == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    sound->rate = decoder->rate();
+    sound->frames = decoder->size() / get_frame_size(sound->format);
+    sound->encoded = std::move(data);
+    return sound;
+}
+
+void rainbow::audio::preload(ArrayView<czstring> paths)
+{
+    al_mixer->sample_cache().preload(paths);
+}
+
 void rainbow::audio::release(Sound* sound)
 {
-    const auto stream = sound->stream;
-    const auto buffer = sound->buffer;
+    Command command{};
+    command.type = Command::Type::DeleteFile;
+    command.file = sound->file.release();
 
-    sound->file.release();
-    al_mixer->release(sound);
+    auto data_command = make_command(Command::Type::DeleteData);
+    data_command.data = sound->encoded.release();
 
-    if (!stream)
-        alDeleteBuffers(1, &buffer);
+    // Channels playing the sound are stopped before it is deleted. Static
+    // buffers are deleted once evicted from the sample cache.
+    al_mixer->release(sound);
+    if (command.file != nullptr)
+        al_mixer->post(command);
+    if (data_command.data != nullptr)
+        al_mixer->post(data_command);
 }
 
 bool rainbow::audio::is_paused(Channel* channel)
 {
-    return get_channel_state(*channel) == AL_PAUSED;
+    return channel->state == Channel::State::Paused;
 }
 
 bool rainbow::audio::is_playing(Channel* channel)
 {
-    const auto state = get_channel_state(*channel);
-    return state == AL_PLAYING || state == AL_PAUSED;
+    return channel->state != Channel::State::Stopped;
 }
 
 void rainbow::audio::set_loop_count(Channel* channel, int count)
 {
-    // TODO: Doesn't actually set loop _count_.
-    alSourcei(channel->id(), AL_LOOPING, count);
+    channel->loop_count = count;
+    auto command = make_command(Command::Type::SetLoopCount);
+    command.count = count;
+    al_mixer->post(*channel, command);
+}
+
+void rainbow::audio::set_priority(Channel* channel, int priority)
+{
+    // Sources are rebalanced on the next update.
+    channel->priority = priority;
 }
 
 void rainbow::audio::set_volume(Channel* channel, float volume)
 {
-    alSourcef(channel->id(), AL_GAIN, volume);
+    channel->volume = volume;
+    auto command = make_command(Command::Type::SetVolume);
+    command.volume = volume;
+    al_mixer->post(*channel, command);
 }
 
 void rainbow::audio::set_world_position(Channel* channel, Vec2f position)
 {
-    const ALfloat pos[]{position.x, position.y, 0.0f};
-    alSourcefv(channel->id(), AL_POSITION, pos);
+    channel->world_position = position;
+    auto command = make_command(Command::Type::SetPosition);
+    command.position = position;
+    al_mixer->post(*channel, command);
 }
 
 void rainbow::audio::pause(Channel* channel)
 {
-    alSourcePause(channel->id());
+    if (channel->state != Channel::State::Playing)
+        return;
+
+    channel->state = Channel::State::Paused;
+    al_mixer->post(*channel, make_command(Command::Type::Pause));
 }
 
 auto rainbow::audio::play(Channel* channel) -> Channel*
 {
-    if (get_channel_state(*channel) == AL_STOPPED)
-        return nullptr;
-
-    alSourcePlay(channel->id());
+    switch (channel->state)
+    {
+        case Channel::State::Stopped:
+            return nullptr;
+        case Channel::State::Paused:
+            channel->state = Channel::State::Playing;
+            al_mixer->post(*channel, make_command(Command::Type::Resume));
+            break;
+        default:
+            break;
+    }
     return channel;
 }
 
 auto rainbow::audio::play(Sound* sound, Vec2f position) -> Channel*
 {
     Channel* channel = al_mixer->get_channel();
-    channel->set_sound(sound);
-
-    if (sound->stream)
-    {
-        auto buffer = get_temp_buffer<uint8_t>(kAudioBufferSize);
-
-        // TODO: Prevent streaming from an already streaming sound.
-        sound->file->rewind();
-
-        int i{};
-        for (; i < Channel::kNumBuffers; ++i)
-        {
-            const size_t size = sound->file->read(buffer, kAudioBufferSize);
-            alBufferData(channel->buffers()[i],
-                         sound->format,
-                         buffer,
-                         static_cast<ALsizei>(size),
-                         sound->rate);
-            if (size < kAudioBufferSize)
-                break;
-        }
-
-        alSourceQueueBuffers(channel->id(), i, channel->buffers());
-    }
-    else
-    {
-        alSourcei(channel->id(), AL_BUFFER, sound->buffer);
-    }
-
-    set_loop_count(channel, 0);
-    set_volume(channel, 1.0f);
+    if (channel == nullptr)
+        return nullptr;
 
-    set_world_position(channel, position);
-    alSourcePlay(channel->id());
+    // TODO: Prevent streaming from an already streaming sound. Sounds loaded
+    // with load_compressed() can be played on any number of channels.
+    channel->sound = sound;
+    channel->state = Channel::State::Playing;
+    channel->world_position = position;
+    al_mixer->balance();
     return channel;
 }
 
 void rainbow::audio::stop(Channel* channel)
 {
-    alSourceStop(channel->id());
-    alSourcei(channel->id(), AL_BUFFER, AL_NONE);
-    for (int i = 0; i < Channel::kNumBuffers; ++i)
-        alBufferData(channel->buffers()[i], AL_FORMAT_MONO16, nullptr, 0, 0);
-    channel->set_sound(nullptr);
+    al_mixer->free(*channel);
 }
@@ -5,13 +5,19 @@
 #ifndef AUDIO_AL_MIXER_H_
 #define AUDIO_AL_MIXER_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 #include "Audio/AL/Channel.h"
 #include "Audio/AL/Sound.h"
 #include "Audio/Mixer.h"
+#include "Threading/SpscQueue.h"
 
 typedef struct ALCcontext_struct ALCcontext;
 
@@ -21,27 +27,218 @@ typedef struct ALCcontext_struct ALCcontext;
 
 namespace rainbow { namespace audio
 {
+    /// <summary>OpenAL backend.</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Sources are driven by a dedicated audio thread that refills
+    ///     streaming sources, so that playback does not depend on the frame
+    ///     rate. Calls to <c>rainbow::audio</c> functions are forwarded to the
+    ///     audio thread through a lock-free queue, and must all be made from
+    ///     the main thread.
+    ///   </para>
+    ///   <para>
+    ///     When all sources are taken, new channels are virtual until they
+    ///     outrank a playing channel by priority, then by how loud they are.
+    ///     The lowest ranking channel is then virtualised to make room.
+    ///   </para>
+    /// </remarks>
     class ALMixer
     {
     public:
+        static constexpr int kNumBuffers = 3;
+
+        /// <summary>Number of channels for every source.</summary>
+        static constexpr int kChannelsPerSource = 4;
+
+        /// <summary>
+        ///   Request for the audio thread to act on a source or sound.
+        /// </summary>
+        struct Command
+        {
+            enum class Type
+            {
+                Start,
+                Pause,
+                Resume,
+                Stop,
+                SetLoopCount,
+                SetPosition,
+                SetVolume,
+                DeleteBuffer,
+                DeleteFile,
+                DeleteData,
+            };
+
+            Type type;
+            uint32_t source;
+            uint32_t generation;  ///< Playback the command is meant for.
+            IAudioFile* file;     ///< Stream to play or delete.
+            const Data* data;     ///< Compressed audio to play or delete.
+            uint32_t buffer;      ///< Static buffer to play or delete.
+            int format;
+            int rate;
+            int count;
+            size_t offset;  ///< Frame to start playing from.
+            float volume;
+            Vec2f position;
+        };
+
+        /// <summary>
+        ///   Returns the number of times a streaming channel has run out of
+        ///   audio before it could be refilled.
+        /// </summary>
+        auto underrun_count() const
+        {
+            return underrun_count_.load(std::memory_order_relaxed);
+        }
+
+        auto sample_cache() -> SampleCache& { return samples_; }
+        auto voice_stats() const -> VoiceStats;
+
         bool initialize(int max_channels);
         void process();
         void suspend(bool should_suspend);
 
         auto create_sound(czstring path) -> Sound*;
-        auto get_channel() -> Channel*;
         void release(Sound* sound);
 
+        /// <summary>
+        ///   Creates a static buffer holding a copy of
+        ///   <paramref name="pcm"/>.
+        /// </summary>
+        auto create_buffer(int format,
+                           const void* pcm,
+                           size_t size,
+                           int rate) -> uint32_t;
+
+        // Channel management
+
+        /// <summary>
+        ///   Returns an unused channel. If there are none, the lowest
+        ///   ranking channel is stolen, unless all channels have higher
+        ///   than default priority, in which case <c>nullptr</c> is returned.
+        /// </summary>
+        auto get_channel() -> Channel*;
+
+        /// <summary>
+        ///   Assigns sources to channels that outrank those currently playing.
+        /// </summary>
+        void balance();
+
+        /// <summary>Stops playback and returns the channel to pool.</summary>
+        void free(Channel& channel);
+
+        /// <summary>
+        ///   Queues a command for the source playing
+        ///   <paramref name="channel"/>, if any.
+        /// </summary>
+        void post(Channel& channel, Command command);
+
+        /// <summary>Queues a command for the audio thread.</summary>
+        void post(const Command& command);
+
     protected:
         ~ALMixer();
 
     private:
+        static constexpr size_t kCommandQueueSize = 1024;
+        static constexpr size_t kEventQueueSize = 256;
+
+        /// <summary>
+        ///   Notification, from the audio thread, that playback has ended.
+        /// </summary>
+        struct Event
+        {
+            uint32_t source;
+            uint32_t generation;
+        };
+
+        /// <summary>An OpenAL source, as seen from the main thread.</summary>
+        struct Source
+        {
+            uint32_t id;
+            std::array<uint32_t, kNumBuffers> buffers;
+            uint32_t generation;  ///< Incremented every time playback starts.
+            Channel* channel;     ///< Channel currently using this source.
+        };
+
+        /// <summary>State of a source owned by the audio thread.</summary>
+        struct Voice
+        {
+            IAudioFile* file = nullptr;  ///< Stream; null if static.
+
+            /// <summary>Decoder owned by this voice, if compressed.</summary>
+            std::unique_ptr<IAudioFile> decoder;
+
+            size_t buffer_size = 0;      ///< Bytes per stream buffer.
+            int format = 0;
+            int rate = 0;
+            int loop_count = 0;
+            uint32_t generation = 0;
+            bool active = false;
+            bool paused = false;
+            bool draining = false;  ///< Stream has no more data to queue.
+            bool finished = false;  ///< Ended, but main thread not told yet.
+        };
+
         std::vector<Channel> channels_;
+        std::vector<Channel*> free_channels_;
+        std::vector<Source> sources_;
+        std::vector<uint32_t> free_sources_;
         std::unordered_map<std::string, Sound> sounds_;
+        SampleCache samples_;
+        std::chrono::steady_clock::time_point last_process_;
+        uint32_t steal_count_ = 0;
         ALCcontext* context_ = nullptr;
 #ifdef RAINBOW_OS_IOS
         RainbowAudioSession* audio_session_ = nil;
 #endif
+
+        SpscQueue<Command, kCommandQueueSize> commands_;
+        SpscQueue<Event, kEventQueueSize> events_;
+        std::vector<Voice> voices_;          ///< Audio thread only.
+        std::vector<uint8_t> stream_buffer_;  ///< Audio thread only.
+        std::vector<Command> deferred_;  ///< Commands held while suspended.
+        std::atomic<uint32_t> underrun_count_{0};
+        bool suspended_ = false;  ///< Guarded by <c>mutex_</c>.
+        std::mutex mutex_;  ///< Held while touching AL.
+        std::atomic<bool> shutdown_{false};
+        std::thread thread_;
+
+        /// <summary>
+        ///   Gives <paramref name="channel"/> a source and starts playback
+        ///   where it should currently be.
+        /// </summary>
+        void realise(Channel& channel, uint32_t source);
+
+        /// <summary>Takes the source from <paramref name="channel"/>.</summary>
+        auto virtualise(Channel& channel) -> uint32_t;
+
+        // Audio thread
+
+        void execute(const Command& command);
+
+        /// <summary>
+        ///   Carries out commands held while suspended, then queued
+        ///   commands, in order.
+        /// </summary>
+        void execute_commands();
+
+        void finish(uint32_t source);
+        auto read(Voice& voice) -> size_t;
+        void run();
+
+        /// <summary>
+        ///   Carries out queued commands and refills streaming sources.
+        ///   While suspended, commands are held until resumed instead, so
+        ///   that the queue never fills up. <c>mutex_</c> must be held.
+        /// </summary>
+        void service();
+
+        void start(const Command& command);
+        void stop(uint32_t source);
+        void update();
+        void update(uint32_t source);
     };
 
     using Mixer = TMixer<ALMixer>;
@@ -0,0 +1,75 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/AL/Ranking.h"
+
+#include <cmath>
+
+using rainbow::audio::Channel;
+using rainbow::audio::Promotion;
+
+auto rainbow::audio::get_audibility(const Channel& channel) -> float
+{
+    if (channel.state != Channel::State::Playing)
+        return 0.0f;
+
+    const auto& p = channel.world_position;
+    const float distance = std::sqrt(p.x * p.x + p.y * p.y);
+    return distance > 1.0f ? channel.volume / distance : channel.volume;
+}
+
+bool rainbow::audio::outranks(const Channel& a, const Channel& b)
+{
+    if (a.priority != b.priority)
+        return a.priority > b.priority;
+
+    return get_audibility(a) > get_audibility(b);
+}
+
+auto rainbow::audio::find_steal_victim(std::vector<Channel>& channels)
+    -> Channel*
+{
+    Channel* victim = nullptr;
+    for (Channel& channel : channels)
+    {
+        if (victim == nullptr || outranks(*victim, channel))
+            victim = &channel;
+    }
+
+    if (victim == nullptr || victim->priority > Channel::kDefaultPriority)
+        return nullptr;
+
+    return victim;
+}
+
+auto rainbow::audio::find_promotion(std::vector<Channel>& channels,
+                                    bool has_free_source) -> Promotion
+{
+    Channel* best_virtual = nullptr;
+    Channel* worst_real = nullptr;
+    for (Channel& channel : channels)
+    {
+        if (channel.state == Channel::State::Stopped)
+            continue;
+
+        if (!channel.is_virtual())
+        {
+            if (worst_real == nullptr || outranks(*worst_real, channel))
+                worst_real = &channel;
+        }
+        else if (channel.state == Channel::State::Playing &&
+                 (best_virtual == nullptr || outranks(channel, *best_virtual)))
+        {
+            best_virtual = &channel;
+        }
+    }
+
+    if (best_virtual == nullptr || has_free_source)
+        return {best_virtual, nullptr};
+
+    if (worst_real != nullptr && outranks(*best_virtual, *worst_real))
+        return {best_virtual, worst_real};
+
+    return {nullptr, nullptr};
+}
@@ -0,0 +1,53 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_AL_RANKING_H_
+#define AUDIO_AL_RANKING_H_
+
+#include <vector>
+
+#include "Audio/AL/Channel.h"
+
+namespace rainbow { namespace audio
+{
+    /// <summary>
+    ///   Virtual channel that should be given a source, and the real channel
+    ///   it should take the source from.
+    /// </summary>
+    struct Promotion
+    {
+        Channel* channel;  ///< Virtual channel; <c>nullptr</c> if none.
+        Channel* victim;   ///< Real channel; <c>nullptr</c> if source is free.
+    };
+
+    /// <summary>
+    ///   Returns how loud a channel is. Follows OpenAL's default inverse
+    ///   distance clamped model, with the listener at the origin.
+    /// </summary>
+    auto get_audibility(const Channel& channel) -> float;
+
+    /// <summary>
+    ///   Returns whether <paramref name="a"/> should rather be heard than
+    ///   <paramref name="b"/>: first by priority, then by audibility.
+    /// </summary>
+    bool outranks(const Channel& a, const Channel& b);
+
+    /// <summary>
+    ///   Returns the lowest ranking of <paramref name="channels"/>, which is
+    ///   to be stopped to make room for a new one. Returns <c>nullptr</c> if
+    ///   even that channel has a raised priority.
+    /// </summary>
+    auto find_steal_victim(std::vector<Channel>& channels) -> Channel*;
+
+    /// <summary>
+    ///   Returns the highest ranking virtual channel that is playing, if it
+    ///   should be given a source. It takes a free source if there is one,
+    ///   otherwise the source of the lowest ranking real channel that it
+    ///   outranks.
+    /// </summary>
+    auto find_promotion(std::vector<Channel>& channels,
+                        bool has_free_source) -> Promotion;
+}}  // namespace rainbow::audio
+
+#endif
@@ -6,6 +6,8 @@
 #define AUDIO_AL_SOUND_H_
 
 #include "Audio/AudioFile.h"
+#include "Audio/SampleCache.h"
+#include "Common/Data.h"
 
 namespace rainbow { namespace audio
 {
@@ -15,8 +17,11 @@ namespace rainbow { namespace audio
         int format = 0;
         int rate = 0;
         int loop_count = 0;
+        size_t frames = 0;  ///< Length in sample frames.
         unsigned int buffer = 0;
+        SharedPtr<Samples> samples;  ///< Decoded audio, unless streamed.
         std::unique_ptr<IAudioFile> file;
+        std::unique_ptr<Data> encoded;  ///< Compressed audio, if any.
         czstring key = nullptr;
     };
 }}  // namespace rainbow::audio
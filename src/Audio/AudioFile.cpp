@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <array>
 
+#include "Common/Data.h"
 #include "Common/Logging.h"
 
 #if defined(RAINBOW_OS_IOS) || defined(RAINBOW_OS_MACOS)
@@ -41,6 +42,7 @@ namespace
         auto rate() const -> int override { return kFallbackBufferSize >> 1; }
 
         void rewind() override {}
+        void seek_frame(size_t) override {}
 
         // IFile implementation.
 
@@ -82,3 +84,24 @@ std::unique_ptr<IAudioFile> IAudioFile::open(czstring path)
     return std::unique_ptr<IAudioFile>{std::make_unique<DummyAudioFile>()};
 #endif  // USE_AUDIOTOOLBOX
 }
+
+std::unique_ptr<IAudioFile> IAudioFile::open(const rainbow::Data& data)
+{
+    std::array<uint8_t, 8> signature{};
+    if (data.size() < signature.size())
+        return {};
+
+    const auto bytes = static_cast<const uint8_t*>(data.bytes());
+    std::copy_n(bytes, signature.size(), signature.begin());
+
+#ifdef USE_OGGVORBIS
+    if (OggVorbisAudioFile::signature_matches(signature))
+    {
+        auto file = std::make_unique<OggVorbisAudioFile>(bytes, data.size());
+        if (*file)
+            return std::unique_ptr<IAudioFile>{std::move(file)};
+    }
+#endif  // USE_OGGVORBIS
+
+    return {};
+}
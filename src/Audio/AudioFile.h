@@ -9,6 +9,11 @@
 
 #include "FileSystem/File.h"
 
+namespace rainbow
+{
+    class Data;
+}
+
 namespace rainbow { namespace audio
 {
     class IAudioFile : public IFile
@@ -16,10 +21,22 @@ namespace rainbow { namespace audio
     public:
         static std::unique_ptr<IAudioFile> open(czstring path);
 
+        /// <summary>
+        ///   Returns a decoder reading directly from encoded audio in memory,
+        ///   or an empty pointer if the format cannot be decoded this way.
+        ///   <paramref name="data"/> must outlive the decoder.
+        /// </summary>
+        static std::unique_ptr<IAudioFile> open(const Data& data);
+
         virtual auto channels() const -> int = 0;
         virtual auto rate() const -> int = 0;
 
         virtual void rewind() = 0;
+
+        /// <summary>
+        ///   Moves the read position to the specified sample frame.
+        /// </summary>
+        virtual void seek_frame(size_t frame) = 0;
     };
 }}  // namespace rainbow::audio
 
@@ -26,6 +26,7 @@ namespace rainbow { namespace audio
 
         auto rate() const -> int override { return format_.mSampleRate; }
         void rewind() override { seek(0, 0); }
+        void seek_frame(size_t frame) override { seek(frame, 0); }
 
         // IFile overrides.
 
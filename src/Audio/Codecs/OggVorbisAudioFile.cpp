@@ -4,6 +4,7 @@
 
 #include "Audio/Codecs/OggVorbisAudioFile.h"
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 
@@ -53,6 +54,54 @@ namespace
     }
 }
 
+struct OggVorbisAudioFile::MemoryCallbacks
+{
+    static auto read(void* ptr, size_t size, size_t count, void* datasource)
+        -> size_t
+    {
+        auto reader = static_cast<MemoryReader*>(datasource);
+        if (size == 0)
+            return 0;
+
+        const size_t available = reader->size - reader->position;
+        const size_t n = std::min(count, available / size);
+        memcpy(ptr, reader->data + reader->position, n * size);
+        reader->position += n * size;
+        return n;
+    }
+
+    static int seek(void* datasource, ogg_int64_t offset, int origin)
+    {
+        auto reader = static_cast<MemoryReader*>(datasource);
+        int64_t position = offset;
+        switch (origin)
+        {
+            case SEEK_SET:
+                break;
+            case SEEK_CUR:
+                position += static_cast<int64_t>(reader->position);
+                break;
+            case SEEK_END:
+                position += static_cast<int64_t>(reader->size);
+                break;
+            default:
+                return -1;
+        }
+
+        if (position < 0 || static_cast<size_t>(position) > reader->size)
+            return -1;
+
+        reader->position = static_cast<size_t>(position);
+        return 0;
+    }
+
+    static long tell(void* datasource)
+    {
+        return static_cast<long>(
+            static_cast<MemoryReader*>(datasource)->position);
+    }
+};
+
 bool OggVorbisAudioFile::signature_matches(const std::array<uint8_t, 8>& id)
 {
     constexpr size_t size = array_size(kIdOggVorbis) - 1;
@@ -60,10 +109,31 @@ bool OggVorbisAudioFile::signature_matches(const std::array<uint8_t, 8>& id)
 }
 
 OggVorbisAudioFile::OggVorbisAudioFile(File f)
-    : file_(std::move(f)), vi_(nullptr)
+    : file_(std::move(f)), memory_{nullptr, 0, 0}, vi_(nullptr)
+{
+    init(static_cast<FILE*>(file_), OV_CALLBACKS_DEFAULT);
+}
+
+OggVorbisAudioFile::OggVorbisAudioFile(const uint8_t* data, size_t size)
+    : memory_{data, size, 0}, vi_(nullptr)
 {
-    const int result = ov_open_callbacks(
-        static_cast<FILE*>(file_), &vf_, nullptr, 0, OV_CALLBACKS_DEFAULT);
+    const ov_callbacks callbacks{&MemoryCallbacks::read,
+                                 &MemoryCallbacks::seek,
+                                 nullptr,
+                                 &MemoryCallbacks::tell};
+    init(&memory_, callbacks);
+}
+
+OggVorbisAudioFile::~OggVorbisAudioFile()
+{
+    if (vi_ != nullptr)
+        ov_clear(&vf_);
+}
+
+void OggVorbisAudioFile::init(void* datasource, const ov_callbacks& callbacks)
+{
+    const int result =
+        ov_open_callbacks(datasource, &vf_, nullptr, 0, callbacks);
     if (result < 0)
     {
         ov_log_error(result);
@@ -78,12 +148,6 @@ OggVorbisAudioFile::OggVorbisAudioFile(File f)
     }
 }
 
-OggVorbisAudioFile::~OggVorbisAudioFile()
-{
-    if (vi_ != nullptr)
-        ov_clear(&vf_);
-}
-
 auto OggVorbisAudioFile::size() const -> size_t
 {
     return ov_pcm_total(const_cast<OggVorbis_File*>(&vf_), -1) * channels() * 2;
@@ -116,6 +180,13 @@ auto OggVorbisAudioFile::read(void* dst, size_t size) -> size_t
     return offset;
 }
 
+void OggVorbisAudioFile::seek_frame(size_t frame)
+{
+    const int result = ov_pcm_seek(&vf_, static_cast<ogg_int64_t>(frame));
+    if (result != 0)
+        ov_log_error(result);
+}
+
 auto OggVorbisAudioFile::seek(int64_t offset, int) -> int
 {
     const int result = ov_raw_seek(&vf_, offset);
@@ -28,6 +28,13 @@ namespace rainbow { namespace audio
         static bool signature_matches(const std::array<uint8_t, 8>& signature);
 
         OggVorbisAudioFile(File);
+
+        /// <summary>
+        ///   Decodes Ogg Vorbis data in memory. The data is not copied and
+        ///   must outlive the decoder.
+        /// </summary>
+        OggVorbisAudioFile(const uint8_t* data, size_t size);
+
         ~OggVorbisAudioFile() override;
 
         // IAudioFile overrides.
@@ -35,6 +42,7 @@ namespace rainbow { namespace audio
         auto channels() const -> int override { return vi_->channels; }
         auto rate() const -> int override { return vi_->rate; }
         void rewind() override { seek(0, 0); }
+        void seek_frame(size_t frame) override;
 
         // IFile overrides.
 
@@ -45,9 +53,22 @@ namespace rainbow { namespace audio
         /*explicit*/ operator bool() const override { return vi_ != nullptr; }
 
     private:
+        struct MemoryCallbacks;
+
+        /// <summary>Read position in in-memory data.</summary>
+        struct MemoryReader
+        {
+            const uint8_t* data;
+            size_t size;
+            size_t position;
+        };
+
         File file_;
+        MemoryReader memory_;
         OggVorbis_File vf_;
         vorbis_info* vi_;
+
+        void init(void* datasource, const ov_callbacks& callbacks);
     };
 }}  // namespace rainbow::audio
 
@@ -19,6 +19,7 @@
 #   pragma GCC diagnostic pop
 #endif
 
+#include "Common/Algorithm.h"
 #include "Common/Logging.h"
 #include "FileSystem/FileSystem.h"
 
@@ -40,7 +41,8 @@ namespace
     }
 
     template <typename F>
-    auto create_sound(F&& create, czstring path) -> FMOD::Sound*
+    auto create_sound(F&& create, czstring path, FMOD_MODE mode = FMOD_DEFAULT)
+        -> FMOD::Sound*
     {
 #ifdef RAINBOW_OS_ANDROID
         std::string uri("file:///android_asset/");
@@ -60,7 +62,7 @@ namespace
 #endif
 
         FMOD::Sound* sound;
-        auto result = create(asset, FMOD_DEFAULT, nullptr, &sound);
+        auto result = create(asset, mode, nullptr, &sound);
         if (is_fail(result))
         {
             log_error(result);
@@ -178,6 +180,28 @@ auto rainbow::audio::load_stream(czstring path) -> Sound*
     return to_opaque(sound);
 }
 
+auto rainbow::audio::load_compressed(czstring path) -> Sound*
+{
+    ASSUME(fmod_system != nullptr);
+
+    if (fmod_system == nullptr)
+        return nullptr;
+
+    auto sound = create_sound(
+        [](auto&&... args) {
+            return fmod_system->createSound(
+                std::forward<decltype(args)>(args)...);
+        },
+        path,
+        FMOD_CREATECOMPRESSEDSAMPLE);
+    return to_opaque(sound);
+}
+
+void rainbow::audio::preload(ArrayView<czstring>)
+{
+    // FMOD Studio manages sample data through its banks.
+}
+
 void rainbow::audio::release(Sound* sound)
 {
     from_opaque(sound)->release();
@@ -202,6 +226,12 @@ void rainbow::audio::set_loop_count(Channel* channel, int count)
     from_opaque(channel)->setLoopCount(count);
 }
 
+void rainbow::audio::set_priority(Channel* channel, int priority)
+{
+    // FMOD priorities go from 0 (most important) to 256, with 128 as default.
+    from_opaque(channel)->setPriority(clamp(128 - priority, 0, 256));
+}
+
 void rainbow::audio::set_volume(Channel* channel, float volume)
 {
     from_opaque(channel)->setVolume(volume);
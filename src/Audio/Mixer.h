@@ -8,12 +8,20 @@
 #include "Common/NonCopyable.h"
 #include "Common/String.h"
 #include "Math/Vec2.h"
+#include "Memory/Array.h"
 
 namespace rainbow { namespace audio
 {
     struct Channel;
     struct Sound;
 
+    struct VoiceStats
+    {
+        unsigned int real = 0;         ///< Channels that are audible.
+        unsigned int virtualised = 0;  ///< Channels waiting for a voice.
+        unsigned int stolen = 0;  ///< Channels stopped to make room, total.
+    };
+
     template <typename T>
     class TMixer : private T, private NonCopyable<TMixer<T>>
     {
@@ -26,14 +34,39 @@ namespace rainbow { namespace audio
         void process() { impl().process(); }
         void suspend(bool should_suspend) { impl().suspend(should_suspend); }
 
+        /// <summary>
+        ///   Returns the number of times a streaming channel has run out of
+        ///   audio before it could be refilled.
+        /// </summary>
+        auto underrun_count() const { return impl().underrun_count(); }
+
+        /// <summary>
+        ///   Returns the cache of decoded audio shared by static sounds.
+        /// </summary>
+        auto sample_cache() -> decltype(auto) { return impl().sample_cache(); }
+
+        /// <summary>Returns the number of real and virtual voices.</summary>
+        auto voice_stats() const { return impl().voice_stats(); }
+
     private:
         T& impl() { return *static_cast<T*>(this); }
+        const T& impl() const { return *static_cast<const T*>(this); }
     };
 
     // Sound management
 
     auto load_sound(czstring path) -> Sound*;
     auto load_stream(czstring path) -> Sound*;
+
+    /// <summary>
+    ///   Loads a sound that is kept compressed in memory, and decoded while
+    ///   it plays. Unlike streams, it can be played on several channels at
+    ///   once. Sounds that cannot be decoded from memory are loaded as with
+    ///   <see cref="load_sound"/>.
+    /// </summary>
+    auto load_compressed(czstring path) -> Sound*;
+
+    void preload(ArrayView<czstring> paths);
     void release(Sound* sound);
 
     // Playback
@@ -42,6 +75,7 @@ namespace rainbow { namespace audio
     bool is_playing(Channel*);
 
     void set_loop_count(Channel*, int count);
+    void set_priority(Channel*, int priority);
     void set_volume(Channel*, float volume);
     void set_world_position(Channel*, Vec2f position);
 
@@ -58,6 +92,8 @@ namespace rainbow { namespace audio
 #   include "Audio/AL/Mixer.h"
 #elif defined(RAINBOW_AUDIO_FMOD)
 #   include "Audio/FMOD/Mixer.h"
+#elif defined(RAINBOW_AUDIO_SOFTWARE)
+#   include "Audio/Software/Mixer.h"
 #elif defined(RAINBOW_AUDIO_WWISE)
 #   include "Audio/Wwise/Mixer.h"
 #elif defined(RAINBOW_AUDIO_XAUDIO2)
@@ -0,0 +1,327 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/SampleCache.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "Common/Algorithm.h"
+#include "Common/Logging.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
+#include "Threading/ThreadPool.h"
+
+using rainbow::File;
+using rainbow::SharedPtr;
+using rainbow::ThreadPool;
+using rainbow::audio::SampleCache;
+using rainbow::audio::Samples;
+using rainbow::czstring;
+
+namespace
+{
+    /// <summary>Directory, in user data, of decoded audio.</summary>
+    constexpr char kCacheDirectory[] = "sounds";
+
+    /// <summary>
+    ///   Identifies decoded audio files. Bump the version whenever the layout
+    ///   changes.
+    /// </summary>
+    constexpr uint32_t kCacheMagic = rainbow::make_fourcc('R', 'B', 'P', '1');
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t channels;
+        uint32_t rate;
+        uint32_t size;
+    };
+
+    /// <summary>
+    ///   Returns the path, relative to user data, of the decoded version of
+    ///   the file with the specified hash.
+    /// </summary>
+    auto cache_path(uint64_t hash) -> std::string
+    {
+        char path[sizeof(kCacheDirectory) + 24];
+        snprintf(path, sizeof(path), "%s/%016" PRIx64 ".pcm", kCacheDirectory,
+                 hash);
+        return path;
+    }
+
+    /// <summary>
+    ///   Computes the FNV-1a hash of the asset at <paramref name="path"/>.
+    /// </summary>
+    /// <returns><c>false</c> if the file could not be read.</returns>
+    bool hash_file(czstring path, uint64_t& hash)
+    {
+        auto file = File::open_asset(path);
+        if (!file)
+            return false;
+
+        uint8_t buffer[4096];
+        hash = rainbow::kFnv1aOffsetBasis;
+        for (size_t read = file.read(buffer, sizeof(buffer)); read > 0;
+             read = file.read(buffer, sizeof(buffer)))
+        {
+            hash = rainbow::fnv1a(buffer, read, hash);
+        }
+        return true;
+    }
+
+    auto load_cached(uint64_t hash) -> std::unique_ptr<Samples>
+    {
+        const auto path = cache_path(hash);
+        const auto file_path = rainbow::filesystem::user(path.c_str());
+        std::error_code error;
+        if (!rainbow::filesystem::is_regular_file(file_path, error))
+            return {};
+
+        auto file = File::open(file_path);
+        CacheHeader header;
+        if (file.read(&header, sizeof(header)) != sizeof(header) ||
+            header.magic != kCacheMagic || header.channels == 0 ||
+            header.size % (header.channels * sizeof(int16_t)) != 0)
+        {
+            LOGW("Ignoring invalid decoded audio '%s'", path.c_str());
+            return {};
+        }
+
+        auto samples = std::make_unique<Samples>();
+        samples->pcm.resize(header.size / sizeof(int16_t));
+        if (file.read(samples->pcm.data(), header.size) != header.size)
+            return {};
+
+        samples->hash = hash;
+        samples->channels = header.channels;
+        samples->rate = header.rate;
+        samples->size = header.size;
+        return samples;
+    }
+
+    void save_cached(const Samples& samples)
+    {
+        std::error_code error;
+        const auto directory = rainbow::filesystem::user(kCacheDirectory);
+        if (!rainbow::filesystem::create_directories(directory, error))
+            return;
+
+        const auto path = cache_path(samples.hash);
+        auto file = File::open_write(path.c_str());
+        if (!file)
+            return;
+
+        const CacheHeader header{kCacheMagic,
+                                 static_cast<uint32_t>(samples.channels),
+                                 static_cast<uint32_t>(samples.rate),
+                                 static_cast<uint32_t>(samples.size)};
+        if (file.write(&header, sizeof(header)) != sizeof(header) ||
+            file.write(samples.pcm.data(), samples.size) != samples.size)
+        {
+            LOGW("Failed to write decoded audio '%s'", path.c_str());
+        }
+    }
+
+    /// <summary>
+    ///   Decodes the file at <paramref name="path"/>, or reads it from the
+    ///   disk cache if enabled. Safe to call from any thread.
+    /// </summary>
+    auto decode(SampleCache::Opener open,
+                czstring path,
+                uint64_t hash,
+                bool disk_cache) -> std::unique_ptr<Samples>
+    {
+        if (disk_cache)
+        {
+            auto cached = load_cached(hash);
+            if (cached)
+                return cached;
+        }
+
+        auto file = open(path);
+        if (!file || !*file)
+            return {};
+
+        auto samples = std::make_unique<Samples>();
+        samples->hash = hash;
+        samples->channels = file->channels();
+        samples->rate = file->rate();
+
+        auto& pcm = samples->pcm;
+        pcm.resize(file->size() / sizeof(pcm[0]));
+        const size_t read = file->read(pcm.data(), pcm.size() * sizeof(pcm[0]));
+        pcm.resize(read / sizeof(pcm[0]));
+        samples->size = pcm.size() * sizeof(pcm[0]);
+
+        if (disk_cache)
+            save_cached(*samples);
+
+        return samples;
+    }
+}
+
+SampleCache::SampleCache(Opener open)
+    : open_(open), budget_(kDefaultBudget), size_(0), clock_(0),
+      disk_cache_(false)
+{
+}
+
+SampleCache::~SampleCache()
+{
+    clear();
+}
+
+auto SampleCache::acquire(czstring path) -> SharedPtr<Samples>
+{
+    auto i = hashes_.find(path);
+    if (i == hashes_.end())
+    {
+        uint64_t hash;
+        if (!hash_file(path, hash))
+        {
+            LOGE("Failed to open '%s'", path);
+            return {};
+        }
+
+        i = hashes_.emplace(path, hash).first;
+    }
+
+    auto entry = entries_.find(i->second);
+    if (entry != entries_.end())
+    {
+        entry->second->last_used = ++clock_;
+        return entry->second;
+    }
+
+    auto samples = decode(open_, path, i->second, disk_cache_);
+    if (!samples)
+        return {};
+
+    SharedPtr<Samples> result = insert(std::move(samples));
+    trim();
+    return result;
+}
+
+void SampleCache::clear()
+{
+    for (auto&& entry : entries_)
+    {
+        if (evict_)
+            evict_(*entry.second);
+    }
+
+    entries_.clear();
+    size_ = 0;
+}
+
+void SampleCache::preload(ArrayView<czstring> paths)
+{
+    struct Job
+    {
+        czstring path;
+        uint64_t hash;
+        bool hashed;
+        std::unique_ptr<Samples> samples;
+    };
+
+    std::vector<Job> jobs;
+    jobs.reserve(paths.size());
+    for (auto path : paths)
+    {
+        auto i = hashes_.find(path);
+        if (i == hashes_.end())
+            jobs.push_back({path, 0, false, nullptr});
+        else if (entries_.find(i->second) == entries_.end())
+            jobs.push_back({path, i->second, true, nullptr});
+    }
+
+    if (jobs.empty())
+        return;
+
+    if (!decoders_)
+    {
+        decoders_ =
+            std::make_unique<ThreadPool>(ThreadPool::default_worker_count());
+    }
+
+    // |entries_| is only read while jobs are running.
+    decoders_->parallel_for(
+        static_cast<uint32_t>(jobs.size()), [this, &jobs](uint32_t i) {
+            Job& job = jobs[i];
+            if (!job.hashed)
+            {
+                job.hashed = hash_file(job.path, job.hash);
+                if (!job.hashed || entries_.count(job.hash) > 0)
+                    return;
+            }
+
+            job.samples = decode(open_, job.path, job.hash, disk_cache_);
+        });
+
+    for (Job& job : jobs)
+    {
+        if (!job.hashed)
+        {
+            LOGE("Failed to open '%s'", job.path);
+            continue;
+        }
+
+        hashes_.emplace(job.path, job.hash);
+
+        // Identical files may have been decoded more than once.
+        if (job.samples && entries_.count(job.hash) == 0)
+            insert(std::move(job.samples));
+    }
+
+    if (size_ > budget_)
+        LOGW("Preloaded sounds exceed the sample cache budget");
+
+    trim();
+}
+
+void SampleCache::set_budget(size_t budget)
+{
+    budget_ = budget;
+    trim();
+}
+
+void SampleCache::trim()
+{
+    while (size_ > budget_)
+    {
+        auto lru = entries_.end();
+        for (auto i = entries_.begin(); i != entries_.end(); ++i)
+        {
+            // The cache holds the only reference to unused entries.
+            if (i->second.use_count() > 1)
+                continue;
+
+            if (lru == entries_.end() ||
+                i->second->last_used < lru->second->last_used)
+            {
+                lru = i;
+            }
+        }
+
+        if (lru == entries_.end())
+            return;
+
+        if (evict_)
+            evict_(*lru->second);
+
+        size_ -= lru->second->size;
+        entries_.erase(lru);
+    }
+}
+
+auto SampleCache::insert(std::unique_ptr<Samples> samples)
+    -> const SharedPtr<Samples>&
+{
+    samples->last_used = ++clock_;
+    size_ += samples->size;
+
+    const uint64_t hash = samples->hash;
+    return entries_.emplace(hash, std::move(samples)).first->second;
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SAMPLECACHE_H_
+#define AUDIO_SAMPLECACHE_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Audio/AudioFile.h"
+#include "Common/NonCopyable.h"
+#include "Memory/Array.h"
+#include "Memory/SharedPtr.h"
+
+namespace rainbow
+{
+    class ThreadPool;
+}
+
+namespace rainbow { namespace audio
+{
+    /// <summary>
+    ///   Decoded 16-bit PCM, shared by all sounds whose source files have
+    ///   identical contents.
+    /// </summary>
+    struct Samples : public RefCounted
+    {
+        uint64_t hash = 0;  ///< FNV-1a hash of the source file.
+        int channels = 0;
+        int rate = 0;
+        size_t size = 0;  ///< Size of the decoded audio, in bytes.
+
+        /// <summary>
+        ///   Decoded audio. May be emptied once the backend has its own copy.
+        /// </summary>
+        std::vector<int16_t> pcm;
+
+        /// <summary>Backend copy of the samples, e.g. OpenAL buffer.</summary>
+        unsigned int handle = 0;
+
+        uint64_t last_used = 0;
+
+        auto frames() const -> size_t
+        {
+            return channels > 0 ? size / (channels * sizeof(int16_t)) : 0;
+        }
+    };
+
+    /// <summary>Memory budgeted cache of decoded audio.</summary>
+    /// <remarks>
+    ///   <para>
+    ///     Entries are keyed on the contents of the source file, so the same
+    ///     clip is only decoded and kept once, regardless of how many names
+    ///     it goes by. Entries no longer referenced by any sound are kept
+    ///     until the cache goes over budget, at which point the least
+    ///     recently used are evicted first. Entries in use are never evicted.
+    ///   </para>
+    ///   <para>
+    ///     When the disk cache is enabled, decoded audio is also written to
+    ///     the user data directory so that later launches can skip decoding.
+    ///   </para>
+    ///   <para>
+    ///     Apart from the decoding done by <see cref="preload"/>, the cache
+    ///     must only be used from the main thread.
+    ///   </para>
+    /// </remarks>
+    class SampleCache : private NonCopyable<SampleCache>
+    {
+    public:
+        using Evictor = std::function<void(Samples&)>;
+        using Opener = std::unique_ptr<IAudioFile> (*)(czstring path);
+
+        static constexpr size_t kDefaultBudget = 32 * 1024 * 1024;
+
+        explicit SampleCache(Opener open = &IAudioFile::open);
+        ~SampleCache();
+
+        auto budget() const { return budget_; }
+        auto count() const { return entries_.size(); }
+
+        /// <summary>
+        ///   Returns whether decoded audio is cached in the user data
+        ///   directory.
+        /// </summary>
+        bool has_disk_cache() const { return disk_cache_; }
+
+        /// <summary>
+        ///   Returns the size, in bytes, of all decoded audio held, whether in
+        ///   use or not.
+        /// </summary>
+        auto size() const { return size_; }
+
+        /// <summary>
+        ///   Returns decoded audio for <paramref name="path"/>, decoding it
+        ///   only if no file with identical contents is cached. Returns an
+        ///   empty pointer if the file could not be opened.
+        /// </summary>
+        auto acquire(czstring path) -> SharedPtr<Samples>;
+
+        /// <summary>Evicts all entries, even those in use.</summary>
+        void clear();
+
+        /// <summary>
+        ///   Decodes <paramref name="paths"/> in parallel on worker threads,
+        ///   and returns when all are cached. Files already in the cache are
+        ///   skipped.
+        /// </summary>
+        void preload(ArrayView<czstring> paths);
+
+        /// <summary>
+        ///   Sets the memory budget, in bytes, for decoded audio not in use.
+        /// </summary>
+        void set_budget(size_t budget);
+
+        /// <summary>
+        ///   Sets whether decoded audio should be cached in the user data
+        ///   directory.
+        /// </summary>
+        void set_disk_cache(bool enable) { disk_cache_ = enable; }
+
+        /// <summary>
+        ///   Sets the function called on entries before they are evicted,
+        ///   e.g. to delete the backend copy.
+        /// </summary>
+        void set_evictor(Evictor evict) { evict_ = std::move(evict); }
+
+        /// <summary>
+        ///   Evicts unused entries, least recently used first, until the
+        ///   cache is within budget.
+        /// </summary>
+        void trim();
+
+    private:
+        std::unordered_map<uint64_t, SharedPtr<Samples>> entries_;
+        std::unordered_map<std::string, uint64_t> hashes_;  ///< By path.
+        std::unique_ptr<ThreadPool> decoders_;
+        Evictor evict_;
+        Opener open_;
+        size_t budget_;
+        size_t size_;
+        uint64_t clock_;  ///< Incremented on every access.
+        bool disk_cache_;
+
+        auto insert(std::unique_ptr<Samples> samples)
+            -> const SharedPtr<Samples>&;
+    };
+}}  // namespace rainbow::audio
+
+#endif
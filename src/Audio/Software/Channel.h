@@ -0,0 +1,26 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SOFTWARE_CHANNEL_H_
+#define AUDIO_SOFTWARE_CHANNEL_H_
+
+#include <memory>
+
+#include "Audio/Software/Voice.h"
+
+namespace rainbow { namespace audio
+{
+    struct Sound;
+
+    struct Channel
+    {
+        Voice voice;
+        Sound* sound = nullptr;
+
+        /// <summary>Decoder for compressed sounds.</summary>
+        std::unique_ptr<IAudioFile> decoder;
+    };
+}}  // namespace rainbow::audio
+
+#endif
@@ -0,0 +1,381 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Software/Mixer.h"
+
+#include "Platform/Macros.h"
+#if defined(RAINBOW_SDL) && !defined(RAINBOW_TEST)
+#   include <SDL.h>
+#   define USE_SDL_AUDIO
+#endif
+
+#include "Common/Logging.h"
+
+using rainbow::audio::Channel;
+using rainbow::audio::ISink;
+using rainbow::audio::NullSink;
+using rainbow::audio::Samples;
+using rainbow::audio::Sound;
+using rainbow::audio::SoftwareMixer;
+using rainbow::czstring;
+
+namespace
+{
+    /// <summary>
+    ///   Number of frames a <see cref="NullSink"/> accepts per update; one
+    ///   frame's worth at 60 fps.
+    /// </summary>
+    constexpr size_t kNullSinkFrames = SoftwareMixer::kDefaultRate / 60;
+
+    SoftwareMixer* software_mixer = nullptr;
+
+#ifdef USE_SDL_AUDIO
+    /// <summary>Queues audio on the default SDL audio device.</summary>
+    class SDLSink final : public ISink
+    {
+    public:
+        SDLSink() : device_(0), rate_(SoftwareMixer::kDefaultRate)
+        {
+            if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+            {
+                LOGE("SDL: Failed to initialise audio: %s", SDL_GetError());
+                return;
+            }
+
+            SDL_AudioSpec desired{};
+            desired.freq = rate_;
+            desired.format = AUDIO_S16SYS;
+            desired.channels = 2;
+            desired.samples = 1024;
+
+            SDL_AudioSpec obtained;
+            device_ = SDL_OpenAudioDevice(  //
+                nullptr,
+                0,
+                &desired,
+                &obtained,
+                SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+            if (device_ == 0)
+            {
+                LOGE("SDL: Failed to open audio device: %s", SDL_GetError());
+                return;
+            }
+
+            rate_ = obtained.freq;
+            SDL_PauseAudioDevice(device_, 0);
+        }
+
+        ~SDLSink()
+        {
+            if (device_ != 0)
+                SDL_CloseAudioDevice(device_);
+            SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        }
+
+        explicit operator bool() const { return device_ != 0; }
+
+        // ISink implementation.
+
+        auto rate() const -> int override { return rate_; }
+
+        auto available() const -> size_t override
+        {
+            // Stay this far ahead of the device to survive a slow frame.
+            constexpr size_t kLatency = 60;  // ms
+
+            const size_t target = rate_ * kLatency / 1000;
+            const size_t queued = SDL_GetQueuedAudioSize(device_) / kFrameSize;
+            return queued < target ? target - queued : 0;
+        }
+
+        void write(const int16_t* samples, size_t frames) override
+        {
+            SDL_QueueAudio(
+                device_, samples, static_cast<Uint32>(frames * kFrameSize));
+        }
+
+    private:
+        static constexpr size_t kFrameSize = 2 * sizeof(int16_t);
+
+        SDL_AudioDeviceID device_;
+        int rate_;
+    };
+#endif  // USE_SDL_AUDIO
+
+    auto make_default_sink() -> std::unique_ptr<ISink>
+    {
+#ifdef USE_SDL_AUDIO
+        auto sink = std::make_unique<SDLSink>();
+        if (*sink)
+            return std::unique_ptr<ISink>{std::move(sink)};
+
+        LOGW("SDL: No audio device available, audio will be discarded");
+#endif  // USE_SDL_AUDIO
+        return std::make_unique<NullSink>(SoftwareMixer::kDefaultRate,
+                                          kNullSinkFrames);
+    }
+}
+
+bool SoftwareMixer::initialize(int max_channels)
+{
+    R_ASSERT(software_mixer == nullptr, "Mixer is already initialised");
+
+    channels_.resize(max_channels);
+    voices_.reserve(max_channels);
+    set_sink(make_default_sink());
+    software_mixer = this;
+    return true;
+}
+
+void SoftwareMixer::process()
+{
+    voices_.clear();
+    for (Channel& channel : channels_)
+    {
+        if (!channel.voice.playing)
+        {
+            channel.sound = nullptr;
+            channel.decoder.reset();
+            continue;
+        }
+
+        voices_.push_back(&channel.voice);
+    }
+
+    if (suspended_ || !sink_)
+        return;
+
+    const size_t frames = sink_->available();
+    if (frames == 0)
+        return;
+
+    output_.resize(frames * 2);
+    renderer_.render(voices_.data(), voices_.size(), output_.data(), frames);
+    sink_->write(output_.data(), frames);
+}
+
+auto SoftwareMixer::create_sound(czstring path) -> Sound*
+{
+    auto i = sounds_.find(path);
+    if (i == sounds_.end())
+    {
+        sounds_[path] = Sound{};
+        i = sounds_.find(path);
+        i->second.key = i->first.c_str();
+    }
+    return &i->second;
+}
+
+auto SoftwareMixer::get_channel() -> Channel*
+{
+    for (Channel& channel : channels_)
+    {
+        if (!channel.voice.playing)
+            return &channel;
+    }
+
+    channels_.emplace_back();
+    return &channels_.back();
+}
+
+void SoftwareMixer::release(Sound* sound)
+{
+    for (Channel& channel : channels_)
+    {
+        if (channel.sound == sound)
+            rainbow::audio::stop(&channel);
+    }
+
+    sounds_.erase(sound->key);
+    samples_.trim();
+}
+
+void SoftwareMixer::set_sink(std::unique_ptr<ISink> sink)
+{
+    sink_ = std::move(sink);
+    renderer_ = Renderer{sink_ ? sink_->rate() : kDefaultRate};
+}
+
+SoftwareMixer::~SoftwareMixer()
+{
+    software_mixer = nullptr;
+}
+
+void rainbow::audio::set_sink(std::unique_ptr<ISink> sink)
+{
+    software_mixer->set_sink(std::move(sink));
+}
+
+auto rainbow::audio::load_sound(czstring path) -> Sound*
+{
+    auto sound = software_mixer->create_sound(path);
+    if (sound == nullptr || sound->samples)
+        return sound;
+
+    R_ASSERT(!sound->stream, "Sound already opened as a stream");
+
+    auto samples = software_mixer->sample_cache().acquire(path);
+    if (!samples)
+    {
+        release(sound);
+        return nullptr;
+    }
+
+    sound->channels = samples->channels;
+    sound->rate = samples->rate;
+    sound->samples = std::move(samples);
+    return sound;
+}
+
+auto rainbow::audio::load_stream(czstring path) -> Sound*
+{
+    auto sound = software_mixer->create_sound(path);
+    if (sound == nullptr || sound->file != nullptr)
+        return sound;
+
+    R_ASSERT(!sound->samples, "Sound already opened as static");
+    R_ASSERT(sound->encoded == nullptr, "Sound already opened as compressed");
+
+    auto audio_file = IAudioFile::open(path);
+    if (!*audio_file)
+    {
+        release(sound);
+        return nullptr;
+    }
+
+    sound->stream = true;
+    sound->channels = audio_file->channels();
+    sound->rate = audio_file->rate();
+    sound->file = std::move(audio_file);
+    return sound;
+}
+
+auto rainbow::audio::load_compressed(czstring path) -> Sound*
+{
+    auto sound = software_mixer->create_sound(path);
+    if (sound == nullptr || sound->encoded != nullptr)
+        return sound;
+
+    R_ASSERT(!sound->samples, "Sound already opened as static");
+    R_ASSERT(sound->file == nullptr, "Sound already opened as a stream");
+
+    auto data = std::make_unique<Data>(Data::load_asset(path));
+    if (!*data)
+    {
+        release(sound);
+        return nullptr;
+    }
+
+    // Only used to validate the file and read its properties. Every channel
+    // gets its own decoder.
+    auto decoder = IAudioFile::open(*data);
+    if (!decoder)
+    {
+        LOGW("'%s' cannot be decoded from memory; loading it decoded instead",
+             path);
+        release(sound);
+        return load_sound(path);
+    }
+
+    sound->stream = true;
+    sound->channels = decoder->channels();
+    sound->rate = decoder->rate();
+    sound->encoded = std::move(data);
+    return sound;
+}
+
+void rainbow::audio::preload(ArrayView<czstring> paths)
+{
+    software_mixer->sample_cache().preload(paths);
+}
+
+void rainbow::audio::release(Sound* sound)
+{
+    software_mixer->release(sound);
+}
+
+bool rainbow::audio::is_paused(Channel* channel)
+{
+    return channel->voice.paused;
+}
+
+bool rainbow::audio::is_playing(Channel* channel)
+{
+    return channel->voice.playing;
+}
+
+void rainbow::audio::set_loop_count(Channel* channel, int count)
+{
+    channel->voice.loop_count = count;
+}
+
+void rainbow::audio::set_priority(Channel*, int)
+{
+    // Channels are never stolen as the number of voices is unbounded.
+}
+
+void rainbow::audio::set_volume(Channel* channel, float volume)
+{
+    channel->voice.volume = volume;
+}
+
+void rainbow::audio::set_world_position(Channel* channel, Vec2f position)
+{
+    channel->voice.world_position = position;
+}
+
+void rainbow::audio::pause(Channel* channel)
+{
+    if (channel->voice.playing)
+        channel->voice.paused = true;
+}
+
+auto rainbow::audio::play(Channel* channel) -> Channel*
+{
+    if (!channel->voice.playing)
+        return nullptr;
+
+    channel->voice.paused = false;
+    return channel;
+}
+
+auto rainbow::audio::play(Sound* sound, Vec2f position) -> Channel*
+{
+    Channel* channel = software_mixer->get_channel();
+    channel->sound = sound;
+
+    // TODO: Prevent streaming from an already streaming sound. Sounds loaded
+    // with load_compressed() can be played on any number of channels.
+    if (sound->encoded != nullptr)
+    {
+        channel->decoder = IAudioFile::open(*sound->encoded);
+        if (!channel->decoder)
+        {
+            channel->sound = nullptr;
+            return nullptr;
+        }
+
+        channel->voice.play(channel->decoder.get());
+    }
+    else if (sound->stream)
+    {
+        channel->voice.play(sound->file.get());
+    }
+    else
+    {
+        const Samples& samples = *sound->samples;
+        channel->voice.play(
+            samples.pcm.data(), samples.frames(), sound->channels, sound->rate);
+    }
+
+    channel->voice.world_position = position;
+    return channel;
+}
+
+void rainbow::audio::stop(Channel* channel)
+{
+    channel->voice.stop();
+    channel->sound = nullptr;
+    channel->decoder.reset();
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SOFTWARE_MIXER_H_
+#define AUDIO_SOFTWARE_MIXER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Audio/Mixer.h"
+#include "Audio/Software/Channel.h"
+#include "Audio/Software/Renderer.h"
+#include "Audio/Software/Sink.h"
+#include "Audio/Software/Sound.h"
+
+namespace rainbow { namespace audio
+{
+    /// <summary>Software mixer backend.</summary>
+    /// <remarks>
+    ///   Voices are mixed by <see cref="Renderer"/> on every update, as much
+    ///   as the sink is ready to accept. Channels are created as needed, so
+    ///   the number of simultaneous voices is only limited by CPU time.
+    /// </remarks>
+    class SoftwareMixer
+    {
+    public:
+        static constexpr int kDefaultRate = 44100;
+
+        SoftwareMixer() : renderer_(kDefaultRate), suspended_(false) {}
+
+        /// <summary>Returns the number of voices mixed last update.</summary>
+        auto voice_count() const { return voices_.size(); }
+
+        auto sample_cache() -> SampleCache& { return samples_; }
+
+        auto voice_stats() const -> VoiceStats
+        {
+            VoiceStats stats;
+            stats.real = static_cast<unsigned int>(voices_.size());
+            return stats;
+        }
+
+        bool initialize(int max_channels);
+        void process();
+        void suspend(bool should_suspend) { suspended_ = should_suspend; }
+
+        auto create_sound(czstring path) -> Sound*;
+        auto get_channel() -> Channel*;
+        void release(Sound* sound);
+
+        /// <summary>Replaces the sink that mixed audio is written to.</summary>
+        void set_sink(std::unique_ptr<ISink> sink);
+
+    protected:
+        ~SoftwareMixer();
+
+    private:
+        std::deque<Channel> channels_;
+        std::vector<Voice*> voices_;
+        std::vector<int16_t> output_;
+        std::unordered_map<std::string, Sound> sounds_;
+        SampleCache samples_;
+        std::unique_ptr<ISink> sink_;
+        Renderer renderer_;
+        bool suspended_;
+    };
+
+    using Mixer = TMixer<SoftwareMixer>;
+
+    /// <summary>
+    ///   Sets where mixed audio should go, e.g. a <see cref="WavSink"/> for
+    ///   capturing output. The mixer must be initialised.
+    /// </summary>
+    void set_sink(std::unique_ptr<ISink> sink);
+}}  // namespace rainbow::audio
+
+#endif
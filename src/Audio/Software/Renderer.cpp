@@ -0,0 +1,247 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Software/Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define USE_SSE2
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define USE_NEON
+#   include <arm_neon.h>
+#endif
+
+#include "Common/Constants.h"
+
+using rainbow::audio::Renderer;
+using rainbow::audio::Voice;
+using rainbow::kPi;
+
+namespace
+{
+    constexpr float kFixedPointScale = 1.0f / 4294967296.0f;
+    constexpr float kSampleScale = 1.0f / 32768.0f;
+
+    struct Gain
+    {
+        float left;
+        float right;
+    };
+
+    /// <summary>
+    ///   Returns how loud a voice should be in either speaker. Follows
+    ///   OpenAL's default inverse distance clamped model, with a reference
+    ///   distance and rolloff factor of 1.
+    /// </summary>
+    auto get_gain(const Voice& voice) -> Gain
+    {
+        const auto& position = voice.world_position;
+        const float distance =
+            std::sqrt(position.x * position.x + position.y * position.y);
+
+        float gain = voice.volume;
+        float pan = 0.0f;
+        if (distance > 0.0f)
+        {
+            pan = position.x / distance;
+            if (distance > 1.0f)
+                gain /= distance;
+        }
+
+        if (voice.channels == 1)
+        {
+            // Constant power panning
+            const float angle = (pan + 1.0f) * kPi<float> * 0.25f;
+            return {gain * std::cos(angle), gain * std::sin(angle)};
+        }
+
+        return {gain * std::min(1.0f, 1.0f - pan),
+                gain * std::min(1.0f, 1.0f + pan)};
+    }
+
+    /// <summary>Adds <paramref name="src"/> to the bus with gain.</summary>
+    void mix(float* bus, const float* src, size_t frames, Gain gain)
+    {
+        const size_t count = frames * 2;
+        size_t i = 0;
+#if defined(USE_SSE2)
+        const __m128 g = _mm_setr_ps(gain.left, gain.right, gain.left,
+                                     gain.right);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 s = _mm_mul_ps(_mm_loadu_ps(src + i), g);
+            _mm_storeu_ps(bus + i, _mm_add_ps(_mm_loadu_ps(bus + i), s));
+        }
+#elif defined(USE_NEON)
+        const float gains[]{gain.left, gain.right, gain.left, gain.right};
+        const float32x4_t g = vld1q_f32(gains);
+        for (; i + 4 <= count; i += 4)
+        {
+            const float32x4_t s = vld1q_f32(src + i);
+            vst1q_f32(bus + i, vmlaq_f32(vld1q_f32(bus + i), s, g));
+        }
+#endif
+        for (; i < count; i += 2)
+        {
+            bus[i] += src[i] * gain.left;
+            bus[i + 1] += src[i + 1] * gain.right;
+        }
+    }
+
+    /// <summary>Clips the bus and converts it to 16-bit samples.</summary>
+    void to_int16(int16_t* out, const float* bus, size_t count)
+    {
+        size_t i = 0;
+#if defined(USE_SSE2)
+        const __m128 lower = _mm_set1_ps(-1.0f);
+        const __m128 upper = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(32767.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128 a = _mm_min_ps(
+                _mm_max_ps(_mm_loadu_ps(bus + i), lower), upper);
+            const __m128 b = _mm_min_ps(
+                _mm_max_ps(_mm_loadu_ps(bus + i + 4), lower), upper);
+            const __m128i packed =
+                _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)),
+                                _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+        }
+#elif defined(USE_NEON)
+        const float32x4_t lower = vdupq_n_f32(-1.0f);
+        const float32x4_t upper = vdupq_n_f32(1.0f);
+        for (; i + 4 <= count; i += 4)
+        {
+            const float32x4_t s =
+                vminq_f32(vmaxq_f32(vld1q_f32(bus + i), lower), upper);
+            vst1_s16(out + i,
+                     vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(s, 32767.0f))));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            const float s = std::min(std::max(bus[i], -1.0f), 1.0f);
+            out[i] = static_cast<int16_t>(std::lrint(s * 32767.0f));
+        }
+    }
+
+    /// <summary>
+    ///   Resamples <paramref name="voice"/> into interleaved stereo until
+    ///   either <paramref name="count"/> frames are written, or the position
+    ///   reaches <paramref name="end"/>.
+    /// </summary>
+    template <int Channels>
+    auto interpolate(Voice& voice,
+                     uint64_t step,
+                     uint64_t end,
+                     float* out,
+                     size_t count) -> size_t
+    {
+        const int16_t* pcm = voice.samples;
+        uint64_t position = voice.position;
+        size_t i = 0;
+        for (; i < count && position < end; ++i, position += step)
+        {
+            const size_t index = static_cast<size_t>(position >> 32) * Channels;
+            const float t = (position & 0xffffffff) * kFixedPointScale;
+            for (int c = 0; c < 2; ++c)
+            {
+                const int channel = Channels == 1 ? 0 : c;
+                const float a = pcm[index + channel];
+                const float b = pcm[index + Channels + channel];
+                out[i * 2 + c] = (a + (b - a) * t) * kSampleScale;
+            }
+        }
+        voice.position = position;
+        return i;
+    }
+
+    /// <summary>
+    ///   Moves <paramref name="voice"/> past the end of its samples, either
+    ///   by decoding more of the stream or by looping.
+    /// </summary>
+    /// <returns><c>false</c> if the voice has finished playing.</returns>
+    bool advance(Voice& voice)
+    {
+        if (voice.stream != nullptr)
+            return voice.refill();
+
+        if (voice.frames < 2 || voice.loop_count == 0)
+            return false;
+
+        if (voice.loop_count > 0)
+            --voice.loop_count;
+
+        // The last frame is only used to interpolate towards, so it lines up
+        // with the first frame when looping.
+        voice.position -= static_cast<uint64_t>(voice.frames - 1) << 32;
+        return true;
+    }
+
+    auto resample(Voice& voice, uint64_t step, float* out, size_t count)
+    {
+        size_t written = 0;
+        while (written < count)
+        {
+            const uint64_t end =
+                static_cast<uint64_t>(std::max<size_t>(voice.frames, 1) - 1)
+                << 32;
+            if (voice.position >= end)
+            {
+                if (!advance(voice))
+                {
+                    voice.stop();
+                    break;
+                }
+                continue;
+            }
+
+            written += voice.channels == 1
+                           ? interpolate<1>(voice,
+                                            step,
+                                            end,
+                                            out + written * 2,
+                                            count - written)
+                           : interpolate<2>(voice,
+                                            step,
+                                            end,
+                                            out + written * 2,
+                                            count - written);
+        }
+        return written;
+    }
+}
+
+void Renderer::render(Voice* const* voices,
+                      size_t count,
+                      int16_t* out,
+                      size_t frames)
+{
+    while (frames > 0)
+    {
+        const size_t block = std::min(frames, kBlockFrames);
+        std::fill_n(bus_.data(), block * 2, 0.0f);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Voice& voice = *voices[i];
+            if (!voice.playing || voice.paused)
+                continue;
+
+            const uint64_t step =
+                (static_cast<uint64_t>(voice.rate) << 32) / rate_;
+            const size_t length =
+                resample(voice, step, scratch_.data(), block);
+            mix(bus_.data(), scratch_.data(), length, get_gain(voice));
+        }
+
+        to_int16(out, bus_.data(), block * 2);
+        out += block * 2;
+        frames -= block;
+    }
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SOFTWARE_RENDERER_H_
+#define AUDIO_SOFTWARE_RENDERER_H_
+
+#include <array>
+
+#include "Audio/Software/Voice.h"
+
+namespace rainbow { namespace audio
+{
+    /// <summary>
+    ///   Mixes any number of voices into interleaved, 16-bit stereo.
+    /// </summary>
+    /// <remarks>
+    ///   Each voice is resampled to the output rate with linear
+    ///   interpolation, then panned and summed into a floating-point bus.
+    ///   The bus is clipped to 16-bit on output. Voices are panned and
+    ///   attenuated by their world position, like OpenAL's default distance
+    ///   model with the listener at the origin.
+    /// </remarks>
+    class Renderer
+    {
+    public:
+        explicit Renderer(int rate) : rate_(rate) {}
+
+        auto rate() const { return rate_; }
+
+        /// <summary>
+        ///   Mixes <paramref name="frames"/> frames of the given voices into
+        ///   <paramref name="out"/>. Voices that reach the end are stopped.
+        /// </summary>
+        void render(Voice* const* voices,
+                    size_t count,
+                    int16_t* out,
+                    size_t frames);
+
+    private:
+        /// <summary>Number of frames mixed at a time.</summary>
+        static constexpr size_t kBlockFrames = 256;
+
+        int rate_;
+        std::array<float, kBlockFrames * 2> bus_;      ///< Mixed output.
+        std::array<float, kBlockFrames * 2> scratch_;  ///< Resampled voice.
+    };
+}}  // namespace rainbow::audio
+
+#endif
@@ -0,0 +1,78 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Software/Sink.h"
+
+#include <array>
+
+#include "Common/Logging.h"
+
+using rainbow::audio::WavSink;
+using rainbow::czstring;
+
+namespace
+{
+    constexpr size_t kChannels = 2;
+    constexpr size_t kFrameSize = kChannels * sizeof(int16_t);
+    constexpr size_t kHeaderSize = 44;
+
+    template <size_t N>
+    void store_le(uint8_t* dst, uint32_t value)
+    {
+        for (size_t i = 0; i < N; ++i)
+            dst[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+}
+
+WavSink::WavSink(czstring path, int rate, size_t frames_per_update)
+    : NullSink(rate, frames_per_update), file_(File::open_write(path))
+{
+    if (!file_)
+    {
+        LOGE("Failed to open '%s' for writing", path);
+        return;
+    }
+
+    write_header();
+}
+
+WavSink::~WavSink()
+{
+    if (!file_)
+        return;
+
+    file_.seek(0, SEEK_SET);
+    write_header();
+}
+
+void WavSink::write(const int16_t* samples, size_t frames)
+{
+    NullSink::write(samples, frames);
+
+    // WAV files are little-endian, same as every platform we target.
+    if (file_)
+        file_.write(samples, frames * kFrameSize);
+}
+
+void WavSink::write_header()
+{
+    const auto data_size = static_cast<uint32_t>(frames_written() * kFrameSize);
+    const auto sample_rate = static_cast<uint32_t>(rate());
+
+    std::array<uint8_t, kHeaderSize> header{
+        'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        'd', 'a', 't', 'a', 0, 0, 0, 0};
+    store_le<4>(header.data() + 4, kHeaderSize - 8 + data_size);
+    store_le<4>(header.data() + 16, 16);  // Size of format chunk
+    store_le<2>(header.data() + 20, 1);   // PCM
+    store_le<2>(header.data() + 22, kChannels);
+    store_le<4>(header.data() + 24, sample_rate);
+    store_le<4>(header.data() + 28, sample_rate * kFrameSize);
+    store_le<2>(header.data() + 32, kFrameSize);
+    store_le<2>(header.data() + 34, 16);  // Bits per sample
+    store_le<4>(header.data() + 40, data_size);
+    file_.write(header.data(), header.size());
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SOFTWARE_SINK_H_
+#define AUDIO_SOFTWARE_SINK_H_
+
+#include <cstdint>
+
+#include "FileSystem/File.h"
+
+namespace rainbow { namespace audio
+{
+    /// <summary>
+    ///   Destination for audio mixed in software, e.g. an output device.
+    ///   Audio is always interleaved, 16-bit stereo.
+    /// </summary>
+    class ISink
+    {
+    public:
+        virtual ~ISink() = default;
+
+        /// <summary>Returns the sample rate of the sink.</summary>
+        virtual auto rate() const -> int = 0;
+
+        /// <summary>
+        ///   Returns the number of frames the sink is ready to accept.
+        /// </summary>
+        virtual auto available() const -> size_t = 0;
+
+        /// <summary>Writes <paramref name="frames"/> frames.</summary>
+        virtual void write(const int16_t* samples, size_t frames) = 0;
+    };
+
+    /// <summary>
+    ///   Discards all audio. Accepts a fixed number of frames per update,
+    ///   making the amount of work deterministic.
+    /// </summary>
+    class NullSink : public ISink
+    {
+    public:
+        NullSink(int rate, size_t frames_per_update)
+            : rate_(rate), frames_per_update_(frames_per_update),
+              frames_written_(0)
+        {
+        }
+
+        /// <summary>Returns the total number of frames written.</summary>
+        auto frames_written() const { return frames_written_; }
+
+        // ISink implementation.
+
+        auto rate() const -> int override { return rate_; }
+
+        auto available() const -> size_t override
+        {
+            return frames_per_update_;
+        }
+
+        void write(const int16_t*, size_t frames) override
+        {
+            frames_written_ += frames;
+        }
+
+    private:
+        int rate_;
+        size_t frames_per_update_;
+        size_t frames_written_;
+    };
+
+    /// <summary>
+    ///   Writes audio to a WAV file. Like <see cref="NullSink"/>, accepts a
+    ///   fixed number of frames per update.
+    /// </summary>
+    class WavSink final : public NullSink
+    {
+    public:
+        WavSink(czstring path, int rate, size_t frames_per_update);
+        ~WavSink();
+
+        explicit operator bool() const { return file_.is_open(); }
+
+        // ISink implementation.
+
+        void write(const int16_t* samples, size_t frames) override;
+
+    private:
+        File file_;
+
+        /// <summary>Writes the header for the current data size.</summary>
+        void write_header();
+    };
+}}  // namespace rainbow::audio
+
+#endif
@@ -0,0 +1,26 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SOFTWARE_SOUND_H_
+#define AUDIO_SOFTWARE_SOUND_H_
+
+#include "Audio/AudioFile.h"
+#include "Audio/SampleCache.h"
+#include "Common/Data.h"
+
+namespace rainbow { namespace audio
+{
+    struct Sound
+    {
+        bool stream = false;
+        int channels = 0;
+        int rate = 0;
+        SharedPtr<Samples> samples;  ///< Decoded audio, unless streamed.
+        std::unique_ptr<IAudioFile> file;
+        std::unique_ptr<Data> encoded;  ///< Compressed audio, if any.
+        czstring key = nullptr;
+    };
+}}  // namespace rainbow::audio
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Audio/Software/Voice.h"
+
+#include <algorithm>
+
+using rainbow::audio::IAudioFile;
+using rainbow::audio::Voice;
+
+namespace
+{
+    auto read_frames(IAudioFile& file, int16_t* dst, size_t frames, int ch)
+    {
+        const size_t frame_size = ch * sizeof(*dst);
+        return file.read(dst, frames * frame_size) / frame_size;
+    }
+}
+
+void Voice::play(const int16_t* pcm, size_t count, int ch, int sample_rate)
+{
+    *this = Voice{};
+    samples = pcm;
+    frames = count;
+    channels = ch;
+    rate = sample_rate;
+    playing = frames > 0;
+}
+
+void Voice::play(IAudioFile* file)
+{
+    auto storage = std::move(buffer);
+    *this = Voice{};
+
+    stream = file;
+    channels = file->channels();
+    rate = file->rate();
+    buffer = std::move(storage);
+    buffer.resize((kStreamBufferFrames + 1) * channels);
+
+    stream->rewind();
+    playing = refill();
+}
+
+void Voice::stop()
+{
+    samples = nullptr;
+    frames = 0;
+    stream = nullptr;
+    playing = false;
+    paused = false;
+}
+
+bool Voice::refill()
+{
+    size_t carried = 0;
+    if (frames > 0)
+    {
+        std::copy_n(buffer.data() + (frames - 1) * channels,
+                    channels,
+                    buffer.data());
+        position -= static_cast<uint64_t>(frames - 1) << 32;
+        carried = 1;
+    }
+
+    int16_t* dst = buffer.data() + carried * channels;
+    size_t count = read_frames(*stream, dst, kStreamBufferFrames, channels);
+    if (count == 0 && loop_count != 0)
+    {
+        if (loop_count > 0)
+            --loop_count;
+        stream->rewind();
+        count = read_frames(*stream, dst, kStreamBufferFrames, channels);
+    }
+
+    samples = buffer.data();
+    frames = carried + count;
+    return count > 0;
+}
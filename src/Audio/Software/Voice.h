@@ -0,0 +1,58 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef AUDIO_SOFTWARE_VOICE_H_
+#define AUDIO_SOFTWARE_VOICE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Audio/AudioFile.h"
+#include "Math/Vec2.h"
+
+namespace rainbow { namespace audio
+{
+    /// <summary>
+    ///   Playback state of a single sound, mixed in software by
+    ///   <see cref="Renderer"/>.
+    /// </summary>
+    struct Voice
+    {
+        /// <summary>Number of frames decoded at a time from streams.</summary>
+        static constexpr size_t kStreamBufferFrames = 4096;
+
+        const int16_t* samples = nullptr;  ///< Interleaved 16-bit PCM.
+        size_t frames = 0;                 ///< Number of frames in samples.
+        IAudioFile* stream = nullptr;      ///< Source of samples; or null.
+        std::vector<int16_t> buffer;       ///< Decoded stream data.
+        int channels = 0;
+        int rate = 0;
+        uint64_t position = 0;  ///< Frame index in 32.32 fixed point.
+        int loop_count = 0;     ///< Number of loops left; -1 for infinite.
+        float volume = 1.0f;
+        Vec2f world_position;
+        bool playing = false;
+        bool paused = false;
+
+        /// <summary>Starts playing a fully decoded sound.</summary>
+        void play(const int16_t* pcm, size_t count, int ch, int sample_rate);
+
+        /// <summary>Starts streaming from <paramref name="file"/>.</summary>
+        void play(IAudioFile* file);
+
+        /// <summary>Stops playback and detaches the sound.</summary>
+        void stop();
+
+        /// <summary>
+        ///   Decodes the next chunk of the stream, keeping the last frame of
+        ///   the previous chunk in front so that interpolation is seamless.
+        /// </summary>
+        /// <returns>
+        ///   <c>false</c> if the stream has ended and should not loop.
+        /// </returns>
+        bool refill();
+    };
+}}  // namespace rainbow::audio
+
+#endif
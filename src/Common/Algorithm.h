@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <iterator>
 #include <limits>
 #include <utility>
@@ -113,6 +114,26 @@ namespace rainbow
         return i - (i >> 1);
     }
 
+    constexpr uint64_t kFnv1aOffsetBasis = 0xcbf29ce484222325ull;
+
+    /// <summary>
+    ///   Returns the 64-bit FNV-1a hash of <paramref name="data"/>. Larger
+    ///   inputs can be hashed in chunks by passing the previous result as
+    ///   <paramref name="hash"/>.
+    /// </summary>
+    inline auto fnv1a(const void* data,
+                      size_t size,
+                      uint64_t hash = kFnv1aOffsetBasis)
+    {
+        const auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
     /// <summary>
     ///   Returns whether <paramref name="x"/> is practically zero. A number is
     ///   considered almost zero if it's within <c>10 * ε</c>. On some hardware,
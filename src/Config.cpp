@@ -20,8 +20,9 @@ namespace
 }
 
 rainbow::Config::Config()
-    : accelerometer_(true), high_dpi_(false), suspend_(true), width_(0),
-      height_(0), msaa_(0)
+    : accelerometer_(true), high_dpi_(false), parallel_update_(false),
+      suspend_(true), texture_compression_(false), width_(0), height_(0),
+      msaa_(0)
 {
     constexpr char kConfigModule[] = "config";
 
@@ -53,6 +54,10 @@ rainbow::Config::Config()
     lua_getglobal(L.get(), "msaa");
     if (lua::isnumber(L.get(), -1))
         msaa_ = std::min(floor_pow2(lua::tointeger(L.get(), -1)), kMaxMSAA);
+
+    lua_getglobal(L.get(), "parallel_update");
+    if (lua::isboolean(L.get(), -1))
+        parallel_update_ = lua::toboolean(L.get(), -1);
 #endif
 
     lua_getglobal(L.get(), "resolution");
@@ -68,5 +73,9 @@ rainbow::Config::Config()
     lua_getglobal(L.get(), "suspend_on_focus_lost");
     if (lua::isboolean(L.get(), -1))
         suspend_ = lua::toboolean(L.get(), -1);
+
+    lua_getglobal(L.get(), "texture_compression");
+    if (lua::isboolean(L.get(), -1))
+        texture_compression_ = lua::toboolean(L.get(), -1);
 #endif
 }
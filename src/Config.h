@@ -26,6 +26,10 @@ namespace rainbow
     ///       Sets number of samples for multisample anti-aliasing.
     ///     </item>
     ///     <item>
+    ///       <c>parallel_update = false|true</c><br/>
+    ///       Specifies whether to update sprite batches on worker threads.
+    ///     </item>
+    ///     <item>
     ///       <c>resolution = {width, height}</c><br/>
     ///       Specifies the preferred screen resolution or window size. It also
     ///       determines whether we are in landscape or portrait mode.
@@ -34,6 +38,10 @@ namespace rainbow
     ///       <c>suspend_on_focus_lost = false|true</c><br/>
     ///       Specifies whether to suspend when focus is lost.
     ///     </item>
+    ///     <item>
+    ///       <c>texture_compression = false|true</c><br/>
+    ///       Specifies whether to compress PNG textures to S3TC when loaded.
+    ///     </item>
     ///   </list>
     ///
     ///   If no configuration file is present, or the file is somehow
@@ -43,8 +51,10 @@ namespace rainbow
     ///     <item><c>accelerometer = true</c></item>
     ///     <item><c>allow_high_dpi = false</c></item>
     ///     <item><c>msaa = 0</c></item>
+    ///     <item><c>parallel_update = false</c></item>
     ///     <item><c>resolution = {0, 0}</c> (implying landscape mode)</item>
     ///     <item><c>suspend_on_focus_lost = true</c></item>
+    ///     <item><c>texture_compression = false</c></item>
     ///   </list>
     /// </remarks>
     class Config
@@ -74,13 +84,25 @@ namespace rainbow
         /// <summary>Returns whether we need to use the accelerometer.</summary>
         bool needs_accelerometer() const { return accelerometer_; }
 
+        /// <summary>
+        ///   Returns whether to update sprite batches on worker threads.
+        /// </summary>
+        bool parallel_update() const { return parallel_update_; }
+
         /// <summary>Returns whether to suspend when focus is lost.</summary>
         bool suspend() const { return suspend_; }
 
+        /// <summary>
+        ///   Returns whether to compress PNG textures to S3TC when loaded.
+        /// </summary>
+        bool texture_compression() const { return texture_compression_; }
+
     private:
         bool accelerometer_;
         bool high_dpi_;
+        bool parallel_update_;
         bool suspend_;
+        bool texture_compression_;
         int width_;
         int height_;
         unsigned int msaa_;
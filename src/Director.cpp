@@ -6,6 +6,7 @@
 
 #include "Common/Random.h"
 #include "Script/GameBase.h"
+#include "Threading/ThreadPool.h"
 
 #ifdef USE_PHYSICS
 #   include "ThirdParty/Box2D/DebugDraw.h"
@@ -20,7 +21,8 @@ namespace rainbow
 {
     Random random;
 
-    Director::Director() : active_(true), terminated_(false), error_(nullptr)
+    Director::Director()
+        : active_(true), terminated_(false), error_(nullptr)
     {
         if (!mixer_.initialize(kMaxAudioChannels))
             terminate("Failed to initialise audio engine");
@@ -60,6 +62,17 @@ namespace rainbow
 #endif  // USE_PHYSICS
     }
 
+    void Director::set_parallel_update(bool enable)
+    {
+        if (!enable)
+            thread_pool_.reset();
+        else if (!thread_pool_)
+        {
+            thread_pool_ = std::make_unique<ThreadPool>(
+                ThreadPool::default_worker_count());
+        }
+    }
+
     void Director::update(uint64_t dt)
     {
         R_ASSERT(!terminated_, "App should have terminated by now");
@@ -67,8 +80,11 @@ namespace rainbow
         mixer_.process();
         timer_manager_.update(dt);
         script_->update(dt);
-        graphics::update(render_queue_, dt);
-        graphics::TextureManager::Get()->trim();
+        if (thread_pool_)
+            graphics::update(render_queue_, dt, *thread_pool_);
+        else
+            graphics::update(render_queue_, dt);
+        graphics::TextureManager::Get()->update();
     }
 
     void Director::on_focus_gained()
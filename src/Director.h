@@ -15,6 +15,7 @@ namespace rainbow
 {
     class Data;
     class GameBase;
+    class ThreadPool;
 
     /// <summary>
     ///   Simple game loop for Lua-scripted games. Must be created after having
@@ -39,6 +40,12 @@ namespace rainbow
 
         void draw();
 
+        /// <summary>
+        ///   Sets whether to update sprite batches on worker threads. Off by
+        ///   default; sprite batches are then updated on the calling thread.
+        /// </summary>
+        void set_parallel_update(bool enable);
+
         void terminate()
         {
             active_ = false;
@@ -71,6 +78,7 @@ namespace rainbow
         Input input_;
         graphics::State renderer_;
         audio::Mixer mixer_;
+        std::unique_ptr<ThreadPool> thread_pool_;  ///< Only when enabled.
     };
 }
 
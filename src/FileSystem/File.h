@@ -65,6 +65,9 @@ namespace rainbow
         static auto open_document(czstring path) -> File;
         static auto open_write(czstring path) -> File;
 
+        /// <summary>Creates an instance without an associated file.</summary>
+        File() : handle_(nullptr) {}
+
         File(File&& file) noexcept : handle_(std::move(file.handle_))
         {
             file.handle_ = nullptr;
@@ -0,0 +1,352 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Threading/ThreadPool.h"
+
+using rainbow::BlockFormat;
+
+namespace
+{
+    constexpr uint32_t kBlockSize = 4;
+    constexpr uint32_t kBlockPixels = kBlockSize * kBlockSize;
+
+    /// <summary>
+    ///   Number of power iterations for finding the principal axis.
+    /// </summary>
+    constexpr int kPowerIterations = 8;
+
+    /// <summary>
+    ///   Weight of the second endpoint for each colour index, in 4-colour
+    ///   mode.
+    /// </summary>
+    constexpr float kColorWeight[]{0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    using Block = uint8_t[kBlockPixels][4];
+
+    struct ColorBlock
+    {
+        uint16_t c0;
+        uint16_t c1;
+        uint32_t indices;
+        uint32_t error;
+    };
+
+    auto block_bytes(BlockFormat format) -> size_t
+    {
+        return format == BlockFormat::BC1 ? 8 : 16;
+    }
+
+    template <typename T>
+    auto square(T x) { return x * x; }
+
+    auto pack_565(const float (&c)[3]) -> uint16_t
+    {
+        auto quantize = [](float value, int max) {
+            const auto q = static_cast<int>(std::round(value * max / 255.0f));
+            return static_cast<uint16_t>(std::min(std::max(q, 0), max));
+        };
+        return (quantize(c[0], 31) << 11) | (quantize(c[1], 63) << 5) |
+               quantize(c[2], 31);
+    }
+
+    void unpack_565(uint16_t c, int (&rgb)[3])
+    {
+        const int r = (c >> 11) & 0x1f;
+        const int g = (c >> 5) & 0x3f;
+        const int b = c & 0x1f;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    /// <summary>
+    ///   Quantises the endpoints and picks the closest palette entry for
+    ///   every pixel.
+    /// </summary>
+    auto encode_colors(const Block& block,
+                       const float (&e0)[3],
+                       const float (&e1)[3]) -> ColorBlock
+    {
+        ColorBlock result{pack_565(e0), pack_565(e1), 0, 0};
+        if (result.c0 < result.c1)
+            std::swap(result.c0, result.c1);
+
+        int palette[4][3];
+        unpack_565(result.c0, palette[0]);
+        unpack_565(result.c1, palette[1]);
+        for (int i = 0; i < 3; ++i)
+        {
+            palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+        }
+
+        // With equal endpoints, the block is decoded in 3-colour mode where
+        // index 3 means transparent black.
+        const uint32_t candidates = result.c0 == result.c1 ? 1 : 4;
+        for (uint32_t p = 0; p < kBlockPixels; ++p)
+        {
+            uint32_t best = 0;
+            uint32_t best_error = std::numeric_limits<uint32_t>::max();
+            for (uint32_t i = 0; i < candidates; ++i)
+            {
+                const uint32_t error = square(block[p][0] - palette[i][0]) +
+                                       square(block[p][1] - palette[i][1]) +
+                                       square(block[p][2] - palette[i][2]);
+                if (error < best_error)
+                {
+                    best = i;
+                    best_error = error;
+                }
+            }
+            result.indices |= best << (p * 2);
+            result.error += best_error;
+        }
+        return result;
+    }
+
+    /// <summary>
+    ///   Returns the endpoints that best reproduce the block given the
+    ///   indices chosen in <paramref name="colors"/>, by least squares.
+    /// </summary>
+    bool refine(const Block& block,
+                const ColorBlock& colors,
+                float (&e0)[3],
+                float (&e1)[3])
+    {
+        float alpha2 = 0.0f;
+        float beta2 = 0.0f;
+        float alphabeta = 0.0f;
+        float alphax[3]{};
+        float betax[3]{};
+        for (uint32_t p = 0; p < kBlockPixels; ++p)
+        {
+            const float beta = kColorWeight[(colors.indices >> (p * 2)) & 3];
+            const float alpha = 1.0f - beta;
+            alpha2 += alpha * alpha;
+            beta2 += beta * beta;
+            alphabeta += alpha * beta;
+            for (int i = 0; i < 3; ++i)
+            {
+                alphax[i] += alpha * block[p][i];
+                betax[i] += beta * block[p][i];
+            }
+        }
+
+        const float det = alpha2 * beta2 - alphabeta * alphabeta;
+        if (std::abs(det) < 1e-6f)
+            return false;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            e0[i] = (alphax[i] * beta2 - betax[i] * alphabeta) / det;
+            e1[i] = (betax[i] * alpha2 - alphax[i] * alphabeta) / det;
+        }
+        return true;
+    }
+
+    void compress_alpha(const Block& block, uint8_t* out)
+    {
+        uint8_t min = 255;
+        uint8_t max = 0;
+        for (auto&& pixel : block)
+        {
+            min = std::min(min, pixel[3]);
+            max = std::max(max, pixel[3]);
+        }
+
+        out[0] = max;
+        out[1] = min;
+        std::fill_n(out + 2, 6, 0);
+        if (min == max)
+            return;
+
+        // With a0 > a1, the palette interpolates six values in between.
+        int palette[8]{max, min};
+        for (int i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * max + (i - 1) * min) / 7;
+
+        uint64_t indices = 0;
+        for (uint32_t p = 0; p < kBlockPixels; ++p)
+        {
+            uint64_t best = 0;
+            int best_error = std::numeric_limits<int>::max();
+            for (int i = 0; i < 8; ++i)
+            {
+                const int error = std::abs(block[p][3] - palette[i]);
+                if (error < best_error)
+                {
+                    best = i;
+                    best_error = error;
+                }
+            }
+            indices |= best << (p * 3);
+        }
+
+        for (int i = 0; i < 6; ++i)
+            out[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+    }
+
+    void compress_color(const Block& block, uint8_t* out)
+    {
+        float mean[3]{};
+        for (auto&& pixel : block)
+        {
+            for (int i = 0; i < 3; ++i)
+                mean[i] += pixel[i];
+        }
+        for (auto&& m : mean)
+            m /= kBlockPixels;
+
+        float covariance[3][3]{};
+        for (auto&& pixel : block)
+        {
+            const float d[3]{
+                pixel[0] - mean[0], pixel[1] - mean[1], pixel[2] - mean[2]};
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                    covariance[i][j] += d[i] * d[j];
+            }
+        }
+
+        // Find the principal axis by power iteration.
+        float axis[3]{1.0f, 1.0f, 1.0f};
+        for (int n = 0; n < kPowerIterations; ++n)
+        {
+            float v[3]{};
+            for (int i = 0; i < 3; ++i)
+            {
+                v[i] = covariance[i][0] * axis[0] +
+                       covariance[i][1] * axis[1] +
+                       covariance[i][2] * axis[2];
+            }
+            const float norm =
+                std::max({std::abs(v[0]), std::abs(v[1]), std::abs(v[2])});
+            if (norm < 1e-6f)
+                break;
+
+            for (int i = 0; i < 3; ++i)
+                axis[i] = v[i] / norm;
+        }
+        const float length =
+            std::sqrt(square(axis[0]) + square(axis[1]) + square(axis[2]));
+        for (auto&& a : axis)
+            a /= length;
+
+        float t_min = std::numeric_limits<float>::max();
+        float t_max = std::numeric_limits<float>::lowest();
+        for (auto&& pixel : block)
+        {
+            const float t = (pixel[0] - mean[0]) * axis[0] +
+                            (pixel[1] - mean[1]) * axis[1] +
+                            (pixel[2] - mean[2]) * axis[2];
+            t_min = std::min(t_min, t);
+            t_max = std::max(t_max, t);
+        }
+
+        // Inset the endpoints slightly to reduce the error of the pixels
+        // in between.
+        const float inset = (t_max - t_min) / 16.0f;
+        t_min += inset;
+        t_max -= inset;
+
+        float e0[3];
+        float e1[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            e0[i] = mean[i] + axis[i] * t_max;
+            e1[i] = mean[i] + axis[i] * t_min;
+        }
+
+        ColorBlock colors = encode_colors(block, e0, e1);
+        if (colors.error > 0 && refine(block, colors, e0, e1))
+        {
+            const ColorBlock refined = encode_colors(block, e0, e1);
+            if (refined.error < colors.error)
+                colors = refined;
+        }
+
+        out[0] = static_cast<uint8_t>(colors.c0);
+        out[1] = static_cast<uint8_t>(colors.c0 >> 8);
+        out[2] = static_cast<uint8_t>(colors.c1);
+        out[3] = static_cast<uint8_t>(colors.c1 >> 8);
+        for (int i = 0; i < 4; ++i)
+            out[4 + i] = static_cast<uint8_t>(colors.indices >> (i * 8));
+    }
+
+    void fetch_block(const uint8_t* rgba,
+                     uint32_t width,
+                     uint32_t height,
+                     uint32_t bx,
+                     uint32_t by,
+                     Block& block)
+    {
+        for (uint32_t y = 0; y < kBlockSize; ++y)
+        {
+            const uint32_t py = std::min(by * kBlockSize + y, height - 1);
+            for (uint32_t x = 0; x < kBlockSize; ++x)
+            {
+                const uint32_t px = std::min(bx * kBlockSize + x, width - 1);
+                std::copy_n(rgba + (py * width + px) * 4,
+                            4,
+                            block[y * kBlockSize + x]);
+            }
+        }
+    }
+}
+
+auto rainbow::block_compressed_size(BlockFormat format,
+                                    uint32_t width,
+                                    uint32_t height) -> size_t
+{
+    const size_t blocks_x = (width + kBlockSize - 1) / kBlockSize;
+    const size_t blocks_y = (height + kBlockSize - 1) / kBlockSize;
+    return blocks_x * blocks_y * block_bytes(format);
+}
+
+void rainbow::compress_blocks(BlockFormat format,
+                              const uint8_t* rgba,
+                              uint32_t width,
+                              uint32_t height,
+                              uint8_t* out,
+                              ThreadPool* pool)
+{
+    if (width == 0 || height == 0)
+        return;
+
+    const uint32_t blocks_x = (width + kBlockSize - 1) / kBlockSize;
+    const uint32_t blocks_y = (height + kBlockSize - 1) / kBlockSize;
+    const size_t row_bytes = blocks_x * block_bytes(format);
+    auto compress_row = [=](uint32_t by) {
+        Block block;
+        uint8_t* dst = out + by * row_bytes;
+        for (uint32_t bx = 0; bx < blocks_x; ++bx)
+        {
+            fetch_block(rgba, width, height, bx, by, block);
+            if (format == BlockFormat::BC3)
+            {
+                compress_alpha(block, dst);
+                dst += 8;
+            }
+            compress_color(block, dst);
+            dst += 8;
+        }
+    };
+
+    if (pool == nullptr)
+    {
+        for (uint32_t by = 0; by < blocks_y; ++by)
+            compress_row(by);
+    }
+    else
+    {
+        pool->parallel_for(blocks_y, compress_row);
+    }
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_BLOCKCOMPRESSION_H_
+#define GRAPHICS_BLOCKCOMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rainbow
+{
+    class ThreadPool;
+
+    enum class BlockFormat
+    {
+        BC1,  ///< S3TC DXT1; opaque RGB, 4 bits per pixel.
+        BC3,  ///< S3TC DXT5; RGBA, 8 bits per pixel.
+    };
+
+    /// <summary>
+    ///   Returns the size, in bytes, of an image of given dimension once
+    ///   compressed to <paramref name="format"/>.
+    /// </summary>
+    auto block_compressed_size(BlockFormat format,
+                               uint32_t width,
+                               uint32_t height) -> size_t;
+
+    /// <summary>Compresses an RGBA8 image to BC1 or BC3.</summary>
+    /// <remarks>
+    ///   Colour endpoints are fit along the principal axis of each block,
+    ///   then refined once by least squares. Blocks along the right and
+    ///   bottom edges of images whose dimensions are not multiples of four
+    ///   are padded by repeating the last column and row.
+    /// </remarks>
+    /// <param name="format">Block compression format.</param>
+    /// <param name="rgba">Image data, 4 bytes per pixel.</param>
+    /// <param name="width">Width of the image.</param>
+    /// <param name="height">Height of the image.</param>
+    /// <param name="out">
+    ///   [out] Compressed blocks. Must hold at least
+    ///   <see cref="block_compressed_size"/> bytes.
+    /// </param>
+    /// <param name="pool">
+    ///   Threads to spread rows of blocks across; if null, all blocks are
+    ///   compressed on the calling thread.
+    /// </param>
+    void compress_blocks(BlockFormat format,
+                         const uint8_t* rgba,
+                         uint32_t width,
+                         uint32_t height,
+                         uint8_t* out,
+                         ThreadPool* pool = nullptr);
+}
+
+#endif
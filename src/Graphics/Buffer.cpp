@@ -4,12 +4,21 @@
 
 #include "Graphics/Buffer.h"
 
+#include "Common/Logging.h"
 #include "Graphics/OpenGL.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/ShaderDetails.h"
+#include "Graphics/SpriteInstance.h"
 #include "Graphics/SpriteVertex.h"
 
+using rainbow::PackedSpriteVertex;
+using rainbow::SpriteInstance;
+using rainbow::SpriteVertex;
+using rainbow::VertexFormat;
 using rainbow::graphics::Buffer;
 
+namespace graphics = rainbow::graphics;
+
 namespace
 {
     unsigned int glGenBuffer()
@@ -18,13 +27,62 @@ namespace
         glGenBuffers(1, &id);
         return id;
     }
+
+    template <typename T>
+    void bind_vertex_attributes(GLenum texcoord_type,
+                                GLboolean texcoord_normalized)
+    {
+        glEnableVertexAttribArray(Shader::kAttributeColor);
+        glVertexAttribPointer(
+            Shader::kAttributeColor,
+            4,
+            GL_UNSIGNED_BYTE,
+            GL_TRUE,
+            sizeof(T),
+            reinterpret_cast<void*>(offsetof(T, color)));
+        glEnableVertexAttribArray(Shader::kAttributeTexCoord);
+        glVertexAttribPointer(
+            Shader::kAttributeTexCoord,
+            2,
+            texcoord_type,
+            texcoord_normalized,
+            sizeof(T),
+            reinterpret_cast<void*>(offsetof(T, texcoord)));
+        glEnableVertexAttribArray(Shader::kAttributeVertex);
+        glVertexAttribPointer(
+            Shader::kAttributeVertex,
+            2,
+            GL_FLOAT,
+            GL_TRUE,
+            sizeof(T),
+            reinterpret_cast<void*>(offsetof(T, position)));
+    }
+
+#ifdef USE_INSTANCED_SPRITES
+    void bind_instance_attribute(unsigned int index,
+                                 int size,
+                                 GLenum type,
+                                 GLboolean normalized,
+                                 size_t offset)
+    {
+        glEnableVertexAttribArray(index);
+        glVertexAttribPointer(index,
+                              size,
+                              type,
+                              normalized,
+                              sizeof(SpriteInstance),
+                              reinterpret_cast<void*>(offset));
+        glVertexAttribDivisor(index, 1);
+    }
+#endif
 }
 
-Buffer::Buffer() : id_(glGenBuffer()) {}
+Buffer::Buffer() : id_(glGenBuffer()), size_(0) {}
 
-Buffer::Buffer(Buffer&& buffer) noexcept : id_(buffer.id_)
+Buffer::Buffer(Buffer&& buffer) noexcept : id_(buffer.id_), size_(buffer.size_)
 {
     buffer.id_ = 0;
+    buffer.size_ = 0;
 }
 
 Buffer::~Buffer()
@@ -36,32 +94,17 @@ Buffer::~Buffer()
 }
 
 void Buffer::bind() const
+{
+    bind(VertexFormat::Float);
+}
+
+void Buffer::bind(VertexFormat format) const
 {
     glBindBuffer(GL_ARRAY_BUFFER, id_);
-    glEnableVertexAttribArray(Shader::kAttributeColor);
-    glVertexAttribPointer(
-        Shader::kAttributeColor,
-        4,
-        GL_UNSIGNED_BYTE,
-        GL_TRUE,
-        sizeof(SpriteVertex),
-        reinterpret_cast<void*>(offsetof(SpriteVertex, color)));
-    glEnableVertexAttribArray(Shader::kAttributeTexCoord);
-    glVertexAttribPointer(
-        Shader::kAttributeTexCoord,
-        2,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(SpriteVertex),
-        reinterpret_cast<void*>(offsetof(SpriteVertex, texcoord)));
-    glEnableVertexAttribArray(Shader::kAttributeVertex);
-    glVertexAttribPointer(
-        Shader::kAttributeVertex,
-        2,
-        GL_FLOAT,
-        GL_TRUE,
-        sizeof(SpriteVertex),
-        reinterpret_cast<void*>(offsetof(SpriteVertex, position)));
+    if (format == VertexFormat::Packed)
+        bind_vertex_attributes<PackedSpriteVertex>(GL_UNSIGNED_SHORT, GL_TRUE);
+    else
+        bind_vertex_attributes<SpriteVertex>(GL_FLOAT, GL_FALSE);
 }
 
 void Buffer::bind(unsigned int index) const
@@ -71,10 +114,67 @@ void Buffer::bind(unsigned int index) const
     glVertexAttribPointer(index, 2, GL_FLOAT, GL_FALSE, sizeof(Vec2f), nullptr);
 }
 
-void Buffer::upload(const void* data, size_t size) const
+void Buffer::bind_instances() const
 {
+#ifdef USE_INSTANCED_SPRITES
+    static_assert(offsetof(SpriteInstance, size) ==
+                      offsetof(SpriteInstance, position) + sizeof(Vec2f),
+                  "Position and size are read as a single attribute");
+
+    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    bind_instance_attribute(Shader::kAttributeColor,
+                            4,
+                            GL_UNSIGNED_BYTE,
+                            GL_TRUE,
+                            offsetof(SpriteInstance, color));
+    bind_instance_attribute(Shader::kAttributeTransform,
+                            4,
+                            GL_FLOAT,
+                            GL_FALSE,
+                            offsetof(SpriteInstance, position));
+    bind_instance_attribute(Shader::kAttributeAngle,
+                            1,
+                            GL_FLOAT,
+                            GL_FALSE,
+                            offsetof(SpriteInstance, angle));
+    bind_instance_attribute(Shader::kAttributePivot,
+                            2,
+                            GL_UNSIGNED_SHORT,
+                            GL_TRUE,
+                            offsetof(SpriteInstance, pivot));
+    bind_instance_attribute(Shader::kAttributeRegion,
+                            2,
+                            GL_UNSIGNED_SHORT,
+                            GL_FALSE,
+                            offsetof(SpriteInstance, region));
+#else
+    R_ABORT("Instanced sprites are not supported on this platform");
+#endif
+}
+
+void Buffer::upload(const void* data, size_t size)
+{
+    size_ = size;
+    if (data != nullptr)
+        graphics::detail::g_bytes_uploaded_accumulator += size;
+    if (id_ == 0)
+        return;
+
     glBindBuffer(GL_ARRAY_BUFFER, id_);
     glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
     glBufferData(GL_ARRAY_BUFFER, size, data, GL_STREAM_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
+
+void Buffer::upload(const void* data, size_t offset, size_t size)
+{
+    R_ASSERT(offset + size <= size_, "Upload range is out of bounds");
+
+    graphics::detail::g_bytes_uploaded_accumulator += size;
+    if (id_ == 0)
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, id_);
+    glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -7,7 +7,11 @@
 
 #include <cstddef>
 
-namespace rainbow { struct ISolemnlySwearThatIAmOnlyTesting; }
+namespace rainbow
+{
+    struct ISolemnlySwearThatIAmOnlyTesting;
+    enum class VertexFormat;
+}
 
 namespace rainbow { namespace graphics
 {
@@ -18,26 +22,54 @@ namespace rainbow { namespace graphics
         Buffer(Buffer&&) noexcept;
         ~Buffer();
 
+        /// <summary>Returns the size of the GPU buffer, in bytes.</summary>
+        auto size() const { return size_; }
+
         /// <summary>
         ///  Used by Label and SpriteBatch for interleaved vertex buffer.
         /// </summary>
         void bind() const;
 
+        /// <summary>
+        ///   Used by Label and SpriteBatch for interleaved vertex buffer in
+        ///   the given format.
+        /// </summary>
+        void bind(VertexFormat format) const;
+
         /// <summary>Used by SpriteBatch for normal buffers.</summary>
         void bind(unsigned int index) const;
 
+        /// <summary>
+        ///   Used by SpriteBatch for per-sprite instance data. Requires
+        ///   <c>USE_INSTANCED_SPRITES</c>.
+        /// </summary>
+        void bind_instances() const;
+
+        /// <summary>
+        ///   Uploads <paramref name="data"/> of size <paramref name="size"/> to
+        ///   the GPU buffer, replacing its storage. If <paramref name="data"/>
+        ///   is <c>nullptr</c>, the storage is allocated but left undefined.
+        /// </summary>
+        void upload(const void* data, size_t size);
+
         /// <summary>
         ///   Uploads <paramref name="data"/> of size <paramref name="size"/> to
-        ///   the GPU buffer.
+        ///   the GPU buffer at <paramref name="offset"/>, leaving the rest of
+        ///   the buffer untouched. The range must lie within the storage
+        ///   allocated by the last full <see cref="upload"/>.
         /// </summary>
-        void upload(const void* data, size_t size) const;
+        void upload(const void* data, size_t offset, size_t size);
 
 #ifdef RAINBOW_TEST
-        explicit Buffer(const ISolemnlySwearThatIAmOnlyTesting&) : id_(0) {}
+        explicit Buffer(const ISolemnlySwearThatIAmOnlyTesting&)
+            : id_(0), size_(0)
+        {
+        }
 #endif
 
     private:
         unsigned int id_;
+        size_t size_;  ///< Size of the GPU buffer, in bytes.
     };
 }}  // namespace rainbow::graphics
 
@@ -5,11 +5,15 @@
 #ifndef GRAPHICS_DECODERS_PNG_H_
 #define GRAPHICS_DECODERS_PNG_H_
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
-#include <memory>
 
 #include <png.h>
 
+#include "Common/Logging.h"
+#include "Memory/BufferPool.h"
+
 #define USE_PNG
 
 namespace png
@@ -44,13 +48,155 @@ namespace png
             image.channels = PNG_IMAGE_SAMPLE_CHANNELS(PNG_FORMAT_RGBA);
         }
 
-        auto buffer = std::make_unique<uint8_t[]>(PNG_IMAGE_SIZE(pi));
+        auto buffer = rainbow::staging_buffers().acquire(PNG_IMAGE_SIZE(pi));
         png_image_finish_read(
-            &pi, nullptr, buffer.get(), PNG_IMAGE_ROW_STRIDE(pi), nullptr);
-        image.data = buffer.release();
+            &pi, nullptr, buffer.data(), PNG_IMAGE_ROW_STRIDE(pi), nullptr);
+        image.data = buffer.data();
+        image.buffer = std::move(buffer);
 
         return image;
     }
+
+    /// <summary>
+    ///   Decodes a PNG image a band of rows at a time, so that the whole
+    ///   image need not be held in memory. Rows are in the same format as
+    ///   those returned by <see cref="decode"/>.
+    /// </summary>
+    /// <remarks>
+    ///   Interlaced images, 16-bit images, and images with a gamma other
+    ///   than sRGB's cannot be read row by row; use <see cref="decode"/>.
+    /// </remarks>
+    class RowReader : private rainbow::NonCopyable<RowReader>
+    {
+    public:
+        explicit RowReader(const rainbow::DataMap& data)
+            : png_(png_create_read_struct(
+                  PNG_LIBPNG_VER_STRING, nullptr, &error, &warning)),
+              info_(nullptr), source_{data.data(), data.size(), 0}, width_(0),
+              height_(0), channels_(0), row_(0)
+        {
+            if (png_ == nullptr)
+                return;
+
+            info_ = png_create_info_struct(png_);
+            if (info_ == nullptr)
+                return;
+
+            if (setjmp(png_jmpbuf(png_)))
+            {
+                height_ = 0;
+                return;
+            }
+
+            png_set_read_fn(png_, &source_, &read);
+            png_read_info(png_, info_);
+
+            // |decode| converts these to 8-bit sRGB, which is not worth
+            // replicating here.
+            png_fixed_point gamma = kGammaSRGB;
+            png_get_gAMA_fixed(png_, info_, &gamma);
+            if (png_get_interlace_type(png_, info_) != PNG_INTERLACE_NONE ||
+                png_get_bit_depth(png_, info_) > 8 ||
+                std::abs(gamma - kGammaSRGB) > 100)
+            {
+                return;
+            }
+
+            const int color_type = png_get_color_type(png_, info_);
+            const bool is_gray = (color_type & PNG_COLOR_MASK_COLOR) == 0;
+            const bool has_alpha = (color_type & PNG_COLOR_MASK_ALPHA) != 0 ||
+                                   png_get_valid(png_, info_, PNG_INFO_tRNS);
+
+            // Match the formats chosen by |decode|: grey with alpha, or RGBA.
+            png_set_expand(png_);
+            if (is_gray && has_alpha)
+            {
+                channels_ = 2;
+            }
+            else
+            {
+                if (is_gray)
+                    png_set_gray_to_rgb(png_);
+                if (!has_alpha)
+                    png_set_add_alpha(png_, 0xff, PNG_FILLER_AFTER);
+                channels_ = 4;
+            }
+            png_read_update_info(png_, info_);
+
+            width_ = png_get_image_width(png_, info_);
+            R_ASSERT(png_get_rowbytes(png_, info_) == width_ * channels_,
+                     "Unexpected row size");
+            height_ = png_get_image_height(png_, info_);
+        }
+
+        ~RowReader() { png_destroy_read_struct(&png_, &info_, nullptr); }
+
+        auto channels() const { return channels_; }
+        auto height() const { return height_; }
+        auto width() const { return width_; }
+
+        /// <summary>
+        ///   Decodes the next <paramref name="count"/> rows, or as many as
+        ///   remain, into <paramref name="out"/>.
+        /// </summary>
+        /// <returns>Number of rows decoded; zero on error.</returns>
+        auto read_rows(uint8_t* out, uint32_t count) -> uint32_t
+        {
+            count = std::min(count, height_ - row_);
+            if (setjmp(png_jmpbuf(png_)))
+            {
+                height_ = row_;
+                return 0;
+            }
+
+            const uint32_t stride = width_ * channels_;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                png_read_row(png_, out + i * stride, nullptr);
+                ++row_;
+            }
+            return count;
+        }
+
+        explicit operator bool() const { return height_ > 0; }
+
+    private:
+        /// <summary>Gamma of sRGB, scaled by 100,000.</summary>
+        static constexpr png_fixed_point kGammaSRGB = 45455;
+
+        struct Source
+        {
+            const uint8_t* data;
+            size_t size;
+            size_t offset;
+        };
+
+        png_structp png_;
+        png_infop info_;
+        Source source_;
+        uint32_t width_;
+        uint32_t height_;
+        uint32_t channels_;
+        uint32_t row_;  ///< Next row to decode.
+
+        static void error(png_structp png, png_const_charp message)
+        {
+            LOGE("PNG: %s", message);
+            png_longjmp(png, 1);
+        }
+
+        static void read(png_structp png, png_bytep out, png_size_t length)
+        {
+            auto source = static_cast<Source*>(png_get_io_ptr(png));
+            if (length > source->size - source->offset)
+                png_error(png, "Unexpected end of data");
+
+            std::memcpy(out, source->data + source->offset, length);
+            source->offset += length;
+        }
+
+        static void warning(png_structp, png_const_charp) {}
+    };
 }
 
 #endif
@@ -5,7 +5,10 @@
 #ifndef GRAPHICS_DECODERS_SVG_H_
 #define GRAPHICS_DECODERS_SVG_H_
 
+#include <memory>
+
 #include "Common/Algorithm.h"
+#include "Memory/BufferPool.h"
 #include "ThirdParty/NanoSVG/NanoSVG.h"
 
 #define USE_SVG
@@ -47,9 +50,14 @@ namespace svg
 
         std::unique_ptr<NSVGimage> img;
         {
-            auto svg = std::make_unique<char[]>(data.size());
-            std::copy(data.data(), data.data() + data.size(), svg.get());
-            img.reset(nsvgParse(svg.get(), "px", 96.0f));
+            // |nsvgParse| tokenises the document in place and expects it to
+            // be null-terminated, so it cannot parse the mapped file
+            // directly.
+            auto svg = rainbow::staging_buffers().acquire(data.size() + 1);
+            std::copy_n(data.data(), data.size(), svg.data());
+            svg.data()[data.size()] = '\0';
+            img.reset(nsvgParse(
+                reinterpret_cast<char*>(svg.data()), "px", 96.0f));
             if (img == nullptr)
                 return image;
         }
@@ -60,19 +68,20 @@ namespace svg
         image.channels = 4;
         image.size = image.width * image.height * 4;
 
-        auto buffer = std::make_unique<uint8_t[]>(image.size);
+        auto buffer = rainbow::staging_buffers().acquire(image.size);
         std::unique_ptr<NSVGrasterizer> rasterizer{nsvgCreateRasterizer()};
         nsvgRasterize(rasterizer.get(),
                       img.get(),
                       0.0f,
                       0.0f,
                       scale,
-                      buffer.get(),
+                      buffer.data(),
                       img->width * scale,
                       img->height * scale,
                       image.width * 4);
 
-        image.data = buffer.release();
+        image.data = buffer.data();
+        image.buffer = std::move(buffer);
         return image;
     }
 }
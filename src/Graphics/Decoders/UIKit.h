@@ -8,6 +8,7 @@
 #include <UIKit/UIKit.h>
 
 #include "Common/Logging.h"
+#include "Memory/BufferPool.h"
 
 #define USE_UIKIT
 
@@ -45,9 +46,9 @@ namespace uikit
 
         CGColorSpaceRef color_space = CGColorSpaceCreateDeviceRGB();
         auto buffer =
-            std::make_unique<uint8_t[]>(image.height * image.width * 4);
+            rainbow::staging_buffers().acquire(image.height * image.width * 4);
         CGContextRef context = CGBitmapContextCreate(
-            buffer.get(),
+            buffer.data(),
             image.width,
             image.height,
             8,
@@ -61,7 +62,8 @@ namespace uikit
         CGContextDrawImage(context, bounds, uiimage.CGImage);
         CGContextRelease(context);
 
-        image.data = buffer.release();
+        image.data = buffer.data();
+        image.buffer = std::move(buffer);
         return image;
     }
 }
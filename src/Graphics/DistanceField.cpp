@@ -0,0 +1,153 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/DistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Common/Logging.h"
+
+using rainbow::Vec2u;
+
+namespace
+{
+    /// <summary>
+    ///   Squared distance standing in for infinity. Using a finite value
+    ///   avoids subtracting infinities in <see cref="transform"/>.
+    /// </summary>
+    constexpr float kFar = 1e20f;
+
+    constexpr uint8_t kInsideThreshold = 128;
+
+    struct Scratch
+    {
+        std::vector<float> f;
+        std::vector<float> z;
+        std::vector<uint32_t> v;
+
+        explicit Scratch(uint32_t n) : f(n), z(n + 1), v(n) {}
+    };
+
+    /// <summary>
+    ///   Computes the one-dimensional squared distance transform of
+    ///   <paramref name="n"/> samples, <paramref name="stride"/> apart, in
+    ///   place. The result is the lower envelope of the parabolas rooted at
+    ///   each sample.
+    /// </summary>
+    void transform(float* grid, uint32_t n, uint32_t stride, Scratch& scratch)
+    {
+        auto& f = scratch.f;
+        auto& z = scratch.z;
+        auto& v = scratch.v;
+        for (uint32_t q = 0; q < n; ++q)
+            f[q] = grid[q * stride];
+
+        uint32_t k = 0;
+        v[0] = 0;
+        z[0] = -kFar;
+        z[1] = kFar;
+        for (uint32_t q = 1; q < n; ++q)
+        {
+            float s;
+            while (true)
+            {
+                const auto r = static_cast<float>(v[k]);
+                const auto p = static_cast<float>(q);
+                s = ((f[q] + p * p) - (f[v[k]] + r * r)) / (2.0f * (p - r));
+                if (s > z[k] || k == 0)
+                    break;
+                --k;
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = kFar;
+        }
+
+        k = 0;
+        for (uint32_t q = 0; q < n; ++q)
+        {
+            while (z[k + 1] < q)
+                ++k;
+            const auto d = static_cast<float>(q) - static_cast<float>(v[k]);
+            grid[q * stride] = d * d + f[v[k]];
+        }
+    }
+
+    /// <summary>
+    ///   Computes the squared distance to the nearest zero for every cell of
+    ///   <paramref name="grid"/>, in place.
+    /// </summary>
+    void transform(std::vector<float>& grid, uint32_t width, uint32_t height)
+    {
+        Scratch scratch(std::max(width, height));
+        for (uint32_t x = 0; x < width; ++x)
+            transform(grid.data() + x, height, width, scratch);
+        for (uint32_t y = 0; y < height; ++y)
+            transform(grid.data() + y * width, width, 1, scratch);
+    }
+}
+
+auto rainbow::make_distance_field(const uint8_t* coverage,
+                                  const Vec2u& size,
+                                  uint32_t spread,
+                                  uint32_t downscale,
+                                  Vec2u& field_size)
+    -> std::unique_ptr<uint8_t[]>
+{
+    R_ASSERT(spread > 0, "Spread must be at least one pixel");
+    R_ASSERT(downscale > 0, "Downscale factor must be at least one");
+
+    const uint32_t padding = spread * downscale;
+    const uint32_t width = size.x + padding * 2;
+    const uint32_t height = size.y + padding * 2;
+
+    // |outside| holds the distance to the shape; |inside|, to its exterior.
+    std::vector<float> inside(width * height, 0.0f);
+    std::vector<float> outside(width * height, kFar);
+    for (uint32_t y = 0; y < size.y; ++y)
+    {
+        for (uint32_t x = 0; x < size.x; ++x)
+        {
+            if (coverage[y * size.x + x] < kInsideThreshold)
+                continue;
+
+            const uint32_t i = (y + padding) * width + x + padding;
+            inside[i] = kFar;
+            outside[i] = 0.0f;
+        }
+    }
+
+    transform(inside, width, height);
+    transform(outside, width, height);
+
+    field_size.x = (width + downscale - 1) / downscale;
+    field_size.y = (height + downscale - 1) / downscale;
+    auto field = std::make_unique<uint8_t[]>(field_size.x * field_size.y);
+
+    // Distances are measured between pixel centres; the edge lies half a
+    // pixel away from the outermost pixel on either side.
+    const float scale = 1.0f / (2.0f * padding);
+    for (uint32_t y = 0; y < field_size.y; ++y)
+    {
+        const uint32_t sy = std::min(y * downscale + downscale / 2, height - 1);
+        for (uint32_t x = 0; x < field_size.x; ++x)
+        {
+            const uint32_t sx =
+                std::min(x * downscale + downscale / 2, width - 1);
+            const uint32_t i = sy * width + sx;
+            const float distance =
+                outside[i] == 0.0f ? std::sqrt(inside[i]) - 0.5f
+                                   : 0.5f - std::sqrt(outside[i]);
+            const float value =
+                std::min(std::max(0.5f + distance * scale, 0.0f), 1.0f);
+            field[y * field_size.x + x] =
+                static_cast<uint8_t>(std::lround(value * 255.0f));
+        }
+    }
+
+    return field;
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_DISTANCEFIELD_H_
+#define GRAPHICS_DISTANCEFIELD_H_
+
+#include <memory>
+
+#include "Math/Vec2.h"
+
+namespace rainbow
+{
+    /// <summary>
+    ///   Generates a signed distance field from a coverage bitmap.
+    /// </summary>
+    /// <remarks>
+    ///   <para>
+    ///     Pixels with coverage of at least 50% are inside the shape. The
+    ///     distance to the edge is computed at full resolution, then sampled
+    ///     down by <paramref name="downscale"/>. Rasterising at a higher
+    ///     resolution than the field keeps the edges accurate.
+    ///   </para>
+    ///   <para>
+    ///     Distances are encoded so that 128 lies on the edge, with greater
+    ///     values inside. Distances beyond <paramref name="spread"/> pixels
+    ///     are clamped to 0 or 255.
+    ///   </para>
+    ///   <list type="bullet">
+    ///     <item>Chris Green, Improved Alpha-Tested Magnification for Vector Textures and Special Effects, 2007</item>
+    ///     <item>Pedro Felzenszwalb and Daniel Huttenlocher, Distance Transforms of Sampled Functions, 2012</item>
+    ///   </list>
+    /// </remarks>
+    /// <param name="coverage">8-bit coverage bitmap.</param>
+    /// <param name="size">Dimension of the bitmap.</param>
+    /// <param name="spread">
+    ///   Maximum encoded distance, in field pixels. The field is padded by as
+    ///   much on every side.
+    /// </param>
+    /// <param name="downscale">
+    ///   Number of bitmap pixels per field pixel, in each direction.
+    /// </param>
+    /// <param name="field_size">[out] Dimension of the distance field.</param>
+    /// <returns>8-bit signed distance field.</returns>
+    auto make_distance_field(const uint8_t* coverage,
+                             const Vec2u& size,
+                             uint32_t spread,
+                             uint32_t downscale,
+                             Vec2u& field_size) -> std::unique_ptr<uint8_t[]>;
+}
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/DynamicAtlas.h"
+
+#include <string>
+
+#include "Graphics/OpenGL.h"
+#include "Graphics/TextureManager.h"
+
+using rainbow::DynamicAtlas;
+using rainbow::Vec2u;
+using rainbow::graphics::TextureManager;
+
+namespace
+{
+    /// <summary>
+    ///   Empty pixels kept between images so that linear filtering does not
+    ///   bleed neighbours into each other.
+    /// </summary>
+    constexpr uint32_t kPadding = 1;
+
+    /// <summary>
+    ///   Identifier of the next page, shared by all atlases. Pages must have
+    ///   unique identifiers, or they would share textures.
+    /// </summary>
+    uint32_t next_page_id = 0;
+}
+
+DynamicAtlas::DynamicAtlas(uint32_t page_size) : page_size_(page_size) {}
+
+auto DynamicAtlas::add(uint32_t width, uint32_t height, const void* rgba)
+    -> Region
+{
+    R_ASSERT(width > 0 && height > 0, "Image cannot be empty");
+    R_ASSERT(width + kPadding <= page_size_ && height + kPadding <= page_size_,
+             "Image is larger than a page");
+
+    const uint32_t padded_width = width + kPadding;
+    const uint32_t padded_height = height + kPadding;
+
+    // Earlier pages are likely to be fuller; try the newest page first.
+    Vec2u position;
+    auto page = static_cast<uint32_t>(pages_.size());
+    while (page > 0 &&
+           !pages_[page - 1].packer.pack(padded_width, padded_height, position))
+    {
+        --page;
+    }
+
+    if (page == 0)
+    {
+        add_page();
+        page = page_count();
+        pages_.back().packer.pack(padded_width, padded_height, position);
+    }
+
+    --page;
+    auto& atlas = *pages_[page].atlas;
+    TextureManager::Get()->upload_subimage(
+        atlas.texture(), position.x, position.y, width, height, GL_RGBA, rgba);
+    return {page, atlas.add_region(position.x, position.y, width, height)};
+}
+
+void DynamicAtlas::add_page()
+{
+    const std::string id =
+        "rainbow://dynamic_atlas/" + std::to_string(++next_page_id);
+    pages_.push_back(
+        {make_shared<TextureAtlas>(id.c_str(), page_size_, page_size_),
+         SkylinePacker{page_size_, page_size_}});
+}
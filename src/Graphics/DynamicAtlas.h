@@ -0,0 +1,79 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_DYNAMICATLAS_H_
+#define GRAPHICS_DYNAMICATLAS_H_
+
+#include <vector>
+
+#include "Common/NonCopyable.h"
+#include "Graphics/SkylinePacker.h"
+#include "Graphics/TextureAtlas.h"
+
+namespace rainbow
+{
+    /// <summary>Texture atlas packed at run-time.</summary>
+    /// <remarks>
+    ///   Images are packed into shared pages of fixed size, each page being a
+    ///   regular <see cref="TextureAtlas"/>. A new page is only created when
+    ///   an image does not fit in any of the existing pages. Adding an image
+    ///   uploads just the rectangle it occupies.
+    /// </remarks>
+    class DynamicAtlas : private NonCopyable<DynamicAtlas>
+    {
+    public:
+        static constexpr uint32_t kDefaultPageSize = 1024;
+
+        /// <summary>Location of an image in the atlas.</summary>
+        struct Region
+        {
+            uint32_t page;  ///< Index of the page holding the image.
+            uint32_t id;    ///< Texture region within the page.
+        };
+
+        explicit DynamicAtlas(uint32_t page_size = kDefaultPageSize);
+
+        auto page_count() const
+        {
+            return static_cast<uint32_t>(pages_.size());
+        }
+
+        auto page_size() const { return page_size_; }
+
+        /// <summary>
+        ///   Returns the page at specified index, usable in sprite batches.
+        /// </summary>
+        auto page(uint32_t i) const -> const SharedPtr<TextureAtlas>&
+        {
+            return pages_[i].atlas;
+        }
+
+        /// <summary>Packs and uploads an image.</summary>
+        /// <param name="width">Width of the image.</param>
+        /// <param name="height">Height of the image.</param>
+        /// <param name="rgba">
+        ///   Image data, four bytes per pixel, top row first.
+        /// </param>
+        /// <returns>
+        ///   The page and texture region of the image. The region can be used
+        ///   with <see cref="Sprite::set_texture"/> in a sprite batch using the
+        ///   page.
+        /// </returns>
+        auto add(uint32_t width, uint32_t height, const void* rgba) -> Region;
+
+    private:
+        struct Page
+        {
+            SharedPtr<TextureAtlas> atlas;
+            SkylinePacker packer;
+        };
+
+        std::vector<Page> pages_;
+        uint32_t page_size_;
+
+        void add_page();
+    };
+}
+
+#endif
@@ -9,6 +9,30 @@
 
 namespace rainbow { namespace graphics
 {
+    /// <summary>
+    ///   Fills <paramref name="indices"/> with the triangle indices of
+    ///   <paramref name="count"/> consecutive quads.
+    /// </summary>
+    /// <remarks>
+    ///   Each quad takes six indices; 0,1,2 for the first triangle, and 2,3,0
+    ///   for the second.
+    /// </remarks>
+    template <typename T>
+    void generate_quad_indices(T* indices, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto index = i * 6;
+            const auto vertex = static_cast<T>(i * 4);
+            indices[index] = vertex;
+            indices[index + 1] = vertex + 1;
+            indices[index + 2] = vertex + 2;
+            indices[index + 3] = vertex + 2;
+            indices[index + 4] = vertex + 3;
+            indices[index + 5] = vertex;
+        }
+    }
+
     class ElementBuffer
     {
     public:
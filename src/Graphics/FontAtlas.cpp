@@ -4,7 +4,10 @@
 
 #include "Graphics/FontAtlas.h"
 
-#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
 
 #ifdef __GNUC__
 #   pragma GCC diagnostic push
@@ -16,15 +19,18 @@
 #   pragma GCC diagnostic pop
 #endif
 
-#include "Common/Data.h"
+#include "Graphics/DistanceField.h"
 #include "Graphics/OpenGL.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/TextureManager.h"
 
 using rainbow::Data;
 using rainbow::FontAtlas;
 using rainbow::FontGlyph;
+using rainbow::Vec2f;
 using rainbow::Vec2u;
 using rainbow::czstring;
+using rainbow::make_distance_field;
 using rainbow::graphics::Texture;
 using rainbow::graphics::TextureManager;
 
@@ -32,12 +38,39 @@ namespace
 {
     constexpr float kGlyphMargin = 2.0f;          ///< Margin around rendered font glyph.
     constexpr uint32_t kASCIIOffset = 32;         ///< Start loading from character 32.
+    constexpr uint32_t kBytesPerPixel = 2;        ///< Luminance-alpha.
     constexpr uint32_t kDPI = 96;                 ///< Horizontal/vertical resolution in dpi.
+    constexpr uint32_t kDistanceFieldSupersample = 4;  ///< Glyph resolution relative to distance field.
     constexpr uint32_t kGlyphPadding = 3;         ///< Padding around font glyph texture.
     constexpr uint32_t kGlyphPadding2 = kGlyphPadding * 2;
-    constexpr uint32_t kNumGlyphsPerColRow = 12;  ///< Number of glyphs per column/row on texture.
+    constexpr uint32_t kInitialPageSize = 256;    ///< Initial width and height of glyph texture.
+    constexpr uint32_t kNumCharacters = 95;       ///< Number of characters loaded up front.
     constexpr int kPixelFormat = 64;              ///< 26.6 fixed-point pixel coordinates.
 
+    /// <summary>
+    ///   Returns the cell size of a glyph. Cells are an even number of pixels
+    ///   wide so that every row starts on a 4-byte boundary when uploaded.
+    /// </summary>
+    auto cell_size(const Vec2u& bitmap_size)
+    {
+        return Vec2u((bitmap_size.x + kGlyphPadding2 + 1) & ~1u,
+                     bitmap_size.y + kGlyphPadding2);
+    }
+
+    /// <summary>
+    ///   Returns a copy of the font data. Glyphs are rasterised on demand, so
+    ///   the data must outlive the font face.
+    /// </summary>
+    auto copy(const Data& data) -> Data
+    {
+        if (!data)
+            return {};
+
+        auto bytes = operator new(data.size());
+        memcpy(bytes, data.bytes(), data.size());
+        return {bytes, data.size(), Data::Ownership::Owner};
+    }
+
     void copy_bitmap_into(uint8_t* dst,
                           const Vec2u& dst_sz,
                           const Vec2u& off,
@@ -60,245 +93,387 @@ namespace
         }
     }
 
-    Vec2u max_glyph_size(const FT_Face& face,
-                         const FontGlyph* glyphs,
-                         size_t count)
+    /// <summary>Copies a rectangle of luminance-alpha pixels.</summary>
+    void copy_rect(uint8_t* dst,
+                   uint32_t dst_width,
+                   const Vec2u& dst_pos,
+                   const uint8_t* src,
+                   uint32_t src_width,
+                   const Vec2u& src_pos,
+                   const Vec2u& size)
     {
-        Vec2u max;
-        std::for_each(glyphs,
-                      glyphs + count,
-                      [&face, &max](const FontGlyph& glyph) {
-            if (FT_Load_Char(face, glyph.code, FT_LOAD_DEFAULT) != 0)
-            {
-                max.x = 0;
-                R_ABORT("Failed to load characters");
-                UNREACHABLE();
-                return;
-            }
-            const FT_Glyph_Metrics& metrics = face->glyph->metrics;
-            if (metrics.width > static_cast<FT_Pos>(max.x))
-                max.x = static_cast<Vec2u::value_type>(metrics.width);
-            if (metrics.height > static_cast<FT_Pos>(max.y))
-                max.y = static_cast<Vec2u::value_type>(metrics.height);
-        });
-        if (max.x == 0)
-            return Vec2u();
-        return Vec2u(max.x / kPixelFormat + kGlyphPadding2,
-                     max.y / kPixelFormat + kGlyphPadding2);
+        const size_t row = size.x * kBytesPerPixel;
+        for (uint32_t y = 0; y < size.y; ++y)
+        {
+            const size_t src_offset = (src_pos.y + y) * src_width + src_pos.x;
+            const size_t dst_offset = (dst_pos.y + y) * dst_width + dst_pos.x;
+            std::copy_n(src + src_offset * kBytesPerPixel,
+                        row,
+                        dst + dst_offset * kBytesPerPixel);
+        }
     }
 
-    class FontFace
+    bool is_control(uint32_t c)
     {
-    public:
-        FontFace(FT_Library library, const Data& font) : face_(nullptr)
-        {
-            FT_Error error =
-                FT_New_Memory_Face(library,
-                                   static_cast<const FT_Byte*>(font.bytes()),
-                                   static_cast<FT_Long>(font.size()),
-                                   0,
-                                   &face_);
-            R_ASSERT(!error, "Failed to load font face");
-            R_ASSERT(FT_IS_SCALABLE(face_),
-                     "Unscalable fonts are not supported");
-            error = FT_Select_Charmap(face_, FT_ENCODING_UNICODE);
-            R_ASSERT(!error, "Failed to select character map");
-            NOT_USED(error);
-        }
+        return c < kASCIIOffset || (c >= 0x7f && c < 0xa0);
+    }
 
-        ~FontFace()
-        {
-            if (face_ == nullptr)
-                return;
+    auto next_font_id()
+    {
+        static uint32_t font_count = 0;
+        return ++font_count;
+    }
 
-            FT_Done_Face(face_);
-        }
+    void set_texcoords(FontGlyph& glyph,
+                       const Vec2u& offset,
+                       const Vec2u& size,
+                       const Vec2u& page_size)
+    {
+        const Vec2f pixel(1.0f / page_size.x, 1.0f / page_size.y);
+        auto vx = glyph.quad;
+        vx[0].texcoord.x = (kGlyphPadding - kGlyphMargin + offset.x) * pixel.x;
+        vx[0].texcoord.y =
+            (kGlyphPadding + size.y + kGlyphMargin + offset.y) * pixel.y;
+        vx[1].texcoord.x =
+            (kGlyphPadding + size.x + kGlyphMargin + offset.x) * pixel.x;
+        vx[1].texcoord.y = vx[0].texcoord.y;
+        vx[2].texcoord.x = vx[1].texcoord.x;
+        vx[2].texcoord.y = (kGlyphPadding - kGlyphMargin + offset.y) * pixel.y;
+        vx[3].texcoord.x = vx[0].texcoord.x;
+        vx[3].texcoord.y = vx[2].texcoord.y;
+    }
 
-        FT_Face operator->() const { return face_; }
-        explicit operator bool() const { return face_ != nullptr; }
-        operator const FT_Face&() const { return face_; }
+    /// <summary>
+    ///   Returns the resolution glyphs are rasterised at, relative to point
+    ///   size.
+    /// </summary>
+    auto supersample(const FontAtlas& font) -> uint32_t
+    {
+        return font.is_distance_field() ? kDistanceFieldSupersample : 1;
+    }
+}
 
-    private:
-        FT_Face face_;
-    };
+FontAtlas::FontAtlas(czstring path, float pt, Rendering rendering)
+    : FontAtlas(path, Data::load_asset(path), pt, rendering)
+{
+}
 
-    class FontLibrary
-    {
-    public:
-        FontLibrary() : library_(nullptr)
-        {
-            FT_Init_FreeType(&library_);
-            R_ASSERT(library_, "Failed to initialise FreeType");
-        }
+FontAtlas::FontAtlas(czstring name,
+                     const Data& font,
+                     float pt,
+                     Rendering rendering)
+    : rendering_(rendering), id_(next_font_id()), pt_(pt), height_(0),
+      font_(copy(font)), library_(nullptr), face_(nullptr),
+      page_size_(kInitialPageSize, kInitialPageSize),
+      packer_(kInitialPageSize, kInitialPageSize),
+      cache_budget_(kDefaultCacheBudget), generation_(0), clock_(0)
+{
+    // Every atlas has its own glyph texture, even with identical fonts.
+    const std::string id = std::string{name} + '#' + std::to_string(id_);
+    texture_ = TextureManager::Get()->create(
+        id,
+        [this](TextureManager& texture_manager, const Texture& texture) {
+            load(texture_manager, texture);
+        });
+}
 
-        ~FontLibrary()
-        {
-            if (library_ == nullptr)
-                return;
+FontAtlas::~FontAtlas()
+{
+    if (face_ != nullptr)
+        FT_Done_Face(face_);
+    if (library_ != nullptr)
+        FT_Done_FreeType(library_);
+}
 
-            FT_Done_FreeType(library_);
-        }
+bool FontAtlas::get_glyph(uint32_t c, FontGlyph& glyph)
+{
+    if (is_control(c))
+        return false;
 
-        explicit operator bool() const { return library_ != nullptr; }
-        operator const FT_Library&() const { return library_; }
+    ++clock_;
+    auto i = index_.find(c);
+    if (i == index_.end())
+    {
+        // Rasterising may evict, so copy the glyph before anything else can.
+        const FontGlyph* rasterized = rasterize(c);
+        if (rasterized == nullptr)
+            return false;
+
+        glyph = *rasterized;
+        return true;
+    }
 
-    private:
-        FT_Library library_;
-    };
+    auto& cached = glyphs_[i->second];
+    cached.last_used = clock_;
+    glyph = cached.glyph;
+    return true;
 }
 
-FontAtlas::FontAtlas(czstring path, float pt)
-    : FontAtlas(path, Data::load_asset(path), pt) {}
+auto FontAtlas::kerning(uint32_t left, uint32_t right) -> float
+{
+    if (face_ == nullptr || !FT_HAS_KERNING(face_))
+        return 0.0f;
+
+    const uint64_t pair = (static_cast<uint64_t>(left) << 32) | right;
+    auto i = kerning_.find(pair);
+    if (i != kerning_.end())
+        return i->second;
+
+    FT_Vector delta{};
+    FT_Get_Kerning(face_,
+                   FT_Get_Char_Index(face_, left),
+                   FT_Get_Char_Index(face_, right),
+                   FT_KERNING_DEFAULT,
+                   &delta);
+    const float kerning =
+        static_cast<float>(delta.x) / (kPixelFormat * supersample(*this));
+    kerning_.emplace(pair, kerning);
+    return kerning;
+}
 
-FontAtlas::FontAtlas(czstring name, const Data& font, float pt)
-    : pt_(pt), height_(0)
+bool FontAtlas::allocate(const Vec2u& cell, Vec2u& position)
 {
-    texture_ = TextureManager::Get()->create(
-        name,
-        [this, &font](TextureManager& texture_manager, const Texture& texture)
-        {
-            load(texture_manager, texture, font);
-        });
+    if (packer_.pack(cell.x, cell.y, position))
+        return true;
+
+    while (grow())
+    {
+        if (packer_.pack(cell.x, cell.y, position))
+            return true;
+    }
+
+    evict();
+    return packer_.pack(cell.x, cell.y, position);
 }
 
-auto FontAtlas::get_glyph(uint32_t c) const -> const FontGlyph*
+void FontAtlas::evict()
 {
-#if FONTATLAS_EXTENDED > 0
-    if (c >= 0x80u)
+    // Keep the most recently used half, packing the tallest glyphs first.
+    std::sort(glyphs_.begin(),
+              glyphs_.end(),
+              [](const CachedGlyph& a, const CachedGlyph& b) {
+                  return a.last_used > b.last_used;
+              });
+    glyphs_.resize(glyphs_.size() / 2);
+    std::sort(glyphs_.begin(),
+              glyphs_.end(),
+              [](const CachedGlyph& a, const CachedGlyph& b) {
+                  return a.size.y > b.size.y;
+              });
+
+    const size_t page_bytes = page_size_.x * page_size_.y * kBytesPerPixel;
+    auto page = std::make_unique<uint8_t[]>(page_bytes);
+    std::fill_n(page.get(), page_bytes, 0);
+    packer_.clear();
+    index_.clear();
+
+    size_t count = 0;
+    for (auto&& cached : glyphs_)
     {
-        const auto first = charset_ + kNumCharacters;
-        const auto last = first + FONTATLAS_EXTENDED;
-        const auto i = std::find_if(first, last, [c](const FontGlyph& glyph) {
-            return glyph.code == c;
-        });
-        return (i == last ? nullptr : i);
+        const Vec2u& cell = cell_size(cached.size);
+        Vec2u position;
+        if (!packer_.pack(cell.x, cell.y, position))
+            continue;
+
+        copy_rect(page.get(), page_size_.x, position, page_.get(),
+                  page_size_.x, cached.position, cell);
+        cached.position = position;
+        set_texcoords(cached.glyph, cached.position, cached.size, page_size_);
+
+        index_[cached.glyph.code] = static_cast<uint32_t>(count);
+        glyphs_[count++] = cached;
     }
-#endif
-    return &charset_[static_cast<uint8_t>(c) - kASCIIOffset];
+
+    glyphs_.resize(count);
+    page_ = std::move(page);
+    ++generation_;
+    upload_page();
 }
 
-void FontAtlas::load(TextureManager& texture_manager,
-                     const Texture& texture,
-                     const Data& font)
+bool FontAtlas::grow()
 {
-    R_ASSERT(font, "Failed to load font");
+    Vec2u size = page_size_;
+    if (size.x <= size.y)
+        size.x *= 2;
+    else
+        size.y *= 2;
+
+    const auto max_size = static_cast<uint32_t>(graphics::max_texture_size());
+    if (size.x > max_size || size.y > max_size ||
+        size.x * size.y * kBytesPerPixel > cache_budget_)
+    {
+        return false;
+    }
 
-    for (uint32_t i = 0; i < kNumCharacters; ++i)
-        charset_[i].code = i + kASCIIOffset;
-
-#if FONTATLAS_EXTENDED > 0
-    const uint32_t characters[]{
-        0x00c5,  // LATIN CAPITAL LETTER A WITH RING ABOVE
-        0x00c6,  // LATIN CAPITAL LETTER AE
-        0x00d8,  // LATIN CAPITAL LETTER O WITH STROKE
-        0x00e5,  // LATIN SMALL LETTER A WITH RING ABOVE
-        0x00e6,  // LATIN SMALL LETTER AE
-        0x00f8,  // LATIN SMALL LETTER O WITH STROKE
-    };
-    for (size_t i = 0; i < array_size(characters); ++i)
-        charset_[kNumCharacters + i].code = characters[i];
-#endif
+    const size_t page_bytes = size.x * size.y * kBytesPerPixel;
+    auto page = std::make_unique<uint8_t[]>(page_bytes);
+    std::fill_n(page.get(), page_bytes, 0);
+    copy_rect(page.get(), size.x, Vec2u::Zero, page_.get(), page_size_.x,
+              Vec2u::Zero, page_size_);
+
+    page_ = std::move(page);
+    page_size_ = size;
+    packer_.grow(size.x, size.y);
+    for (auto&& cached : glyphs_)
+        set_texcoords(cached.glyph, cached.position, cached.size, page_size_);
+
+    ++generation_;
+    upload_page();
+    return true;
+}
 
-    FontLibrary library;
-    if (!library)
+void FontAtlas::load(TextureManager& texture_manager, const Texture& texture)
+{
+    if (face_ != nullptr)
+    {
+        // The texture is being restored; the glyphs are already rasterised.
+        texture_manager.upload(texture, GL_LUMINANCE_ALPHA, page_size_.x,
+                               page_size_.y, GL_LUMINANCE_ALPHA, page_.get());
         return;
+    }
 
-    FontFace face(library, font);
-    if (!face)
-        return;
+    R_ASSERT(font_, "Failed to load font");
 
-    FT_Set_Char_Size(face, 0, pt_ * kPixelFormat, kDPI, kDPI);
-    const Vec2u& max = max_glyph_size(face, charset_, array_size(charset_));
-    if (max.is_zero())
-        return;
-    const Vec2u size(ceil_pow2(max.x * kNumGlyphsPerColRow),
-                     ceil_pow2(max.y * kNumGlyphsPerColRow));
-
-    // GL_LUMINANCE8_ALPHA8 buffer
-    Vec2u offset(size.x * size.y * 2, 0);
-    auto buffer = std::make_unique<GLubyte[]>(offset.x);
-    std::fill_n(buffer.get(), offset.x, 0);
-
-    // Copy all glyph bitmaps to our texture.
-    offset.x = 0;
-    const Vec2f pixel(1.0f / size.x, 1.0f / size.y);
-    for (auto& glyph : charset_)
+    if (!font_ || FT_Init_FreeType(&library_) != 0)
     {
-        FT_Load_Char(face, glyph.code, FT_LOAD_RENDER);
-
-        const FT_GlyphSlot& slot = face->glyph;
-        const FT_Bitmap& bitmap = slot->bitmap;
+        R_ABORT("Failed to initialise FreeType");
+        return;
+    }
 
-        // Make sure bitmap data has enough space to the right. Otherwise, start
-        // a new line.
-        const uint32_t width = bitmap.width + kGlyphPadding2;
-        if (offset.x + width > size.x)
-        {
-            offset.x = 0;
-            offset.y += max.y;
-        }
+    FT_Error error = FT_New_Memory_Face(
+        library_, static_cast<const FT_Byte*>(font_.bytes()),
+        static_cast<FT_Long>(font_.size()), 0, &face_);
+    if (error != 0)
+    {
+        R_ABORT("Failed to load font face");
+        face_ = nullptr;
+        return;
+    }
 
-        // Copy bitmap data to texture.
-        if (bitmap.buffer != nullptr)
-        {
-            R_ASSERT(bitmap.num_grays == 256, "");
-            R_ASSERT(bitmap.pixel_mode == FT_PIXEL_MODE_GRAY, "");
-            copy_bitmap_into(buffer.get(),
-                             size,
-                             offset + kGlyphPadding,
-                             bitmap.buffer,
-                             Vec2u(bitmap.width, bitmap.rows));
-        }
+    R_ASSERT(FT_IS_SCALABLE(face_), "Unscalable fonts are not supported");
+    error = FT_Select_Charmap(face_, FT_ENCODING_UNICODE);
+    R_ASSERT(!error, "Failed to select character map");
+    NOT_USED(error);
 
-        // Save font glyph data.
-        glyph.advance = slot->advance.x / kPixelFormat;
-        glyph.left = slot->bitmap_left;
+    const uint32_t scale = supersample(*this);
+    FT_Set_Char_Size(face_, 0, pt_ * kPixelFormat * scale, kDPI, kDPI);
+    height_ = face_->size->metrics.height / kPixelFormat / scale;
 
-        auto vx = static_cast<SpriteVertex*>(glyph.quad);
+    const size_t page_bytes = page_size_.x * page_size_.y * kBytesPerPixel;
+    page_ = std::make_unique<uint8_t[]>(page_bytes);
+    std::fill_n(page_.get(), page_bytes, 0);
 
-        vx[0].position.x = -kGlyphMargin;
-        vx[0].position.y = static_cast<float>(slot->bitmap_top -
-                                              static_cast<int>(bitmap.rows)) -
-                           kGlyphMargin;
-        vx[1].position.x = static_cast<float>(bitmap.width) + kGlyphMargin;
-        vx[1].position.y = vx[0].position.y;
-        vx[2].position.x = vx[1].position.x;
-        vx[2].position.y = static_cast<float>(slot->bitmap_top) + kGlyphMargin;
-        vx[3].position.x = vx[0].position.x;
-        vx[3].position.y = vx[2].position.y;
+    // |texture_| is not yet set; glyphs and growth are not uploaded until
+    // the whole page is.
+    for (uint32_t i = 0; i < kNumCharacters; ++i)
+        rasterize(i + kASCIIOffset);
 
-        vx[0].texcoord.x = (kGlyphPadding - kGlyphMargin + offset.x) * pixel.x;
-        vx[0].texcoord.y =
-            (kGlyphPadding + bitmap.rows + kGlyphMargin + offset.y) * pixel.y;
-        vx[1].texcoord.x =
-            (kGlyphPadding + bitmap.width + kGlyphMargin + offset.x) * pixel.x;
-        vx[1].texcoord.y = vx[0].texcoord.y;
-        vx[2].texcoord.x = vx[1].texcoord.x;
-        vx[2].texcoord.y = (kGlyphPadding - kGlyphMargin + offset.y) * pixel.y;
-        vx[3].texcoord.x = vx[0].texcoord.x;
-        vx[3].texcoord.y = vx[2].texcoord.y;
+    texture_manager.upload(texture, GL_LUMINANCE_ALPHA, page_size_.x,
+                           page_size_.y, GL_LUMINANCE_ALPHA, page_.get());
+}
 
-#ifdef FONTATLAS_KERNING
-        if (FT_HAS_KERNING(face))
+auto FontAtlas::rasterize(uint32_t c) -> const FontGlyph*
+{
+    if (face_ == nullptr || FT_Load_Char(face_, c, FT_LOAD_RENDER) != 0)
+        return nullptr;
+
+    const FT_GlyphSlot& slot = face_->glyph;
+    const FT_Bitmap& bitmap = slot->bitmap;
+    R_ASSERT(bitmap.buffer == nullptr || bitmap.num_grays == 256, "");
+    R_ASSERT(bitmap.buffer == nullptr ||
+                 bitmap.pixel_mode == FT_PIXEL_MODE_GRAY,
+             "");
+
+    Vec2u size(bitmap.width, bitmap.rows);
+    const uint8_t* pixels = bitmap.buffer;
+    float advance = static_cast<float>(slot->advance.x) / kPixelFormat;
+    float left = static_cast<float>(slot->bitmap_left);
+    float top = static_cast<float>(slot->bitmap_top);
+
+    std::unique_ptr<uint8_t[]> field;
+    if (is_distance_field())
+    {
+        // The glyph was rasterised at a higher resolution than the field.
+        constexpr float kScale = 1.0f / kDistanceFieldSupersample;
+        constexpr auto kSpread = static_cast<float>(kDistanceFieldSpread);
+        if (pixels != nullptr)
         {
-            int i = -1;
-            FT_Vector kerning;
-            for (auto& left : charset_)
-            {
-                FT_Get_Kerning(
-                    face, left.code, glyph.code, FT_KERNING_DEFAULT, &kerning);
-                glyph.kern[++i] =
-                    static_cast<int16_t>(kerning.x / kPixelFormat);
-            }
+            Vec2u field_size;
+            field = make_distance_field(pixels,
+                                        size,
+                                        kDistanceFieldSpread,
+                                        kDistanceFieldSupersample,
+                                        field_size);
+            pixels = field.get();
+            size = field_size;
         }
-#endif
+        advance *= kScale;
+        left = left * kScale - kSpread;
+        top = top * kScale + kSpread;
+    }
+
+    const Vec2u& cell = cell_size(size);
 
-        // Advance to the next "slot" in our texture.
-        offset.x += width;
+    Vec2u position;
+    if (!allocate(cell, position))
+    {
+        LOGW("Glyph U+%04X does not fit in font texture", c);
+        return nullptr;
     }
 
-    height_ = face->size->metrics.height / kPixelFormat;
+    // |allocate| may have repacked the page, but |pixels| is still intact.
+    if (pixels != nullptr)
+    {
+        copy_bitmap_into(
+            page_.get(), page_size_, position + kGlyphPadding, pixels, size);
+    }
+
+    CachedGlyph cached{};
+    cached.position = position;
+    cached.size = size;
+    cached.last_used = clock_;
+
+    // Save font glyph data.
+    FontGlyph& glyph = cached.glyph;
+    glyph.code = c;
+    glyph.advance = advance;
+    glyph.left = left;
+
+    auto vx = glyph.quad;
+    vx[0].position.x = -kGlyphMargin;
+    vx[0].position.y = top - static_cast<float>(size.y) - kGlyphMargin;
+    vx[1].position.x = static_cast<float>(size.x) + kGlyphMargin;
+    vx[1].position.y = vx[0].position.y;
+    vx[2].position.x = vx[1].position.x;
+    vx[2].position.y = top + kGlyphMargin;
+    vx[3].position.x = vx[0].position.x;
+    vx[3].position.y = vx[2].position.y;
+    set_texcoords(glyph, position, size, page_size_);
+
+    index_[c] = static_cast<uint32_t>(glyphs_.size());
+    glyphs_.push_back(cached);
+
+    if (texture_)
+    {
+        // Upload only the glyph's cell.
+        auto pixels = std::make_unique<uint8_t[]>(cell.x * cell.y *
+                                                  kBytesPerPixel);
+        copy_rect(pixels.get(), cell.x, Vec2u::Zero, page_.get(),
+                  page_size_.x, position, cell);
+        TextureManager::Get()->upload_subimage(
+            texture_, position.x, position.y, cell.x, cell.y,
+            GL_LUMINANCE_ALPHA, pixels.get());
+    }
+
+    return &glyphs_.back().glyph;
+}
+
+void FontAtlas::upload_page()
+{
+    if (!texture_)
+        return;
 
-    texture_manager.upload(texture, GL_LUMINANCE_ALPHA, size.x, size.y,
-                           GL_LUMINANCE_ALPHA, buffer.get());
+    TextureManager::Get()->upload(texture_, GL_LUMINANCE_ALPHA, page_size_.x,
+                                  page_size_.y, GL_LUMINANCE_ALPHA,
+                                  page_.get());
 }
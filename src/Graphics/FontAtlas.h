@@ -4,14 +4,21 @@
 
 #ifndef GRAPHICS_FONTATLAS_H_
 #define GRAPHICS_FONTATLAS_H_
-#define FONTATLAS_EXTENDED 6
-//#define FONTATLAS_KERNING
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/Data.h"
 #include "Common/String.h"
 #include "Graphics/FontGlyph.h"
+#include "Graphics/SkylinePacker.h"
 #include "Graphics/Texture.h"
 #include "Memory/SharedPtr.h"
 
+struct FT_FaceRec_;
+struct FT_LibraryRec_;
+
 namespace rainbow
 {
     namespace graphics
@@ -20,20 +27,35 @@ namespace rainbow
         class TextureManager;
     }
 
-    class Data;
-
     /// <summary>Uses FreeType to load OpenType and TrueType fonts.</summary>
     /// <remarks>
     ///   <para>
-    ///     Creates textures from font glyphs for symbols 32 through 126. Copies
-    ///     bitmap data into a larger buffer which is then used as texture.
+    ///     Glyphs are rasterised the first time they are requested, and packed
+    ///     into a texture that grows as needed. Only the rectangle occupied by
+    ///     a new glyph is uploaded. Printable ASCII characters are rasterised
+    ///     up front.
+    ///   </para>
+    ///   <para>
+    ///     When the texture cannot grow any further without exceeding the
+    ///     cache budget, the least recently used half of the glyphs is evicted
+    ///     and the rest are repacked. Growing or repacking moves glyphs within
+    ///     the texture, which is signalled by a change in
+    ///     <see cref="generation"/>.
+    ///   </para>
+    ///   <para>
+    ///     Fonts rendered as signed distance fields store the distance to the
+    ///     glyph outlines rather than their coverage. A single font can then
+    ///     be scaled up or down with crisp edges, in place of one font per
+    ///     size. The point size should be chosen so that the field captures
+    ///     the finer details of the glyphs, e.g. 32 pt. Labels using such
+    ///     fonts are drawn with a dedicated shader.
     ///   </para>
     ///   Features:
     ///   <list type="bullet">
     ///     <item>Anti-aliasing</item>
-    ///     <item>Kerning</item>
+    ///     <item>Signed distance fields</item>
+    ///     <item>Unicode</item>
     ///   </list>
-    ///   <para>TODO: Optimise texture size by sorting glyphs.</para>
     ///   References
     ///   <list type="bullet">
     ///     <item>http://iphone-3d-programming.labs.oreilly.com/ch07.html</item>
@@ -46,39 +68,145 @@ namespace rainbow
     class FontAtlas : public RefCounted
     {
     public:
-        FontAtlas(czstring path, float pt);
-        FontAtlas(czstring name, const Data& font, float pt);
+        using Glyph = FontGlyph;
+
+        /// <summary>
+        ///   Default maximum video memory used by the glyph texture, in bytes.
+        /// </summary>
+        static constexpr size_t kDefaultCacheBudget = 4 * 1024 * 1024;
+
+        /// <summary>
+        ///   Maximum distance, in pixels at point size, encoded in signed
+        ///   distance fields.
+        /// </summary>
+        static constexpr uint32_t kDistanceFieldSpread = 4;
+
+        enum class Rendering
+        {
+            Bitmap,
+            SignedDistanceField,
+        };
+
+        FontAtlas(czstring path,
+                  float pt,
+                  Rendering rendering = Rendering::Bitmap);
+        FontAtlas(czstring name,
+                  const Data& font,
+                  float pt,
+                  Rendering rendering = Rendering::Bitmap);
+        ~FontAtlas();
+
+        /// <summary>
+        ///   Returns the maximum video memory used by the glyph texture.
+        /// </summary>
+        auto cache_budget() const { return cache_budget_; }
+
+        /// <summary>
+        ///   Returns a number that changes whenever glyphs are moved within
+        ///   the texture. Texture coordinates of glyphs retrieved under a
+        ///   different generation are no longer valid.
+        /// </summary>
+        auto generation() const { return generation_; }
 
         /// <summary>Returns the line height.</summary>
         auto height() const { return height_; }
 
+        /// <summary>Returns a number uniquely identifying this font.</summary>
+        auto id() const { return id_; }
+
+        /// <summary>
+        ///   Returns whether glyphs are rendered as signed distance fields.
+        /// </summary>
+        bool is_distance_field() const
+        {
+            return rendering_ == Rendering::SignedDistanceField;
+        }
+
         /// <summary>Returns whether this FontAtlas is valid.</summary>
         bool is_valid() const { return texture_; }
 
+        /// <summary>Returns the texture containing the glyphs.</summary>
+        auto texture() const -> const graphics::Texture& { return texture_; }
+
+        /// <summary>
+        ///   Sets the maximum video memory used by the glyph texture. Glyphs
+        ///   are only evicted when the texture would exceed this budget.
+        /// </summary>
+        void set_cache_budget(size_t bytes) { cache_budget_ = bytes; }
+
         /// <summary>Sets this font as active texture.</summary>
         void bind() const { texture_.bind(); }
 
         /// <summary>
-        ///   Returns the glyph for character <paramref name="c"/>.
+        ///   Copies the glyph for character <paramref name="c"/> into
+        ///   <paramref name="glyph"/>, rasterising it if necessary.
         /// </summary>
-        auto get_glyph(uint32_t c) const -> const FontGlyph*;
+        /// <returns>
+        ///   <c>false</c> for control characters, or if the glyph could not be
+        ///   rasterised; <paramref name="glyph"/> is then left untouched.
+        /// </returns>
+        bool get_glyph(uint32_t c, FontGlyph& glyph);
 
-    protected:
         /// <summary>
-        ///   Load characters 32 through 126 from the ASCII table.
+        ///   Returns the horizontal adjustment between characters
+        ///   <paramref name="left"/> and <paramref name="right"/>, when the
+        ///   latter follows the former.
         /// </summary>
-        static constexpr uint32_t kNumCharacters = 95;
+        auto kerning(uint32_t left, uint32_t right) -> float;
 
     private:
+        struct CachedGlyph
+        {
+            FontGlyph glyph;
+            Vec2u position;      ///< Upper left corner of the glyph's cell.
+            Vec2u size;          ///< Dimension of the glyph's bitmap.
+            uint32_t last_used;  ///< Time of last use; see |clock_|.
+        };
+
+        const Rendering rendering_;  ///< Whether glyphs are distance fields.
+        const uint32_t id_;          ///< Unique font identifier.
         const float pt_;             ///< Font point size.
-        Color color_;                ///< Font colour.
         int height_;                 ///< Font line height.
+        Data font_;                  ///< Font data, referenced by |face_|.
+        FT_LibraryRec_* library_;    ///< FreeType library instance.
+        FT_FaceRec_* face_;          ///< Font face.
         graphics::Texture texture_;  ///< Texture name.
-        FontGlyph charset_[kNumCharacters + FONTATLAS_EXTENDED];  ///< Character set.
+        Vec2u page_size_;            ///< Dimension of the glyph texture.
+        std::unique_ptr<uint8_t[]> page_;  ///< Copy of the glyph texture (luminance-alpha).
+        SkylinePacker packer_;             ///< Allocates glyph cells in the texture.
+        std::vector<CachedGlyph> glyphs_;  ///< Rasterised glyphs.
+        std::unordered_map<uint32_t, uint32_t> index_;  ///< Character to index into |glyphs_|.
+        std::unordered_map<uint64_t, float> kerning_;   ///< Kerning by character pair.
+        size_t cache_budget_;        ///< Maximum size of the glyph texture.
+        uint32_t generation_;        ///< Incremented whenever glyphs move.
+        uint32_t clock_;             ///< Incremented on every glyph lookup.
+
+        /// <summary>
+        ///   Finds space for a cell, growing or repacking the texture if
+        ///   needed.
+        /// </summary>
+        bool allocate(const Vec2u& cell, Vec2u& position);
+
+        /// <summary>
+        ///   Evicts the least recently used half of the glyphs, and repacks
+        ///   the rest.
+        /// </summary>
+        void evict();
+
+        /// <summary>
+        ///   Doubles the smaller side of the glyph texture, unless it would
+        ///   exceed the budget.
+        /// </summary>
+        bool grow();
 
         void load(graphics::TextureManager& texture_manager,
-                  const graphics::Texture& texture,
-                  const Data& font);
+                  const graphics::Texture& texture);
+
+        /// <summary>Rasterises and caches a glyph.</summary>
+        auto rasterize(uint32_t c) -> const FontGlyph*;
+
+        /// <summary>Uploads the whole glyph texture.</summary>
+        void upload_page();
     };
 }
 
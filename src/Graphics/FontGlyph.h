@@ -15,13 +15,9 @@ namespace rainbow
     struct FontGlyph
     {
         uint32_t code;         ///< UTF-32 code.
-        int32_t advance;       ///< Horizontal advancement.
-        int32_t left;          ///< Left alignment.
+        float advance;         ///< Horizontal advancement.
+        float left;            ///< Left alignment.
         SpriteVertex quad[4];  ///< Sprite vertices.
-
-#ifdef FONTATLAS_KERNING
-        int16_t kern[95];  ///< Font kerning information for each character.
-#endif
     };
 }
 
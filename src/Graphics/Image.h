@@ -6,6 +6,7 @@
 #define GRAPHICS_IMAGE_H_
 
 #include "Common/DataMap.h"
+#include "Memory/BufferPool.h"
 
 namespace rainbow
 {
@@ -50,6 +51,7 @@ namespace rainbow
         uint32_t channels;
         size_t size;
         const uint8_t* data;
+        BufferPool::Buffer buffer;  ///< Owns |data| if it was decoded.
 
         Image() : Image(Format::Unknown) {}
 
@@ -62,7 +64,7 @@ namespace rainbow
         Image(Image&& image) noexcept
             : format(image.format), width(image.width), height(image.height),
               depth(image.depth), channels(image.channels), size(image.size),
-              data(image.data)
+              data(image.data), buffer(std::move(image.buffer))
         {
             image.format = Format::Unknown;
             image.width = 0;
@@ -72,24 +74,6 @@ namespace rainbow
             image.size = 0;
             image.data = nullptr;
         }
-
-        ~Image()
-        {
-            switch (format)
-            {
-                case Format::ATITC:
-                case Format::ETC1:
-                case Format::PVRTC:
-                case Format::S3TC:
-                    break;
-
-                case Format::PNG:
-                case Format::SVG:
-                default:
-                    delete[] data;
-                    break;
-            }
-        }
     };
 }
 
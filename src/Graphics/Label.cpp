@@ -6,28 +6,44 @@
 
 #include <cstring>
 
-#include "Common/UTF8.h"
+#include "Graphics/Renderer.h"
 #include "Math/Transform.h"
 
 using rainbow::Color;
 using rainbow::FontAtlas;
 using rainbow::Label;
+using rainbow::PackedSpriteVertex;
 using rainbow::SharedPtr;
 using rainbow::TextAlignment;
 using rainbow::Vec2f;
+using rainbow::VertexFormat;
 using rainbow::czstring;
 
 namespace
 {
     constexpr float kAlignmentFactor[]{0.0f, 1.0f, 0.5f};
+    constexpr float kMaxScale = 1.0f;
+    constexpr float kMaxScaleDistanceField = 8.0f;
+    constexpr float kMinScale = 0.01f;
+
+    auto max_scale(const FontAtlas* font)
+    {
+        return font != nullptr && font->is_distance_field()
+                   ? kMaxScaleDistanceField
+                   : kMaxScale;
+    }
 }
 
 Label::Label()
     : scale_(1.0f), alignment_(TextAlignment::Left), angle_(0.0f), count_(0),
       stale_(0), width_(0),
-      cutoff_(std::numeric_limits<decltype(cutoff_)>::max()), size_(0)
+      cutoff_(std::numeric_limits<decltype(cutoff_)>::max()), size_(0),
+      vertex_format_(VertexFormat::Float), font_generation_(0),
+      generation_(0), max_width_(0.0f),
+      edit_offset_(std::numeric_limits<decltype(edit_offset_)>::max()),
+      upload_first_(0)
 {
-    array_.reconfigure([this] { buffer_.bind(); });
+    array_.reconfigure([this] { buffer_.bind(vertex_format_); });
 }
 
 void Label::set_alignment(TextAlignment a)
@@ -45,6 +61,18 @@ void Label::set_color(Color c)
 void Label::set_font(SharedPtr<FontAtlas> f)
 {
     font_ = std::move(f);
+    scale_ = std::min(scale_, max_scale(font_.get()));
+    layout_.reset();
+    set_needs_update(kStaleBuffer);
+}
+
+void Label::set_max_width(float width)
+{
+    if (are_equal(width, max_width_))
+        return;
+
+    max_width_ = std::max(width, 0.0f);
+    layout_.reset();
     set_needs_update(kStaleBuffer);
 }
 
@@ -69,21 +97,51 @@ void Label::set_scale(float f)
     if (are_equal(f, scale_))
         return;
 
-    scale_ = clamp(f, 0.01f, 1.0f);
+    scale_ = clamp(f, kMinScale, max_scale(font_.get()));
+    if (max_width_ > 0.0f)
+        layout_.reset();
     set_needs_update(kStaleBuffer);
 }
 
 void Label::set_text(czstring text)
 {
     const size_t len = strlen(text);
+    size_t prefix = 0;
+    if (text_)
+    {
+        while (prefix < len && text_[prefix] == text[prefix])
+            ++prefix;
+        if (prefix == len && text_[prefix] == '\0')
+            return;
+    }
+
     if (len > size_)
     {
-        text_ = std::make_unique<char[]>(len + 1);
-        size_ = len;
+        // Grow geometrically so that appending costs amortised constant time.
+        const size_t size = std::max(len, size_ * 2);
+        auto buffer = std::make_unique<char[]>(size + 1);
+        std::copy_n(text_.get(), prefix, buffer.get());
+        text_ = std::move(buffer);
+        size_ = size;
         set_needs_update(kStaleBufferSize);
     }
-    std::copy_n(text, len, text_.get());
+    std::copy_n(text + prefix, len - prefix, text_.get() + prefix);
     text_[len] = '\0';
+    edit_offset_ = std::min(edit_offset_, static_cast<uint32_t>(prefix));
+    set_needs_update(kStaleText);
+}
+
+void Label::set_vertex_format(VertexFormat format)
+{
+    if (format == vertex_format_)
+        return;
+
+    vertex_format_ = format;
+    if (format == VertexFormat::Float)
+        packed_.reset();
+
+    if (array_)
+        array_.reconfigure([this] { buffer_.bind(vertex_format_); });
     set_needs_update(kStaleBuffer);
 }
 
@@ -95,9 +153,11 @@ void Label::move(const Vec2f& delta)
 
 void Label::update()
 {
+    check_font_generation();
     if (stale_ != 0)
     {
         update_internal();
+        generation_ = graphics::detail::next_vertex_generation();
         upload();
         clear_state();
     }
@@ -105,59 +165,28 @@ void Label::update()
 
 void Label::update_internal()
 {
-    // Note: This algorithm currently does not support font kerning.
-    if ((stale_ & kStaleBuffer) != 0)
+    if ((stale_ & (kStaleBuffer | kStaleColor)) == 0 &&
+        (stale_ & kStaleText) != 0 && layout_)
+    {
+        update_text();
+    }
+    else if ((stale_ & (kStaleBuffer | kStaleText)) != 0)
     {
         if ((stale_ & kStaleBufferSize) != 0)
             vertices_ = std::make_unique<SpriteVertex[]>(size_ * 4);
-        width_ = 0;
-        unsigned int start = 0;
-        unsigned int count = 0;
-        const bool is_rotated = !is_almost_zero(angle_);
-        const Vec2f R = is_rotated ? Vec2f{cosf(-angle_), sinf(-angle_)}
-                                   : Vec2f::Right;
-        const bool needs_alignment =
-            alignment_ != TextAlignment::Left || is_rotated;
-        Vec2f pen = (needs_alignment ? Vec2f::Zero : position_);
-        const float origin_x = pen.x;
-        SpriteVertex* vx = vertices_.get();
-
-        for_each_utf8(
-            text_.get(),
-            [this, &start, &count, &pen, origin_x, R, needs_alignment, &vx](
-                uint32_t ch)
-            {
-                if (ch == '\n')
-                {
-                    save(start, count, pen.x - origin_x, R, needs_alignment);
-                    pen.x = origin_x;
-                    start = count;
-                    pen.y -= font_->height() * scale_;
-                    return;
-                }
-
-                const FontGlyph* glyph = font_->get_glyph(ch);
-                if (glyph == nullptr)
-                    return;
-
-                pen.x += glyph->left * scale_;
-
-                for (size_t i = 0; i < 4; ++i)
-                {
-                    vx->color = color_;
-                    vx->texcoord = glyph->quad[i].texcoord;
-                    vx->position = glyph->quad[i].position;
-                    vx->position *= scale_;
-                    vx->position += pen;
-                    ++vx;
-                }
-
-                pen.x += (glyph->advance - glyph->left) * scale_;
-                ++count;
-            });
+        if ((stale_ & kStaleText) != 0)
+            layout_.reset();
 
-        count_ = count * 4;
-        save(start, count, pen.x - origin_x, R, needs_alignment);
+        // Rasterising glyphs may move previously laid out glyphs within the
+        // font texture. Should that happen, lay out the text once more to
+        // pick up their new texture coordinates.
+        font_generation_ = font_->generation();
+        lay_out(0);
+        if (font_->generation() != font_generation_)
+        {
+            font_generation_ = font_->generation();
+            lay_out(0);
+        }
     }
     else if ((stale_ & kStaleColor) != 0)
     {
@@ -168,11 +197,150 @@ void Label::update_internal()
                           v.color = color;
                       });
     }
+    edit_offset_ = std::numeric_limits<decltype(edit_offset_)>::max();
 }
 
-void Label::upload() const
+void Label::lay_out(size_t first_line)
 {
-    buffer_.upload(vertices_.get(), count_ * sizeof(vertices_[0]));
+    if (!layout_)
+    {
+        layout_ = TextLayout::get(*font_, text_.get(), max_width_ / scale_);
+        edited_layout_.reset();
+    }
+
+    const auto& lines = layout_->lines();
+    width_ = 0;
+    for (size_t l = 0; l < first_line; ++l)
+    {
+        width_ = std::max(width_,
+                          static_cast<unsigned int>(lines[l].width * scale_));
+    }
+
+    const bool is_rotated = !is_almost_zero(angle_);
+    const Vec2f R = is_rotated ? Vec2f{cosf(-angle_), sinf(-angle_)}
+                               : Vec2f::Right;
+    const bool needs_alignment =
+        alignment_ != TextAlignment::Left || is_rotated;
+    Vec2f pen = (needs_alignment ? Vec2f::Zero : position_);
+    const float line_height = font_->height() * scale_;
+    pen.y -= line_height * first_line;
+
+    const auto& glyphs = layout_->glyphs();
+    SpriteVertex* vx = vertices_.get() + lines[first_line].first * 4;
+    for (size_t l = first_line; l < lines.size(); ++l)
+    {
+        const auto& line = lines[l];
+        for (uint32_t i = line.first; i < line.last; ++i)
+        {
+            // Missing glyphs are drawn as empty quads so that every glyph in
+            // the layout maps to a quad.
+            FontGlyph glyph;
+            const bool has_glyph = font_->get_glyph(glyphs[i].code, glyph);
+            const Vec2f offset{pen.x + glyphs[i].x * scale_, pen.y};
+            for (size_t j = 0; j < 4; ++j)
+            {
+                vx->color = color_;
+                vx->texcoord =
+                    has_glyph ? glyph.quad[j].texcoord : Vec2f::Zero;
+                vx->position =
+                    has_glyph ? glyph.quad[j].position : Vec2f::Zero;
+                vx->position *= scale_;
+                vx->position += offset;
+                ++vx;
+            }
+        }
+
+        save(line.first, line.last, line.width * scale_, R, needs_alignment);
+        pen.y -= line_height;
+    }
+
+    count_ = static_cast<unsigned int>(glyphs.size() * 4);
+}
+
+void Label::update_text()
+{
+    // Cached layouts may be shared with other labels; edit a copy.
+    if (edited_layout_ != layout_)
+    {
+        edited_layout_ = std::make_shared<TextLayout>(*layout_);
+        layout_ = edited_layout_;
+    }
+
+    if ((stale_ & kStaleBufferSize) != 0)
+    {
+        auto vertices = std::make_unique<SpriteVertex[]>(size_ * 4);
+        std::copy_n(vertices_.get(), count_, vertices.get());
+        vertices_ = std::move(vertices);
+    }
+
+    font_generation_ = font_->generation();
+    const size_t first_line =
+        edited_layout_->relayout(*font_, text_.get(), edit_offset_);
+    lay_out(first_line);
+    if (font_->generation() != font_generation_)
+    {
+        font_generation_ = font_->generation();
+        lay_out(0);
+        return;
+    }
+
+    upload_first_ = layout_->lines()[first_line].first * 4;
+}
+
+void Label::upload()
+{
+    bounds_ = bounding_box(vertices_.get(), count_);
+    if (vertex_format_ == VertexFormat::Packed)
+    {
+        if (!packed_)
+        {
+            packed_ = std::make_unique<PackedSpriteVertex[]>(size_ * 4);
+            upload_first_ = 0;
+        }
+        else if ((stale_ & kStaleBufferSize) != 0)
+        {
+            auto packed = std::make_unique<PackedSpriteVertex[]>(size_ * 4);
+            std::copy_n(packed_.get(), upload_first_, packed.get());
+            packed_ = std::move(packed);
+        }
+        pack(vertices_.get() + upload_first_,
+             count_ - upload_first_,
+             packed_.get() + upload_first_);
+        upload(packed_.get(), sizeof(packed_[0]));
+    }
+    else
+    {
+        upload(vertices_.get(), sizeof(vertices_[0]));
+    }
+}
+
+void Label::upload(const void* vertices, size_t stride)
+{
+    const size_t size = count_ * stride;
+    if (upload_first_ > 0 && size <= buffer_.size())
+    {
+        // Only vertices from |upload_first_| onwards have changed.
+        const size_t offset = upload_first_ * stride;
+        buffer_.upload(static_cast<const uint8_t*>(vertices) + offset,
+                       offset,
+                       size - offset);
+    }
+    else
+    {
+        // Reserve room for the text to grow, so that edits can be uploaded
+        // in place.
+        const size_t capacity = size_ * 4 * stride;
+        if (capacity > size)
+        {
+            buffer_.upload(nullptr, capacity);
+            buffer_.upload(vertices, 0, size);
+        }
+        else
+        {
+            buffer_.upload(vertices, size);
+        }
+    }
+    upload_first_ = 0;
 }
 
 void Label::save(unsigned int start,
@@ -11,6 +11,8 @@
 
 #include "Graphics/Buffer.h"
 #include "Graphics/FontAtlas.h"
+#include "Graphics/SpriteVertex.h"
+#include "Graphics/TextLayout.h"
 #include "Graphics/VertexArray.h"
 
 namespace rainbow
@@ -22,6 +24,7 @@ namespace rainbow
         static constexpr uint32_t kStaleBuffer      = 1u << 0;
         static constexpr uint32_t kStaleBufferSize  = 1u << 1;
         static constexpr uint32_t kStaleColor       = 1u << 2;
+        static constexpr uint32_t kStaleText        = 1u << 3;
         static constexpr uint32_t kStaleMask        = 0xffffu;
 
         Label();
@@ -33,6 +36,11 @@ namespace rainbow
         /// <summary>Returns label angle of rotation.</summary>
         auto angle() const { return angle_; }
 
+        /// <summary>
+        ///   Returns the bounding box of all glyphs, as of last update.
+        /// </summary>
+        auto bounds() const -> const Rect& { return bounds_; }
+
         /// <summary>Returns label text color.</summary>
         auto color() const { return color_; }
 
@@ -42,6 +50,12 @@ namespace rainbow
         /// <summary>Returns the number of characters.</summary>
         auto length() const { return count_ / 4; }
 
+        /// <summary>
+        ///   Returns the width at which lines are wrapped; zero if they are
+        ///   only broken at line feeds.
+        /// </summary>
+        auto max_width() const { return max_width_; }
+
         /// <summary>Returns label position.</summary>
         auto position() const -> const Vec2f& { return position_; }
 
@@ -57,12 +71,23 @@ namespace rainbow
             return array_;
         }
 
+        auto vertex_buffer() const { return vertices_.get(); }
+
+        /// <summary>
+        ///   Returns the generation of the client vertex buffer. It changes
+        ///   whenever the buffer is modified.
+        /// </summary>
+        auto vertex_generation() const { return generation_; }
+
         /// <summary>Returns the vertex count.</summary>
         auto vertex_count() const
         {
             return std::min(count_ + (count_ >> 1), cutoff_);
         }
 
+        /// <summary>Returns the layout of uploaded vertices.</summary>
+        auto vertex_format() const { return vertex_format_; }
+
         /// <summary>Returns label width.</summary>
         auto width() const { return width_; }
 
@@ -75,6 +100,13 @@ namespace rainbow
         /// <summary>Sets text font.</summary>
         void set_font(SharedPtr<FontAtlas>);
 
+        /// <summary>
+        ///   Sets the width at which lines are wrapped. Lines are broken at
+        ///   spaces where possible. Set to zero to only break lines at line
+        ///   feeds.
+        /// </summary>
+        void set_max_width(float width);
+
         /// <summary>Sets label as needing update.</summary>
         void set_needs_update(unsigned int what) { stale_ |= what; }
 
@@ -88,13 +120,20 @@ namespace rainbow
         void set_rotation(float r);
 
         /// <summary>
-        ///   Sets label scale. Value is clamped between 0.01 and 1.0.
+        ///   Sets label scale. Value is clamped between 0.01 and 1.0, or 8.0
+        ///   if the font is rendered as signed distance fields.
         /// </summary>
         void set_scale(float f);
 
-        /// <summary>Sets text to display.</summary>
+        /// <summary>
+        ///   Sets text to display. Only lines from the first changed
+        ///   character onwards are laid out and uploaded again.
+        /// </summary>
         void set_text(czstring);
 
+        /// <summary>Sets the layout of vertices uploaded to the GPU.</summary>
+        void set_vertex_format(VertexFormat format);
+
         /// <summary>Binds all used textures.</summary>
         void bind_textures() const { font_->bind(); }
 
@@ -109,17 +148,29 @@ namespace rainbow
         void set_cutoff(int cutoff) { cutoff_ = cutoff * 6; }
 
         auto state() const { return stale_; }
-        auto vertex_buffer() const { return vertices_.get(); }
 
         void clear_state() { stale_ = 0; }
+
+        /// <summary>
+        ///   Marks the vertex buffer as stale if glyphs have moved within the
+        ///   font texture since last update.
+        /// </summary>
+        void check_font_generation()
+        {
+            if (font_ && font_->generation() != font_generation_)
+                set_needs_update(kStaleBuffer);
+        }
+
         void update_internal();
-        void upload() const;
+        void upload();
 
     private:
         using String = std::unique_ptr<char[]>;
+        using PackedBuffer = std::unique_ptr<PackedSpriteVertex[]>;
         using VertexBuffer = std::unique_ptr<SpriteVertex[]>;
 
         VertexBuffer vertices_;        ///< Client vertex buffer.
+        PackedBuffer packed_;          ///< Staging buffer for packed vertices.
         String text_;                  ///< Content of this label.
         Vec2f position_;               ///< Position of the text (bottom left).
         Color color_;                  ///< Text colour.
@@ -131,9 +182,35 @@ namespace rainbow
         unsigned int width_;           ///< Label width.
         unsigned int cutoff_;          ///< Number of characters to render.
         size_t size_;                  ///< Size of the char array.
+        Rect bounds_;                  ///< Bounding box of all glyphs.
         graphics::Buffer buffer_;      ///< Vertex buffer.
         graphics::VertexArray array_;  ///< Vertex array object.
         SharedPtr<FontAtlas> font_;    ///< The font used in this label.
+        VertexFormat vertex_format_;   ///< Layout of uploaded vertices.
+        uint32_t font_generation_;     ///< Font generation as of last layout.
+        uint64_t generation_;          ///< Changes whenever client vertices change.
+        float max_width_;              ///< Width to wrap lines at.
+        uint32_t edit_offset_;         ///< Byte offset of first text change.
+        uint32_t upload_first_;        ///< First vertex changed since upload.
+        std::shared_ptr<const TextLayout> layout_;  ///< Positioned glyphs.
+        std::shared_ptr<TextLayout> edited_layout_; ///< Layout owned by label.
+
+        /// <summary>
+        ///   Lays out the glyphs of the text, starting at
+        ///   <paramref name="first_line"/>.
+        /// </summary>
+        void lay_out(size_t first_line);
+
+        /// <summary>
+        ///   Lays out the text again from the line containing the first
+        ///   changed character.
+        /// </summary>
+        void update_text();
+
+        /// <summary>
+        ///   Uploads vertices from <see cref="upload_first_"/> onwards.
+        /// </summary>
+        void upload(const void* vertices, size_t stride);
 
         /// <summary>Saves line width and aligns the line if needed.</summary>
         /// <param name="start">First character of line.</param>
@@ -75,6 +75,9 @@ void LyricalLabel::set_text(czstring text)
 {
     clear_animations();
     Label::set_text(text);
+
+    // Attributes are applied to all vertices; rebuild them all.
+    set_needs_update(kStaleBuffer);
 }
 
 void LyricalLabel::set_offset(const Vec2i& offset,
@@ -170,6 +173,7 @@ void LyricalLabel::stop_animation(Animation animation)
 
 void LyricalLabel::update()
 {
+    check_font_generation();
     if (state() != 0)
     {
         if ((state() & kStaleMask) != 0)
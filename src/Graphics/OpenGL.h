@@ -53,4 +53,34 @@
 #   define USE_VERTEX_ARRAY_OBJECT 1
 #endif
 
+// Instanced arrays are core in OpenGL 3.3 and OpenGL ES 3.0, and OpenGL ES 2.0
+// devices may have them as an extension. Android and web builds may run on
+// either, so the entry points are loaded at run-time. Whether they can be used
+// is always decided at run-time; see graphics::has_instancing().
+#if defined(RAINBOW_OS_ANDROID) || defined(RAINBOW_JS)
+#   if defined(GL_ES_VERSION_3_0) || defined(GL_EXT_instanced_arrays) || \
+       defined(GL_ANGLE_instanced_arrays)
+#       define USE_INSTANCED_SPRITES 1
+#       define LOAD_INSTANCED_ARRAYS 1
+namespace rainbow { namespace graphics { namespace gl
+{
+    extern void (GL_APIENTRYP VertexAttribDivisor)(GLuint, GLuint);
+    extern void (GL_APIENTRYP DrawElementsInstanced)(
+        GLenum, GLsizei, GLenum, const void*, GLsizei);
+}}}  // namespace rainbow::graphics::gl
+#       define glVertexAttribDivisor \
+            rainbow::graphics::gl::VertexAttribDivisor
+#       define glDrawElementsInstanced \
+            rainbow::graphics::gl::DrawElementsInstanced
+#   endif
+#elif defined(RAINBOW_OS_IOS)
+#   ifdef GL_EXT_instanced_arrays
+#       define USE_INSTANCED_SPRITES 1
+#       define glVertexAttribDivisor    glVertexAttribDivisorEXT
+#       define glDrawElementsInstanced  glDrawElementsInstancedEXT
+#   endif
+#elif !defined(RAINBOW_OS_MACOS)
+#   define USE_INSTANCED_SPRITES 1
+#endif
+
 #endif
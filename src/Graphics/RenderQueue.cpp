@@ -9,22 +9,112 @@
 #include "Graphics/Label.h"
 #include "Graphics/Renderer.h"
 #include "Graphics/SpriteBatch.h"
+#include "Threading/ThreadPool.h"
 
 using rainbow::Animation;
 using rainbow::Label;
+using rainbow::Rect;
 using rainbow::SpriteBatch;
+using rainbow::SpriteVertex;
+using rainbow::graphics::DrawBatch;
 using rainbow::graphics::RenderQueue;
+using rainbow::graphics::RenderUnit;
+using rainbow::graphics::ShaderManager;
+using rainbow::graphics::detail::MergedUnit;
 
 namespace
 {
+    /// <summary>
+    ///   Units with more quads than this are always drawn on their own.
+    ///   Streaming their vertices every frame would cost more than the draw
+    ///   call that is saved, and they would lose out on partial uploads.
+    /// </summary>
+    constexpr uint32_t kMaxMergeableQuads = 256;
+
+    /// <summary>
+    ///   Merged units are drawn with 16-bit indices, which every device
+    ///   supports.
+    /// </summary>
+    constexpr uint32_t kMaxMergedVertices =
+        rainbow::graphics::kMaxSpritesUint16 * 4;
+
+    struct MergeKey
+    {
+        bool is_mergeable;
+        uint32_t texture;
+        uint32_t vertex_count;
+    };
+
+    struct BindTexturesCommand
+    {
+        void operator()(Label* label) const { label->bind_textures(); }
+
+        void operator()(SpriteBatch* sprite_batch) const
+        {
+            sprite_batch->bind_textures();
+        }
+
+        template <typename T>
+        void operator()(T&&) const
+        {
+        }
+    };
+
+    void count_quads(unsigned int visible, unsigned int culled)
+    {
+#ifndef NDEBUG
+        rainbow::graphics::detail::g_visible_count_accumulator += visible;
+        rainbow::graphics::detail::g_culled_count_accumulator += culled;
+#else
+        NOT_USED(visible);
+        NOT_USED(culled);
+#endif
+    }
+
+    bool is_culled(const Label& label, const Rect& viewport)
+    {
+        return label.length() > 0 && !label.bounds().intersects(viewport);
+    }
+
+    bool is_culled(const SpriteBatch& sprite_batch, const Rect& viewport)
+    {
+        return sprite_batch.size() > 0 &&
+               !sprite_batch.bounds().intersects(viewport);
+    }
+
     struct DrawCommand
     {
+        const Rect& viewport;
+
         void operator()(Animation*) const {}
 
-        void operator()(Label* label) const { rainbow::graphics::draw(*label); }
+        void operator()(Label* label) const
+        {
+            if (is_culled(*label, viewport))
+            {
+                count_quads(0, label->length());
+                return;
+            }
+
+            count_quads(label->length(), 0);
+            rainbow::graphics::draw(*label);
+        }
 
         void operator()(SpriteBatch* sprite_batch) const
         {
+            if (!sprite_batch->is_visible())
+                return;
+
+            if (is_culled(*sprite_batch, viewport))
+            {
+                count_quads(0, sprite_batch->size());
+                return;
+            }
+
+            sprite_batch->cull(viewport);
+
+            const uint32_t visible = sprite_batch->vertex_count() / 6;
+            count_quads(visible, sprite_batch->size() - visible);
             rainbow::graphics::draw(*sprite_batch);
         }
 
@@ -35,6 +125,217 @@ namespace
         }
     };
 
+    struct MergeKeyCommand
+    {
+        const Rect& viewport;
+
+        auto operator()(Label* label) const -> MergeKey
+        {
+            const uint32_t quads = label->vertex_count() / 6;
+            if (quads == 0 || is_culled(*label, viewport))
+                return {true, 0, 0};
+
+            // Distance field fonts are drawn with their own shader.
+            return {quads <= kMaxMergeableQuads &&
+                        !label->font().is_distance_field(),
+                    label->font().texture(),
+                    quads * 4};
+        }
+
+        auto operator()(SpriteBatch* sprite_batch) const -> MergeKey
+        {
+            // Hidden batches draw nothing and can be folded into any batch.
+            if (!sprite_batch->is_visible())
+                return {true, 0, 0};
+
+            // Merging streams client vertices, which are either compacted
+            // by culling or not generated at all when instanced.
+            if (sprite_batch->cull_mode() == SpriteBatch::CullMode::Sprite ||
+                sprite_batch->is_instanced())
+            {
+                return {false, 0, 0};
+            }
+
+            const uint32_t quads = sprite_batch->vertex_count() / 6;
+            if (quads == 0 || is_culled(*sprite_batch, viewport))
+                return {true, 0, 0};
+
+            return {quads <= kMaxMergeableQuads && !sprite_batch->has_normal(),
+                    sprite_batch->texture().texture(),
+                    quads * 4};
+        }
+
+        template <typename T>
+        auto operator()(T&&) const -> MergeKey
+        {
+            return {false, 0, 0};
+        }
+    };
+
+    /// <summary>
+    ///   Stands in for merged units when passed to
+    ///   <see cref="rainbow::graphics::draw"/>.
+    /// </summary>
+    class MergedUnits
+    {
+    public:
+        MergedUnits(const RenderUnit& front,
+                    const rainbow::graphics::VertexArray& array,
+                    uint32_t vertex_count)
+            : front_(front), array_(array), vertex_count_(vertex_count)
+        {
+        }
+
+        auto vertex_array() const -> const rainbow::graphics::VertexArray&
+        {
+            return array_;
+        }
+
+        auto vertex_count() const { return vertex_count_ / 4 * 6; }
+
+        void bind_textures() const
+        {
+            visit(BindTexturesCommand{}, front_.object());
+        }
+
+    private:
+        const RenderUnit& front_;
+        const rainbow::graphics::VertexArray& array_;
+        const uint32_t vertex_count_;
+    };
+
+    struct MergedUnitCommand
+    {
+        const Rect& viewport;
+
+        auto operator()(Label* label) const -> MergedUnit
+        {
+            if (is_culled(*label, viewport))
+                return {nullptr, 0, 0};
+
+            return {label, label->vertex_generation(), label->vertex_count()};
+        }
+
+        auto operator()(SpriteBatch* sprite_batch) const -> MergedUnit
+        {
+            if (!sprite_batch->is_visible() ||
+                is_culled(*sprite_batch, viewport))
+            {
+                return {nullptr, 0, 0};
+            }
+
+            return {sprite_batch,
+                    sprite_batch->vertex_generation(),
+                    sprite_batch->vertex_count()};
+        }
+
+        template <typename T>
+        auto operator()(T&&) const -> MergedUnit
+        {
+            return {nullptr, 0, 0};
+        }
+    };
+
+    /// <summary>
+    ///   Streams the vertices of merged units into <see cref="buffer"/>. If
+    ///   <see cref="buffer"/> is <c>nullptr</c>, it already holds them and
+    ///   only the offsets are advanced.
+    /// </summary>
+    struct StreamCommand
+    {
+        rainbow::graphics::Buffer* buffer;
+        size_t& offset;
+        const Rect& viewport;
+
+        auto operator()(Label* label) const -> size_t
+        {
+            if (is_culled(*label, viewport))
+            {
+                count_quads(0, label->length());
+                return 0;
+            }
+
+            count_quads(label->length(), 0);
+            return stream(label->vertex_buffer(), label->vertex_count());
+        }
+
+        auto operator()(SpriteBatch* sprite_batch) const -> size_t
+        {
+            if (!sprite_batch->is_visible())
+                return 0;
+
+            if (is_culled(*sprite_batch, viewport))
+            {
+                count_quads(0, sprite_batch->size());
+                return 0;
+            }
+
+            count_quads(sprite_batch->vertex_count() / 6, 0);
+            return stream(sprite_batch->vertices(),
+                          sprite_batch->vertex_count());
+        }
+
+        template <typename T>
+        auto operator()(T&&) const -> size_t
+        {
+            return 0;
+        }
+
+        auto stream(const SpriteVertex* vertices, size_t index_count) const
+            -> size_t
+        {
+            const size_t size = index_count / 6 * 4 * sizeof(SpriteVertex);
+            if (size > 0)
+            {
+                if (buffer != nullptr)
+                    buffer->upload(vertices, offset, size);
+                offset += size;
+            }
+            return size;
+        }
+    };
+
+    void draw_merged(const RenderQueue& queue,
+                     const DrawBatch& batch,
+                     const Rect& viewport)
+    {
+        // Only stream vertices if they changed since the last frame.
+        auto& merge_stream = rainbow::graphics::detail::next_merge_stream();
+        rainbow::graphics::Buffer* buffer = nullptr;
+        if (rainbow::graphics::detail::update_merged_units(
+                queue, batch, viewport, merge_stream.units))
+        {
+            buffer = &merge_stream.buffer;
+            buffer->upload(nullptr, batch.vertex_count * sizeof(SpriteVertex));
+        }
+
+        const RenderUnit* front = nullptr;
+        size_t offset = 0;
+        for (uint32_t i = batch.first; i < batch.last; ++i)
+        {
+            const auto& unit = queue[i];
+            if (!unit.is_enabled())
+                continue;
+
+            const StreamCommand stream{buffer, offset, viewport};
+            if (visit(stream, unit.object()) > 0 &&
+                front == nullptr)
+            {
+                front = &unit;
+            }
+        }
+
+        ShaderManager::Context context;
+        if (front->has_program())
+            ShaderManager::Get()->use(front->program());
+
+        rainbow::graphics::draw(
+            MergedUnits{*front, merge_stream.array, batch.vertex_count});
+
+        IF_DEBUG(rainbow::graphics::detail::g_merged_count_accumulator +=
+                 batch.unit_count - 1);
+    }
+
     struct UpdateCommand
     {
         const uint64_t dt;
@@ -52,21 +353,137 @@ namespace
             unit->update(dt);
         }
     };
+
+    /// <summary>
+    ///   Updates everything but sprite batches, which are deferred so that
+    ///   their vertices can be generated in parallel. Texture atlases may be
+    ///   shared between batches, and are therefore resolved here.
+    /// </summary>
+    struct SerialUpdateCommand
+    {
+        const uint64_t dt;
+
+        void operator()(SpriteBatch* sprite_batch) const
+        {
+            sprite_batch->resolve_texture();
+        }
+
+        template <typename T>
+        void operator()(T&& unit) const
+        {
+            UpdateCommand{dt}(std::forward<T>(unit));
+        }
+    };
+
+    struct UpdateVerticesCommand
+    {
+        void operator()(SpriteBatch* sprite_batch) const
+        {
+            sprite_batch->update_vertices();
+        }
+
+        template <typename T>
+        void operator()(T&&) const
+        {
+        }
+    };
+
+    struct UploadCommand
+    {
+        void operator()(SpriteBatch* sprite_batch) const
+        {
+            sprite_batch->upload();
+        }
+
+        template <typename T>
+        void operator()(T&&) const
+        {
+        }
+    };
 }
 
 void rainbow::graphics::draw(RenderQueue& queue)
 {
-    for (auto&& unit : queue)
+    const Rect& viewport = projection();
+    const auto size = static_cast<uint32_t>(queue.size());
+    for (uint32_t i = 0; i < size;)
+    {
+        const DrawBatch batch = next_draw_batch(queue, i, viewport);
+        if (batch.is_merged())
+        {
+            draw_merged(queue, batch, viewport);
+        }
+        else
+        {
+            for (uint32_t j = batch.first; j < batch.last; ++j)
+            {
+                auto& unit = queue[j];
+                if (!unit.is_enabled())
+                    continue;
+
+                ShaderManager::Context context;
+                if (unit.has_program())
+                    ShaderManager::Get()->use(unit.program());
+
+                visit(DrawCommand{viewport}, unit.object());
+            }
+        }
+        i = batch.last;
+    }
+}
+
+auto rainbow::graphics::next_draw_batch(const RenderQueue& queue,
+                                        uint32_t first,
+                                        const Rect& viewport) -> DrawBatch
+{
+    DrawBatch batch{first, first, 0, 0};
+    uint32_t program = ShaderManager::kInvalidProgram;
+    uint32_t texture = 0;
+    const auto size = static_cast<uint32_t>(queue.size());
+    for (uint32_t i = first; i < size; ++i)
     {
+        const auto& unit = queue[i];
         if (!unit.is_enabled())
+        {
+            batch.last = i + 1;
             continue;
+        }
 
-        ShaderManager::Context context;
-        if (unit.has_program())
-            ShaderManager::Get()->use(unit.program());
+        const MergeKey key = visit(MergeKeyCommand{viewport}, unit.object());
+        if (!key.is_mergeable)
+        {
+            if (batch.unit_count == 0)
+            {
+                batch.last = i + 1;
+                batch.unit_count = 1;
+            }
+            break;
+        }
+
+        // Empty and culled units draw nothing and can be folded into any
+        // batch.
+        if (key.vertex_count == 0)
+        {
+            batch.last = i + 1;
+            continue;
+        }
+
+        if (batch.unit_count == 0)
+        {
+            program = unit.program();
+            texture = key.texture;
+        }
+        else if (unit.program() != program || key.texture != texture ||
+                 batch.vertex_count + key.vertex_count > kMaxMergedVertices)
+        {
+            break;
+        }
 
-        visit(DrawCommand{}, unit.object());
+        batch.last = i + 1;
+        ++batch.unit_count;
+        batch.vertex_count += key.vertex_count;
     }
+    return batch;
 }
 
 void rainbow::graphics::update(RenderQueue& queue, uint64_t dt)
@@ -79,3 +496,74 @@ void rainbow::graphics::update(RenderQueue& queue, uint64_t dt)
         visit(UpdateCommand{dt}, unit.object());
     }
 }
+
+void rainbow::graphics::update(RenderQueue& queue,
+                               uint64_t dt,
+                               ThreadPool& pool)
+{
+    for (auto&& unit : queue)
+    {
+        if (!unit.is_enabled())
+            continue;
+
+        visit(SerialUpdateCommand{dt}, unit.object());
+    }
+
+    const auto size = static_cast<uint32_t>(queue.size());
+    pool.parallel_for(size, [&queue](uint32_t i) {
+        const auto& unit = queue[i];
+        if (!unit.is_enabled())
+            return;
+
+        visit(UpdateVerticesCommand{}, unit.object());
+    });
+
+    for (auto&& unit : queue)
+    {
+        if (!unit.is_enabled())
+            continue;
+
+        visit(UploadCommand{}, unit.object());
+    }
+}
+
+bool rainbow::graphics::detail::update_merged_units(
+    const RenderQueue& queue,
+    const DrawBatch& batch,
+    const Rect& viewport,
+    std::vector<MergedUnit>& units)
+{
+    bool changed = false;
+    size_t count = 0;
+    for (uint32_t i = batch.first; i < batch.last; ++i)
+    {
+        const auto& unit = queue[i];
+        if (!unit.is_enabled())
+            continue;
+
+        const MergedUnit merged =
+            visit(MergedUnitCommand{viewport}, unit.object());
+        if (merged.vertex_count == 0)
+            continue;
+
+        if (count == units.size())
+        {
+            units.push_back(merged);
+            changed = true;
+        }
+        else if (!(units[count] == merged))
+        {
+            units[count] = merged;
+            changed = true;
+        }
+        ++count;
+    }
+
+    if (count != units.size())
+    {
+        units.resize(count);
+        changed = true;
+    }
+
+    return changed;
+}
@@ -18,10 +18,17 @@ namespace rainbow
     class IDrawable;
     class Label;
     class SpriteBatch;
+    class ThreadPool;
+    struct Rect;
 }
 
 namespace rainbow { namespace graphics
 {
+    namespace detail
+    {
+        struct MergedUnit;
+    }
+
     class RenderUnit
     {
     public:
@@ -90,9 +97,72 @@ namespace rainbow { namespace graphics
 
     using RenderQueue = std::vector<RenderUnit>;
 
+    /// <summary>
+    ///   Range of render units, [first, last), that are drawn together.
+    /// </summary>
+    struct DrawBatch
+    {
+        uint32_t first;
+        uint32_t last;
+        uint32_t unit_count;    ///< Number of enabled units in the range.
+        uint32_t vertex_count;  ///< Number of vertices in merged units.
+
+        /// <summary>
+        ///   Returns whether the units in this batch are drawn with a single
+        ///   draw call.
+        /// </summary>
+        auto is_merged() const { return unit_count > 1; }
+    };
+
+    /// <summary>
+    ///   Draws all enabled units in <paramref name="queue"/>. Adjacent units
+    ///   sharing texture and program are merged into a single draw call.
+    /// </summary>
+    /// <remarks>
+    ///   Units outside the current projection are culled.
+    /// </remarks>
     void draw(RenderQueue& queue);
 
+    /// <summary>
+    ///   Returns the batch of units starting at <paramref name="first"/>.
+    ///   Enabled sprite batches and labels that are small, and share texture
+    ///   and program, are grouped so that they can be drawn with one call.
+    ///   Disabled units, and units outside <paramref name="viewport"/>, do
+    ///   not break a batch.
+    /// </summary>
+    auto next_draw_batch(const RenderQueue& queue,
+                         uint32_t first,
+                         const Rect& viewport) -> DrawBatch;
+
     void update(RenderQueue& queue, uint64_t dt);
+
+    /// <summary>
+    ///   Same as <see cref="update(RenderQueue&amp;, uint64_t)"/>, but
+    ///   generates the vertices of sprite batches in parallel.
+    /// </summary>
+    /// <remarks>
+    ///   All other units are updated first, in queue order, on the calling
+    ///   thread. Then sprite batches generate their vertices on
+    ///   <paramref name="pool"/>. Finally, the vertices are uploaded on the
+    ///   calling thread, which must be the render thread.
+    /// </remarks>
+    void update(RenderQueue& queue, uint64_t dt, ThreadPool& pool);
+
+    namespace detail
+    {
+        /// <summary>
+        ///   Replaces <paramref name="units"/> with the units in merged
+        ///   <paramref name="batch"/> that have vertices to stream.
+        /// </summary>
+        /// <returns>
+        ///   Whether the units, or their vertices, differ from those
+        ///   previously recorded in <paramref name="units"/>.
+        /// </returns>
+        bool update_merged_units(const RenderQueue& queue,
+                                 const DrawBatch& batch,
+                                 const Rect& viewport,
+                                 std::vector<MergedUnit>& units);
+    }
 }}  // namespace rainbow::graphics
 
 #endif
@@ -4,12 +4,27 @@
 
 #include "Graphics/Renderer.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#ifdef LOAD_INSTANCED_ARRAYS
+#   include <EGL/egl.h>
+#endif
 
 #include "Graphics/Label.h"
+#include "Graphics/ShaderDetails.h"
+#include "Graphics/Shaders.h"
 #include "Graphics/SpriteBatch.h"
+#include "Graphics/SpriteInstance.h"
 
+using rainbow::FontAtlas;
+using rainbow::Label;
 using rainbow::Rect;
+using rainbow::SpriteBatch;
 using rainbow::Vec2i;
 using rainbow::czstring;
 using rainbow::graphics::State;
@@ -18,27 +33,212 @@ namespace graphics = rainbow::graphics;
 
 namespace
 {
+    size_t g_bytes_uploaded = 0;
     unsigned int g_draw_count = 0;
+    unsigned int g_merged_count = 0;
+    graphics::CullCount g_cull_count{};
     State* g_state = nullptr;
 
     auto gl_get_string(GLenum name)
     {
         return reinterpret_cast<czstring>(glGetString(name));
     }
+
+    bool has_uint32_indices()
+    {
+#ifdef GL_ES_VERSION_2_0
+        static const bool supported =
+            graphics::has_extension("GL_OES_element_index_uint");
+        return supported;
+#else
+        return true;
+#endif
+    }
+
+#ifdef LOAD_INSTANCED_ARRAYS
+    template <typename F>
+    bool get_proc_address(F& proc, czstring name)
+    {
+        proc = reinterpret_cast<F>(eglGetProcAddress(name));
+        return proc != nullptr;
+    }
+
+    /// <summary>
+    ///   Loads the instanced array entry points, from the core of OpenGL ES
+    ///   3.0 or from any supported extension.
+    /// </summary>
+    bool load_instanced_arrays(const graphics::detail::GLVersion& version)
+    {
+        struct EntryPoints
+        {
+            czstring extension;  ///< Required extension; null if core.
+            czstring divisor;
+            czstring draw;
+        };
+
+        constexpr EntryPoints kEntryPoints[]{
+            {nullptr, "glVertexAttribDivisor", "glDrawElementsInstanced"},
+            {"GL_EXT_instanced_arrays",
+             "glVertexAttribDivisorEXT",
+             "glDrawElementsInstancedEXT"},
+            {"GL_ANGLE_instanced_arrays",
+             "glVertexAttribDivisorANGLE",
+             "glDrawElementsInstancedANGLE"}};
+
+        for (auto&& entry_points : kEntryPoints)
+        {
+            if (entry_points.extension == nullptr
+                    ? version.major < 3
+                    : !graphics::has_extension(entry_points.extension))
+            {
+                continue;
+            }
+
+            if (get_proc_address(graphics::gl::VertexAttribDivisor,
+                                 entry_points.divisor) &&
+                get_proc_address(graphics::gl::DrawElementsInstanced,
+                                 entry_points.draw))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+#endif
+
+    bool has_instanced_arrays()
+    {
+#ifdef USE_INSTANCED_SPRITES
+        const auto version =
+            graphics::detail::parse_gl_version(gl_get_string(GL_VERSION));
+        if (!version.is_es)
+        {
+            // Instanced arrays and draws are core since OpenGL 3.3.
+            return version.major > 3 ||
+                   (version.major == 3 && version.minor >= 3);
+        }
+
+#   if defined(LOAD_INSTANCED_ARRAYS)
+        return load_instanced_arrays(version);
+#   else
+        return graphics::has_extension("GL_EXT_instanced_arrays");
+#   endif
+#else
+        return false;
+#endif
+    }
+
+    template <typename T>
+    void upload_quad_indices(const graphics::ElementBuffer& element_buffer,
+                             size_t count)
+    {
+        const size_t size = count * 6;
+        auto indices = std::make_unique<T[]>(size);
+        graphics::generate_quad_indices(indices.get(), count);
+        element_buffer.upload(indices.get(), size * sizeof(T));
+    }
 }
 
+#ifdef LOAD_INSTANCED_ARRAYS
+namespace rainbow { namespace graphics { namespace gl
+{
+    void (GL_APIENTRYP VertexAttribDivisor)(GLuint, GLuint) = nullptr;
+    void (GL_APIENTRYP DrawElementsInstanced)(
+        GLenum, GLsizei, GLenum, const void*, GLsizei) = nullptr;
+}}}  // namespace rainbow::graphics::gl
+#endif
+
 namespace rainbow { namespace graphics { namespace detail
 {
+    size_t g_bytes_uploaded_accumulator = 0;
+
 #ifndef NDEBUG
     unsigned int g_draw_count_accumulator = 0;
+    unsigned int g_merged_count_accumulator = 0;
+    unsigned int g_culled_count_accumulator = 0;
+    unsigned int g_visible_count_accumulator = 0;
 #endif  // NDEBUG
+
+    auto next_merge_stream() -> MergeStream&
+    {
+        auto& streams = g_state->merge_streams;
+        if (g_state->merge_stream_count == streams.size())
+        {
+            streams.push_back(std::make_unique<MergeStream>());
+            auto stream = streams.back().get();
+            stream->array.reconfigure([stream] { stream->buffer.bind(); });
+        }
+        return *streams[g_state->merge_stream_count++];
+    }
+
+    auto next_vertex_generation() -> uint64_t
+    {
+        static std::atomic<uint64_t> generation{0};
+        return ++generation;
+    }
+
+    auto parse_gl_version(czstring version) -> GLVersion
+    {
+        GLVersion gl_version{0, 0, false};
+        if (version == nullptr)
+            return gl_version;
+
+        // OpenGL ES reports "OpenGL ES <major>.<minor> <vendor-specific>".
+        constexpr char kOpenGLES[] = "OpenGL ES ";
+        constexpr size_t kOpenGLESLength = sizeof(kOpenGLES) - 1;
+        if (strncmp(version, kOpenGLES, kOpenGLESLength) == 0)
+        {
+            gl_version.is_es = true;
+            version += kOpenGLESLength;
+        }
+
+        const int parsed =
+            sscanf(version, "%d.%d", &gl_version.major, &gl_version.minor);
+        if (parsed != 2)
+            return {0, 0, gl_version.is_es};
+
+        return gl_version;
+    }
+
+    auto quad_buffer() -> const Buffer& { return *g_state->quad_buffer; }
+
+    auto reserve_elements(size_t& count) -> GLenum
+    {
+        const size_t sprite_count = (count + 5) / 6;
+        if (sprite_count > g_state->element_capacity &&
+            !g_state->reserve_elements(sprite_count))
+        {
+            LOGE("Cannot draw %zu sprites at once without support for 32-bit "
+                 "indices; only the first %zu are drawn",
+                 sprite_count,
+                 g_state->element_capacity);
+            count = g_state->element_capacity * 6;
+        }
+        return g_state->element_type;
+    }
 }}}
 
+auto graphics::bytes_uploaded() -> size_t
+{
+    return g_bytes_uploaded;
+}
+
+auto graphics::cull_count() -> CullCount
+{
+    return g_cull_count;
+}
+
 auto graphics::draw_count() -> unsigned int
 {
     return g_draw_count;
 }
 
+auto graphics::draw_count_unmerged() -> unsigned int
+{
+    return g_draw_count + g_merged_count;
+}
+
 auto graphics::gl_version() -> czstring
 {
     return gl_get_string(GL_VERSION);
@@ -54,6 +254,12 @@ auto graphics::max_texture_size() -> int
     return max_texture_size;
 }
 
+auto graphics::max_sprites_per_draw() -> size_t
+{
+    return has_uint32_indices() ? std::numeric_limits<uint32_t>::max() / 4
+                                : kMaxSpritesUint16;
+}
+
 auto graphics::memory_info() -> graphics::MemoryInfo
 {
     static const GLenum pname = [] {
@@ -174,9 +380,20 @@ void graphics::clear()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
+    g_state->merge_stream_count = 0;
+
+    g_bytes_uploaded = detail::g_bytes_uploaded_accumulator;
+    detail::g_bytes_uploaded_accumulator = 0;
+
 #ifndef NDEBUG
     g_draw_count = detail::g_draw_count_accumulator;
     detail::g_draw_count_accumulator = 0;
+    g_merged_count = detail::g_merged_count_accumulator;
+    detail::g_merged_count_accumulator = 0;
+    g_cull_count.visible = detail::g_visible_count_accumulator;
+    g_cull_count.culled = detail::g_culled_count_accumulator;
+    detail::g_visible_count_accumulator = 0;
+    detail::g_culled_count_accumulator = 0;
 #endif
 }
 
@@ -200,12 +417,80 @@ auto graphics::convert_to_view(const Vec2i& p) -> Vec2i
                      g_state->origin.y / g_state->zoom);
 }
 
+void graphics::draw(const Label& label)
+{
+    if (!label.font().is_distance_field() ||
+        g_state->distance_field_program == ShaderManager::kInvalidProgram)
+    {
+        draw<Label>(label);
+        return;
+    }
+
+    ShaderManager::Context context;
+    g_state->shader_manager.use(g_state->distance_field_program);
+
+    // Anti-alias over one pixel on screen. A distance of one pixel at point
+    // size spans 1 / (2 * spread) of the field's range.
+    const float pixels = label.scale() * g_state->zoom;
+    const float smoothing = 0.25f / (FontAtlas::kDistanceFieldSpread * pixels);
+    glUniform1f(g_state->distance_field_smoothing, std::min(smoothing, 0.5f));
+
+    draw<Label>(label);
+}
+
+void graphics::draw(const SpriteBatch& batch)
+{
+#ifdef USE_INSTANCED_SPRITES
+    if (batch.is_instanced())
+    {
+        ShaderManager::Context context;
+        g_state->shader_manager.use(g_state->instanced_program);
+
+        // Texture regions are looked up by index in the vertex shader.
+        // Batches stop instancing on update once their atlas outgrows the
+        // uniform array, so this only holds if regions were added since.
+        const TextureAtlas& texture = batch.texture();
+        R_ASSERT(texture.size() <= kMaxInstancedRegions,
+                 "Too many texture regions for instanced drawing");
+        const auto region_count = static_cast<unsigned int>(
+            std::min<size_t>(texture.size(), kMaxInstancedRegions));
+        std::array<float, kMaxInstancedRegions * 4> regions;
+        for (unsigned int i = 0; i < region_count; ++i)
+        {
+            const auto& region = texture[i];
+            regions[i * 4 + 0] = region.vx[0].x;
+            regions[i * 4 + 1] = region.vx[0].y;
+            regions[i * 4 + 2] = region.vx[2].x;
+            regions[i * 4 + 3] = region.vx[2].y;
+        }
+        glUniform4fv(g_state->instanced_regions, region_count, regions.data());
+
+        size_t count = 6;
+        const auto type = detail::reserve_elements(count);
+        batch.vertex_array().bind();
+        batch.bind_textures();
+        glDrawElementsInstanced(
+            GL_TRIANGLES, count, type, nullptr, batch.size());
+
+        IF_DEBUG(++detail::g_draw_count_accumulator);
+        return;
+    }
+#endif
+
+    draw<SpriteBatch>(batch);
+}
+
 bool graphics::has_extension(czstring extension)
 {
     static auto gl_extensions = gl_get_string(GL_EXTENSIONS);
     return strstr(gl_extensions, extension) != nullptr;
 }
 
+bool graphics::has_instancing()
+{
+    return g_state != nullptr && g_state->instancing;
+}
+
 void graphics::reset()
 {
     glDisable(GL_CULL_FACE);
@@ -259,28 +544,100 @@ bool State::initialize()
     if (!shader_manager.init())
         return false;
 
-    constexpr size_t kElementBufferSize = kMaxSprites * 6;
-    auto default_indices = std::make_unique<uint16_t[]>(kElementBufferSize);
-    for (size_t i = 0; i < kMaxSprites; ++i)
-    {
-        const auto index = i * 6;
-        const auto vertex = static_cast<uint16_t>(i * 4);
-        default_indices[index] = vertex;
-        default_indices[index + 1] = vertex + 1;
-        default_indices[index + 2] = vertex + 2;
-        default_indices[index + 3] = vertex + 2;
-        default_indices[index + 4] = vertex + 3;
-        default_indices[index + 5] = vertex;
-    }
-
     unsigned int buffer;
     glGenBuffers(1, &buffer);
     element_buffer = buffer;
-    element_buffer.upload(default_indices.get(), kElementBufferSize);
 
-    const bool success = glGetError() == GL_NO_ERROR;
+    if (has_instanced_arrays())
+        initialize_instancing();
+
+    initialize_distance_field();
+
+    const bool success = reserve_elements(kInitialElementCapacity) &&
+                         glGetError() == GL_NO_ERROR;
     if (success)
         g_state = this;
 
     return success;
 }
+
+void State::initialize_distance_field()
+{
+    Shader::Params shaders[]{
+        {Shader::kTypeVertex, 0, nullptr, nullptr},  // kFixed2Dv
+        {Shader::kTypeFragment, 0, shaders::kSignedDistanceFieldf,
+         shaders::integrated::kSignedDistanceFieldf},
+        {Shader::kTypeInvalid, 0, nullptr, nullptr}};
+    distance_field_program = shader_manager.compile(shaders, nullptr);
+    if (distance_field_program == ShaderManager::kInvalidProgram)
+    {
+        LOGW("Failed to compile distance field shader");
+        return;
+    }
+
+    distance_field_smoothing = glGetUniformLocation(
+        shader_manager.get_program(distance_field_program).program,
+        "smoothing");
+}
+
+void State::initialize_instancing()
+{
+    Shader::Params shaders[]{
+        {Shader::kTypeVertex, 0, shaders::kInstanced2Dv,
+         shaders::integrated::kInstanced2Dv},
+        {Shader::kTypeFragment, 1, nullptr, nullptr},  // kFixed2Df
+        {Shader::kTypeInvalid, 0, nullptr, nullptr}};
+    const Shader::AttributeParams attributes[]{
+        {Shader::kAttributeVertex, "vertex"},
+        {Shader::kAttributeColor, "color"},
+        {Shader::kAttributeTransform, "transform"},
+        {Shader::kAttributeAngle, "angle"},
+        {Shader::kAttributePivot, "pivot"},
+        {Shader::kAttributeRegion, "region"},
+        {Shader::kAttributeNone, nullptr}};
+    instanced_program = shader_manager.compile(shaders, attributes);
+    if (instanced_program == ShaderManager::kInvalidProgram)
+    {
+        LOGW("Failed to compile instanced sprite shader");
+        return;
+    }
+
+    instanced_regions = glGetUniformLocation(
+        shader_manager.get_program(instanced_program).program, "regions");
+
+    const Vec2f quad[]{{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+    quad_buffer = std::make_unique<Buffer>();
+    quad_buffer->upload(quad, sizeof(quad));
+    instancing = true;
+}
+
+bool State::reserve_elements(size_t sprite_count)
+{
+    size_t capacity = std::max(element_capacity, kInitialElementCapacity);
+    while (capacity < sprite_count)
+        capacity *= 2;
+
+    if (capacity <= kMaxSpritesUint16)
+    {
+        upload_quad_indices<uint16_t>(element_buffer, capacity);
+        element_type = GL_UNSIGNED_SHORT;
+    }
+    else if (has_uint32_indices())
+    {
+        upload_quad_indices<uint32_t>(element_buffer, capacity);
+        element_type = GL_UNSIGNED_INT;
+    }
+    else
+    {
+        if (element_capacity < kMaxSpritesUint16)
+        {
+            upload_quad_indices<uint16_t>(element_buffer, kMaxSpritesUint16);
+            element_capacity = kMaxSpritesUint16;
+            element_type = GL_UNSIGNED_SHORT;
+        }
+        return false;
+    }
+
+    element_capacity = capacity;
+    return true;
+}
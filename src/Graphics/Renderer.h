@@ -5,22 +5,112 @@
 #ifndef GRAPHICS_RENDERER_H_
 #define GRAPHICS_RENDERER_H_
 
+#include <memory>
+#include <vector>
+
+#include "Graphics/Buffer.h"
 #include "Graphics/ElementBuffer.h"
 #include "Graphics/ShaderManager.h"
 #include "Graphics/TextureManager.h"
+#include "Graphics/VertexArray.h"
 #include "Math/Geometry.h"
 
+namespace rainbow
+{
+    class Label;
+    class SpriteBatch;
+}
+
 namespace rainbow { namespace graphics
 {
     namespace detail
     {
+        extern size_t g_bytes_uploaded_accumulator;
+
 #ifndef NDEBUG
         extern unsigned int g_draw_count_accumulator;
+        extern unsigned int g_merged_count_accumulator;
+        extern unsigned int g_culled_count_accumulator;
+        extern unsigned int g_visible_count_accumulator;
 #endif
+
+        /// <summary>Render unit whose vertices were merged.</summary>
+        struct MergedUnit
+        {
+            const void* object;
+            uint64_t generation;  ///< Vertex generation when streamed.
+            uint32_t vertex_count;
+
+            friend bool operator==(const MergedUnit& a, const MergedUnit& b)
+            {
+                return a.object == b.object && a.generation == b.generation &&
+                       a.vertex_count == b.vertex_count;
+            }
+        };
+
+        /// <summary>
+        ///   Buffer that a batch of merged render units stream their vertices
+        ///   into. The units are remembered so that the vertices need not be
+        ///   streamed again until one of them changes.
+        /// </summary>
+        struct MergeStream
+        {
+            Buffer buffer;
+            VertexArray array;
+            std::vector<MergedUnit> units;
+        };
+
+        /// <summary>
+        ///   Returns the merge stream for the next merged batch drawn this
+        ///   frame. Batches are assigned streams in drawing order.
+        /// </summary>
+        auto next_merge_stream() -> MergeStream&;
+
+        /// <summary>
+        ///   Returns a new, unique vertex generation. Drawables take a new
+        ///   generation whenever their client vertices change.
+        /// </summary>
+        auto next_vertex_generation() -> uint64_t;
+
+        struct GLVersion
+        {
+            int major;  ///< Zero if the version could not be parsed.
+            int minor;
+            bool is_es;  ///< Whether this is OpenGL ES.
+        };
+
+        /// <summary>
+        ///   Parses a <c>GL_VERSION</c> string, from either OpenGL or
+        ///   OpenGL ES.
+        /// </summary>
+        auto parse_gl_version(czstring version) -> GLVersion;
+
+        /// <summary>
+        ///   Returns the buffer holding the corners of the unit quad that
+        ///   instanced sprites are expanded from.
+        /// </summary>
+        auto quad_buffer() -> const Buffer&;
+
+        /// <summary>
+        ///   Grows the shared element buffer, if needed, so that it holds at
+        ///   least <paramref name="count"/> indices. If the buffer cannot
+        ///   grow any further, <paramref name="count"/> is clamped.
+        /// </summary>
+        /// <returns>The type of the indices in the element buffer.</returns>
+        auto reserve_elements(size_t& count) -> GLenum;
     }
 
-    ///<summary>Hard-coded limit on number of sprites.</summary>
-    static constexpr size_t kMaxSprites = 4096;
+    /// <summary>Initial number of sprites the element buffer indexes.</summary>
+    static constexpr size_t kInitialElementCapacity = 4096;
+
+    /// <summary>Maximum number of sprites 16-bit indices can address.</summary>
+    static constexpr size_t kMaxSpritesUint16 = 0x10000 / 4;
+
+    struct CullCount
+    {
+        unsigned int visible;  ///< Number of quads drawn.
+        unsigned int culled;   ///< Number of quads skipped.
+    };
 
     struct MemoryInfo
     {
@@ -28,9 +118,35 @@ namespace rainbow { namespace graphics
         int total_available;
     };
 
+    /// <summary>
+    ///   Returns the number of bytes of vertex data uploaded to the GPU in the
+    ///   previous frame.
+    /// </summary>
+    auto bytes_uploaded() -> size_t;
+
+    /// <summary>
+    ///   Returns the number of quads that were drawn and culled in the
+    ///   previous frame.
+    /// </summary>
+    auto cull_count() -> CullCount;
+
     auto draw_count() -> unsigned int;
+
+    /// <summary>
+    ///   Returns the number of draw calls the previous frame would have issued
+    ///   without merging render units.
+    /// </summary>
+    auto draw_count_unmerged() -> unsigned int;
     auto gl_version() -> czstring;
     auto max_texture_size() -> int;
+
+    /// <summary>
+    ///   Returns the number of sprites a single draw call can address. This
+    ///   is limited to <see cref="kMaxSpritesUint16"/> on devices without
+    ///   support for 32-bit indices.
+    /// </summary>
+    auto max_sprites_per_draw() -> size_t;
+
     auto memory_info() -> MemoryInfo;
     auto projection() -> const Rect&;
     auto renderer() -> czstring;
@@ -53,14 +169,26 @@ namespace rainbow { namespace graphics
     template <typename T>
     void draw(const T& obj)
     {
+        size_t count = obj.vertex_count();
+        const auto type = detail::reserve_elements(count);
         obj.vertex_array().bind();
         obj.bind_textures();
-        glDrawElements(
-            GL_TRIANGLES, obj.vertex_count(), GL_UNSIGNED_SHORT, nullptr);
+        glDrawElements(GL_TRIANGLES, count, type, nullptr);
 
         IF_DEBUG(++detail::g_draw_count_accumulator);
     }
 
+    /// <summary>
+    ///   Draws <paramref name="label"/>, using the distance field shader if
+    ///   its font is rendered as signed distance fields.
+    /// </summary>
+    void draw(const Label& label);
+
+    /// <summary>
+    ///   Draws <paramref name="batch"/>, instanced if it is set up for it.
+    /// </summary>
+    void draw(const SpriteBatch& batch);
+
     template <typename T>
     void draw_arrays(const T& obj, int first, size_t count)
     {
@@ -73,6 +201,9 @@ namespace rainbow { namespace graphics
 
     bool has_extension(czstring extension);
 
+    /// <summary>Returns whether sprites can be drawn instanced.</summary>
+    bool has_instancing();
+
     void reset();
 
     void scissor(int x, int y, int width, int height);
@@ -113,6 +244,16 @@ namespace rainbow { namespace graphics
         Vec2i window;
         Rect rect;
         ElementBuffer element_buffer;
+        size_t element_capacity = 0;  ///< Number of sprites indexable.
+        GLenum element_type = GL_UNSIGNED_SHORT;
+        std::vector<std::unique_ptr<detail::MergeStream>> merge_streams;
+        size_t merge_stream_count = 0;  ///< Merge streams used this frame.
+        bool instancing = false;  ///< Whether instanced arrays are supported.
+        unsigned int instanced_program = ShaderManager::kInvalidProgram;
+        int instanced_regions = -1;  ///< Location of the regions uniform.
+        std::unique_ptr<Buffer> quad_buffer;  ///< Unit quad for instancing.
+        unsigned int distance_field_program = ShaderManager::kInvalidProgram;
+        int distance_field_smoothing = -1;  ///< Location of smoothing uniform.
         TextureManager texture_manager;
         ShaderManager shader_manager;
 
@@ -125,6 +266,21 @@ namespace rainbow { namespace graphics
         ~State();
 
         bool initialize();
+
+        /// <summary>Compiles the signed distance field font program.</summary>
+        void initialize_distance_field();
+
+        /// <summary>
+        ///   Compiles the instanced sprite program and enables instancing if
+        ///   successful.
+        /// </summary>
+        void initialize_instancing();
+
+        /// <summary>
+        ///   Regenerates the element buffer to index at least
+        ///   <paramref name="sprite_count"/> sprites.
+        /// </summary>
+        bool reserve_elements(size_t sprite_count);
     };
 }}  // namespace rainbow::graphics
 
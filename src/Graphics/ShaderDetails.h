@@ -16,6 +16,10 @@ namespace Shader
         kAttributeColor,
         kAttributeTexCoord,
         kAttributeNormal,
+        kAttributeTransform,
+        kAttributeAngle,
+        kAttributePivot,
+        kAttributeRegion,
         kAttributeNone
     };
 
@@ -13,7 +13,9 @@ namespace rainbow { namespace shaders
         extern const char kDiffuseLightNormalf[];
         extern const char kFixed2Df[];
         extern const char kFixed2Dv[];
+        extern const char kInstanced2Dv[];
         extern const char kNormalMappedv[];
+        extern const char kSignedDistanceFieldf[];
         extern const char kSimple2Dv[];
         extern const char kSimplef[];
     }
@@ -22,7 +24,9 @@ namespace rainbow { namespace shaders
     constexpr char kDiffuseLightNormalf[]  = "Shaders/DiffuseLightNormal.fsh";
     constexpr char kFixed2Df[]             = "Shaders/Fixed2D.fsh";
     constexpr char kFixed2Dv[]             = "Shaders/Fixed2D.vsh";
+    constexpr char kInstanced2Dv[]         = "Shaders/Instanced2D.vsh";
     constexpr char kNormalMappedv[]        = "Shaders/NormalMapped.vsh";
+    constexpr char kSignedDistanceFieldf[] = "Shaders/SignedDistanceField.fsh";
     constexpr char kSimple2Dv[]            = "Shaders/Simple2D.vsh";
     constexpr char kSimplef[]              = "Shaders/Simple.fsh";
 }}  // namespace rainbow::shaders
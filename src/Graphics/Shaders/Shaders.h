@@ -134,6 +134,47 @@ void main()
 }
 )";
 
+const char kInstanced2Dv[] =
+R"(
+#ifdef GL_ES
+#   ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#   else
+precision mediump float;
+#   endif
+#else
+#   define lowp
+#endif
+
+uniform mat4 mvp_matrix;
+uniform vec4 regions[128];
+
+attribute vec2 vertex;
+attribute vec4 color;
+attribute vec4 transform;
+attribute float angle;
+attribute vec2 pivot;
+attribute vec2 region;
+
+varying lowp vec4 v_color;
+varying vec2 v_texcoord;
+
+void main()
+{
+    vec2 p = (vertex - vec2(pivot.x, 1.0 - pivot.y)) * transform.zw;
+    float s = sin(-angle);
+    float c = cos(-angle);
+    p = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + transform.xy;
+
+    vec2 flip = mod(floor(region.y / vec2(2.0, 1.0)), 2.0);
+    vec4 r = regions[int(region.x)];
+
+    v_color = color;
+    v_texcoord = mix(r.xy, r.zw, abs(vertex - flip));
+    gl_Position = mvp_matrix * vec4(p, 0.0, 1.0);
+}
+)";
+
 const char kNormalMappedv[] =
 R"(
 #ifdef GL_ES
@@ -186,6 +227,32 @@ void main()
 }
 )";
 
+const char kSignedDistanceFieldf[] =
+R"(
+#ifdef GL_ES
+#   ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#   else
+precision mediump float;
+#   endif
+#else
+#   define lowp
+#endif
+
+uniform float smoothing;
+uniform sampler2D texture;
+
+varying lowp vec4 v_color;
+varying vec2 v_texcoord;
+
+void main()
+{
+    float distance = texture2D(texture, v_texcoord).a;
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);
+}
+)";
+
 const char kSimple2Dv[] =
 R"(
 #ifdef GL_ES
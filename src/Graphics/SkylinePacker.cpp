@@ -0,0 +1,133 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/SkylinePacker.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Common/Logging.h"
+
+using rainbow::SkylinePacker;
+using rainbow::Vec2u;
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+    : width_(width), height_(height)
+{
+    clear();
+}
+
+void SkylinePacker::clear()
+{
+    skyline_.clear();
+    skyline_.push_back({0, 0, width_});
+}
+
+void SkylinePacker::grow(uint32_t width, uint32_t height)
+{
+    R_ASSERT(width >= width_ && height >= height_, "Cannot shrink packer");
+
+    if (width > width_)
+    {
+        auto& last = skyline_.back();
+        if (last.y == 0)
+            last.width += width - width_;
+        else
+            skyline_.push_back({width_, 0, width - width_});
+        width_ = width;
+    }
+
+    height_ = height;
+}
+
+bool SkylinePacker::pack(uint32_t width, uint32_t height, Vec2u& position)
+{
+    if (width == 0 || height == 0)
+        return false;
+
+    size_t best = skyline_.size();
+    int64_t best_top = std::numeric_limits<int64_t>::max();
+    uint32_t best_width = std::numeric_limits<uint32_t>::max();
+    for (size_t i = 0; i < skyline_.size(); ++i)
+    {
+        const int64_t y = fit(i, width, height);
+        if (y < 0)
+            continue;
+
+        // Prefer the lowest top edge, then the narrowest segment to leave
+        // wider segments for wider rectangles.
+        const int64_t top = y + height;
+        if (top < best_top ||
+            (top == best_top && skyline_[i].width < best_width))
+        {
+            best = i;
+            best_top = top;
+            best_width = skyline_[i].width;
+        }
+    }
+
+    if (best == skyline_.size())
+        return false;
+
+    position.x = skyline_[best].x;
+    position.y = static_cast<uint32_t>(best_top - height);
+
+    // Raise the skyline under the new rectangle, then shrink or remove the
+    // segments it now covers.
+    skyline_.insert(skyline_.begin() + best,
+                    {position.x, static_cast<uint32_t>(best_top), width});
+
+    const uint32_t right = position.x + width;
+    size_t i = best + 1;
+    while (i < skyline_.size() && skyline_[i].x < right)
+    {
+        const uint32_t end = skyline_[i].x + skyline_[i].width;
+        if (end <= right)
+        {
+            skyline_.erase(skyline_.begin() + i);
+            continue;
+        }
+
+        skyline_[i].width = end - right;
+        skyline_[i].x = right;
+        break;
+    }
+
+    // Merge neighbouring segments of equal height.
+    for (i = 0; i + 1 < skyline_.size();)
+    {
+        if (skyline_[i].y == skyline_[i + 1].y)
+        {
+            skyline_[i].width += skyline_[i + 1].width;
+            skyline_.erase(skyline_.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return true;
+}
+
+auto SkylinePacker::fit(size_t segment, uint32_t width, uint32_t height) const
+    -> int64_t
+{
+    const uint32_t x = skyline_[segment].x;
+    if (x + static_cast<uint64_t>(width) > width_)
+        return -1;
+
+    uint32_t y = 0;
+    int64_t remaining = width;
+    for (size_t i = segment; remaining > 0; ++i)
+    {
+        y = std::max(y, skyline_[i].y);
+        if (y + static_cast<uint64_t>(height) > height_)
+            return -1;
+
+        remaining -= skyline_[i].width;
+    }
+
+    return y;
+}
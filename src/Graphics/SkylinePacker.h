@@ -0,0 +1,74 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_SKYLINEPACKER_H_
+#define GRAPHICS_SKYLINEPACKER_H_
+
+#include <vector>
+
+#include "Math/Vec2.h"
+
+namespace rainbow
+{
+    /// <summary>Incremental rectangle packer, using a skyline.</summary>
+    /// <remarks>
+    ///   The packed area is tracked as a skyline; a list of horizontal
+    ///   segments, each at the height of the tallest rectangle below it.
+    ///   Rectangles are placed bottom-left, i.e. where their top edge ends up
+    ///   lowest. Space below the skyline that is not covered is lost, which
+    ///   makes packing fast and works well for rectangles of similar height.
+    ///   <list type="bullet">
+    ///     <item>Jukka Jylänki, A Thousand Ways to Pack the Bin, 2010</item>
+    ///   </list>
+    /// </remarks>
+    class SkylinePacker
+    {
+    public:
+        SkylinePacker(uint32_t width, uint32_t height);
+
+        auto height() const { return height_; }
+        auto width() const { return width_; }
+
+        /// <summary>Removes all rectangles.</summary>
+        void clear();
+
+        /// <summary>
+        ///   Enlarges the packing area. Rectangles already packed stay where
+        ///   they are.
+        /// </summary>
+        void grow(uint32_t width, uint32_t height);
+
+        /// <summary>Finds space for a rectangle and reserves it.</summary>
+        /// <param name="width">Width of the rectangle.</param>
+        /// <param name="height">Height of the rectangle.</param>
+        /// <param name="position">
+        ///   Set to the upper left corner of the reserved space.
+        /// </param>
+        /// <returns>
+        ///   <c>true</c> if the rectangle fit; <c>false</c> otherwise.
+        /// </returns>
+        bool pack(uint32_t width, uint32_t height, Vec2u& position);
+
+    private:
+        struct Segment
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t width;
+        };
+
+        uint32_t width_;
+        uint32_t height_;
+        std::vector<Segment> skyline_;
+
+        /// <summary>
+        ///   Returns the lowest y at which a rectangle fits when its left edge
+        ///   is aligned with the specified segment; -1 if it doesn't fit.
+        /// </summary>
+        auto fit(size_t segment, uint32_t width, uint32_t height) const
+            -> int64_t;
+    };
+}
+
+#endif
@@ -5,13 +5,18 @@
 #include "Graphics/Sprite.h"
 
 #include "Graphics/SpriteBatch.h"
+#include "Graphics/SpriteInstance.h"
+#include "Graphics/SpriteVertex.h"
+#include "Graphics/TransformStream.h"
 #include "Math/Transform.h"
 
 using rainbow::Color;
 using rainbow::Sprite;
+using rainbow::SpriteInstance;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
 using rainbow::TextureAtlas;
+using rainbow::TransformStream;
 using rainbow::Vec2f;
 
 namespace
@@ -51,7 +56,8 @@ Sprite::Sprite(Sprite&& s) noexcept
     : state_(s.state_ | kStaleMask), center_(s.center_), position_(s.position_),
       texture_(s.texture_), color_(s.color_), width_(s.width_),
       height_(s.height_), angle_(s.angle_), pivot_(s.pivot_), scale_(s.scale_),
-      normal_map_(s.normal_map_), id_(s.id_), vertex_array_(s.vertex_array_)
+      sort_key_(s.sort_key_), normal_map_(s.normal_map_), id_(s.id_),
+      vertex_array_(s.vertex_array_)
 {
     s.id_ = kNoId;
     s.vertex_array_ = nullptr;
@@ -72,6 +78,11 @@ auto Sprite::is_mirrored() const -> bool
     return (state_ & kIsMirrored) == kIsMirrored;
 }
 
+auto Sprite::is_stale() const -> bool
+{
+    return (state_ & kStaleMask) != 0;
+}
+
 void Sprite::set_color(Color c)
 {
     state_ |= kStaleTexture;
@@ -143,6 +154,11 @@ void Sprite::hide()
     state_ |= kIsHidden | kStaleMask;
 }
 
+void Sprite::invalidate()
+{
+    state_ |= kStaleMask;
+}
+
 void Sprite::mirror()
 {
     state_ ^= kIsMirrored;
@@ -172,6 +188,20 @@ void Sprite::show()
 
 auto Sprite::update(const ArraySpan<SpriteVertex>& vertex_array,
                     const TextureAtlas& texture) -> bool
+{
+    return update(vertex_array, texture, nullptr);
+}
+
+auto Sprite::update(const ArraySpan<SpriteVertex>& vertex_array,
+                    const TextureAtlas& texture,
+                    TransformStream& stream) -> bool
+{
+    return update(vertex_array, texture, &stream);
+}
+
+auto Sprite::update(const ArraySpan<SpriteVertex>& vertex_array,
+                    const TextureAtlas& texture,
+                    TransformStream* stream) -> bool
 {
     if ((state_ & kStaleMask) == 0)
         return false;
@@ -191,7 +221,10 @@ auto Sprite::update(const ArraySpan<SpriteVertex>& vertex_array,
         if ((state_ & kStalePosition) != 0)
             center_ = position_;
 
-        rainbow::transform(*this, vertex_array);
+        if (stream != nullptr)
+            stream->push(*this, vertex_array.data());
+        else
+            rainbow::transform(*this, vertex_array);
     }
     else if ((state_ & kStalePosition) != 0)
     {
@@ -220,6 +253,29 @@ auto Sprite::update(const ArraySpan<SpriteVertex>& vertex_array,
     return true;
 }
 
+auto Sprite::update(SpriteInstance& instance) -> bool
+{
+    if ((state_ & kStaleMask) == 0)
+        return false;
+
+    center_ = position_;
+
+    instance.position = position_;
+    instance.size = is_hidden()
+                        ? Vec2f::Zero
+                        : Vec2f{width_ * scale_.x, height_ * scale_.y};
+    instance.angle = angle_;
+    instance.pivot[0] = normalize_uint16(pivot_.x);
+    instance.pivot[1] = normalize_uint16(pivot_.y);
+    instance.color = color_;
+    instance.region = static_cast<uint16_t>(texture_);
+    instance.flags = (is_flipped() ? SpriteInstance::kFlipped : 0) |
+                     (is_mirrored() ? SpriteInstance::kMirrored : 0);
+
+    state_ &= ~kStaleMask;
+    return true;
+}
+
 auto Sprite::update(const ArraySpan<Vec2f>& normal_array,
                     const TextureAtlas& normal) -> bool
 {
@@ -247,6 +303,7 @@ auto Sprite::operator=(Sprite&& s) noexcept -> Sprite&
     angle_ = s.angle_;
     pivot_ = s.pivot_;
     scale_ = s.scale_;
+    sort_key_ = s.sort_key_;
     normal_map_ = s.normal_map_;
     id_ = s.id_;
     vertex_array_ = s.vertex_array_;
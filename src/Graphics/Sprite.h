@@ -15,7 +15,9 @@ namespace rainbow
 {
     class Sprite;
     class SpriteBatch;
+    struct SpriteInstance;
     class TextureAtlas;
+    class TransformStream;
 
     class SpriteRef
     {
@@ -87,9 +89,15 @@ namespace rainbow
         auto is_flipped() const -> bool;
         auto is_hidden() const -> bool;
         auto is_mirrored() const -> bool;
+
+        /// <summary>
+        ///   Returns whether the sprite has changed since it was last updated.
+        /// </summary>
+        auto is_stale() const -> bool;
         auto pivot() const { return pivot_; }
         auto position() const { return position_; }
         auto scale() const { return scale_; }
+        auto sort_key() const { return sort_key_; }
 
         auto vertex_array() const -> const SpriteVertex*
         {
@@ -132,6 +140,12 @@ namespace rainbow
         /// <param name="f">Scaling factors for x- and y-axis.</param>
         void set_scale(const Vec2f& f);
 
+        /// <summary>
+        ///   Sets the key used to order sprites in batches sorted by key.
+        ///   Sprites with lower keys are drawn first.
+        /// </summary>
+        void set_sort_key(float key) { sort_key_ = key; }
+
         /// <summary>Sets texture.</summary>
         /// <param name="id">Identifier of the texture to set.</param>
         void set_texture(unsigned int id);
@@ -142,6 +156,11 @@ namespace rainbow
         /// <summary>Hides sprite if it is currently shown.</summary>
         void hide();
 
+        /// <summary>
+        ///   Marks the sprite as changed, forcing a full update of its buffers.
+        /// </summary>
+        void invalidate();
+
         /// <summary>Mirrors sprite.</summary>
         void mirror();
 
@@ -161,6 +180,29 @@ namespace rainbow
         auto update(const ArraySpan<SpriteVertex>& vertex_array,
                     const TextureAtlas& texture) -> bool;
 
+        /// <summary>
+        ///   Updates the vertex buffer, deferring vertex transformation to
+        ///   <paramref name="stream"/>.
+        /// </summary>
+        /// <returns>
+        ///   <c>true</c> if the buffer has changed; <c>false</c> otherwise.
+        /// </returns>
+        auto update(const ArraySpan<SpriteVertex>& vertex_array,
+                    const TextureAtlas& texture,
+                    TransformStream& stream) -> bool;
+
+        /// <summary>
+        ///   Updates the per-sprite record for instanced drawing.
+        /// </summary>
+        /// <remarks>
+        ///   The vertex array is not updated, so <see cref="vertex_array"/>
+        ///   goes stale.
+        /// </remarks>
+        /// <returns>
+        ///   <c>true</c> if the record has changed; <c>false</c> otherwise.
+        /// </returns>
+        auto update(SpriteInstance& instance) -> bool;
+
         /// <summary>Updates the normal buffer.</summary>
         /// <returns>
         ///   <c>true</c> if the buffer has changed; <c>false</c> otherwise.
@@ -235,9 +277,14 @@ namespace rainbow
         float angle_ = 0.0f;          ///< Angle of rotation.
         Vec2f pivot_ = {0.5f, 0.5f};  ///< Pivot point (normalised).
         Vec2f scale_ = Vec2f::One;    ///< Scaling factor.
+        float sort_key_ = 0.0f;       ///< Draw order within sorted batches.
         unsigned int normal_map_ = 0;
         int id_ = kNoId;                        ///< Sprite identifier.
         SpriteVertex* vertex_array_ = nullptr;  ///< Interleaved vertex array.
+
+        auto update(const ArraySpan<SpriteVertex>& vertex_array,
+                    const TextureAtlas& texture,
+                    TransformStream* stream) -> bool;
     };
 }
 
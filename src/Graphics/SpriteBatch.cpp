@@ -4,21 +4,136 @@
 
 #include "Graphics/SpriteBatch.h"
 
+#include <cstring>
+#include <limits>
+#include <numeric>
+
 #include "Graphics/Renderer.h"
 
+using rainbow::PackedSpriteVertex;
+using rainbow::Rect;
 using rainbow::SharedPtr;
 using rainbow::SpriteBatch;
+using rainbow::SpriteInstance;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
 using rainbow::TextureAtlas;
 using rainbow::Vec2f;
+using rainbow::VertexFormat;
+
+namespace
+{
+    /// <summary>
+    ///   Scratch space needed per sprite for sorting; keys and indices, double
+    ///   buffered.
+    /// </summary>
+    constexpr uint32_t kSortBufferStride = 4;
+
+    constexpr uint32_t kEdgeLeft    = 1u << 0;
+    constexpr uint32_t kEdgeBottom  = 1u << 1;
+    constexpr uint32_t kEdgeRight   = 1u << 2;
+    constexpr uint32_t kEdgeTop     = 1u << 3;
+
+    /// <summary>Returns bounds that contain nothing.</summary>
+    auto empty_bounds()
+    {
+        constexpr float kMax = std::numeric_limits<float>::max();
+        return Rect{kMax, kMax, -kMax, -kMax};
+    }
+
+    /// <summary>
+    ///   Returns the edges of <paramref name="bounds"/> that
+    ///   <paramref name="box"/> reaches or extends beyond.
+    /// </summary>
+    auto edges_reached(const Rect& box, const Rect& bounds) -> uint32_t
+    {
+        return (box.left <= bounds.left ? kEdgeLeft : 0u) |
+               (box.bottom <= bounds.bottom ? kEdgeBottom : 0u) |
+               (box.right >= bounds.right ? kEdgeRight : 0u) |
+               (box.top >= bounds.top ? kEdgeTop : 0u);
+    }
+
+    void grow(Rect& bounds, const Rect& box)
+    {
+        bounds.left = std::min(bounds.left, box.left);
+        bounds.bottom = std::min(bounds.bottom, box.bottom);
+        bounds.right = std::max(bounds.right, box.right);
+        bounds.top = std::max(bounds.top, box.top);
+    }
+
+    /// <summary>
+    ///   Maps <paramref name="f"/> to an unsigned integer such that integer
+    ///   comparison gives the same order as comparing the floats.
+    /// </summary>
+    auto radix_key(float f)
+    {
+        uint32_t i;
+        std::memcpy(&i, &f, sizeof(i));
+        return (i & 0x80000000u) != 0 ? ~i : i | 0x80000000u;
+    }
+
+    /// <summary>
+    ///   Stable LSD radix sort of the indices of <paramref name="keys"/>, one
+    ///   byte at a time. Passes where all keys share the same byte are
+    ///   skipped.
+    /// </summary>
+    /// <param name="keys">
+    ///   Keys to sort, followed by scratch space of the same size.
+    /// </param>
+    /// <param name="indices">Scratch space for twice as many indices.</param>
+    /// <param name="count">Number of keys.</param>
+    /// <returns>
+    ///   Indices of <paramref name="keys"/>, in sorted order. This points
+    ///   into <paramref name="indices"/>.
+    /// </returns>
+    auto radix_sort(uint32_t* keys, uint32_t* indices, uint32_t count)
+    {
+        uint32_t* keys_out = keys + count;
+        uint32_t* indices_out = indices + count;
+        std::iota(indices, indices + count, 0);
+
+        for (uint32_t shift = 0; shift < 32; shift += 8)
+        {
+            uint32_t offsets[256]{};
+            for (uint32_t i = 0; i < count; ++i)
+                ++offsets[(keys[i] >> shift) & 0xff];
+
+            if (offsets[(keys[0] >> shift) & 0xff] == count)
+                continue;
+
+            uint32_t offset = 0;
+            for (auto&& o : offsets)
+            {
+                const uint32_t n = o;
+                o = offset;
+                offset += n;
+            }
+
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint32_t j = offsets[(keys[i] >> shift) & 0xff]++;
+                keys_out[j] = keys[i];
+                indices_out[j] = indices[i];
+            }
+
+            std::swap(keys, keys_out);
+            std::swap(indices, indices_out);
+        }
+
+        return indices;
+    }
+}
 
 SpriteBatch::SpriteBatch(uint32_t count)
     : sprites_(count), vertices_(std::make_unique<SpriteVertex[]>(count * 4)),
-      count_(0), visible_(true)
+      count_(0), dirty_first_(0), dirty_last_(0), generation_(0),
+      transform_(count),
+      texture_pending_(false), visible_(true), cull_mode_(CullMode::Batch),
+      needs_cull_(false), visible_count_(0), bounds_(empty_bounds()),
+      needs_bounds_(false), sort_order_(SortOrder::None),
+      instancing_(false), instanced_(false), needs_reconfigure_(false),
+      vertex_format_(VertexFormat::Float)
 {
-    R_ASSERT(count <= graphics::kMaxSprites, "Hard-coded limit reached");
-
     array_.reconfigure([this] { bind_arrays(); });
 }
 
@@ -26,14 +141,53 @@ SpriteBatch::SpriteBatch(SpriteBatch&& batch) noexcept
     : sprites_(std::move(batch.sprites_)),
       vertices_(std::move(batch.vertices_)),
       normals_(std::move(batch.normals_)), count_(batch.count_),
+      dirty_first_(batch.dirty_first_), dirty_last_(batch.dirty_last_),
+      generation_(batch.generation_),
+      transform_(std::move(batch.transform_)),
       vertex_buffer_(std::move(batch.vertex_buffer_)),
       normal_buffer_(std::move(batch.normal_buffer_)),
       array_(std::move(batch.array_)), normal_(std::move(batch.normal_)),
-      texture_(std::move(batch.texture_)), visible_(batch.visible_)
+      texture_(std::move(batch.texture_)),
+      texture_pending_(batch.texture_pending_), visible_(batch.visible_),
+      cull_mode_(batch.cull_mode_), needs_cull_(batch.needs_cull_),
+      visible_count_(batch.visible_count_), bounds_(batch.bounds_),
+      needs_bounds_(batch.needs_bounds_), viewport_(batch.viewport_),
+      culled_vertices_(std::move(batch.culled_vertices_)),
+      culled_normals_(std::move(batch.culled_normals_)),
+      sort_order_(batch.sort_order_),
+      sort_buffer_(std::move(batch.sort_buffer_)),
+      instances_(std::move(batch.instances_)),
+      instancing_(batch.instancing_), instanced_(batch.instanced_),
+      needs_reconfigure_(batch.needs_reconfigure_),
+      vertex_format_(batch.vertex_format_),
+      packed_vertices_(std::move(batch.packed_vertices_))
 {
     batch.clear();
 }
 
+void SpriteBatch::set_cull_mode(CullMode mode)
+{
+    if (mode == cull_mode_)
+        return;
+
+    cull_mode_ = mode;
+    if (mode == CullMode::Sprite)
+    {
+        culled_vertices_ =
+            std::make_unique<SpriteVertex[]>(sprites_.size() * 4);
+        needs_cull_ = true;
+    }
+    else
+    {
+        culled_vertices_.reset();
+        culled_normals_.reset();
+
+        // The GPU buffers hold culled sprites; replace them on next upload.
+        dirty_first_ = 0;
+        dirty_last_ = count_;
+    }
+}
+
 void SpriteBatch::set_normal(SharedPtr<TextureAtlas> texture)
 {
     if (!normals_)
@@ -45,9 +199,48 @@ void SpriteBatch::set_normal(SharedPtr<TextureAtlas> texture)
     normal_ = std::move(texture);
 }
 
+void SpriteBatch::set_sort_order(SortOrder order)
+{
+    sort_order_ = order;
+    if (order == SortOrder::None)
+    {
+        sort_buffer_.reset();
+    }
+    else if (!sort_buffer_)
+    {
+        sort_buffer_ = std::make_unique<uint32_t[]>(sprites_.size() *
+                                                    kSortBufferStride);
+    }
+}
+
 void SpriteBatch::set_texture(SharedPtr<TextureAtlas> texture)
 {
     texture_ = std::move(texture);
+    texture_pending_ = texture_ && !texture_->is_ready();
+}
+
+void SpriteBatch::set_vertex_format(VertexFormat format)
+{
+    if (format == vertex_format_)
+        return;
+
+    vertex_format_ = format;
+    if (format == VertexFormat::Packed)
+    {
+        packed_vertices_ =
+            std::make_unique<PackedSpriteVertex[]>(sprites_.size() * 4);
+    }
+    else
+    {
+        packed_vertices_.reset();
+    }
+
+    // The GPU buffer holds vertices in the previous format.
+    dirty_first_ = 0;
+    dirty_last_ = count_;
+    needs_cull_ = true;
+    if (array_)
+        array_.reconfigure([this] { bind_arrays(); });
 }
 
 auto SpriteBatch::add(int x, int y, int w, int h) -> SpriteRef
@@ -73,13 +266,9 @@ auto SpriteBatch::create_sprite(uint32_t width, uint32_t height) -> SpriteRef
 {
     if (count_ == sprites_.size())
     {
-        LOGW(
-            "Tried to add a sprite (size: %ux%u) to a full SpriteBatch "
-            "(capacity: %u). Increase the capacity and try again.",
-            width,
-            height,
-            sprites_.size());
-        return {};
+        const auto max_count =
+            static_cast<uint32_t>(graphics::max_sprites_per_draw());
+        reserve(std::max(std::min(count_ * 2, max_count), count_ + 1));
     }
 
     new (sprites_.data() + count_) Sprite(width, height);
@@ -90,10 +279,67 @@ auto SpriteBatch::create_sprite(uint32_t width, uint32_t height) -> SpriteRef
     return {*this, sprites_.find_iterator(count_++)};
 }
 
+void SpriteBatch::cull(const Rect& viewport)
+{
+    if (cull_mode_ != CullMode::Sprite ||
+        (!needs_cull_ && viewport == viewport_))
+    {
+        return;
+    }
+
+    if (normals_ && !culled_normals_)
+        culled_normals_ = std::make_unique<Vec2f[]>(sprites_.size() * 4);
+
+    uint32_t visible = 0;
+    for (uint32_t i = 0; i < count_; ++i)
+    {
+        Rect box;
+        if (!sprite_bounds(i, box) || !box.intersects(viewport))
+            continue;
+
+        const uint32_t offset = i * 4;
+        const uint32_t culled_offset = visible * 4;
+        std::copy_n(vertices_.get() + offset,
+                    4,
+                    culled_vertices_.get() + culled_offset);
+        if (normals_)
+        {
+            std::copy_n(normals_.get() + offset,
+                        4,
+                        culled_normals_.get() + culled_offset);
+        }
+        ++visible;
+    }
+
+    const uint32_t vertex_count = visible * 4;
+    if (packed_vertices_)
+    {
+        pack(culled_vertices_.get(), vertex_count, packed_vertices_.get());
+        vertex_buffer_.upload(packed_vertices_.get(),
+                              vertex_count * sizeof(PackedSpriteVertex));
+    }
+    else
+    {
+        vertex_buffer_.upload(
+            culled_vertices_.get(), vertex_count * sizeof(SpriteVertex));
+    }
+    if (normals_)
+    {
+        normal_buffer_.upload(
+            culled_normals_.get(), vertex_count * sizeof(Vec2f));
+    }
+
+    visible_count_ = visible;
+    viewport_ = viewport;
+    needs_cull_ = false;
+}
+
 void SpriteBatch::erase(uint32_t i)
 {
     bring_to_front(i);
     sprites_.data()[--count_].~Sprite();
+    needs_cull_ = true;
+    needs_bounds_ = true;
 }
 
 auto SpriteBatch::find_sprite_by_id(int id) const -> SpriteRef
@@ -117,6 +363,55 @@ void SpriteBatch::move(const Vec2f& delta)
         sprite.move(delta);
 }
 
+void SpriteBatch::reserve(uint32_t count)
+{
+    if (count <= sprites_.size())
+        return;
+
+    R_ASSERT(count <= graphics::max_sprites_per_draw(),
+             "Sprite batch cannot hold more sprites than can be drawn at once");
+
+    sprites_.resize(count, count_);
+
+    const uint32_t vertex_count = count_ * 4;
+    auto vertices = std::make_unique<SpriteVertex[]>(count * 4);
+    std::copy_n(vertices_.get(), vertex_count, vertices.get());
+    vertices_ = std::move(vertices);
+
+    if (normals_)
+    {
+        auto normals = std::make_unique<Vec2f[]>(count * 4);
+        std::copy_n(normals_.get(), vertex_count, normals.get());
+        normals_ = std::move(normals);
+    }
+
+    transform_ = TransformStream(count);
+
+    if (culled_vertices_)
+    {
+        culled_vertices_ = std::make_unique<SpriteVertex[]>(count * 4);
+        culled_normals_.reset();
+        needs_cull_ = true;
+    }
+
+    if (sort_buffer_)
+        sort_buffer_ = std::make_unique<uint32_t[]>(count * kSortBufferStride);
+
+    if (packed_vertices_)
+    {
+        auto packed = std::make_unique<PackedSpriteVertex[]>(count * 4);
+        std::copy_n(packed_vertices_.get(), vertex_count, packed.get());
+        packed_vertices_ = std::move(packed);
+    }
+
+    if (instances_)
+    {
+        auto instances = std::make_unique<SpriteInstance[]>(count);
+        std::copy_n(instances_.get(), count_, instances.get());
+        instances_ = std::move(instances);
+    }
+}
+
 void SpriteBatch::swap(uint32_t i, uint32_t j)
 {
     if (i == j)
@@ -125,50 +420,295 @@ void SpriteBatch::swap(uint32_t i, uint32_t j)
     sprites_.swap(i, j);
 }
 
-void SpriteBatch::update()
+void SpriteBatch::resolve_texture()
 {
-    bool needs_update = false;
+    if (!texture_pending_ || !texture_->is_ready())
+        return;
+
+    // Texture coordinates were computed before the atlas was loaded.
+    for (uint32_t i = 0; i < count_; ++i)
+        sprites_[i].invalidate();
+    texture_pending_ = false;
+}
+
+void SpriteBatch::update_vertices()
+{
+    if (sort_order_ != SortOrder::None)
+        sort();
+
+    const bool instanced = can_instance();
+    if (instanced != instanced_)
+        set_instanced(instanced);
+
+    // Track the range of sprites that changed so that only the affected
+    // vertices need to be sent to the GPU.
+    uint32_t first = std::min(dirty_first_, count_);
+    uint32_t last = std::min(dirty_last_, count_);
+    if (first >= last)
+    {
+        first = count_;
+        last = 0;
+    }
+
+    // Edges of the bounds defined by sprites that are about to change.
+    uint32_t vacated = 0;
+    auto touches_edge = [this, &vacated](uint32_t i) {
+        Rect box;
+        if (sprite_bounds(i, box))
+            vacated |= edges_reached(box, bounds_);
+    };
+
     auto sprites = sprites_.data();
-    if (normals_)
+    if (instanced_)
     {
         for (uint32_t i = 0; i < count_; ++i)
         {
+            if (sprites[i].is_stale())
+                touches_edge(i);
+
+            if (sprites[i].update(instances_[i]))
+            {
+                first = std::min(first, i);
+                last = i + 1;
+            }
+        }
+    }
+    else if (normals_)
+    {
+        for (uint32_t i = 0; i < count_; ++i)
+        {
+            if (sprites[i].is_stale())
+                touches_edge(i);
+
             ArraySpan<Vec2f> normal_buffer{normals_.get() + i * 4, 4};
             ArraySpan<SpriteVertex> vertex_buffer{vertices_.get() + i * 4, 4};
-            needs_update |= sprites[i].update(normal_buffer, *normal_) |
-                            sprites[i].update(vertex_buffer, *texture_);
+            if (sprites[i].update(normal_buffer, *normal_) |
+                sprites[i].update(vertex_buffer, *texture_, transform_))
+            {
+                first = std::min(first, i);
+                last = i + 1;
+            }
         }
     }
     else
     {
         for (uint32_t i = 0; i < count_; ++i)
         {
+            if (sprites[i].is_stale())
+                touches_edge(i);
+
             ArraySpan<SpriteVertex> buffer{vertices_.get() + i * 4, 4};
-            needs_update |= sprites[i].update(buffer, *texture_);
+            if (sprites[i].update(buffer, *texture_, transform_))
+            {
+                first = std::min(first, i);
+                last = i + 1;
+            }
         }
     }
 
-    if (needs_update)
+    transform_.flush();
+
+    if (first < last)
+        generation_ = graphics::detail::next_vertex_generation();
+
+    if (first < last || needs_bounds_)
+        update_bounds(first, last, vacated);
+
+    dirty_first_ = first;
+    dirty_last_ = last;
+}
+
+void SpriteBatch::upload()
+{
+    if (needs_reconfigure_)
+    {
+        array_.reconfigure([this] { bind_arrays(); });
+        needs_reconfigure_ = false;
+    }
+
+    const uint32_t first = std::min(dirty_first_, count_);
+    const uint32_t last = std::min(dirty_last_, count_);
+    if (cull_mode_ == CullMode::Sprite)
+    {
+        // Uploading is deferred until we know which sprites are visible.
+        needs_cull_ |= first < last;
+    }
+    else if (instanced_)
+    {
+        if (first < last)
+            upload_range(vertex_buffer_, instances_.get(), 1, first, last);
+    }
+    else if (first < last)
     {
-        const uint32_t count = count_ * 4;
-        vertex_buffer_.upload(vertices_.get(), count * sizeof(SpriteVertex));
+        upload_vertices(first, last);
         if (normals_)
-            normal_buffer_.upload(normals_.get(), count * sizeof(Vec2f));
+            upload_range(normal_buffer_, normals_.get(), 4, first, last);
     }
+
+    dirty_first_ = 0;
+    dirty_last_ = 0;
 }
 
 void SpriteBatch::bind_arrays() const
 {
-    vertex_buffer_.bind();
+    if (instanced_)
+    {
+        graphics::detail::quad_buffer().bind(Shader::kAttributeVertex);
+        vertex_buffer_.bind_instances();
+        return;
+    }
+
+    vertex_buffer_.bind(vertex_format_);
     if (normals_)
         normal_buffer_.bind(Shader::kAttributeNormal);
 }
 
+bool SpriteBatch::can_instance() const
+{
+    return instancing_ && !normals_ && cull_mode_ == CullMode::Batch &&
+           texture_ && texture_->size() <= kMaxInstancedRegions &&
+           graphics::has_instancing();
+}
+
+void SpriteBatch::set_instanced(bool instanced)
+{
+    instanced_ = instanced;
+    if (instanced)
+        instances_ = std::make_unique<SpriteInstance[]>(sprites_.size());
+    else
+        instances_.reset();
+
+    for (auto&& sprite : *this)
+        sprite.invalidate();
+
+    dirty_first_ = 0;
+    dirty_last_ = count_;
+    needs_reconfigure_ = true;
+    needs_bounds_ = true;
+}
+
+bool SpriteBatch::sprite_bounds(uint32_t i, Rect& box) const
+{
+    // Hidden sprites are collapsed to a point.
+    if (instanced_)
+    {
+        const SpriteInstance& instance = instances_[i];
+        if (instance.size.is_zero())
+            return false;
+
+        box = bounding_box(&instance, 1);
+        return true;
+    }
+
+    box = bounding_box(vertices_.get() + i * 4, 4);
+    return box.left != box.right || box.bottom != box.top;
+}
+
+void SpriteBatch::update_bounds(uint32_t first, uint32_t last, uint32_t vacated)
+{
+    if (needs_bounds_)
+    {
+        bounds_ = empty_bounds();
+        first = 0;
+        last = count_;
+        vacated = 0;
+        needs_bounds_ = false;
+    }
+
+    Rect bounds = bounds_;
+    uint32_t reached = 0;
+    for (uint32_t i = first; i < last; ++i)
+    {
+        Rect box;
+        if (!sprite_bounds(i, box))
+            continue;
+
+        reached |= edges_reached(box, bounds_);
+        grow(bounds, box);
+    }
+
+    // A sprite that defined an edge moved inward, or was hidden.
+    if ((vacated & ~reached) != 0)
+    {
+        needs_bounds_ = true;
+        update_bounds(0, count_, 0);
+        return;
+    }
+
+    bounds_ = bounds;
+}
+
+void SpriteBatch::upload_vertices(uint32_t first, uint32_t last)
+{
+    if (!packed_vertices_)
+    {
+        upload_range(vertex_buffer_, vertices_.get(), 4, first, last);
+        return;
+    }
+
+    const uint32_t offset = first * 4;
+    pack(vertices_.get() + offset,
+         (last - first) * 4,
+         packed_vertices_.get() + offset);
+    upload_range(vertex_buffer_, packed_vertices_.get(), 4, first, last);
+}
+
+void SpriteBatch::sort()
+{
+    if (count_ < 2)
+        return;
+
+    uint32_t* keys = sort_buffer_.get();
+    bool is_sorted = true;
+    auto sprites = sprites_.data();
+    for (uint32_t i = 0; i < count_; ++i)
+    {
+        keys[i] = radix_key(sort_order_ == SortOrder::PositionY
+                                ? -sprites[i].position().y
+                                : sprites[i].sort_key());
+        is_sorted = is_sorted && (i == 0 || keys[i - 1] <= keys[i]);
+    }
+
+    // Sprites rarely change order between frames; avoid moving them around
+    // when nothing changed.
+    if (is_sorted)
+        return;
+
+    uint32_t* indices = radix_sort(keys, keys + count_ * 2, count_);
+    sprites_.reorder(indices, count_);
+}
+
+template <typename T>
+void SpriteBatch::upload_range(graphics::Buffer& buffer,
+                               const T* data,
+                               uint32_t stride,
+                               uint32_t first,
+                               uint32_t last) const
+{
+    const size_t sprite_size = stride * sizeof(T);
+    const size_t size = count_ * sprite_size;
+    if (buffer.size() < size || (first == 0 && last == count_))
+    {
+        buffer.upload(data, size);
+        return;
+    }
+
+    const size_t offset = first * sprite_size;
+    buffer.upload(data + first * stride, offset, (last - first) * sprite_size);
+}
+
 #ifdef RAINBOW_TEST
 SpriteBatch::SpriteBatch(const rainbow::ISolemnlySwearThatIAmOnlyTesting& test)
     : sprites_(4), vertices_(std::make_unique<SpriteVertex[]>(4 * 4)),
-      count_(0), vertex_buffer_(test), normal_buffer_(test),
-      texture_(make_shared<TextureAtlas>(test)), visible_(true)
+      count_(0), dirty_first_(0), dirty_last_(0), generation_(0),
+      transform_(4),
+      vertex_buffer_(test), normal_buffer_(test),
+      texture_(make_shared<TextureAtlas>(test)), texture_pending_(false),
+      visible_(true),
+      cull_mode_(CullMode::Batch), needs_cull_(false), visible_count_(0),
+      bounds_(empty_bounds()), needs_bounds_(false),
+      sort_order_(SortOrder::None), instancing_(false), instanced_(false),
+      needs_reconfigure_(false), vertex_format_(VertexFormat::Float)
 {
     texture_->add_region(0, 0, 1, 1);
 }
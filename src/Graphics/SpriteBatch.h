@@ -9,7 +9,9 @@
 
 #include "Graphics/Buffer.h"
 #include "Graphics/Sprite.h"
+#include "Graphics/SpriteInstance.h"
 #include "Graphics/TextureAtlas.h"
+#include "Graphics/TransformStream.h"
 #include "Graphics/VertexArray.h"
 #include "Memory/StableArray.h"
 
@@ -26,6 +28,40 @@ namespace rainbow
     class SpriteBatch : private NonCopyable<SpriteBatch>
     {
     public:
+        enum class CullMode
+        {
+            /// <summary>The batch is drawn only if any of it is visible.</summary>
+            Batch,
+
+            /// <summary>
+            ///   Additionally, only visible sprites are uploaded and drawn.
+            ///   Suitable for large batches where only a few sprites are on
+            ///   screen at a time, e.g. tile maps.
+            /// </summary>
+            Sprite,
+        };
+
+        enum class SortOrder
+        {
+            /// <summary>
+            ///   Sprites are drawn in the order they were created, or arranged
+            ///   with <see cref="bring_to_front"/> and <see cref="swap"/>.
+            /// </summary>
+            None,
+
+            /// <summary>
+            ///   Sprites are drawn in ascending order of their sort key.
+            /// </summary>
+            SortKey,
+
+            /// <summary>
+            ///   Sprites are drawn in descending order of their y-coordinate,
+            ///   i.e. sprites lower on screen are drawn on top. Suitable for
+            ///   top-down and isometric views.
+            /// </summary>
+            PositionY,
+        };
+
         /// <summary>Creates a batch of sprites.</summary>
         /// <param name="count">Number of sprites to allocate for.</param>
         SpriteBatch(uint32_t count);
@@ -44,10 +80,24 @@ namespace rainbow
         auto begin() { return sprites_.data(); }
         auto begin() const { return sprites_.data(); }
 
+        /// <summary>Returns the bounding box of all sprites.</summary>
+        auto bounds() const -> const Rect& { return bounds_; }
+
+        /// <summary>Returns how sprites in this batch are culled.</summary>
+        auto cull_mode() const { return cull_mode_; }
+
         /// <summary>Returns a pointer to the end.</summary>
         auto end() { return begin() + count_; }
         auto end() const { return begin() + count_; }
 
+        /// <summary>Returns whether a normal map is assigned.</summary>
+        auto has_normal() const { return static_cast<bool>(normal_); }
+
+        /// <summary>
+        ///   Returns whether sprites were last updated for instanced drawing.
+        /// </summary>
+        auto is_instanced() const { return instanced_; }
+
         /// <summary>Returns whether the batch is visible.</summary>
         auto is_visible() const { return visible_; }
 
@@ -61,6 +111,9 @@ namespace rainbow
         /// <summary>Returns sprite count.</summary>
         auto size() const { return count_; }
 
+        /// <summary>Returns the order sprites are drawn in.</summary>
+        auto sort_order() const { return sort_order_; }
+
         /// <summary>Returns current texture.</summary>
         auto texture() const -> TextureAtlas&
         {
@@ -74,15 +127,63 @@ namespace rainbow
             return array_;
         }
 
+        /// <summary>Returns the layout of uploaded vertices.</summary>
+        auto vertex_format() const { return vertex_format_; }
+
         /// <summary>Returns the vertex count.</summary>
-        auto vertex_count() const { return !visible_ ? 0 : count_ * 6; }
+        auto vertex_count() const
+        {
+            return !visible_ ? 0
+                             : (cull_mode_ == CullMode::Sprite ? visible_count_
+                                                               : count_) *
+                                   6;
+        }
+
+        /// <summary>
+        ///   Returns the client vertex buffer. Its contents are stale while
+        ///   the batch is instanced.
+        /// </summary>
+        auto vertices() const { return vertices_.get(); }
+
+        /// <summary>
+        ///   Returns the generation of the client vertex buffer. It changes
+        ///   whenever the buffer is modified.
+        /// </summary>
+        auto vertex_generation() const { return generation_; }
+
+        /// <summary>Sets how sprites in this batch are culled.</summary>
+        void set_cull_mode(CullMode mode);
+
+        /// <summary>
+        ///   Sets whether sprites should be drawn instanced, uploading a
+        ///   compact record per sprite instead of four vertices.
+        /// </summary>
+        /// <remarks>
+        ///   Instancing is only used if supported by the GPU, and the batch
+        ///   has no normal map, is culled as a whole, and its texture atlas
+        ///   has at most <see cref="kMaxInstancedRegions"/> regions. Sprite
+        ///   vertex arrays are not updated while instanced.
+        /// </remarks>
+        void set_instancing(bool enable) { instancing_ = enable; }
 
         /// <summary>Assigns a normal map.</summary>
         void set_normal(SharedPtr<TextureAtlas> texture);
 
+        /// <summary>
+        ///   Sets the order sprites are drawn in. Sprites are re-sorted on
+        ///   every update, when needed.
+        /// </summary>
+        void set_sort_order(SortOrder order);
+
         /// <summary>Assigns a texture atlas.</summary>
         void set_texture(SharedPtr<TextureAtlas> texture);
 
+        /// <summary>
+        ///   Sets the layout of vertices uploaded to the GPU. The client
+        ///   vertex buffer is unaffected.
+        /// </summary>
+        void set_vertex_format(VertexFormat format);
+
         /// <summary>Sets batch visibility.</summary>
         void set_visible(bool visible) { visible_ = visible; }
 
@@ -111,6 +212,15 @@ namespace rainbow
         /// <summary>Brings sprite to front.</summary>
         void bring_to_front(uint32_t i);
 
+        /// <summary>
+        ///   Compacts and uploads the sprites that are within
+        ///   <paramref name="viewport"/>. Does nothing unless the cull mode is
+        ///   <see cref="CullMode::Sprite"/>, or if neither sprites nor
+        ///   viewport changed since the last call. Must be called on the
+        ///   render thread.
+        /// </summary>
+        void cull(const Rect& viewport);
+
         /// <summary>Brings sprite to front.</summary>
         void bring_to_front(const SpriteRef& ref)
         {
@@ -121,9 +231,15 @@ namespace rainbow
         }
 
         /// <summary>Clears all sprites.</summary>
-        void clear() { count_ = 0; }
+        void clear()
+        {
+            count_ = 0;
+            needs_bounds_ = true;
+        }
 
-        /// <summary>Creates a sprite.</summary>
+        /// <summary>
+        ///   Creates a sprite. The batch grows if it is at full capacity.
+        /// </summary>
         /// <param name="width">Width of the sprite.</param>
         /// <param name="height">Height of the sprite.</param>
         /// <returns>
@@ -149,6 +265,13 @@ namespace rainbow
         /// <summary>Moves all sprites by (x,y).</summary>
         void move(const Vec2f&);
 
+        /// <summary>
+        ///   Ensures that the batch can hold at least
+        ///   <paramref name="count"/> sprites without growing. References to
+        ///   existing sprites remain valid.
+        /// </summary>
+        void reserve(uint32_t count);
+
         /// <summary>Swaps two sprites' positions in the batch.</summary>
         void swap(uint32_t i, uint32_t j);
 
@@ -161,7 +284,35 @@ namespace rainbow
         }
 
         /// <summary>Updates the batch of sprites.</summary>
-        void update();
+        void update()
+        {
+            resolve_texture();
+            update_vertices();
+            upload();
+        }
+
+        /// <summary>
+        ///   Checks whether a texture atlas loading in the background has
+        ///   finished, and if so, invalidates texture coordinates computed in
+        ///   the meantime. Must be called on the render thread, as atlases may
+        ///   be shared between batches.
+        /// </summary>
+        void resolve_texture();
+
+        /// <summary>
+        ///   Sorts sprites if needed, then updates the client vertex buffers
+        ///   without touching the GPU. It is safe to call this concurrently on
+        ///   different batches, provided <see cref="resolve_texture"/> was
+        ///   called on all of them first.
+        /// </summary>
+        void update_vertices();
+
+        /// <summary>
+        ///   Uploads vertices changed by the last call to
+        ///   <see cref="update_vertices"/>. Must be called on the render
+        ///   thread.
+        /// </summary>
+        void upload();
 
         auto operator[](uint32_t i) -> Sprite& { return sprites_[i]; }
 
@@ -176,7 +327,6 @@ namespace rainbow
         auto capacity() const { return sprites_.size(); }
         auto sprites() { return sprites_.data(); }
         auto sprites() const { return sprites_.data(); }
-        auto vertices() const { return vertices_.get(); }
 #endif
 
     private:
@@ -184,12 +334,33 @@ namespace rainbow
         std::unique_ptr<SpriteVertex[]> vertices_;  ///< Client vertex buffer.
         std::unique_ptr<Vec2f[]> normals_;          ///< Client normal buffer.
         uint32_t count_;                            ///< Number of sprites.
+        uint32_t dirty_first_;                      ///< First sprite pending upload.
+        uint32_t dirty_last_;                       ///< One past last sprite pending upload.
+        uint64_t generation_;                       ///< Changes whenever client vertices change.
+        TransformStream transform_;                 ///< Staged vertex transforms.
         graphics::Buffer vertex_buffer_;            ///< Shared, interleaved vertex buffer.
         graphics::Buffer normal_buffer_;            ///< Shared normal buffer.
         graphics::VertexArray array_;               ///< Vertex array object.
         SharedPtr<TextureAtlas> normal_;            ///< Normal map used by all sprites in the batch.
         SharedPtr<TextureAtlas> texture_;           ///< Texture atlas used by all sprites in the batch.
+        bool texture_pending_;                      ///< Whether the texture atlas is still loading.
         bool visible_;                              ///< Whether the batch is visible.
+        CullMode cull_mode_;                        ///< How sprites are culled.
+        bool needs_cull_;                           ///< Whether sprites changed since they were last culled.
+        uint32_t visible_count_;                    ///< Number of sprites that survived culling.
+        Rect bounds_;                               ///< Bounding box of all visible sprites.
+        bool needs_bounds_;                         ///< Whether bounds must be recomputed from scratch.
+        Rect viewport_;                             ///< Viewport sprites were last culled against.
+        std::unique_ptr<SpriteVertex[]> culled_vertices_;  ///< Client vertex buffer after culling.
+        std::unique_ptr<Vec2f[]> culled_normals_;          ///< Client normal buffer after culling.
+        SortOrder sort_order_;                      ///< Order sprites are drawn in.
+        std::unique_ptr<uint32_t[]> sort_buffer_;   ///< Scratch space for sorting sprites.
+        std::unique_ptr<SpriteInstance[]> instances_;  ///< Client instance buffer.
+        bool instancing_;                           ///< Whether instancing was requested.
+        bool instanced_;                            ///< Whether sprites are updated for instancing.
+        bool needs_reconfigure_;                    ///< Whether the vertex array must be rebound.
+        VertexFormat vertex_format_;                ///< Layout of vertices uploaded to the GPU.
+        std::unique_ptr<PackedSpriteVertex[]> packed_vertices_;  ///< Staging buffer for packed vertices.
 
         void add() {}
 
@@ -206,6 +377,59 @@ namespace rainbow
 
         /// <summary>Sets the array state for this batch.</summary>
         void bind_arrays() const;
+
+        /// <summary>
+        ///   Returns whether the batch currently fulfils the requirements for
+        ///   instanced drawing.
+        /// </summary>
+        bool can_instance() const;
+
+        /// <summary>
+        ///   Switches between instanced and per-vertex updates. All sprites
+        ///   are regenerated.
+        /// </summary>
+        void set_instanced(bool instanced);
+
+        /// <summary>
+        ///   Retrieves the bounding box of sprite <paramref name="i"/> as of
+        ///   its last update.
+        /// </summary>
+        /// <returns><c>false</c> if the sprite is hidden.</returns>
+        bool sprite_bounds(uint32_t i, Rect& box) const;
+
+        /// <summary>
+        ///   Grows the bounds to include sprites [<paramref name="first"/>,
+        ///   <paramref name="last"/>). Bounds are only recomputed from scratch
+        ///   if a sprite that defined one of the <paramref name="vacated"/>
+        ///   edges no longer reaches it.
+        /// </summary>
+        void update_bounds(uint32_t first, uint32_t last, uint32_t vacated);
+
+        /// <summary>
+        ///   Uploads the vertices of sprites [<paramref name="first"/>,
+        ///   <paramref name="last"/>) in the current vertex format.
+        /// </summary>
+        void upload_vertices(uint32_t first, uint32_t last);
+
+        /// <summary>
+        ///   Rearranges sprites by their sort keys, unless they are already
+        ///   in order. Sprites that are moved will have their vertices
+        ///   regenerated.
+        /// </summary>
+        void sort();
+
+        /// <summary>
+        ///   Uploads the vertices of sprites [<paramref name="first"/>,
+        ///   <paramref name="last"/>) to <paramref name="buffer"/>. The whole
+        ///   array is uploaded if the buffer needs to grow.
+        /// </summary>
+        /// <param name="stride">Number of elements per sprite.</param>
+        template <typename T>
+        void upload_range(graphics::Buffer& buffer,
+                          const T* data,
+                          uint32_t stride,
+                          uint32_t first,
+                          uint32_t last) const;
     };
 }
 
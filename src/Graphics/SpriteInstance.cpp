@@ -0,0 +1,86 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/SpriteInstance.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Graphics/TextureAtlas.h"
+
+using rainbow::Rect;
+using rainbow::SpriteInstance;
+using rainbow::SpriteVertex;
+using rainbow::TextureAtlas;
+using rainbow::Vec2f;
+
+namespace
+{
+    const Vec2f kQuad[4]{
+        {0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+
+    auto mix(float x, float y, float a) { return x * (1.0f - a) + y * a; }
+
+    /// <summary>
+    ///   Returns the distance from the pivot to the corner furthest away
+    ///   from it, i.e. the radius of the circle the quad rotates within.
+    /// </summary>
+    auto reach(const SpriteInstance& instance)
+    {
+        const float pivot_x = instance.pivot[0] / 65535.0f;
+        const float pivot_y = instance.pivot[1] / 65535.0f;
+        const float x = std::max(pivot_x, 1.0f - pivot_x) * instance.size.x;
+        const float y = std::max(pivot_y, 1.0f - pivot_y) * instance.size.y;
+        return std::sqrt(x * x + y * y);
+    }
+}
+
+auto rainbow::bounding_box(const SpriteInstance* instances, size_t count)
+    -> Rect
+{
+    if (count == 0)
+        return Rect{};
+
+    const Vec2f& origin = instances->position;
+    Rect box{origin.x, origin.y, origin.x, origin.y};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Vec2f& p = instances[i].position;
+        const float r = reach(instances[i]);
+        box.left = std::min(box.left, p.x - r);
+        box.bottom = std::min(box.bottom, p.y - r);
+        box.right = std::max(box.right, p.x + r);
+        box.top = std::max(box.top, p.y + r);
+    }
+    return box;
+}
+
+void rainbow::expand(const SpriteInstance& instance,
+                     const TextureAtlas& texture,
+                     SpriteVertex (&vertices)[4])
+{
+    const float pivot_x = instance.pivot[0] / 65535.0f;
+    const float pivot_y = 1.0f - instance.pivot[1] / 65535.0f;
+    const float s = std::sin(-instance.angle);
+    const float c = std::cos(-instance.angle);
+
+    const float mirror = (instance.flags & SpriteInstance::kMirrored) != 0;
+    const float flip = (instance.flags & SpriteInstance::kFlipped) != 0;
+    const auto& region = texture[instance.region];
+    const Vec2f& t0 = region.vx[0];
+    const Vec2f& t1 = region.vx[2];
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const Vec2f& corner = kQuad[i];
+        const float x = (corner.x - pivot_x) * instance.size.x;
+        const float y = (corner.y - pivot_y) * instance.size.y;
+
+        vertices[i].color = instance.color;
+        vertices[i].texcoord.x = mix(t0.x, t1.x, std::abs(corner.x - mirror));
+        vertices[i].texcoord.y = mix(t0.y, t1.y, std::abs(corner.y - flip));
+        vertices[i].position.x = c * x - s * y + instance.position.x;
+        vertices[i].position.y = s * x + c * y + instance.position.y;
+    }
+}
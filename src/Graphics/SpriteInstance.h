@@ -0,0 +1,62 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_SPRITEINSTANCE_H_
+#define GRAPHICS_SPRITEINSTANCE_H_
+
+#include "Graphics/SpriteVertex.h"
+
+namespace rainbow
+{
+    class TextureAtlas;
+
+    /// <summary>
+    ///   Maximum number of texture regions an atlas can have for its sprites
+    ///   to be drawn instanced. Must match the size of <c>regions</c> in
+    ///   Instanced2D.vsh.
+    /// </summary>
+    constexpr uint32_t kMaxInstancedRegions = 128;
+
+    /// <summary>
+    ///   Compact, per-sprite record used for instanced drawing. The vertex
+    ///   shader expands each instance into a quad.
+    /// </summary>
+    struct SpriteInstance
+    {
+        enum : uint16_t
+        {
+            kFlipped = 1u << 0,
+            kMirrored = 1u << 1,
+        };
+
+        Vec2f position;     ///< Position of the pivot point.
+        Vec2f size;         ///< Scaled width and height; zero if hidden.
+        float angle;        ///< Angle of rotation.
+        uint16_t pivot[2];  ///< Normalised pivot point, in 1/65535 steps.
+        Color color;        ///< Sprite colour.
+        uint16_t region;    ///< Texture region index.
+        uint16_t flags;     ///< Whether the texture is flipped or mirrored.
+    };
+
+    static_assert(sizeof(SpriteInstance) == 32,
+                  "SpriteInstance should be a quarter of a quad's vertices");
+
+    /// <summary>
+    ///   Returns a rectangle containing the first <paramref name="count"/>
+    ///   instances at any rotation. It may be larger than their actual
+    ///   bounding box.
+    /// </summary>
+    auto bounding_box(const SpriteInstance* instances, size_t count) -> Rect;
+
+    /// <summary>
+    ///   Computes the vertices that Instanced2D.vsh generates for
+    ///   <paramref name="instance"/>. This is the reference implementation of
+    ///   the shader, used to verify it without a GPU.
+    /// </summary>
+    void expand(const SpriteInstance& instance,
+                const TextureAtlas& texture,
+                SpriteVertex (&vertices)[4]);
+}
+
+#endif
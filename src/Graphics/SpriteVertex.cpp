@@ -0,0 +1,21 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/SpriteVertex.h"
+
+using rainbow::PackedSpriteVertex;
+using rainbow::SpriteVertex;
+
+void rainbow::pack(const SpriteVertex* vertices,
+                   size_t count,
+                   PackedSpriteVertex* packed)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        packed[i].color = vertices[i].color;
+        packed[i].texcoord[0] = normalize_uint16(vertices[i].texcoord.x);
+        packed[i].texcoord[1] = normalize_uint16(vertices[i].texcoord.y);
+        packed[i].position = vertices[i].position;
+    }
+}
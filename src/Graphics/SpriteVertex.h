@@ -5,7 +5,12 @@
 #ifndef GRAPHICS_SPRITEVERTEX_H_
 #define GRAPHICS_SPRITEVERTEX_H_
 
+#include <algorithm>
+#include <cstdint>
+
+#include "Common/Algorithm.h"
 #include "Common/Color.h"
+#include "Math/Geometry.h"
 #include "Math/Vec2.h"
 
 namespace rainbow
@@ -20,6 +25,77 @@ namespace rainbow
         Vec2f texcoord;  ///< Texture coordinates.
         Vec2f position;  ///< Position of vertex.
     };
+
+    /// <summary>
+    ///   Same as <see cref="SpriteVertex"/>, but with texture coordinates
+    ///   stored as normalised, 16-bit integers.
+    /// </summary>
+    struct PackedSpriteVertex
+    {
+        Color color;           ///< Texture colour.
+        uint16_t texcoord[2];  ///< Texture coordinates, in 1/65535 steps.
+        Vec2f position;        ///< Position of vertex.
+    };
+
+    static_assert(sizeof(PackedSpriteVertex) == 16,
+                  "PackedSpriteVertex should be 16 bytes");
+
+    /// <summary>Layout of vertices uploaded to the GPU.</summary>
+    enum class VertexFormat
+    {
+        /// <summary>
+        ///   Vertices are uploaded as <see cref="SpriteVertex"/>; 20 bytes
+        ///   per vertex.
+        /// </summary>
+        Float,
+
+        /// <summary>
+        ///   Vertices are uploaded as <see cref="PackedSpriteVertex"/>; 16
+        ///   bytes per vertex. Texture coordinates must be within [0, 1],
+        ///   which they are for all texture atlas regions.
+        /// </summary>
+        Packed,
+    };
+
+    /// <summary>
+    ///   Returns the smallest rectangle containing the first
+    ///   <paramref name="count"/> vertices.
+    /// </summary>
+    inline auto bounding_box(const SpriteVertex* vertices, size_t count)
+    {
+        if (count == 0)
+            return Rect{};
+
+        Rect box{vertices->position.x,
+                 vertices->position.y,
+                 vertices->position.x,
+                 vertices->position.y};
+        for (size_t i = 1; i < count; ++i)
+        {
+            const Vec2f& p = vertices[i].position;
+            box.left = std::min(box.left, p.x);
+            box.bottom = std::min(box.bottom, p.y);
+            box.right = std::max(box.right, p.x);
+            box.top = std::max(box.top, p.y);
+        }
+        return box;
+    }
+
+    /// <summary>
+    ///   Returns <paramref name="f"/>, clamped to [0, 1], as a normalised
+    ///   16-bit integer.
+    /// </summary>
+    inline auto normalize_uint16(float f)
+    {
+        return static_cast<uint16_t>(clamp(f, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    /// <summary>
+    ///   Converts <paramref name="count"/> vertices to the packed format.
+    /// </summary>
+    void pack(const SpriteVertex* vertices,
+              size_t count,
+              PackedSpriteVertex* packed);
 }
 
 #endif
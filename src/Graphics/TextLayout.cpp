@@ -0,0 +1,97 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/TextLayout.h"
+
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "Graphics/FontAtlas.h"
+
+using rainbow::FontAtlas;
+using rainbow::TextLayout;
+using rainbow::czstring;
+
+namespace
+{
+    /// <summary>Maximum number of cached layouts.</summary>
+    constexpr size_t kCacheCapacity = 256;
+
+    struct Key
+    {
+        uint32_t font;
+        float max_width;
+        std::string text;
+
+        friend bool operator==(const Key& a, const Key& b)
+        {
+            return a.font == b.font && a.max_width == b.max_width &&
+                   a.text == b.text;
+        }
+    };
+
+    struct KeyHash
+    {
+        auto operator()(const Key& key) const -> size_t
+        {
+            size_t hash = std::hash<std::string>{}(key.text);
+            hash ^= std::hash<uint32_t>{}(key.font) + 0x9e3779b9 +
+                    (hash << 6) + (hash >> 2);
+            hash ^= std::hash<float>{}(key.max_width) + 0x9e3779b9 +
+                    (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    /// <summary>Least recently used cache of text layouts.</summary>
+    class LayoutCache
+    {
+    public:
+        using Layout = std::shared_ptr<const TextLayout>;
+
+        auto get(FontAtlas& font, czstring text, float max_width) -> Layout
+        {
+            Key key{font.id(), max_width, text == nullptr ? "" : text};
+            auto i = entries_.find(key);
+            if (i != entries_.end())
+            {
+                recent_.splice(recent_.begin(), recent_, i->second.recent);
+                return i->second.layout;
+            }
+
+            if (entries_.size() >= kCacheCapacity)
+            {
+                entries_.erase(entries_.find(*recent_.back()));
+                recent_.pop_back();
+            }
+
+            auto layout = std::make_shared<const TextLayout>(
+                font, key.text.c_str(), max_width);
+            auto entry = entries_.emplace(std::move(key), Entry{}).first;
+            recent_.push_front(&entry->first);
+            entry->second.layout = layout;
+            entry->second.recent = recent_.begin();
+            return layout;
+        }
+
+    private:
+        struct Entry
+        {
+            Layout layout;
+            std::list<const Key*>::iterator recent;
+        };
+
+        std::unordered_map<Key, Entry, KeyHash> entries_;
+        std::list<const Key*> recent_;  ///< Keys, most recently used first.
+    };
+}
+
+auto TextLayout::get(FontAtlas& font, czstring text, float max_width)
+    -> std::shared_ptr<const TextLayout>
+{
+    static LayoutCache cache;
+    return cache.get(font, text, max_width);
+}
@@ -0,0 +1,241 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_TEXTLAYOUT_H_
+#define GRAPHICS_TEXTLAYOUT_H_
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "Common/String.h"
+#include "Common/UTF8.h"
+
+namespace rainbow
+{
+    class FontAtlas;
+
+    /// <summary>Glyphs of a text, positioned on lines.</summary>
+    /// <remarks>
+    ///   Positions are in font units, i.e. pixels at point size, relative to
+    ///   the start of their line. Glyphs are kerned, and lines are broken at
+    ///   line feeds, and at spaces where they would otherwise exceed the
+    ///   maximum width. Words too long to fit a line on their own are broken
+    ///   between characters.
+    /// </remarks>
+    class TextLayout
+    {
+    public:
+        struct Glyph
+        {
+            uint32_t code;    ///< UTF-32 code.
+            uint32_t offset;  ///< Byte offset of the character in the text.
+            float x;          ///< Horizontal position, including bearing.
+        };
+
+        struct Line
+        {
+            uint32_t first;   ///< Index of first glyph on this line.
+            uint32_t last;    ///< Index past the last glyph on this line.
+            uint32_t offset;  ///< Byte offset of the line in the text.
+            float width;      ///< Line width, excluding trailing spaces.
+        };
+
+        /// <summary>
+        ///   Returns the layout of <paramref name="text"/>. Recently used
+        ///   layouts are cached, keyed on text, font and maximum width.
+        /// </summary>
+        /// <remarks>Not thread-safe.</remarks>
+        static auto get(FontAtlas& font, czstring text, float max_width)
+            -> std::shared_ptr<const TextLayout>;
+
+        /// <summary>Lays out <paramref name="text"/>.</summary>
+        /// <param name="font">
+        ///   Font providing <c>Glyph</c> metrics through <c>get_glyph()</c>
+        ///   and <c>kerning()</c>.
+        /// </param>
+        /// <param name="text">UTF-8 encoded text.</param>
+        /// <param name="max_width">
+        ///   Width to wrap lines at; zero to only break at line feeds.
+        /// </param>
+        template <typename Font>
+        TextLayout(Font& font, czstring text, float max_width)
+            : max_width_(max_width)
+        {
+            lines_.push_back({0, 0, 0, 0.0f});
+            append(font, text == nullptr ? "" : text, 0);
+        }
+
+        auto glyphs() const -> const std::vector<Glyph>& { return glyphs_; }
+        auto lines() const -> const std::vector<Line>& { return lines_; }
+
+        /// <summary>
+        ///   Lays out <paramref name="text"/> again, where it differs from
+        ///   the text this layout was made from. Lines before the one
+        ///   containing the first difference are kept as they are.
+        /// </summary>
+        /// <param name="font">Font used to make this layout.</param>
+        /// <param name="text">New text.</param>
+        /// <param name="offset">
+        ///   Byte offset of the first difference between the new text and
+        ///   the old.
+        /// </param>
+        /// <returns>Index of the first line that was laid out again.</returns>
+        template <typename Font>
+        auto relayout(Font& font, czstring text, uint32_t offset) -> size_t
+        {
+            size_t l = lines_.size() - 1;
+            while (l > 0 && lines_[l].offset > offset)
+                --l;
+
+            // With wrapping, the first word on the line could now fit on the
+            // line before it.
+            if (l > 0 && max_width_ > 0.0f && !is_line_feed(text, lines_[l]))
+                --l;
+
+            const uint32_t line_offset = lines_[l].offset;
+            glyphs_.resize(lines_[l].first);
+            lines_.resize(l + 1);
+            append(font, text + line_offset, line_offset);
+            return l;
+        }
+
+    private:
+        /// <summary>Position following the last space on a line.</summary>
+        struct Break
+        {
+            uint32_t index = 0;  ///< Index of the glyph following the space.
+            float pen = 0.0f;    ///< Pen position following the space.
+            float width = 0.0f;  ///< Line width up to the space.
+        };
+
+        std::vector<Glyph> glyphs_;
+        std::vector<Line> lines_;
+        float max_width_;
+
+        auto size() const { return static_cast<uint32_t>(glyphs_.size()); }
+
+        /// <summary>
+        ///   Lays out <paramref name="text"/> from the start of the last line,
+        ///   replacing it.
+        /// </summary>
+        /// <param name="font">Font providing glyph metrics.</param>
+        /// <param name="text">Text from the start of the last line.</param>
+        /// <param name="base">Byte offset of the last line.</param>
+        template <typename Font>
+        void append(Font& font, czstring text, uint32_t base)
+        {
+            const bool wraps = max_width_ > 0.0f;
+            uint32_t first = lines_.back().first;
+            uint32_t line_offset = base;
+            lines_.pop_back();
+
+            // Lines broken at a space keep the kerning against it.
+            uint32_t previous =
+                first > 0 && glyphs_[first - 1].code == ' ' &&
+                        glyphs_[first - 1].offset + 1 == base
+                    ? ' '
+                    : 0;
+
+            float pen = 0.0f;
+            Break last_break;
+            uint32_t offset = base;
+            uint32_t c = 0;
+            uint8_t state = kUTF8Accept;
+            for (uint32_t i = 0; text[i] != '\0'; ++i)
+            {
+                if (state == kUTF8Accept)
+                    offset = base + i;
+
+                state = utf8_decode_step(state, text[i], &c);
+                if (state == kUTF8Reject)
+                    break;
+                if (state != kUTF8Accept)
+                    continue;
+
+                if (c == '\n')
+                {
+                    lines_.push_back(
+                        {first, size(), line_offset, trim(last_break, pen)});
+                    first = size();
+                    line_offset = offset + 1;
+                    pen = 0.0f;
+                    previous = 0;
+                    last_break = {};
+                    continue;
+                }
+
+                typename Font::Glyph glyph;
+                if (!font.get_glyph(c, glyph))
+                    continue;
+
+                float kerning = previous == 0 ? 0.0f
+                                              : font.kerning(previous, c);
+                if (wraps && c != ' ' && size() > first &&
+                    pen + kerning + glyph.advance > max_width_)
+                {
+                    if (last_break.index > first)
+                    {
+                        // Move the last word onto a new line.
+                        lines_.push_back({first,
+                                          last_break.index,
+                                          line_offset,
+                                          last_break.width});
+                        for (uint32_t j = last_break.index; j < size(); ++j)
+                            glyphs_[j].x -= last_break.pen;
+                        line_offset = last_break.index < size()
+                                          ? glyphs_[last_break.index].offset
+                                          : offset;
+                        first = last_break.index;
+                        pen -= last_break.pen;
+                    }
+                    else
+                    {
+                        lines_.push_back({first, size(), line_offset, pen});
+                        first = size();
+                        line_offset = offset;
+                        pen = 0.0f;
+                        kerning = 0.0f;
+                    }
+                    last_break = {};
+                }
+
+                pen += kerning;
+                glyphs_.push_back({c, offset, pen + glyph.left});
+                if (c == ' ')
+                {
+                    if (last_break.index != size() - 1)
+                        last_break.width = pen;
+                    last_break.index = size();
+                    last_break.pen = pen + glyph.advance;
+                }
+                pen += glyph.advance;
+                previous = c;
+            }
+            lines_.push_back(
+                {first, size(), line_offset, trim(last_break, pen)});
+        }
+
+        /// <summary>
+        ///   Returns whether <paramref name="line"/> follows a line feed.
+        /// </summary>
+        static bool is_line_feed(czstring text, const Line& line)
+        {
+            return line.offset > 0 && text[line.offset - 1] == '\n';
+        }
+
+        /// <summary>
+        ///   Returns the width of a line ending at <paramref name="pen"/>,
+        ///   excluding trailing spaces.
+        /// </summary>
+        auto trim(const Break& last_break, float pen) const
+        {
+            return last_break.index == size() && last_break.index > 0
+                       ? last_break.width
+                       : pen;
+        }
+    };
+}
+
+#endif
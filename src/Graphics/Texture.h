@@ -5,6 +5,7 @@
 #ifndef GRAPHICS_TEXTURE_H_
 #define GRAPHICS_TEXTURE_H_
 
+#include <functional>
 #include <string>
 #include <utility>
 
@@ -14,6 +15,32 @@ namespace rainbow { struct ISolemnlySwearThatIAmOnlyTesting; }
 
 namespace rainbow { namespace graphics
 {
+    class Texture;
+    class TextureManager;
+
+    using TextureLoader = std::function<void(TextureManager&, const Texture&)>;
+
+    /// <summary>
+    ///   Decodes texture data off the rendering thread, and returns the loader
+    ///   that uploads it. Returns an empty loader on failure.
+    /// </summary>
+    using TextureDecoder = std::function<TextureLoader()>;
+
+    /// <summary>
+    ///   Decodes up to the requested number of rows of pixels into the
+    ///   buffer, and returns the number of rows decoded; zero on failure.
+    /// </summary>
+    using RowDecoder = std::function<uint32_t(uint8_t*, uint32_t)>;
+
+    enum class TextureFilter
+    {
+        Linear,
+        Nearest,
+        LinearMipmap,   ///< Linear, blending the two nearest mipmaps.
+        NearestMipmap,  ///< Nearest, from the nearest mipmap.
+        TextureFilterCount
+    };
+
     namespace detail
     {
         struct Texture
@@ -22,15 +49,19 @@ namespace rainbow { namespace graphics
             uint32_t name;
             uint32_t width;
             uint32_t height;
-            uint32_t size;
+            uint32_t size;  ///< Size in video memory; zero if evicted.
+            uint32_t mipmap_size;  ///< Part of size taken up by mipmaps.
             uint32_t use_count;
+            uint32_t last_used;  ///< Frame the texture was last bound.
+            uint32_t pending;    ///< Asynchronous load ticket; zero if loaded.
+            bool resident;       ///< Whether the texture is in video memory.
+            TextureFilter min_filter;  ///< Minification filter.
+            TextureLoader reload;  ///< Reloads evicted texture; may be empty.
 
             Texture(std::string id_, uint32_t name_)
                 : id(std::move(id_)), name(name_), width(0), height(0), size(0),
-                  use_count(0) {}
-
-            auto operator==(uint32_t name_) { return name == name_; }
-            auto operator==(const std::string& id_) { return id == id_; }
+                  mipmap_size(0), use_count(0), last_used(0), pending(0),
+                  resident(true), min_filter(TextureFilter::Linear) {}
         };
     }
 
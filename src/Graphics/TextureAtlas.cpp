@@ -4,32 +4,275 @@
 
 #include "Graphics/TextureAtlas.h"
 
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "Common/Algorithm.h"
+#include "FileSystem/File.h"
 #include "FileSystem/FileSystem.h"
+#include "Graphics/BlockCompression.h"
 #include "Graphics/Image.h"
 #include "Graphics/TextureManager.h"
+#include "Memory/BufferPool.h"
+
+#ifdef GL_EXT_texture_compression_s3tc
+#   define USE_S3TC_ENCODER
+#endif
 
 #define kInvalidColorDepth "Invalid colour depth"
 
+using rainbow::BlockFormat;
 using rainbow::DataMap;
+using rainbow::File;
 using rainbow::Image;
+using rainbow::ThreadPool;
 using rainbow::TextureAtlas;
 using rainbow::czstring;
 using rainbow::filesystem::Path;
 using rainbow::graphics::Texture;
+using rainbow::graphics::TextureLoader;
 using rainbow::graphics::TextureManager;
 
-TextureAtlas::TextureAtlas(const Path& path, float scale)
+namespace
 {
-    texture_ = TextureManager::Get()->create(
+#ifdef USE_S3TC_ENCODER
+    /// <summary>Directory, in user data, of compressed images.</summary>
+    constexpr char kCacheDirectory[] = "textures";
+
+    /// <summary>
+    ///   Identifies compressed image files. Bump the version whenever the
+    ///   encoder changes output.
+    /// </summary>
+    constexpr uint32_t kCacheMagic = rainbow::make_fourcc('R', 'B', 'C', '1');
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t size;
+    };
+
+    auto block_format(uint32_t gl_format)
+    {
+        return gl_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? BlockFormat::BC1
+                                                            : BlockFormat::BC3;
+    }
+
+    /// <summary>
+    ///   Returns the path, relative to user data, of the compressed version
+    ///   of <paramref name="data"/>. Files are named after the 64-bit FNV-1a
+    ///   hash of the source image.
+    /// </summary>
+    auto cache_path(const DataMap& data) -> std::string
+    {
+        const uint64_t hash = rainbow::fnv1a(data.data(), data.size());
+
+        char path[sizeof(kCacheDirectory) + 24];
+        snprintf(path,
+                 sizeof(path),
+                 "%s/%016" PRIx64 ".s3tc",
+                 kCacheDirectory,
+                 hash);
+        return path;
+    }
+
+    bool is_compressible(const Image& image)
+    {
+        // Compressed textures must be made up of whole blocks on some
+        // drivers.
+        return image.format == Image::Format::PNG && image.channels == 4 &&
+               image.depth == 32 && image.width % 4 == 0 &&
+               image.height % 4 == 0;
+    }
+
+    bool is_opaque(const Image& image)
+    {
+        const size_t size = image.width * image.height * 4;
+        for (size_t i = 3; i < size; i += 4)
+        {
+            if (image.data[i] != 0xff)
+                return false;
+        }
+        return true;
+    }
+
+    auto load_cached(const std::string& path) -> Image
+    {
+        Image image{Image::Format::S3TC};
+
+        const auto file_path = rainbow::filesystem::user(path.c_str());
+        std::error_code error;
+        if (!rainbow::filesystem::is_regular_file(file_path, error))
+            return image;
+
+        auto file = File::open(file_path);
+        CacheHeader header;
+        if (file.read(&header, sizeof(header)) != sizeof(header) ||
+            header.magic != kCacheMagic ||
+            (header.format != GL_COMPRESSED_RGB_S3TC_DXT1_EXT &&
+             header.format != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) ||
+            header.size != rainbow::block_compressed_size(
+                               block_format(header.format),
+                               header.width,
+                               header.height))
+        {
+            LOGW("Ignoring invalid compressed image '%s'", path.c_str());
+            return image;
+        }
+
+        auto buffer = rainbow::staging_buffers().acquire(header.size);
+        if (file.read(buffer.data(), header.size) != header.size)
+            return image;
+
+        image.width = header.width;
+        image.height = header.height;
+        image.channels = header.format;
+        image.size = header.size;
+        image.data = buffer.data();
+        image.buffer = std::move(buffer);
+        return image;
+    }
+
+    void save_cached(const std::string& path, const Image& image)
+    {
+        std::error_code error;
+        const auto directory = rainbow::filesystem::user(kCacheDirectory);
+        if (!rainbow::filesystem::create_directories(directory, error))
+            return;
+
+        auto file = File::open_write(path.c_str());
+        if (!file)
+            return;
+
+        const CacheHeader header{kCacheMagic,
+                                 image.channels,
+                                 image.width,
+                                 image.height,
+                                 static_cast<uint32_t>(image.size)};
+        if (file.write(&header, sizeof(header)) != sizeof(header) ||
+            file.write(image.data, image.size) != image.size)
+        {
+            LOGW("Failed to write compressed image '%s'", path.c_str());
+        }
+    }
+
+    auto compress(const Image& image, ThreadPool& encoders)
+    {
+        const BlockFormat format =
+            is_opaque(image) ? BlockFormat::BC1 : BlockFormat::BC3;
+
+        Image compressed{Image::Format::S3TC};
+        compressed.width = image.width;
+        compressed.height = image.height;
+        compressed.channels = format == BlockFormat::BC1
+                                  ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+                                  : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        compressed.size =
+            rainbow::block_compressed_size(format, image.width, image.height);
+
+        auto buffer = rainbow::staging_buffers().acquire(compressed.size);
+        rainbow::compress_blocks(
+            format, image.data, image.width, image.height, buffer.data(),
+            &encoders);
+        compressed.data = buffer.data();
+        compressed.buffer = std::move(buffer);
+        return compressed;
+    }
+#endif  // USE_S3TC_ENCODER
+
+    /// <summary>
+    ///   Decodes <paramref name="data"/>. If <paramref name="encoders"/> is
+    ///   set, PNG images are compressed to S3TC, or read back from cache if
+    ///   they have been compressed before.
+    /// </summary>
+    auto decode(const DataMap& data, float scale, ThreadPool* encoders)
+        -> Image
+    {
+#ifdef USE_S3TC_ENCODER
+        if (encoders != nullptr && png::check(data))
+        {
+            const std::string path = cache_path(data);
+            Image cached = load_cached(path);
+            if (cached.data != nullptr)
+                return cached;
+
+            Image image = Image::decode(data, scale);
+            if (!is_compressible(image))
+                return image;
+
+            Image compressed = compress(image, *encoders);
+            save_cached(path, compressed);
+            return compressed;
+        }
+#else
+        NOT_USED(encoders);
+#endif  // USE_S3TC_ENCODER
+
+        return Image::decode(data, scale);
+    }
+
+    /// <summary>
+    ///   Decoded image, and the data it may still be pointing into.
+    /// </summary>
+    struct DecodedImage
+    {
+        DataMap data;
+        Image image;
+
+        DecodedImage(DataMap&& data_, float scale, ThreadPool* encoders)
+            : data(std::move(data_)), image(decode(data, scale, encoders))
+        {
+        }
+    };
+}
+
+TextureAtlas::TextureAtlas(const Path& path, float scale) : pending_(false)
+{
+    // Textures loaded from disk can be evicted and read back in when needed.
+    texture_ = TextureManager::Get()->create_evictable(
         path.u8string(),
-        [this, &path, scale](
-            TextureManager& texture_manager, const Texture& texture)
+        [path, scale](TextureManager& texture_manager, const Texture& texture)
+        {
+            load(texture_manager, texture, DataMap{path}, scale);
+        });
+}
+
+TextureAtlas::TextureAtlas(const Path& path, float scale, Async)
+    : pending_(true)
+{
+    texture_ = TextureManager::Get()->create_async(
+        path.u8string(),
+        [path, scale, encoders = TextureManager::Get()->image_encoders()]()
+            -> TextureLoader {
+            DataMap data{path};
+            if (!data)
+                return {};
+
+            auto decoded = std::make_shared<DecodedImage>(
+                std::move(data), scale, encoders);
+            if (decoded->image.data == nullptr)
+                return {};
+
+            return [decoded](TextureManager& texture_manager,
+                             const Texture& texture) {
+                upload(texture_manager, texture, decoded->image);
+            };
+        },
+        [path, scale](TextureManager& texture_manager, const Texture& texture)
         {
             load(texture_manager, texture, DataMap{path}, scale);
         });
+
+    // The texture may already have been loaded by someone else.
+    is_ready();
 }
 
 TextureAtlas::TextureAtlas(czstring id, const DataMap& data, float scale)
+    : pending_(false)
 {
     texture_ = TextureManager::Get()->create(
         id,
@@ -40,8 +283,31 @@ TextureAtlas::TextureAtlas(czstring id, const DataMap& data, float scale)
         });
 }
 
+TextureAtlas::TextureAtlas(czstring id, uint32_t width, uint32_t height)
+    : pending_(false)
+{
+    texture_ = TextureManager::Get()->create(
+        id,
+        [width, height](TextureManager& texture_manager, const Texture& texture)
+        {
+            const std::vector<uint8_t> blank(width * height * 4);
+            texture_manager.upload(
+                texture, GL_RGBA8, width, height, GL_RGBA, blank.data());
+        });
+}
+
 auto TextureAtlas::add_region(int x, int y, int w, int h) -> uint32_t
 {
+    const auto i = static_cast<uint32_t>(regions_.size());
+    if (pending_)
+    {
+        // Dimensions are unknown until the image is decoded; keep the region
+        // in pixels for now and normalise it in |is_ready|.
+        regions_.emplace_back(Vec2f(x, y), Vec2f(x + w, y + h));
+        regions_[i].atlas = texture_;
+        return i;
+    }
+
     const float width = static_cast<float>(texture_.width());
     const float height = static_cast<float>(texture_.height());
 
@@ -50,12 +316,51 @@ auto TextureAtlas::add_region(int x, int y, int w, int h) -> uint32_t
 
     const Vec2f v0(x / width, y / height);
     const Vec2f v1((x + w) / width, (y + h) / height);
-    const auto i = static_cast<uint32_t>(regions_.size());
     regions_.emplace_back(v0, v1);
     regions_[i].atlas = texture_;
     return i;
 }
 
+bool TextureAtlas::is_ready()
+{
+    if (!pending_)
+        return true;
+
+    if (!is_loaded())
+        return false;
+
+    pending_ = false;
+
+    const float width = static_cast<float>(texture_.width());
+    const float height = static_cast<float>(texture_.height());
+    for (auto&& region : regions_)
+    {
+        // |vx[3]| and |vx[1]| hold the lower and upper bounds respectively.
+        R_ASSERT(region.vx[3].x >= 0 && region.vx[1].x <= width &&
+                     region.vx[3].y >= 0 && region.vx[1].y <= height,
+                 "Invalid dimensions");
+
+        for (auto&& v : region.vx)
+        {
+            v.x /= width;
+            v.y /= height;
+        }
+    }
+
+    return true;
+}
+
+bool TextureAtlas::is_loaded()
+{
+#ifdef RAINBOW_TEST
+    // Atlases created for testing have no backing texture.
+    if (!texture_)
+        return loaded_;
+#endif
+
+    return TextureManager::Get()->is_ready(texture_);
+}
+
 void TextureAtlas::set_regions(const ArrayView<int>& rects)
 {
     R_ASSERT(rects.size() % 4 == 0,
@@ -74,10 +379,40 @@ void TextureAtlas::load(TextureManager& texture_manager,
 {
     R_ASSERT(data, "Failed to load texture");
 
-    const Image& image = Image::decode(data, scale);
+#ifdef USE_PNG
+    // Stream PNG images into video memory a few rows at a time, unless they
+    // are to be compressed, which needs the whole image.
+    if (texture_manager.image_encoders() == nullptr && png::check(data))
+    {
+        png::RowReader reader(data);
+        if (reader)
+        {
+            const bool is_rgba = reader.channels() == 4;
+            texture_manager.upload_rows(
+                texture,
+                is_rgba ? GL_RGBA8 : GL_LUMINANCE_ALPHA,
+                reader.width(),
+                reader.height(),
+                is_rgba ? GL_RGBA : GL_LUMINANCE_ALPHA,
+                [&reader](uint8_t* rows, uint32_t count) {
+                    return reader.read_rows(rows, count);
+                });
+            return;
+        }
+    }
+#endif  // USE_PNG
+
+    const Image& image = decode(data, scale, texture_manager.image_encoders());
     if (image.data == nullptr)
         return;
 
+    upload(texture_manager, texture, image);
+}
+
+void TextureAtlas::upload(TextureManager& texture_manager,
+                          const Texture& texture,
+                          const Image& image)
+{
     switch (image.format)
     {
 #ifdef GL_OES_compressed_ETC1_RGB8_texture
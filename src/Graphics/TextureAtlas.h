@@ -19,6 +19,8 @@ namespace rainbow
 {
     namespace graphics { class TextureManager; }
 
+    struct Image;
+
     /// <summary>Texture atlas loaded from an image file.</summary>
     /// <remarks>
     ///   <list type="bullet">
@@ -41,8 +43,19 @@ namespace rainbow
     class TextureAtlas : public RefCounted
     {
     public:
+        /// <summary>Tag for loading the image in the background.</summary>
+        struct Async {};
+
         explicit TextureAtlas(const filesystem::Path& path, float scale = 1.0f);
 
+        /// <summary>
+        ///   Creates a texture atlas that is decoded on a background thread.
+        ///   Until <see cref="is_ready"/> returns <c>true</c>, a transparent
+        ///   placeholder is bound and the atlas reports a size of 1x1.
+        ///   Regions may be added at any time.
+        /// </summary>
+        TextureAtlas(const filesystem::Path& path, float scale, Async);
+
         template <typename... Args>
         TextureAtlas(const filesystem::Path& path,
                      float scale,
@@ -55,6 +68,9 @@ namespace rainbow
 
         TextureAtlas(czstring id, const DataMap& data, float scale = 1.0f);
 
+        /// <summary>Creates a blank, transparent texture atlas.</summary>
+        TextureAtlas(czstring id, uint32_t width, uint32_t height);
+
         template <typename... Args>
         TextureAtlas(czstring id,
                      const DataMap& data,
@@ -69,8 +85,15 @@ namespace rainbow
         auto height() const { return texture_.height(); }
         auto is_valid() const { return texture_; }
         auto size() const { return regions_.size(); }
+        auto texture() const -> const graphics::Texture& { return texture_; }
         auto width() const { return texture_.width(); }
 
+        /// <summary>
+        ///   Returns whether the image has finished loading. Must be called
+        ///   on the render thread.
+        /// </summary>
+        bool is_ready();
+
         /// <summary>Binds this texture.</summary>
         void bind() const { texture_.bind(); }
 
@@ -100,10 +123,23 @@ namespace rainbow
         }
 
         explicit TextureAtlas(const ISolemnlySwearThatIAmOnlyTesting& test)
-            : texture_(test)
+            : texture_(test), pending_(false)
         {
         }
 
+#ifdef RAINBOW_TEST
+        /// <summary>
+        ///   Creates an atlas that is pending until
+        ///   <see cref="finish_loading"/> is called.
+        /// </summary>
+        TextureAtlas(const ISolemnlySwearThatIAmOnlyTesting& test, Async)
+            : texture_(test), pending_(true)
+        {
+        }
+
+        void finish_loading() { loaded_ = true; }
+#endif
+
     private:
         template <std::size_t I, typename T>
         static constexpr bool is_integral_v =
@@ -111,6 +147,13 @@ namespace rainbow
 
         graphics::Texture texture_;                     ///< Texture atlas' id.
         std::vector<graphics::TextureRegion> regions_;  ///< Defined texture regions.
+        bool pending_;  ///< Whether regions are still in pixels, awaiting the image.
+#ifdef RAINBOW_TEST
+        bool loaded_ = false;
+#endif
+
+        /// <summary>Returns whether the image has been uploaded.</summary>
+        bool is_loaded();
 
         void add_regions() {}
 
@@ -130,10 +173,14 @@ namespace rainbow
             add_regions(std::forward<Args>(regions)...);
         }
 
-        void load(graphics::TextureManager& texture_manager,
-                  const graphics::Texture& texture,
-                  const DataMap& data,
-                  float scale);
+        static void load(graphics::TextureManager& texture_manager,
+                         const graphics::Texture& texture,
+                         const DataMap& data,
+                         float scale);
+
+        static void upload(graphics::TextureManager& texture_manager,
+                           const graphics::Texture& texture,
+                           const Image& image);
     };
 }
 
@@ -4,7 +4,14 @@
 
 #include "Graphics/TextureManager.h"
 
+#include <algorithm>
+#include <iterator>
+
+#include "Common/Algorithm.h"
 #include "Graphics/Renderer.h"
+#include "Memory/BufferPool.h"
+#include "Threading/TaskQueue.h"
+#include "Threading/ThreadPool.h"
 
 using rainbow::Passkey;
 using rainbow::graphics::Texture;
@@ -13,6 +20,15 @@ using rainbow::graphics::TextureManager;
 
 namespace
 {
+    /// <summary>Number of threads decoding textures.</summary>
+    constexpr uint32_t kDecodeWorkerCount = 2;
+
+    /// <summary>
+    ///   Size, in bytes, of the bands of rows textures are uploaded in by
+    ///   <see cref="TextureManager::upload_rows"/>.
+    /// </summary>
+    constexpr uint32_t kUploadBandSize = 256 * 1024;
+
 #ifndef NDEBUG
     void assert_texture_size(unsigned int width, unsigned int height)
     {
@@ -24,12 +40,92 @@ namespace
     }
 #endif
 
+    /// <summary>
+    ///   Returns the filter equivalent to <paramref name="filter"/>, without
+    ///   mipmaps.
+    /// </summary>
+    auto base_filter(TextureFilter filter)
+    {
+        switch (filter)
+        {
+            case TextureFilter::Nearest:
+            case TextureFilter::NearestMipmap:
+                return TextureFilter::Nearest;
+            default:
+                return TextureFilter::Linear;
+        }
+    }
+
+    bool is_mipmapped(TextureFilter filter)
+    {
+        return filter == TextureFilter::LinearMipmap ||
+               filter == TextureFilter::NearestMipmap;
+    }
+
+    /// <summary>
+    ///   Returns whether a mipmap chain can be generated for a texture of
+    ///   given dimension.
+    /// </summary>
+    bool can_mipmap(unsigned int width, unsigned int height)
+    {
+#ifdef GL_ES_VERSION_2_0
+        // OpenGL ES 2.0 only supports mipmaps for power-of-two textures.
+        return rainbow::is_pow2(width) && rainbow::is_pow2(height);
+#else
+        NOT_USED(width);
+        NOT_USED(height);
+        return true;
+#endif
+    }
+
+    /// <summary>
+    ///   Returns the number of bytes per pixel of uncompressed image data, or
+    ///   of a texture with the given internal format.
+    /// </summary>
+    auto pixel_size(unsigned int format) -> uint32_t
+    {
+        switch (format)
+        {
+            case GL_LUMINANCE:
+                return 1;
+            case GL_LUMINANCE_ALPHA:
+            case GL_RGBA4:
+                return 2;
+            case GL_RGB:
+                return 3;
+            default:
+                return 4;
+        }
+    }
+
+    /// <summary>
+    ///   Returns the size of all mipmap levels below the base level of a
+    ///   texture with <paramref name="pixel_size"/> bytes per pixel.
+    /// </summary>
+    auto mipmap_size(unsigned int width,
+                     unsigned int height,
+                     uint32_t pixel_size)
+    {
+        uint32_t size = 0;
+        while (width > 1 || height > 1)
+        {
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+            size += width * height * pixel_size;
+        }
+        return size;
+    }
+
     auto texture_filter(TextureFilter filter) -> int
     {
         switch (filter)
         {
             case TextureFilter::Nearest:
                 return GL_NEAREST;
+            case TextureFilter::LinearMipmap:
+                return GL_LINEAR_MIPMAP_LINEAR;
+            case TextureFilter::NearestMipmap:
+                return GL_NEAREST_MIPMAP_NEAREST;
             default:
                 return GL_LINEAR;
         }
@@ -72,9 +168,14 @@ auto Texture::operator=(Texture&& texture) noexcept -> Texture&
 }
 
 TextureManager::TextureManager(const Passkey<rainbow::graphics::State>&)
-    : mag_filter_(TextureFilter::Linear), min_filter_(TextureFilter::Linear)
+    : mag_filter_(TextureFilter::Linear), min_filter_(TextureFilter::Linear),
+      budget_(0), resident_size_(0), mipmap_size_(0),
+      eviction_delay_(kDefaultEvictionDelay),
+      frame_(0), evicted_count_(0), reloaded_count_(0), needs_trim_(false),
+      upload_budget_(kDefaultUploadBudget), ticket_(0),
+      compress_images_(false)
 #if RAINBOW_DEVMODE
-    , mem_peak_(0.0), mem_used_(0.0)
+    , mem_peak_(0.0), evicted_(0), reloaded_(0)
 #endif
 {
     std::fill_n(active_, kNumTextureUnits, 0);
@@ -83,16 +184,36 @@ TextureManager::TextureManager(const Passkey<rainbow::graphics::State>&)
 
 TextureManager::~TextureManager()
 {
+    // Decoders may still be writing to |decoded_|.
+    decoders_.reset();
+
     for (const detail::Texture& texture : textures_)
         glDeleteTextures(1, &texture.name);
 }
 
 void TextureManager::set_filter(TextureFilter filter)
 {
-    mag_filter_ = filter;
+    mag_filter_ = base_filter(filter);
     min_filter_ = filter;
 }
 
+void TextureManager::set_image_compression(bool enable)
+{
+#ifdef GL_EXT_texture_compression_s3tc
+    // The encoders are kept even when disabled as pending decoders may still
+    // be using them.
+    if (enable && !encoders_)
+    {
+        encoders_ =
+            std::make_unique<ThreadPool>(ThreadPool::default_worker_count());
+    }
+    compress_images_ = enable;
+#else
+    if (enable)
+        LOGW("S3TC is not supported on this platform");
+#endif
+}
+
 void TextureManager::bind(uint32_t name)
 {
     if (name == active_[0])
@@ -100,6 +221,9 @@ void TextureManager::bind(uint32_t name)
 
     glBindTexture(GL_TEXTURE_2D, name);
     active_[0] = name;
+
+    if (budget_ > 0)
+        make_resident(name);
 }
 
 void TextureManager::bind(uint32_t name, uint32_t unit)
@@ -113,35 +237,98 @@ void TextureManager::bind(uint32_t name, uint32_t unit)
     glBindTexture(GL_TEXTURE_2D, name);
     glActiveTexture(GL_TEXTURE0);
     active_[unit] = name;
+
+    if (budget_ > 0)
+        make_resident(name);
+}
+
+auto TextureManager::create_async(const std::string& id,
+                                  TextureDecoder decoder,
+                                  TextureLoader reload) -> Texture
+{
+    if (auto t = textures_.find(id))
+        return *t;
+
+    auto& texture = create_texture(id);
+    const uint32_t placeholder = 0;
+    upload(texture, GL_RGBA8, 1, 1, GL_RGBA, &placeholder);
+
+    if (++ticket_ == 0)
+        ++ticket_;
+
+    texture.pending = ticket_;
+    texture.reload = std::move(reload);
+
+    if (!decoders_)
+        decoders_ = std::make_unique<TaskQueue>(kDecodeWorkerCount);
+
+    decoders_->post([this,
+                     name = texture.name,
+                     ticket = ticket_,
+                     decoder = std::move(decoder)] {
+        auto upload = decoder();
+        decoded_->push_back({name, ticket, std::move(upload)});
+    });
+
+    return texture;
+}
+
+bool TextureManager::is_ready(Texture& t)
+{
+    auto texture = textures_.find(t);
+    if (texture == nullptr || texture->pending != 0)
+        return false;
+
+    t = Texture{*texture};
+    return true;
 }
 
 void TextureManager::trim()
 {
-    auto first = std::remove_if(
-        textures_.begin(),
-        textures_.end(),
-        [](const detail::Texture& texture) { return texture.use_count == 0; });
-    auto end = textures_.end();
-    if (first == end)
+    if (!needs_trim_)
         return;
 
-    std::for_each(  //
-        first,
-        end,
-#if RAINBOW_DEVMODE
-        [this](const detail::Texture& texture) {
-            mem_used_ -= texture.size;
-#else
-        [](const detail::Texture& texture) {
-#endif
-            glDeleteTextures(1, &texture.name);
-        });
+    needs_trim_ = false;
+    const size_t count = textures_.size();
+    textures_.erase_unused([this](const detail::Texture& texture) {
+        resident_size_ -= texture.size;
+        mipmap_size_ -= texture.mipmap_size;
+        glDeleteTextures(1, &texture.name);
+    });
 
-    textures_.erase(first, end);
+    if (textures_.size() == count)
+        return;
 
     IF_DEVMODE(update_usage());
 }
 
+void TextureManager::update()
+{
+    trim();
+    upload_decoded();
+
+    if (budget_ > 0)
+    {
+        // Textures may stay bound across frames without being rebound.
+        for (auto name : active_)
+        {
+            if (auto texture = textures_.find(name))
+                texture->last_used = frame_;
+        }
+
+        if (resident_size_ > budget_)
+            evict();
+    }
+
+#if RAINBOW_DEVMODE
+    evicted_ = evicted_count_;
+    reloaded_ = reloaded_count_;
+#endif
+    evicted_count_ = 0;
+    reloaded_count_ = 0;
+    ++frame_;
+}
+
 void TextureManager::upload(const Texture& texture,
                             unsigned int internal_format,
                             unsigned int width,
@@ -157,16 +344,43 @@ void TextureManager::upload(const Texture& texture,
 
     R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to upload texture");
 
-    find_invoke(
-        textures_, texture, [this, width, height](detail::Texture& texture) {
-            texture.width = width;
-            texture.height = height;
-            texture.size = width * height * 4;
-#if RAINBOW_DEVMODE
-            mem_used_ += texture.size;
-            update_usage();
-#endif
-        });
+    finish_upload(texture, internal_format, width, height);
+}
+
+void TextureManager::upload_rows(const Texture& texture,
+                                 unsigned int internal_format,
+                                 unsigned int width,
+                                 unsigned int height,
+                                 unsigned int format,
+                                 const RowDecoder& decoder)
+{
+    IF_DEBUG(assert_texture_size(width, height));
+
+    bind(texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format,
+                 GL_UNSIGNED_BYTE, nullptr);
+
+    const uint32_t row_size = width * pixel_size(format);
+    const uint32_t band_height = std::max(kUploadBandSize / row_size, 1u);
+    auto band = rainbow::staging_buffers().acquire(band_height * row_size);
+    for (uint32_t y = 0; y < height;)
+    {
+        const uint32_t rows =
+            decoder(band.data(), std::min(band_height, height - y));
+        if (rows == 0)
+        {
+            LOGE("Failed to decode texture");
+            break;
+        }
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, rows, format,
+                        GL_UNSIGNED_BYTE, band.data());
+        y += rows;
+    }
+
+    R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to upload texture");
+
+    finish_upload(texture, internal_format, width, height);
 }
 
 void TextureManager::upload_compressed(const Texture& texture,
@@ -184,36 +398,66 @@ void TextureManager::upload_compressed(const Texture& texture,
 
     R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to upload texture");
 
-    find_invoke(textures_,
-                texture,
-                [this, width, height, size](detail::Texture& texture) {
-                    texture.width = width;
-                    texture.height = height;
-                    texture.size = size;
-#if RAINBOW_DEVMODE
-                    mem_used_ += texture.size;
-                    update_usage();
-#endif
-                });
+    auto t = textures_.find(texture);
+    if (t == nullptr)
+        return;
+
+    // Mipmaps cannot be generated for compressed textures.
+    if (is_mipmapped(t->min_filter))
+    {
+        glTexParameteri(GL_TEXTURE_2D,
+                        GL_TEXTURE_MIN_FILTER,
+                        texture_filter(base_filter(t->min_filter)));
+    }
+
+    t->width = width;
+    t->height = height;
+    set_size(*t, size, 0);
+    IF_DEVMODE(update_usage());
+}
+
+void TextureManager::upload_subimage(const Texture& texture,
+                                     unsigned int x,
+                                     unsigned int y,
+                                     unsigned int width,
+                                     unsigned int height,
+                                     unsigned int format,
+                                     const void* data)
+{
+    // The handle's dimensions may be out of date if the texture was resized.
+    auto t = textures_.find(texture);
+    R_ASSERT(t != nullptr && x + width <= t->width && y + height <= t->height,
+             "Rectangle is out of bounds");
+
+    bind(texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format,
+                    GL_UNSIGNED_BYTE, data);
+
+    R_ASSERT(glGetError() == GL_NO_ERROR, "Failed to upload texture");
+
+    if (t != nullptr && t->mipmap_size > 0)
+        glGenerateMipmap(GL_TEXTURE_2D);
 }
 
 void TextureManager::release(const Texture& t, const Passkey<Texture>&)
 {
-    find_invoke(
-        textures_, t, [](detail::Texture& texture) { --texture.use_count; });
+    auto texture = textures_.find(t);
+    if (texture != nullptr && --texture->use_count == 0)
+        needs_trim_ = true;
 }
 
 void TextureManager::retain(const Texture& t, const Passkey<Texture>&)
 {
-    find_invoke(
-        textures_, t, [](detail::Texture& texture) { ++texture.use_count; });
+    if (auto texture = textures_.find(t))
+        ++texture->use_count;
 }
 
-auto TextureManager::create_texture(std::string id) -> Texture
+auto TextureManager::create_texture(std::string id) -> detail::Texture&
 {
     GLuint name;
     glGenTextures(1, &name);
-    textures_.emplace_back(std::move(id), name);
+    auto& texture = textures_.emplace(std::move(id), name);
+    texture.min_filter = min_filter_;
 
     bind(name);
     glTexParameteri(
@@ -223,21 +467,147 @@ auto TextureManager::create_texture(std::string id) -> Texture
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    return textures_.back();
+    return texture;
+}
+
+void TextureManager::finish_upload(const Texture& texture,
+                                   unsigned int internal_format,
+                                   unsigned int width,
+                                   unsigned int height)
+{
+    auto t = textures_.find(texture);
+    if (t == nullptr)
+        return;
+
+    uint32_t mipmaps = 0;
+    if (is_mipmapped(t->min_filter))
+    {
+        // Without a complete chain of mipmaps, the texture cannot be sampled
+        // with a mipmap filter.
+        auto filter = base_filter(t->min_filter);
+        if (can_mipmap(width, height))
+        {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            filter = t->min_filter;
+            mipmaps = mipmap_size(width, height, pixel_size(internal_format));
+        }
+        glTexParameteri(
+            GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_filter(filter));
+    }
+
+    t->width = width;
+    t->height = height;
+    const uint32_t size = width * height * pixel_size(internal_format);
+    set_size(*t, size + mipmaps, mipmaps);
+    IF_DEVMODE(update_usage());
+}
+
+void TextureManager::upload_decoded()
+{
+    if (!decoders_)
+        return;
+
+    decoded_.invoke([this](auto&& decoded) {
+        uploads_.insert(uploads_.end(),
+                        std::make_move_iterator(decoded->begin()),
+                        std::make_move_iterator(decoded->end()));
+        decoded->clear();
+    });
+
+    size_t uploaded = 0;
+    auto i = uploads_.begin();
+    for (; i != uploads_.end(); ++i)
+    {
+        if (uploaded >= upload_budget_ && i != uploads_.begin())
+            break;
+
+        // The texture may have been deleted, and its name reused.
+        auto texture = textures_.find(i->name);
+        if (texture == nullptr || texture->pending != i->ticket)
+            continue;
+
+        texture->pending = 0;
+        if (!i->upload)
+        {
+            LOGE("Failed to load texture '%s'", texture->id.c_str());
+            continue;
+        }
+
+        i->upload(*this, *texture);
+        uploaded += texture->size;
+    }
+
+    uploads_.erase(uploads_.begin(), i);
+}
+
+void TextureManager::evict()
+{
+    detail::select_evictions(textures_,
+                             frame_,
+                             eviction_delay_,
+                             resident_size_ - budget_,
+                             eviction_candidates_);
+    for (auto texture : eviction_candidates_)
+    {
+        // Respecifying the texture with no storage frees its memory while
+        // keeping the name valid for anyone holding on to it.
+        glBindTexture(GL_TEXTURE_2D, texture->name);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, nullptr);
+
+        set_size(*texture, 0, 0);
+        texture->resident = false;
+        ++evicted_count_;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, active_[0]);
+    IF_DEVMODE(update_usage());
+}
+
+void TextureManager::make_resident(uint32_t name)
+{
+    auto texture = textures_.find(name);
+    if (texture == nullptr)
+        return;
+
+    texture->last_used = frame_;
+    if (texture->resident)
+        return;
+
+    // Mark as resident first; the loader will bind the texture again.
+    texture->resident = true;
+    ++reloaded_count_;
+    texture->reload(*this, *texture);
+}
+
+void TextureManager::set_size(detail::Texture& texture,
+                              uint32_t size,
+                              uint32_t mipmap_size)
+{
+    resident_size_ -= texture.size;
+    mipmap_size_ -= texture.mipmap_size;
+    texture.size = size;
+    texture.mipmap_size = mipmap_size;
+    resident_size_ += size;
+    mipmap_size_ += mipmap_size;
 }
 
 #if RAINBOW_DEVMODE
 auto TextureManager::memory_usage() const -> TextureManager::MemoryUsage
 {
     constexpr double M = 1e-6;
-    return {mem_used_ * M, mem_peak_ * M};
+    return {resident_size_ * M, mem_peak_ * M, budget_ * M,
+            mipmap_size_ * M, evicted_, reloaded_};
 }
 
 void TextureManager::update_usage()
 {
-    if (mem_used_ > mem_peak_)
-        mem_peak_ = mem_used_;
+    if (resident_size_ > mem_peak_)
+        mem_peak_ = resident_size_;
 
-    LOGD("Video: %.2f MBs of textures", memory_usage().used);
+    const auto usage = memory_usage();
+    LOGD("Video: %.2f MBs of textures (mipmaps: %.2f MBs)",
+         usage.used,
+         usage.mipmaps);
 }
 #endif
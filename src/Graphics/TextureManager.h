@@ -5,39 +5,108 @@
 #ifndef GRAPHICS_TEXTUREMANAGER_H_
 #define GRAPHICS_TEXTUREMANAGER_H_
 
+#include <memory>
 #include <vector>
 
 #include "Common/Global.h"
 #include "Common/Passkey.h"
 #include "Graphics/Texture.h"
+#include "Graphics/TextureTable.h"
+#include "Threading/Synchronized.h"
+
+namespace rainbow
+{
+    class TaskQueue;
+    class ThreadPool;
+}
 
 namespace rainbow { namespace graphics
 {
     struct State;
 
-    enum class TextureFilter
-    {
-        Linear,
-        Nearest,
-        TextureFilterCount
-    };
-
     /// <summary>Manages texture resources.</summary>
+    /// <remarks>
+    ///   Given a video memory budget, textures that can be reloaded and have
+    ///   not been bound for a while are evicted, least recently used first,
+    ///   whenever the budget is exceeded. Evicted textures keep their names
+    ///   and are transparently reloaded the next time they are bound.
+    ///
+    ///   Textures created with <see cref="create_async"/> are decoded on
+    ///   background threads. Decoded textures are uploaded in
+    ///   <see cref="update"/>, a limited amount per frame.
+    /// </remarks>
     class TextureManager : public Global<TextureManager>
     {
     public:
+        /// <summary>
+        ///   Default number of frames a texture must go unused before it can
+        ///   be evicted.
+        /// </summary>
+        static constexpr uint32_t kDefaultEvictionDelay = 120;
+
+        /// <summary>
+        ///   Default number of bytes of asynchronously loaded textures to
+        ///   upload per frame.
+        /// </summary>
+        static constexpr size_t kDefaultUploadBudget = 4 * 1024 * 1024;
+
         TextureManager(const Passkey<State>&);
         ~TextureManager();
 
+        /// <summary>
+        ///   Returns the video memory budget, in bytes; zero if unlimited.
+        /// </summary>
+        auto budget() const { return budget_; }
+
+        /// <summary>
+        ///   Returns whether decoded PNG images are compressed to S3TC before
+        ///   upload.
+        /// </summary>
+        bool compresses_images() const { return compress_images_; }
+
         auto mag_filter() const { return mag_filter_; }
         auto min_filter() const { return min_filter_; }
 
+        /// <summary>
+        ///   Returns video memory used by resident textures, in bytes.
+        /// </summary>
+        auto resident_size() const { return resident_size_; }
+
+        /// <summary>
+        ///   Sets the video memory budget, in bytes. Zero disables eviction.
+        /// </summary>
+        void set_budget(size_t budget) { budget_ = budget; }
+
+        /// <summary>
+        ///   Sets the number of frames a texture must go unused before it can
+        ///   be evicted.
+        /// </summary>
+        void set_eviction_delay(uint32_t frames) { eviction_delay_ = frames; }
+
         /// <summary>Sets texture filtering function.</summary>
         /// <remarks>
-        ///   Existing textures are not affected by this setting.
+        ///   Existing textures are not affected by this setting. Textures
+        ///   created with a mipmap filter get a full chain of mipmaps,
+        ///   generated on upload, except when compressed.
         /// </remarks>
         void set_filter(TextureFilter filter);
 
+        /// <summary>
+        ///   Sets whether to compress decoded PNG images to S3TC (BC1, or BC3
+        ///   if the image has transparency) before upload. Compressed images
+        ///   are cached in the user data directory so that subsequent loads
+        ///   need not compress them again. Only affects textures loaded
+        ///   after this call.
+        /// </summary>
+        void set_image_compression(bool enable);
+
+        /// <summary>
+        ///   Sets the number of bytes of asynchronously loaded textures to
+        ///   upload per frame. At least one texture is uploaded per frame
+        ///   regardless.
+        /// </summary>
+        void set_upload_budget(size_t bytes) { upload_budget_ = bytes; }
+
         /// <summary>Makes texture active on current rendering target.</summary>
         /// <param name="name">
         ///   Name of texture. If omitted, binds the default texture.
@@ -64,18 +133,70 @@ namespace rainbow { namespace graphics
         template <typename F>
         auto create(const std::string& id, F&& loader) -> Texture
         {
-            auto t = find(textures_, id);
-            if (t == textures_.end())
+            auto texture = textures_.find(id);
+            if (texture == nullptr)
+            {
+                texture = &create_texture(id);
+                loader(*this, *texture);
+            }
+            return *texture;
+        }
+
+        /// <summary>
+        ///   Same as <see cref="create"/>, but the texture may be evicted when
+        ///   over budget. <paramref name="loader"/> is kept for reloading the
+        ///   texture and must therefore not hold on to any temporaries.
+        /// </summary>
+        auto create_evictable(const std::string& id, TextureLoader loader)
+            -> Texture
+        {
+            auto texture = textures_.find(id);
+            if (texture == nullptr)
             {
-                loader(*this, create_texture(id));
-                return textures_.back();
+                texture = &create_texture(id);
+                loader(*this, *texture);
+                texture->reload = std::move(loader);
             }
-            return *t;
+            return *texture;
         }
 
-        /// <summary>Deletes unused textures.</summary>
+        /// <summary>
+        ///   Same as <see cref="create"/>, but returns immediately with a
+        ///   transparent 1x1 placeholder while <paramref name="decoder"/> runs
+        ///   on a background thread. The decoded texture is uploaded in a
+        ///   later call to <see cref="update"/>.
+        /// </summary>
+        /// <param name="id">A unique identifier.</param>
+        /// <param name="decoder">
+        ///   Function for decoding data. Must be safe to call from another
+        ///   thread.
+        /// </param>
+        /// <param name="reload">
+        ///   Function for reloading the texture after it was evicted. If
+        ///   empty, the texture cannot be evicted.
+        /// </param>
+        /// <returns>Texture name.</returns>
+        auto create_async(const std::string& id,
+                          TextureDecoder decoder,
+                          TextureLoader reload) -> Texture;
+
+        /// <summary>
+        ///   Returns whether <paramref name="texture"/> has finished loading.
+        ///   If so, <paramref name="texture"/> is updated with its final
+        ///   dimensions.
+        /// </summary>
+        bool is_ready(Texture& texture);
+
+        /// <summary>Deletes unused textures, if any were released.</summary>
         void trim();
 
+        /// <summary>
+        ///   Deletes unused textures, uploads decoded textures and, if over
+        ///   budget, evicts textures that have gone unused. Should be called
+        ///   once per frame.
+        /// </summary>
+        void update();
+
         /// <summary>Uploads image data to specified texture.</summary>
         /// <param name="name">Target texture.</param>
         /// <param name="internal_format">
@@ -92,6 +213,26 @@ namespace rainbow { namespace graphics
                     unsigned int format,
                     const void* data);
 
+        /// <summary>
+        ///   Same as <see cref="upload"/>, but uploads the image a band of
+        ///   rows at a time as they are decoded by <paramref name="decoder"/>,
+        ///   so that the whole image need not be held in memory.
+        /// </summary>
+        /// <param name="name">Target texture.</param>
+        /// <param name="internal_format">
+        ///   Internal format of the texture.
+        /// </param>
+        /// <param name="width">Width of the texture.</param>
+        /// <param name="height">Height of the texture.</param>
+        /// <param name="format">Format of the image data.</param>
+        /// <param name="decoder">Function decoding rows of image data.</param>
+        void upload_rows(const Texture& texture,
+                         unsigned int internal_format,
+                         unsigned int width,
+                         unsigned int height,
+                         unsigned int format,
+                         const RowDecoder& decoder);
+
         /// <summary>
         ///   Uploads compressed image data to specified texture.
         /// </summary>
@@ -108,8 +249,35 @@ namespace rainbow { namespace graphics
                                unsigned int size,
                                const void* data);
 
+        /// <summary>
+        ///   Replaces a rectangle of image data in specified texture.
+        /// </summary>
+        /// <param name="texture">Target texture.</param>
+        /// <param name="x">Left edge of the rectangle.</param>
+        /// <param name="y">Top edge of the rectangle.</param>
+        /// <param name="width">Width of the rectangle.</param>
+        /// <param name="height">Height of the rectangle.</param>
+        /// <param name="format">Format of the image data.</param>
+        /// <param name="data">Image data.</param>
+        void upload_subimage(const Texture& texture,
+                             unsigned int x,
+                             unsigned int y,
+                             unsigned int width,
+                             unsigned int height,
+                             unsigned int format,
+                             const void* data);
+
         // Internal API
 
+        /// <summary>
+        ///   [Internal] Returns the threads compressing decoded images; null
+        ///   if image compression is disabled.
+        /// </summary>
+        auto image_encoders() const
+        {
+            return compress_images_ ? encoders_.get() : nullptr;
+        }
+
         /// <summary>
         ///   [Internal] Used by <see cref="Texture"/> to release itself.
         /// </summary>
@@ -125,6 +293,10 @@ namespace rainbow { namespace graphics
         {
             double used;
             double peak;
+            double budget;      ///< Zero if unlimited.
+            double mipmaps;     ///< Part of used taken up by mipmaps.
+            uint32_t evicted;   ///< Textures evicted in the previous frame.
+            uint32_t reloaded;  ///< Textures reloaded in the previous frame.
         };
 
         /// <summary>Returns total video memory used by textures.</summary>
@@ -134,17 +306,71 @@ namespace rainbow { namespace graphics
     private:
         static constexpr size_t kNumTextureUnits = 2;
 
+        struct DecodedTexture
+        {
+            uint32_t name;
+            uint32_t ticket;
+            TextureLoader upload;
+        };
+
         uint32_t active_[kNumTextureUnits];
-        std::vector<detail::Texture> textures_;
+        detail::TextureTable textures_;
+        std::vector<detail::Texture*> eviction_candidates_;
         TextureFilter mag_filter_;
         TextureFilter min_filter_;
+        size_t budget_;
+        size_t resident_size_;
+        size_t mipmap_size_;  ///< Part of resident size taken by mipmaps.
+        uint32_t eviction_delay_;
+        uint32_t frame_;
+        uint32_t evicted_count_;
+        uint32_t reloaded_count_;
+        bool needs_trim_;
+        size_t upload_budget_;
+        uint32_t ticket_;  ///< Last asynchronous load ticket handed out.
+        std::vector<DecodedTexture> uploads_;  ///< Decoded textures to upload.
+        Synchronized<std::vector<DecodedTexture>> decoded_;
+        std::unique_ptr<ThreadPool> encoders_;  ///< Created on first use.
+        std::unique_ptr<TaskQueue> decoders_;  ///< Created on first use.
+        bool compress_images_;
 
 #if RAINBOW_DEVMODE
         double mem_peak_;
-        double mem_used_;
+        uint32_t evicted_;
+        uint32_t reloaded_;
 #endif
 
-        auto create_texture(std::string id) -> Texture;
+        auto create_texture(std::string id) -> detail::Texture&;
+
+        /// <summary>
+        ///   Generates mipmaps, if needed, and updates the dimensions and
+        ///   video memory accounted for the newly uploaded texture.
+        /// </summary>
+        void finish_upload(const Texture& texture,
+                           unsigned int internal_format,
+                           unsigned int width,
+                           unsigned int height);
+
+        /// <summary>
+        ///   Updates the video memory accounted for <paramref name="texture"/>.
+        /// </summary>
+        void set_size(detail::Texture& texture,
+                      uint32_t size,
+                      uint32_t mipmap_size);
+
+        /// <summary>
+        ///   Uploads decoded textures until the upload budget is spent.
+        /// </summary>
+        void upload_decoded();
+
+        /// <summary>Evicts unused textures until within budget.</summary>
+        void evict();
+
+        /// <summary>
+        ///   Marks texture as used in the current frame, reloading it if it
+        ///   was evicted.
+        /// </summary>
+        void make_resident(uint32_t name);
 
 #if RAINBOW_DEVMODE
         /// <summary>Updates and prints total texture memory used.</summary>
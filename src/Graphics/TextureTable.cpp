@@ -0,0 +1,90 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/TextureTable.h"
+
+#include <algorithm>
+
+#include "Common/Logging.h"
+
+using rainbow::graphics::detail::Texture;
+using rainbow::graphics::detail::TextureTable;
+
+auto TextureTable::emplace(std::string id, uint32_t name) -> Texture&
+{
+    R_ASSERT(slot_by_id_.find(id) == slot_by_id_.end(),
+             "Texture identifier is already in use");
+    R_ASSERT(slot_by_name_.find(name) == slot_by_name_.end(),
+             "Texture name is already in use");
+
+    const auto slot = static_cast<uint32_t>(textures_.size());
+    slot_by_id_.emplace(id, slot);
+    slot_by_name_.emplace(name, slot);
+    textures_.emplace_back(std::move(id), name);
+    return textures_.back();
+}
+
+auto TextureTable::find(const std::string& id) -> Texture*
+{
+    auto i = slot_by_id_.find(id);
+    return i == slot_by_id_.end() ? nullptr : &textures_[i->second];
+}
+
+auto TextureTable::find(uint32_t name) -> Texture*
+{
+    auto i = slot_by_name_.find(name);
+    return i == slot_by_name_.end() ? nullptr : &textures_[i->second];
+}
+
+void TextureTable::erase(size_t slot)
+{
+    slot_by_id_.erase(textures_[slot].id);
+    slot_by_name_.erase(textures_[slot].name);
+
+    const size_t last = textures_.size() - 1;
+    if (slot != last)
+    {
+        textures_[slot] = std::move(textures_[last]);
+        slot_by_id_[textures_[slot].id] = static_cast<uint32_t>(slot);
+        slot_by_name_[textures_[slot].name] = static_cast<uint32_t>(slot);
+    }
+
+    textures_.pop_back();
+}
+
+bool rainbow::graphics::detail::is_evictable(const Texture& texture,
+                                             uint32_t frame,
+                                             uint32_t delay)
+{
+    const uint32_t unused = frame - texture.last_used;
+    return texture.resident && texture.reload && texture.pending == 0 &&
+           unused > 0 && unused >= delay;
+}
+
+void rainbow::graphics::detail::select_evictions(
+    TextureTable& textures,
+    uint32_t frame,
+    uint32_t delay,
+    size_t excess,
+    std::vector<Texture*>& selected)
+{
+    selected.clear();
+    for (auto&& texture : textures)
+    {
+        if (is_evictable(texture, frame, delay))
+            selected.push_back(&texture);
+    }
+
+    std::sort(selected.begin(),
+              selected.end(),
+              [frame](const Texture* a, const Texture* b) {
+                  return frame - a->last_used > frame - b->last_used;
+              });
+
+    size_t size = 0;
+    auto i = selected.begin();
+    while (i != selected.end() && size < excess)
+        size += (*i++)->size;
+    selected.erase(i, selected.end());
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_TEXTURETABLE_H_
+#define GRAPHICS_TEXTURETABLE_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Graphics/Texture.h"
+
+namespace rainbow { namespace graphics { namespace detail
+{
+    /// <summary>Texture records indexed by identifier and by name.</summary>
+    /// <remarks>
+    ///   Records are stored contiguously for iteration, while lookups go
+    ///   through hash maps. Every <see cref="graphics::Texture"/> copy looks
+    ///   up its record, so lookups must not depend on the number of textures.
+    ///   Erasing a record moves the last record into its slot; pointers to
+    ///   records are invalidated by any insertion or erasure.
+    /// </remarks>
+    class TextureTable
+    {
+    public:
+        auto begin() { return textures_.begin(); }
+        auto begin() const { return textures_.begin(); }
+        auto end() { return textures_.end(); }
+        auto end() const { return textures_.end(); }
+        auto size() const { return textures_.size(); }
+
+        /// <summary>Adds a new record.</summary>
+        /// <remarks>
+        ///   Both <paramref name="id"/> and <paramref name="name"/> must be
+        ///   unique.
+        /// </remarks>
+        auto emplace(std::string id, uint32_t name) -> Texture&;
+
+        /// <summary>
+        ///   Erases every record that is no longer in use, calling
+        ///   <paramref name="on_erase"/> with each record before it's erased.
+        /// </summary>
+        template <typename F>
+        void erase_unused(F&& on_erase)
+        {
+            for (size_t i = 0; i < textures_.size();)
+            {
+                if (textures_[i].use_count > 0)
+                {
+                    ++i;
+                    continue;
+                }
+
+                on_erase(textures_[i]);
+                erase(i);
+            }
+        }
+
+        /// <summary>Returns record with specified identifier.</summary>
+        /// <returns>Pointer to record; <c>nullptr</c> if not found.</returns>
+        auto find(const std::string& id) -> Texture*;
+
+        /// <summary>Returns record with specified name.</summary>
+        /// <returns>Pointer to record; <c>nullptr</c> if not found.</returns>
+        auto find(uint32_t name) -> Texture*;
+
+    private:
+        std::vector<Texture> textures_;
+        std::unordered_map<std::string, uint32_t> slot_by_id_;
+        std::unordered_map<uint32_t, uint32_t> slot_by_name_;
+
+        void erase(size_t slot);
+    };
+
+    /// <summary>
+    ///   Returns whether <paramref name="texture"/> can be evicted at
+    ///   <paramref name="frame"/>: it must be resident, reloadable, not
+    ///   loading, and must have gone unused for <paramref name="delay"/>
+    ///   frames. Textures used in the current frame are never evicted.
+    /// </summary>
+    bool is_evictable(const Texture& texture, uint32_t frame, uint32_t delay);
+
+    /// <summary>
+    ///   Selects textures to evict, least recently used first, until their
+    ///   combined size covers <paramref name="excess"/> bytes or there are no
+    ///   candidates left.
+    /// </summary>
+    void select_evictions(TextureTable& textures,
+                          uint32_t frame,
+                          uint32_t delay,
+                          size_t excess,
+                          std::vector<Texture*>& selected);
+}}}  // namespace rainbow::graphics::detail
+
+#endif
@@ -0,0 +1,196 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Graphics/TransformStream.h"
+
+#include <cmath>
+
+#include "Common/Logging.h"
+#include "Graphics/Sprite.h"
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   include <xmmintrin.h>
+#   define USE_TRANSFORM_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   include <arm_neon.h>
+#   define USE_TRANSFORM_NEON
+#endif
+
+using rainbow::Sprite;
+using rainbow::SpriteVertex;
+using rainbow::TransformStream;
+
+namespace
+{
+#if defined(USE_TRANSFORM_SSE)
+    using float4 = __m128;
+
+    auto load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p, float4 v) { _mm_storeu_ps(p, v); }
+
+    auto add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+    auto mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+    auto sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+#elif defined(USE_TRANSFORM_NEON)
+    using float4 = float32x4_t;
+
+    auto load(const float* p) { return vld1q_f32(p); }
+    void store(float* p, float4 v) { vst1q_f32(p, v); }
+
+    auto add(float4 a, float4 b) { return vaddq_f32(a, b); }
+    auto mul(float4 a, float4 b) { return vmulq_f32(a, b); }
+    auto sub(float4 a, float4 b) { return vsubq_f32(a, b); }
+#endif
+}
+
+TransformStream::TransformStream(uint32_t capacity)
+    : lanes_(std::make_unique<float[]>(capacity * kLaneCount)),
+      output_(std::make_unique<SpriteVertex*[]>(capacity)),
+      capacity_(capacity), size_(0)
+{
+}
+
+TransformStream::TransformStream(TransformStream&& stream) noexcept
+    : lanes_(std::move(stream.lanes_)), output_(std::move(stream.output_)),
+      capacity_(stream.capacity_), size_(stream.size_)
+{
+    stream.capacity_ = 0;
+    stream.size_ = 0;
+}
+
+void TransformStream::flush()
+{
+    transform(transform_simd(), size_);
+    size_ = 0;
+}
+
+void TransformStream::push(const Sprite& sprite, SpriteVertex* vertex_array)
+{
+    R_ASSERT(size_ < capacity_, "Transform stream is full");
+
+    const uint32_t i = size_++;
+    const auto& pivot = sprite.pivot();
+    const auto& position = sprite.position();
+    const auto& scale = sprite.scale();
+
+    lane(kOriginX)[i] = sprite.width() * -pivot.x;
+    lane(kOriginY)[i] = sprite.height() * (pivot.y - 1);
+    lane(kWidth)[i] = sprite.width();
+    lane(kHeight)[i] = sprite.height();
+    lane(kPositionX)[i] = position.x;
+    lane(kPositionY)[i] = position.y;
+
+    // Mirrors the branch in |rainbow::transform| so that sprites without
+    // rotation end up with the exact same vertices.
+    const float angle = sprite.angle();
+    const bool is_rotated = !rainbow::is_almost_zero(angle);
+    const float sin_r = is_rotated ? std::sin(-angle) : 0.0f;
+    const float cos_r = is_rotated ? std::cos(-angle) : 1.0f;
+    lane(kSinScaleX)[i] = sin_r * scale.x;
+    lane(kSinScaleY)[i] = sin_r * scale.y;
+    lane(kCosScaleX)[i] = cos_r * scale.x;
+    lane(kCosScaleY)[i] = cos_r * scale.y;
+
+    output_[i] = vertex_array;
+}
+
+auto TransformStream::operator=(TransformStream&& stream) noexcept
+    -> TransformStream&
+{
+    lanes_ = std::move(stream.lanes_);
+    output_ = std::move(stream.output_);
+    capacity_ = stream.capacity_;
+    size_ = stream.size_;
+    stream.capacity_ = 0;
+    stream.size_ = 0;
+    return *this;
+}
+
+#ifdef RAINBOW_TEST
+void TransformStream::flush_scalar()
+{
+    transform(0, size_);
+    size_ = 0;
+}
+#endif
+
+void TransformStream::transform(uint32_t first, uint32_t last) const
+{
+    const float* origin_x = lane(kOriginX);
+    const float* origin_y = lane(kOriginY);
+    const float* width = lane(kWidth);
+    const float* height = lane(kHeight);
+    const float* position_x = lane(kPositionX);
+    const float* position_y = lane(kPositionY);
+    const float* sin_x = lane(kSinScaleX);
+    const float* sin_y = lane(kSinScaleY);
+    const float* cos_x = lane(kCosScaleX);
+    const float* cos_y = lane(kCosScaleY);
+
+    for (uint32_t i = first; i < last; ++i)
+    {
+        const float x0 = origin_x[i];
+        const float y0 = origin_y[i];
+        const float x1 = x0 + width[i];
+        const float y1 = y0 + height[i];
+        const float quad[4][2]{{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+
+        SpriteVertex* vertex_array = output_[i];
+        for (int j = 0; j < 4; ++j)
+        {
+            const float x = quad[j][0];
+            const float y = quad[j][1];
+            vertex_array[j].position.x =
+                cos_x[i] * x - sin_y[i] * y + position_x[i];
+            vertex_array[j].position.y =
+                sin_x[i] * x + cos_y[i] * y + position_y[i];
+        }
+    }
+}
+
+auto TransformStream::transform_simd() const -> uint32_t
+{
+#if defined(USE_TRANSFORM_SSE) || defined(USE_TRANSFORM_NEON)
+    const uint32_t count = size_ & ~3u;
+    for (uint32_t i = 0; i < count; i += 4)
+    {
+        const float4 x0 = load(lane(kOriginX) + i);
+        const float4 y0 = load(lane(kOriginY) + i);
+        const float4 x1 = add(x0, load(lane(kWidth) + i));
+        const float4 y1 = add(y0, load(lane(kHeight) + i));
+        const float4 position_x = load(lane(kPositionX) + i);
+        const float4 position_y = load(lane(kPositionY) + i);
+        const float4 sin_x = load(lane(kSinScaleX) + i);
+        const float4 sin_y = load(lane(kSinScaleY) + i);
+        const float4 cos_x = load(lane(kCosScaleX) + i);
+        const float4 cos_y = load(lane(kCosScaleY) + i);
+
+        const float4 quad[4][2]{{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+        float vertices[4][2][4];
+        for (int j = 0; j < 4; ++j)
+        {
+            const float4 x = quad[j][0];
+            const float4 y = quad[j][1];
+            store(vertices[j][0],
+                  add(sub(mul(cos_x, x), mul(sin_y, y)), position_x));
+            store(vertices[j][1],
+                  add(add(mul(sin_x, x), mul(cos_y, y)), position_y));
+        }
+
+        for (uint32_t k = 0; k < 4; ++k)
+        {
+            SpriteVertex* vertex_array = output_[i + k];
+            for (int j = 0; j < 4; ++j)
+            {
+                vertex_array[j].position.x = vertices[j][0][k];
+                vertex_array[j].position.y = vertices[j][1][k];
+            }
+        }
+    }
+    return count;
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef GRAPHICS_TRANSFORMSTREAM_H_
+#define GRAPHICS_TRANSFORMSTREAM_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    class Sprite;
+    struct SpriteVertex;
+
+    /// <summary>
+    ///   Structure-of-arrays staging area for sprite vertex transforms.
+    /// </summary>
+    /// <remarks>
+    ///   Sprites with stale geometry are queued with <see cref="push"/>, which
+    ///   splits their properties into separate, contiguous lanes. On
+    ///   <see cref="flush"/>, the quads are transformed four at a time using
+    ///   SSE or NEON when available, and written directly into their
+    ///   respective vertex arrays.
+    /// </remarks>
+    class TransformStream : private NonCopyable<TransformStream>
+    {
+    public:
+        explicit TransformStream(uint32_t capacity);
+        TransformStream(TransformStream&&) noexcept;
+
+        auto capacity() const { return capacity_; }
+        auto size() const { return size_; }
+
+        /// <summary>Clears all queued sprites.</summary>
+        void clear() { size_ = 0; }
+
+        /// <summary>
+        ///   Transforms all queued sprites, then clears the stream.
+        /// </summary>
+        void flush();
+
+        /// <summary>Queues a sprite for transformation.</summary>
+        /// <param name="sprite">Sprite whose geometry is stale.</param>
+        /// <param name="vertex_array">
+        ///   Vertex array to write the transformed quad to.
+        /// </param>
+        void push(const Sprite& sprite, SpriteVertex* vertex_array);
+
+        auto operator=(TransformStream&&) noexcept -> TransformStream&;
+
+#ifdef RAINBOW_TEST
+        /// <summary>
+        ///   Same as <see cref="flush"/>, but never uses SIMD instructions.
+        /// </summary>
+        void flush_scalar();
+#endif
+
+    private:
+        enum Lane
+        {
+            kOriginX,
+            kOriginY,
+            kWidth,
+            kHeight,
+            kPositionX,
+            kPositionY,
+            kSinScaleX,
+            kSinScaleY,
+            kCosScaleX,
+            kCosScaleY,
+            kLaneCount
+        };
+
+        std::unique_ptr<float[]> lanes_;
+        std::unique_ptr<SpriteVertex*[]> output_;
+        uint32_t capacity_;
+        uint32_t size_;
+
+        auto lane(Lane l) { return lanes_.get() + l * capacity_; }
+        auto lane(Lane l) const -> const float*
+        {
+            return lanes_.get() + l * capacity_;
+        }
+
+        void transform(uint32_t first, uint32_t last) const;
+        auto transform_simd() const -> uint32_t;
+    };
+}
+
+#endif
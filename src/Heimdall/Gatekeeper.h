@@ -37,6 +37,11 @@ namespace heimdall
             overlay_.draw();
         }
 
+        void set_parallel_update(bool enable)
+        {
+            director_.set_parallel_update(enable);
+        }
+
         void terminate() { director_.terminate(); }
         void terminate(rainbow::czstring error) { director_.terminate(error); }
         void update(uint64_t dt);
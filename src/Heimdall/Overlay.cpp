@@ -201,7 +201,15 @@ void Overlay::update_impl(uint64_t dt)
         {
             const ImVec2 graph_size(400, 100);
 
-            ImGui::TextWrapped("Draw count: %u", graphics::draw_count());
+            ImGui::TextWrapped("Draw count: %u (%u before merging)",
+                               graphics::draw_count(),
+                               graphics::draw_count_unmerged());
+            const auto cull_count = graphics::cull_count();
+            ImGui::TextWrapped("Quads: %u visible, %u culled",
+                               cull_count.visible,
+                               cull_count.culled);
+            ImGui::TextWrapped("Uploaded: %.2f kB/frame",
+                               graphics::bytes_uploaded() / 1024.0);
 
             snprintf_q(buffer,
                        rainbow::array_size(buffer),
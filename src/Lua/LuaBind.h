@@ -28,7 +28,6 @@ NS_RAINBOW_LUA_BEGIN
             return 1;
         }
 
-#ifdef USE_PHYSICS
         template <typename F>
         static int set1b(lua_State* L, F&& set)
         {
@@ -41,7 +40,6 @@ NS_RAINBOW_LUA_BEGIN
             set(self->get(), lua_toboolean(L, 2));
             return 0;
         }
-#endif  // USE_PHYSICS
 
         template <typename F>
         static int get1f(lua_State* L, F&& get)
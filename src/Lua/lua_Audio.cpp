@@ -4,6 +4,8 @@
 
 #include "Lua/lua_Audio.h"
 
+#include <vector>
+
 #include "Audio/Mixer.h"
 #include "Lua/LuaHelper.h"
 #include "Lua/LuaSyntax.h"
@@ -54,6 +56,37 @@ namespace
         return 1;
     }
 
+    int load_compressed(lua_State* L)
+    {
+        // rainbow.audio.load_compressed(file)
+        rainbow::lua::checkargs<char*>(L);
+
+        Sound* sound = rainbow::audio::load_compressed(lua_tostring(L, 1));
+        if (sound == nullptr)
+            return 0;
+
+        rainbow::lua::pushpointer(L, sound, kSoundType);
+        return 1;
+    }
+
+    int preload(lua_State* L)
+    {
+        // rainbow.audio.preload(file, ...)
+        const int count = lua_gettop(L);
+        std::vector<czstring> paths;
+        paths.reserve(count);
+        for (int i = 1; i <= count; ++i)
+        {
+            czstring path = lua_tostring(L, i);
+            if (path != nullptr)
+                paths.push_back(path);
+        }
+
+        if (!paths.empty())
+            rainbow::audio::preload({paths.data(), paths.size()});
+        return 0;
+    }
+
     int release(lua_State* L)
     {
         // rainbow.audio.release(<sound>)
@@ -101,6 +134,20 @@ namespace
         return 0;
     }
 
+    int set_priority(lua_State* L)
+    {
+        // rainbow.audio.set_priority(<channel>, priority)
+        rainbow::lua::checkargs<Channel, lua_Number>(L);
+
+        const int priority = lua_tointeger(L, 2);
+        lua_settop(L, 1);
+
+        Channel* channel = tochannel(L);
+        if (channel != nullptr)
+            rainbow::audio::set_priority(channel, priority);
+        return 0;
+    }
+
     int set_volume(lua_State* L)
     {
         // rainbow.audio.set_volume(<channel>, volume)
@@ -183,6 +230,10 @@ namespace
             return 0;
         }
 
+        // All channels may be taken by higher priority sounds.
+        if (channel == nullptr)
+            return 0;
+
         rainbow::lua::pushpointer(L, channel, kChannelType);
         return 1;
     }
@@ -208,12 +259,15 @@ NS_RAINBOW_LUA_MODULE_BEGIN(audio)
 
         luaR_rawsetcfunction(L, "load_sound", &load_sound);
         luaR_rawsetcfunction(L, "load_stream", &load_stream);
+        luaR_rawsetcfunction(L, "load_compressed", &load_compressed);
+        luaR_rawsetcfunction(L, "preload", &preload);
         luaR_rawsetcfunction(L, "release", &release);
 
         luaR_rawsetcfunction(L, "is_paused", &is_paused);
         luaR_rawsetcfunction(L, "is_playing", &is_playing);
 
         luaR_rawsetcfunction(L, "set_loop_count", &set_loop_count);
+        luaR_rawsetcfunction(L, "set_priority", &set_priority);
         luaR_rawsetcfunction(L, "set_volume", &set_volume);
         luaR_rawsetcfunction(L, "set_world_position", &set_world_position);
 
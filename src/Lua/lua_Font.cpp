@@ -14,10 +14,14 @@ NS_RAINBOW_LUA_BEGIN
 
     Font::Font(lua_State* L)
     {
-        // rainbow.font("path/to/fontface", font_size)
-        checkargs<char*, lua_Number>(L);
+        // rainbow.font("path/to/fontface", font_size[, distance_field])
+        checkargs<char*, lua_Number, nil_or<bool>>(L);
 
-        font_ = make_shared<FontAtlas>(lua_tostring(L, 1), lua_tonumber(L, 2));
+        const auto rendering = toboolean(L, 3)
+                                   ? FontAtlas::Rendering::SignedDistanceField
+                                   : FontAtlas::Rendering::Bitmap;
+        font_ = make_shared<FontAtlas>(
+            lua_tostring(L, 1), lua_tonumber(L, 2), rendering);
         if (!font_->is_valid())
             luaL_error(L, "rainbow.font: Failed to create font texture");
     }
@@ -13,16 +13,18 @@ NS_RAINBOW_LUA_BEGIN
     const char Label::class_name[] = "label";
 
     const luaL_Reg Label::functions[]{
-        {"get_color",      &Label::get_color},
-        {"set_alignment",  &Label::set_alignment},
-        {"set_color",      &Label::set_color},
-        {"set_font",       &Label::set_font},
-        {"set_position",   &Label::set_position},
-        {"set_rotation",   &Label::set_rotation},
-        {"set_scale",      &Label::set_scale},
-        {"set_text",       &Label::set_text},
-        {"move",           &Label::move},
-        {nullptr,          nullptr}};
+        {"get_color",           &Label::get_color},
+        {"set_alignment",       &Label::set_alignment},
+        {"set_color",           &Label::set_color},
+        {"set_font",            &Label::set_font},
+        {"set_max_width",       &Label::set_max_width},
+        {"set_packed_vertices", &Label::set_packed_vertices},
+        {"set_position",        &Label::set_position},
+        {"set_rotation",        &Label::set_rotation},
+        {"set_scale",           &Label::set_scale},
+        {"set_text",            &Label::set_text},
+        {"move",                &Label::move},
+        {nullptr,               nullptr}};
 
     Label::Label(lua_State* L)
     {
@@ -93,6 +95,23 @@ NS_RAINBOW_LUA_BEGIN
             });
     }
 
+    int Label::set_max_width(lua_State* L)
+    {
+        // <label>:set_max_width(width)
+        return set1f(L, [](rainbow::Label* label, float width) {
+            label->set_max_width(width);
+        });
+    }
+
+    int Label::set_packed_vertices(lua_State* L)
+    {
+        // <label>:set_packed_vertices(enable)
+        return set1b(L, [](rainbow::Label* label, bool enable) {
+            label->set_vertex_format(enable ? VertexFormat::Packed
+                                            : VertexFormat::Float);
+        });
+    }
+
     int Label::set_position(lua_State* L)
     {
         // <label>:set_position(x, y)
@@ -33,7 +33,8 @@ namespace
         const int filter = lua_tointeger(L, 1);
         LUA_ASSERT(L,
                    filter < static_cast<int>(TextureFilter::TextureFilterCount),
-                   "gl.NEAREST or gl.LINEAR expected");
+                   "gl.NEAREST, gl.LINEAR, gl.NEAREST_MIPMAP or "
+                   "gl.LINEAR_MIPMAP expected");
         TextureManager::Get()->set_filter(static_cast<TextureFilter>(filter));
         return 0;
     }
@@ -52,6 +53,18 @@ namespace
                                            lua_tonumber(L, 4)});
         return 0;
     }
+
+    int set_texture_budget(lua_State* L)
+    {
+        // rainbow.renderer.set_texture_budget(megabytes)
+        rainbow::lua::checkargs<lua_Number>(L);
+
+        const lua_Number megabytes = lua_tonumber(L, 1);
+        LUA_ASSERT(L, megabytes >= 0, "Budget cannot be negative");
+        TextureManager::Get()->set_budget(
+            static_cast<size_t>(megabytes * 1e6));
+        return 0;
+    }
 }
 
 NS_RAINBOW_LUA_MODULE_BEGIN(renderer)
@@ -60,7 +73,7 @@ NS_RAINBOW_LUA_MODULE_BEGIN(renderer)
     {
         // Initialise "rainbow.renderer" namespace
         lua_pushliteral(L, "renderer");
-        lua_createtable(L, 0, 5);
+        lua_createtable(L, 0, 6);
 
         luaR_rawsetinteger(L, "max_texture_size", graphics::max_texture_size());
 
@@ -72,15 +85,22 @@ NS_RAINBOW_LUA_MODULE_BEGIN(renderer)
         luaR_rawsetcfunction(L, "set_clear_color", &set_clear_color);
         luaR_rawsetcfunction(L, "set_filter", &set_filter);
         luaR_rawsetcfunction(L, "set_projection", &set_projection);
+        luaR_rawsetcfunction(L, "set_texture_budget", &set_texture_budget);
 
         lua_rawset(L, -3);
 
         // Initialise "gl" namespace
-        lua_createtable(L, 0, 2);
+        lua_createtable(L, 0, 4);
         luaR_rawsetinteger(
             L, "NEAREST", static_cast<int>(TextureFilter::Nearest));
         luaR_rawsetinteger(
             L, "LINEAR", static_cast<int>(TextureFilter::Linear));
+        luaR_rawsetinteger(L,
+                           "NEAREST_MIPMAP",
+                           static_cast<int>(TextureFilter::NearestMipmap));
+        luaR_rawsetinteger(L,
+                           "LINEAR_MIPMAP",
+                           static_cast<int>(TextureFilter::LinearMipmap));
         lua_setglobal(L, "gl");
     }
 } NS_RAINBOW_LUA_MODULE_END(renderer)
@@ -23,6 +23,7 @@ NS_RAINBOW_LUA_BEGIN
         {"set_position",  &Sprite::set_position},
         {"set_rotation",  &Sprite::set_rotation},
         {"set_scale",     &Sprite::set_scale},
+        {"set_sort_key",  &Sprite::set_sort_key},
         {"set_texture",   &Sprite::set_texture},
         {"mirror",        &Sprite::mirror},
         {"move",          &Sprite::move},
@@ -153,6 +154,14 @@ NS_RAINBOW_LUA_BEGIN
         return 0;
     }
 
+    int Sprite::set_sort_key(lua_State* L)
+    {
+        // <sprite>:set_sort_key(key)
+        return set1f(L, [](SpriteRef& sprite, float key) {
+            sprite->set_sort_key(key);
+        });
+    }
+
     int Sprite::set_texture(lua_State* L)
     {
         // <sprite>:set_texture(<texture>)
@@ -34,6 +34,7 @@ NS_RAINBOW_LUA_BEGIN
         static int set_position(lua_State*);
         static int set_rotation(lua_State*);
         static int set_scale(lua_State*);
+        static int set_sort_key(lua_State*);
         static int set_texture(lua_State*);
 
         static int mirror(lua_State*);
@@ -4,6 +4,8 @@
 
 #include "Lua/lua_SpriteBatch.h"
 
+#include <cstring>
+
 #include "Lua/lua_Sprite.h"
 #include "Lua/lua_Texture.h"
 
@@ -14,11 +16,15 @@ NS_RAINBOW_LUA_BEGIN
     const char SpriteBatch::class_name[] = "spritebatch";
 
     const luaL_Reg SpriteBatch::functions[]{
-        {"add",            &SpriteBatch::add},
-        {"create_sprite",  &SpriteBatch::create_sprite},
-        {"set_normal",     &SpriteBatch::set_normal},
-        {"set_texture",    &SpriteBatch::set_texture},
-        {nullptr,          nullptr}};
+        {"add",                 &SpriteBatch::add},
+        {"create_sprite",       &SpriteBatch::create_sprite},
+        {"set_cull_sprites",    &SpriteBatch::set_cull_sprites},
+        {"set_instancing",      &SpriteBatch::set_instancing},
+        {"set_normal",          &SpriteBatch::set_normal},
+        {"set_packed_vertices", &SpriteBatch::set_packed_vertices},
+        {"set_sort_order",      &SpriteBatch::set_sort_order},
+        {"set_texture",         &SpriteBatch::set_texture},
+        {nullptr,               nullptr}};
 
     SpriteBatch::SpriteBatch(lua_State* L) : batch_(optinteger(L, 1, 4))
     {
@@ -71,6 +77,23 @@ NS_RAINBOW_LUA_BEGIN
         return alloc<Sprite>(L);
     }
 
+    int SpriteBatch::set_cull_sprites(lua_State* L)
+    {
+        // <spritebatch>:set_cull_sprites(enable)
+        return set1b(L, [](rainbow::SpriteBatch* batch, bool enable) {
+            batch->set_cull_mode(enable ? rainbow::SpriteBatch::CullMode::Sprite
+                                        : rainbow::SpriteBatch::CullMode::Batch);
+        });
+    }
+
+    int SpriteBatch::set_instancing(lua_State* L)
+    {
+        // <spritebatch>:set_instancing(enable)
+        return set1b(L, [](rainbow::SpriteBatch* batch, bool enable) {
+            batch->set_instancing(enable);
+        });
+    }
+
     int SpriteBatch::set_normal(lua_State* L)
     {
         // <spritebatch>:set_normal(<texture>)
@@ -81,6 +104,37 @@ NS_RAINBOW_LUA_BEGIN
             });
     }
 
+    int SpriteBatch::set_packed_vertices(lua_State* L)
+    {
+        // <spritebatch>:set_packed_vertices(enable)
+        return set1b(L, [](rainbow::SpriteBatch* batch, bool enable) {
+            batch->set_vertex_format(enable ? VertexFormat::Packed
+                                            : VertexFormat::Float);
+        });
+    }
+
+    int SpriteBatch::set_sort_order(lua_State* L)
+    {
+        // <spritebatch>:set_sort_order('none' | 'sort_key' | 'position_y')
+        checkargs<SpriteBatch, char*>(L);
+
+        SpriteBatch* self = Bind::self(L);
+        if (self == nullptr)
+            return 0;
+
+        using SortOrder = rainbow::SpriteBatch::SortOrder;
+        const char* order = lua_tostring(L, 2);
+        if (strcmp(order, "none") == 0)
+            self->batch_.set_sort_order(SortOrder::None);
+        else if (strcmp(order, "sort_key") == 0)
+            self->batch_.set_sort_order(SortOrder::SortKey);
+        else if (strcmp(order, "position_y") == 0)
+            self->batch_.set_sort_order(SortOrder::PositionY);
+        else
+            luaL_argerror(L, 2, "'none', 'sort_key' or 'position_y' expected");
+        return 0;
+    }
+
     int SpriteBatch::set_texture(lua_State* L)
     {
         // <spritebatch>:set_texture(<texture>)
@@ -24,7 +24,11 @@ NS_RAINBOW_LUA_BEGIN
     private:
         static int add(lua_State*);
         static int create_sprite(lua_State*);
+        static int set_cull_sprites(lua_State*);
+        static int set_instancing(lua_State*);
         static int set_normal(lua_State*);
+        static int set_packed_vertices(lua_State*);
+        static int set_sort_order(lua_State*);
         static int set_texture(lua_State*);
 
         rainbow::SpriteBatch batch_;
@@ -21,11 +21,19 @@ NS_RAINBOW_LUA_BEGIN
 
     Texture::Texture(lua_State* L)
     {
-        // rainbow.texture("/path/to/texture")
-        checkargs<char*>(L);
+        // rainbow.texture("/path/to/texture"[, async])
+        checkargs<char*, nil_or<bool>>(L);
 
         const auto path = rainbow::filesystem::relative(lua_tostring(L, 1));
-        texture_ = make_shared<TextureAtlas>(path);
+        if (toboolean(L, 2))
+        {
+            texture_ = make_shared<TextureAtlas>(
+                path, 1.0f, TextureAtlas::Async{});
+        }
+        else
+        {
+            texture_ = make_shared<TextureAtlas>(path);
+        }
         if (!texture_->is_valid())
             luaL_error(L, "rainbow.texture: Failed to create texture");
     }
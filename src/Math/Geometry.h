@@ -57,6 +57,16 @@ namespace rainbow
         auto top_left() const { return Vec2f{left, top}; }
         auto top_right() const { return Vec2f{right, top}; }
 
+        /// <summary>
+        ///   Returns whether this rectangle overlaps <paramref name="r"/>.
+        ///   Rectangles that share an edge are considered overlapping.
+        /// </summary>
+        bool intersects(const Rect& r) const
+        {
+            return left <= r.right && r.left <= right &&  //
+                   bottom <= r.top && r.bottom <= top;
+        }
+
         friend bool operator!=(const Rect& r, const Rect& s)
         {
             return !(r == s);
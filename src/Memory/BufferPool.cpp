@@ -0,0 +1,127 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Memory/BufferPool.h"
+
+#include <algorithm>
+
+using rainbow::BufferPool;
+
+namespace
+{
+    /// <summary>
+    ///   Maximum number of bytes kept in idle staging buffers; enough for a
+    ///   couple of 2048x2048 RGBA images.
+    /// </summary>
+    constexpr size_t kMaxIdleStagingSize = 32 * 1024 * 1024;
+}
+
+void BufferPool::Buffer::release()
+{
+    if (data_ == nullptr)
+        return;
+
+    pool_->release(data_, capacity_);
+    pool_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+auto BufferPool::Buffer::operator=(Buffer&& buffer) noexcept -> Buffer&
+{
+    release();
+    std::swap(pool_, buffer.pool_);
+    std::swap(data_, buffer.data_);
+    std::swap(size_, buffer.size_);
+    std::swap(capacity_, buffer.capacity_);
+    return *this;
+}
+
+BufferPool::BufferPool(size_t max_idle_size)
+    : max_idle_size_(max_idle_size), idle_size_(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    clear();
+}
+
+auto BufferPool::idle_count() const -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+auto BufferPool::idle_size() const -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_size_;
+}
+
+auto BufferPool::acquire(size_t size) -> Buffer
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Pick the smallest buffer that fits without wasting more than half.
+        auto best = idle_.end();
+        for (auto i = idle_.begin(); i != idle_.end(); ++i)
+        {
+            if (i->capacity >= size && i->capacity / 2 <= size &&
+                (best == idle_.end() || i->capacity < best->capacity))
+            {
+                best = i;
+            }
+        }
+
+        if (best != idle_.end())
+        {
+            const Block block = *best;
+            idle_.erase(best);
+            idle_size_ -= block.capacity;
+            return {this, block.data, size, block.capacity};
+        }
+    }
+
+    return {this, new uint8_t[size], size, size};
+}
+
+void BufferPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto&& block : idle_)
+        delete[] block.data;
+    idle_.clear();
+    idle_size_ = 0;
+}
+
+void BufferPool::release(uint8_t* data, size_t capacity)
+{
+    if (capacity > max_idle_size_)
+    {
+        delete[] data;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto oldest = idle_.begin();
+    for (; idle_size_ + capacity > max_idle_size_; ++oldest)
+    {
+        idle_size_ -= oldest->capacity;
+        delete[] oldest->data;
+    }
+    idle_.erase(idle_.begin(), oldest);
+
+    idle_.push_back({data, capacity});
+    idle_size_ += capacity;
+}
+
+auto rainbow::staging_buffers() -> BufferPool&
+{
+    static BufferPool pool(kMaxIdleStagingSize);
+    return pool;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef MEMORY_BUFFERPOOL_H_
+#define MEMORY_BUFFERPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>
+    ///   Pool of large byte buffers that are allocated and freed often, e.g.
+    ///   for staging decoded images before upload. Safe to use from multiple
+    ///   threads.
+    /// </summary>
+    /// <remarks>
+    ///   Released buffers are kept for reuse until the total size of idle
+    ///   buffers exceeds a given limit, at which point the oldest are freed.
+    ///   A buffer is only handed out for requests of at least half its size
+    ///   so that small requests do not hold on to large buffers.
+    /// </remarks>
+    class BufferPool : private NonCopyable<BufferPool>
+    {
+    public:
+        /// <summary>
+        ///   Buffer borrowed from a pool. Returned to the pool on
+        ///   destruction.
+        /// </summary>
+        class Buffer : private NonCopyable<Buffer>
+        {
+        public:
+            Buffer() : pool_(nullptr), data_(nullptr), size_(0), capacity_(0)
+            {
+            }
+
+            Buffer(Buffer&& buffer) noexcept
+                : pool_(buffer.pool_), data_(buffer.data_),
+                  size_(buffer.size_), capacity_(buffer.capacity_)
+            {
+                buffer.pool_ = nullptr;
+                buffer.data_ = nullptr;
+                buffer.size_ = 0;
+                buffer.capacity_ = 0;
+            }
+
+            ~Buffer() { release(); }
+
+            auto data() const { return data_; }
+            auto size() const { return size_; }
+
+            /// <summary>Returns the buffer to its pool.</summary>
+            void release();
+
+            auto operator=(Buffer&& buffer) noexcept -> Buffer&;
+
+            explicit operator bool() const { return data_ != nullptr; }
+
+        private:
+            BufferPool* pool_;
+            uint8_t* data_;
+            size_t size_;
+            size_t capacity_;
+
+            Buffer(BufferPool* pool,
+                   uint8_t* data,
+                   size_t size,
+                   size_t capacity)
+                : pool_(pool), data_(data), size_(size), capacity_(capacity)
+            {
+            }
+
+            friend BufferPool;
+        };
+
+        /// <summary>Creates an empty pool.</summary>
+        /// <param name="max_idle_size">
+        ///   Maximum number of bytes kept in idle buffers.
+        /// </param>
+        explicit BufferPool(size_t max_idle_size);
+        ~BufferPool();
+
+        /// <summary>Returns the number of buffers waiting for reuse.</summary>
+        auto idle_count() const -> size_t;
+
+        /// <summary>
+        ///   Returns the total size, in bytes, of buffers waiting for reuse.
+        /// </summary>
+        auto idle_size() const -> size_t;
+
+        /// <summary>
+        ///   Returns a buffer of at least <paramref name="size"/> bytes,
+        ///   reusing an idle one if possible. Contents are undefined.
+        /// </summary>
+        auto acquire(size_t size) -> Buffer;
+
+        /// <summary>Frees all idle buffers.</summary>
+        void clear();
+
+    private:
+        struct Block
+        {
+            uint8_t* data;
+            size_t capacity;
+        };
+
+        const size_t max_idle_size_;
+        size_t idle_size_;
+        std::vector<Block> idle_;  ///< Idle buffers, oldest first.
+        mutable std::mutex mutex_;
+
+        void release(uint8_t* data, size_t capacity);
+    };
+
+    /// <summary>
+    ///   Returns the pool image decoders write into, and that decoded images
+    ///   are returned to once uploaded.
+    /// </summary>
+    auto staging_buffers() -> BufferPool&;
+}
+
+#endif
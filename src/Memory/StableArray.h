@@ -11,13 +11,17 @@
 
 #include "Common/Logging.h"
 #include "Common/NonCopyable.h"
-#include "Memory/TempBuffer.h"
 
 namespace rainbow
 {
     /// <summary>
     ///   A fixed-size, heap-allocated array whose indices are stable.
     /// </summary>
+    /// <remarks>
+    ///   Elements are accessed through iterators that are unaffected by
+    ///   rearranging the elements. The array keeps maps in both directions so
+    ///   that going from iterator to element, and back, are constant time.
+    /// </remarks>
     template <typename T>
     class StableArray : private NonCopyable<StableArray<T>>
     {
@@ -32,13 +36,14 @@ namespace rainbow
                 return ((bytes / align) + (bytes % align != 0)) * align;
             };
 
-            const size_t header_size =
-                aligned_sizeof(count * sizeof(size_type), alignof(value_type));
+            const size_t header_size = aligned_sizeof(
+                2 * count * sizeof(size_type), alignof(value_type));
             const size_t bytes = header_size + count * sizeof(value_type);
             auto ptr =
                 static_cast<uint8_t*>(::operator new(bytes, std::nothrow));
 
             indices_ = reinterpret_cast<size_type*>(ptr);
+            iterators_ = indices_ + count;
             data_ = reinterpret_cast<value_type*>(ptr + header_size);
 
             R_ASSERT(
@@ -47,12 +52,15 @@ namespace rainbow
 
             auto seq = [i = -1]() mutable noexcept -> size_type { return ++i; };
             std::generate_n(indices_, count, seq);
+            std::copy_n(indices_, count, iterators_);
         }
 
         StableArray(StableArray&& array) noexcept
-            : indices_(array.indices_), data_(array.data_), size_(array.size_)
+            : indices_(array.indices_), iterators_(array.iterators_),
+              data_(array.data_), size_(array.size_)
         {
             array.indices_ = nullptr;
+            array.iterators_ = nullptr;
             array.data_ = nullptr;
             array.size_ = 0;
         }
@@ -63,17 +71,21 @@ namespace rainbow
         auto data() const -> const value_type* { return data_; }
         auto size() const { return size_; }
 
+        /// <summary>
+        ///   Returns the iterator of the element at <paramref name="offset"/>
+        ///   in <see cref="data"/>, or <see cref="size"/> if out of bounds.
+        /// </summary>
         auto find_iterator(size_type offset) const
         {
-            for (size_type i = 0; i < size(); ++i)
-            {
-                if (index_of(i) == offset)
-                    return i;
-            }
-
-            return size();
+            return offset < size() ? iterators_[offset] : size();
         }
 
+        /// <summary>
+        ///   Moves <paramref name="element"/> to offset
+        ///   <paramref name="new_index"/>, shifting the elements in between
+        ///   one step towards its old offset. Existing iterators remain
+        ///   valid.
+        /// </summary>
         void move(size_type element, size_type new_index)
         {
             R_ASSERT(element < size(), "Index out of bounds");
@@ -83,20 +95,88 @@ namespace rainbow
             if (element_index == new_index)
                 return;
 
-            if (element_index < new_index)
+            // Rotate the element into place, then fix up the indices of
+            // every element that was shifted.
+            const auto first = std::min(element_index, new_index);
+            const auto last = std::max(element_index, new_index) + 1;
+            const auto middle =
+                element_index < new_index ? first + 1 : last - 1;
+            std::rotate(data_ + first, data_ + middle, data_ + last);
+            std::rotate(iterators_ + first,
+                        iterators_ + middle,
+                        iterators_ + last);
+            for (auto i = first; i < last; ++i)
+                indices_[iterators_[i]] = i;
+        }
+
+        /// <summary>
+        ///   Rearranges the first <paramref name="count"/> elements such that
+        ///   the element at offset <c>order[i]</c> ends up at offset
+        ///   <c>i</c>. Existing iterators remain valid.
+        /// </summary>
+        /// <param name="order">
+        ///   A permutation of [0, <paramref name="count"/>). It is used as
+        ///   scratch space and is left in an unspecified state.
+        /// </param>
+        /// <param name="count">Number of elements to rearrange.</param>
+        void reorder(size_type* order, size_type count)
+        {
+            R_ASSERT(count <= size(), "Index out of bounds");
+
+            // Follow each cycle of the permutation, moving every element
+            // exactly once. Offsets that are in place are marked as such.
+            for (size_type i = 0; i < count; ++i)
             {
-                const auto lower = element_index + 1;
-                rotate(element, lower, new_index, [lower](size_type i) {
-                    return i - lower;
-                });
+                if (order[i] == i)
+                    continue;
+
+                value_type value(std::move(data_[i]));
+                const size_type iterator = iterators_[i];
+                size_type j = i;
+                while (order[j] != i)
+                {
+                    const size_type k = order[j];
+                    data_[j] = std::move(data_[k]);
+                    iterators_[j] = iterators_[k];
+                    indices_[iterators_[j]] = j;
+                    order[j] = j;
+                    j = k;
+                }
+
+                data_[j] = std::move(value);
+                iterators_[j] = iterator;
+                indices_[iterator] = j;
+                order[j] = j;
             }
-            else
+        }
+
+        /// <summary>
+        ///   Grows the array to <paramref name="count"/> elements. Existing
+        ///   indices remain valid.
+        /// </summary>
+        /// <param name="count">New number of elements.</param>
+        /// <param name="live">
+        ///   Number of constructed elements, counted from the beginning of
+        ///   <see cref="data"/>, that will be moved to the new store.
+        /// </param>
+        void resize(size_type count, size_type live)
+        {
+            R_ASSERT(count >= size(), "StableArray cannot shrink");
+            R_ASSERT(live <= size(), "Index out of bounds");
+
+            StableArray array(count);
+            std::copy_n(indices_, size(), array.indices_);
+            std::copy_n(iterators_, size(), array.iterators_);
+            for (size_type i = 0; i < live; ++i)
             {
-                const auto upper = element_index - 1;
-                rotate(element, new_index, upper, [upper](size_type i) {
-                    return upper - i;
-                });
+                new (array.data_ + i) value_type(std::move(data_[i]));
+                data_[i].~value_type();
             }
+
+            std::swap(indices_, array.indices_);
+            std::swap(iterators_, array.iterators_);
+            std::swap(data_, array.data_);
+            std::swap(size_, array.size_);
         }
 
         void swap(size_type i, size_type j)
@@ -109,6 +189,8 @@ namespace rainbow
 
             std::swap(indices_[i], indices_[j]);
             std::swap(at(i), at(j));
+            iterators_[index_of(i)] = i;
+            iterators_[index_of(j)] = j;
         }
 
         auto operator[](size_type i) -> value_type& { return at(i); }
@@ -127,7 +209,8 @@ namespace rainbow
         }
 
     private:
-        size_type* indices_;
+        size_type* indices_;    ///< Maps iterators to offsets in |data_|.
+        size_type* iterators_;  ///< Maps offsets in |data_| to iterators.
         value_type* data_;
         size_type size_;
 
@@ -137,35 +220,6 @@ namespace rainbow
         {
             return indices_[element];
         }
-
-        template <typename F>
-        void rotate(size_type element,
-                    size_type lower,
-                    size_type upper,
-                    F&& ordered_index)
-        {
-            const size_type count = upper - lower + 1;
-
-            std::unique_ptr<size_type[]> scoped_buffer;
-            size_type* sorted_indices = get_temp_buffer<size_type>(count);
-            if (sorted_indices == nullptr)
-            {
-                scoped_buffer = std::make_unique<size_type[]>(count);
-                sorted_indices = scoped_buffer.get();
-            }
-
-            for (size_type i = 0; i < size(); ++i)
-            {
-                const auto j = index_of(i);
-                if (j < lower || j > upper)
-                    continue;
-
-                sorted_indices[ordered_index(j)] = i;
-            }
-
-            auto rotate = [this, element](size_type i) { swap(element, i); };
-            std::for_each(sorted_indices, sorted_indices + count, rotate);
-        }
     };
 }
 
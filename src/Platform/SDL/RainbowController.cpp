@@ -7,6 +7,7 @@
 #include <SDL.h>
 
 #include "Config.h"
+#include "Graphics/TextureManager.h"
 #include "Input/Controller.h"
 #include "Input/Pointer.h"
 #include "Platform/SDL/Context.h"
@@ -15,6 +16,7 @@ using rainbow::Config;
 using rainbow::RainbowController;
 using rainbow::SDLContext;
 using rainbow::Vec2i;
+using rainbow::graphics::TextureManager;
 
 namespace
 {
@@ -58,6 +60,9 @@ RainbowController::RainbowController(SDLContext& context, const Config& config)
     for (int i = 0; i < SDL_NumJoysticks(); ++i)
         on_controller_connected(i);
 
+    TextureManager::Get()->set_image_compression(config.texture_compression());
+    director_.set_parallel_update(config.parallel_update());
+
     director_.init(context_.drawable_size());
     on_window_resized();
 
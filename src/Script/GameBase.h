@@ -75,6 +75,7 @@ namespace rainbow
         virtual ~GameBase() {}
 
         auto input() -> Input& { return director_.input(); }
+        auto mixer() -> audio::Mixer& { return director_.mixer(); }
 
         auto render_queue() -> graphics::RenderQueue&
         {
@@ -22,7 +22,7 @@ auto create_font(lua_State* L, ScopeStack& stack) -> Prose::Asset
         return Prose::Asset::none();
     }
 
-    auto font = stack.allocate<FontAtlas>(data, pt);
+    auto font = stack.allocate<FontAtlas>(path, data, pt);
     if (!font->is_valid())
     {
         LOGE(kProseFailedLoading, kKeyFont, path);
@@ -2,6 +2,8 @@
 // Distributed under the MIT License.
 // (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "Audio/Mixer.h"
@@ -35,6 +37,14 @@ namespace
         }
     };
 
+    struct Compressed
+    {
+        auto load() const
+        {
+            return rainbow::audio::load_compressed(kAudioTestFile);
+        }
+    };
+
     template <typename T>
     class AudioTest : public testing::Test
     {
@@ -55,7 +65,7 @@ namespace
     };
 }
 
-using AudioSoundTypes = ::testing::Types<Static, Stream>;
+using AudioSoundTypes = ::testing::Types<Static, Stream, Compressed>;
 TYPED_TEST_CASE(AudioTest, AudioSoundTypes);
 
 TYPED_TEST(AudioTest, ControlsChannelPlayback)
@@ -101,7 +111,7 @@ TYPED_TEST(AudioTest, ControlsChannelPlayback)
     ASSERT_PRED1(not_playing, channel);
 }
 
-#ifdef RAINBOW_AUDIO_AL
+#if defined(RAINBOW_AUDIO_AL) || defined(RAINBOW_AUDIO_SOFTWARE)
 TYPED_TEST(AudioTest, ReusesChannels)
 {
     auto channel = rainbow::audio::play(this->sound_);
@@ -127,7 +137,7 @@ TYPED_TEST(AudioTest, ReusesSounds)
     ASSERT_EQ(this->sound_, this->sound_type_.load());
     rainbow::audio::release(this->sound_);
 }
-#endif  // RAINBOW_AUDIO_AL
+#endif  // RAINBOW_AUDIO_AL || RAINBOW_AUDIO_SOFTWARE
 
 TYPED_TEST(AudioTest, StopsPlaybackWhenSoundIsReleased)
 {
@@ -211,3 +221,68 @@ TEST(AudioTest, CanPlaySingleSoundOnMultipleChannels)
         ASSERT_PRED1(not_playing, channel);
     }
 }
+
+#ifdef RAINBOW_AUDIO_AL
+TEST(AudioTest, VirtualisesChannelsBeyondAvailableVoices)
+{
+    constexpr int kNumVoices = 2;
+
+    Mixer mixer_;
+    ASSERT_TRUE(mixer_.initialize(kNumVoices));
+    auto sound = rainbow::audio::load_sound(kAudioTestFile);
+
+    Channel* channels[kNumVoices + 1];
+    for (auto&& channel : channels)
+    {
+        channel = rainbow::audio::play(sound);
+        ASSERT_NE(nullptr, channel);
+        rainbow::audio::set_loop_count(channel, -1);
+    }
+
+    auto stats = mixer_.voice_stats();
+    ASSERT_EQ(2u, stats.real);
+    ASSERT_EQ(1u, stats.virtualised);
+
+    // Virtual channels are still considered playing.
+    for (auto&& channel : channels)
+        ASSERT_PRED1(rainbow::audio::is_playing, channel);
+
+    // Stopping a real channel frees its voice for the virtual one.
+    rainbow::audio::stop(channels[0]);
+    mixer_.process();
+
+    stats = mixer_.voice_stats();
+    ASSERT_EQ(2u, stats.real);
+    ASSERT_EQ(0u, stats.virtualised);
+
+    rainbow::audio::release(sound);
+}
+
+TEST(AudioTest, StealsLowestPriorityChannel)
+{
+    Mixer mixer_;
+    ASSERT_TRUE(mixer_.initialize(1));
+    auto sound = rainbow::audio::load_sound(kAudioTestFile);
+
+    std::vector<Channel*> channels;
+    while (true)
+    {
+        auto channel = rainbow::audio::play(sound);
+        if (channel == nullptr)
+            break;
+
+        rainbow::audio::set_loop_count(channel, -1);
+        rainbow::audio::set_priority(channel, 1);
+        channels.push_back(channel);
+    }
+
+    ASSERT_FALSE(channels.empty());
+    ASSERT_EQ(0u, mixer_.voice_stats().stolen);
+
+    rainbow::audio::set_priority(channels.back(), 0);
+    ASSERT_EQ(channels.back(), rainbow::audio::play(sound));
+    ASSERT_EQ(1u, mixer_.voice_stats().stolen);
+
+    rainbow::audio::release(sound);
+}
+#endif  // RAINBOW_AUDIO_AL
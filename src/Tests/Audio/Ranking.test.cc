@@ -0,0 +1,121 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifdef RAINBOW_AUDIO_AL
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Audio/AL/Ranking.h"
+
+using rainbow::Vec2f;
+using rainbow::audio::Channel;
+
+namespace
+{
+    auto make_channel(float distance, int source, int priority = 0)
+    {
+        Channel channel;
+        channel.state = Channel::State::Playing;
+        channel.source = source;
+        channel.priority = priority;
+        channel.world_position = Vec2f{0.0f, distance};
+        return channel;
+    }
+}
+
+TEST(RankingTest, AttenuatesByDistance)
+{
+    Channel channel = make_channel(0.0f, 0);
+    channel.volume = 0.5f;
+
+    ASSERT_FLOAT_EQ(0.5f, rainbow::audio::get_audibility(channel));
+
+    channel.world_position = Vec2f{0.6f, 0.8f};
+
+    ASSERT_FLOAT_EQ(0.5f, rainbow::audio::get_audibility(channel));
+
+    channel.world_position = Vec2f{3.0f, 4.0f};
+
+    ASSERT_FLOAT_EQ(0.1f, rainbow::audio::get_audibility(channel));
+
+    channel.state = Channel::State::Paused;
+
+    ASSERT_FLOAT_EQ(0.0f, rainbow::audio::get_audibility(channel));
+}
+
+TEST(RankingTest, RanksByPriorityThenAudibility)
+{
+    const Channel near = make_channel(1.0f, 0);
+    const Channel far = make_channel(10.0f, 1);
+    const Channel important = make_channel(100.0f, 2, 1);
+
+    ASSERT_TRUE(rainbow::audio::outranks(near, far));
+    ASSERT_FALSE(rainbow::audio::outranks(far, near));
+    ASSERT_FALSE(rainbow::audio::outranks(near, near));
+    ASSERT_TRUE(rainbow::audio::outranks(important, near));
+    ASSERT_FALSE(rainbow::audio::outranks(near, important));
+}
+
+TEST(RankingTest, StealsLowestRankingChannel)
+{
+    std::vector<Channel> channels{make_channel(1.0f, 0),
+                                  make_channel(10.0f, Channel::kVirtual),
+                                  make_channel(100.0f, 1, 1)};
+
+    ASSERT_EQ(&channels[1], rainbow::audio::find_steal_victim(channels));
+
+    channels[1].priority = -1;
+    channels[1].world_position = Vec2f::Zero;
+
+    ASSERT_EQ(&channels[1], rainbow::audio::find_steal_victim(channels));
+
+    // Channels with raised priority are never stolen.
+    for (auto&& channel : channels)
+        channel.priority = 1;
+
+    ASSERT_EQ(nullptr, rainbow::audio::find_steal_victim(channels));
+
+    std::vector<Channel> none;
+
+    ASSERT_EQ(nullptr, rainbow::audio::find_steal_victim(none));
+}
+
+TEST(RankingTest, PromotesLoudestVirtualChannel)
+{
+    std::vector<Channel> channels{make_channel(1.0f, 0),
+                                  make_channel(20.0f, 1),
+                                  make_channel(10.0f, Channel::kVirtual),
+                                  make_channel(5.0f, Channel::kVirtual),
+                                  make_channel(50.0f, Channel::kVirtual)};
+    channels[3].state = Channel::State::Paused;
+
+    auto promotion = rainbow::audio::find_promotion(channels, true);
+
+    ASSERT_EQ(&channels[2], promotion.channel);
+    ASSERT_EQ(nullptr, promotion.victim);
+
+    promotion = rainbow::audio::find_promotion(channels, false);
+
+    ASSERT_EQ(&channels[2], promotion.channel);
+    ASSERT_EQ(&channels[1], promotion.victim);
+
+    // Virtual channels that do not outrank any real channel stay virtual.
+    channels[2].world_position = Vec2f{0.0f, 30.0f};
+    promotion = rainbow::audio::find_promotion(channels, false);
+
+    ASSERT_EQ(nullptr, promotion.channel);
+    ASSERT_EQ(nullptr, promotion.victim);
+
+    // Stopped channels are ignored altogether.
+    channels[1].state = Channel::State::Stopped;
+    channels[2].state = Channel::State::Stopped;
+    channels[4].state = Channel::State::Stopped;
+    promotion = rainbow::audio::find_promotion(channels, true);
+
+    ASSERT_EQ(nullptr, promotion.channel);
+}
+
+#endif  // RAINBOW_AUDIO_AL
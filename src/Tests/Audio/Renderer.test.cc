@@ -0,0 +1,281 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Audio/Software/Renderer.h"
+#include "Audio/Software/Sink.h"
+#include "Tests/Benchmark.h"
+
+using rainbow::audio::IAudioFile;
+using rainbow::audio::NullSink;
+using rainbow::audio::Renderer;
+using rainbow::audio::Voice;
+using rainbow::test::measure;
+
+namespace
+{
+    constexpr int kRate = 44100;
+
+    /// <summary>Streams a sequence of 16-bit mono samples.</summary>
+    class PcmStream final : public IAudioFile
+    {
+    public:
+        explicit PcmStream(std::vector<int16_t> samples)
+            : samples_(std::move(samples)), offset_(0) {}
+
+        // IAudioFile implementation.
+
+        auto channels() const -> int override { return 1; }
+        auto rate() const -> int override { return kRate; }
+
+        void rewind() override { offset_ = 0; }
+        void seek_frame(size_t frame) override { offset_ = frame; }
+
+        // IFile implementation.
+
+        auto size() const -> size_t override
+        {
+            return samples_.size() * sizeof(int16_t);
+        }
+
+        auto read(void* dst, size_t size) -> size_t override
+        {
+            // Hand out odd sizes to exercise partial reads.
+            const size_t count = std::min({size / sizeof(int16_t),
+                                           samples_.size() - offset_,
+                                           size_t{999}});
+            const size_t length = count * sizeof(int16_t);
+            std::memcpy(dst, samples_.data() + offset_, length);
+            offset_ += count;
+            return length;
+        }
+
+        auto seek(int64_t, int) -> int override { return 0; }
+        auto write(const void*, size_t) -> size_t override { return 0; }
+        /*explicit*/ operator bool() const override { return true; }
+
+    private:
+        std::vector<int16_t> samples_;
+        size_t offset_;
+    };
+
+    auto make_ramp(size_t frames, int channels)
+    {
+        std::vector<int16_t> pcm(frames * channels);
+        for (size_t i = 0; i < pcm.size(); ++i)
+            pcm[i] = static_cast<int16_t>((i / channels) * 7 % 20000 - 10000);
+        return pcm;
+    }
+
+    auto render(Renderer& renderer, Voice& voice, size_t frames)
+    {
+        std::vector<int16_t> out(frames * 2, 1);
+        Voice* voices[]{&voice};
+        renderer.render(voices, 1, out.data(), frames);
+        return out;
+    }
+}
+
+TEST(RendererTest, OutputsSilenceWithoutVoices)
+{
+    Renderer renderer(kRate);
+    std::vector<int16_t> out(1000, 1);
+    renderer.render(nullptr, 0, out.data(), out.size() / 2);
+    for (auto sample : out)
+        ASSERT_EQ(0, sample);
+}
+
+TEST(RendererTest, PlaysStereoVoiceUnchanged)
+{
+    const auto pcm = make_ramp(1000, 2);
+
+    Renderer renderer(kRate);
+    Voice voice;
+    voice.play(pcm.data(), 1000, 2, kRate);
+    const auto out = render(renderer, voice, 999);
+
+    for (size_t i = 0; i < out.size(); ++i)
+        ASSERT_NEAR(pcm[i], out[i], 1);
+}
+
+TEST(RendererTest, PansMonoVoices)
+{
+    const std::vector<int16_t> pcm(100, 16384);
+
+    Renderer renderer(kRate);
+    Voice voice;
+    voice.play(pcm.data(), pcm.size(), 1, kRate);
+    auto out = render(renderer, voice, 50);
+
+    // Centred voices are played at equal power.
+    for (size_t i = 0; i < out.size(); ++i)
+        ASSERT_NEAR(11585, out[i], 1);
+
+    voice.play(pcm.data(), pcm.size(), 1, kRate);
+    voice.world_position = {1.0f, 0.0f};
+    out = render(renderer, voice, 50);
+
+    for (size_t i = 0; i < out.size(); i += 2)
+    {
+        ASSERT_NEAR(0, out[i], 1);
+        ASSERT_NEAR(16384, out[i + 1], 1);
+    }
+
+    // Voices are attenuated beyond one unit.
+    voice.play(pcm.data(), pcm.size(), 1, kRate);
+    voice.world_position = {-4.0f, 0.0f};
+    out = render(renderer, voice, 50);
+
+    for (size_t i = 0; i < out.size(); i += 2)
+    {
+        ASSERT_NEAR(4096, out[i], 1);
+        ASSERT_NEAR(0, out[i + 1], 1);
+    }
+}
+
+TEST(RendererTest, ClipsLoudMixes)
+{
+    const std::vector<int16_t> loud(200, 30000);
+    const std::vector<int16_t> quiet(200, -30000);
+
+    Renderer renderer(kRate);
+    Voice a;
+    Voice b;
+    a.play(loud.data(), 100, 2, kRate);
+    b.play(loud.data(), 100, 2, kRate);
+
+    std::vector<int16_t> out(100);
+    Voice* voices[]{&a, &b};
+    renderer.render(voices, 2, out.data(), 50);
+    for (auto sample : out)
+        ASSERT_EQ(32767, sample);
+
+    a.play(quiet.data(), 100, 2, kRate);
+    b.play(quiet.data(), 100, 2, kRate);
+    renderer.render(voices, 2, out.data(), 50);
+    for (auto sample : out)
+        ASSERT_EQ(-32767, sample);
+}
+
+TEST(RendererTest, StopsVoicesThatEnd)
+{
+    const std::vector<int16_t> pcm(200, 16384);
+
+    Renderer renderer(kRate);
+    Voice voice;
+    voice.play(pcm.data(), 100, 2, kRate);
+    const auto out = render(renderer, voice, 300);
+
+    ASSERT_FALSE(voice.playing);
+    ASSERT_NEAR(16384, out[98 * 2], 1);
+    ASSERT_EQ(0, out[100 * 2]);
+    ASSERT_EQ(0, out.back());
+}
+
+TEST(RendererTest, LoopsVoices)
+{
+    const std::vector<int16_t> pcm(200, 16384);
+
+    Renderer renderer(kRate);
+    Voice voice;
+    voice.play(pcm.data(), 100, 2, kRate);
+    voice.loop_count = 2;
+    const auto out = render(renderer, voice, 400);
+
+    ASSERT_FALSE(voice.playing);
+    ASSERT_EQ(0, voice.loop_count);
+    ASSERT_NEAR(16384, out[250 * 2], 1);
+    ASSERT_EQ(0, out[350 * 2]);
+
+    voice.play(pcm.data(), 100, 2, kRate);
+    voice.loop_count = -1;
+    render(renderer, voice, 10000);
+
+    ASSERT_TRUE(voice.playing);
+}
+
+TEST(RendererTest, ResamplesToOutputRate)
+{
+    const auto pcm = make_ramp(1000, 2);
+
+    Renderer renderer(kRate);
+    Voice voice;
+    voice.play(pcm.data(), 1000, 2, kRate / 2);
+    const auto out = render(renderer, voice, 1998);
+
+    for (size_t i = 0; i < 999; ++i)
+    {
+        for (size_t c = 0; c < 2; ++c)
+        {
+            const int a = pcm[i * 2 + c];
+            const int b = pcm[(i + 1) * 2 + c];
+            ASSERT_NEAR(a, out[i * 4 + c], 1);
+            ASSERT_NEAR((a + b) / 2, out[i * 4 + 2 + c], 1);
+        }
+    }
+}
+
+TEST(RendererTest, StreamsSeamlessly)
+{
+    const size_t kFrames = Voice::kStreamBufferFrames * 3 + 123;
+    const auto pcm = make_ramp(kFrames, 1);
+
+    PcmStream stream(pcm);
+    Renderer renderer(kRate);
+    Voice voice;
+    voice.play(&stream);
+    voice.world_position = {1.0f, 0.0f};
+    const auto out = render(renderer, voice, kFrames);
+
+    ASSERT_FALSE(voice.playing);
+    for (size_t i = 0; i + 1 < kFrames; ++i)
+        ASSERT_NEAR(pcm[i], out[i * 2 + 1], 1) << "at frame " << i;
+}
+
+// Measures how long it takes to mix one second of audio with an increasing
+// number of voices.
+TEST(DISABLED_RendererBenchmark, Mix)
+{
+    constexpr size_t kUpdateFrames = kRate / 60;
+
+    const auto pcm = make_ramp(48000, 2);
+    std::vector<int16_t> out(kUpdateFrames * 2);
+    for (size_t count : {1, 24, 128, 512})
+    {
+        std::vector<Voice> voices(count);
+        std::vector<Voice*> pointers;
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Mix of rates so that resampling is exercised.
+            voices[i].play(pcm.data(), 48000, 2, i % 2 == 0 ? 48000 : 22050);
+            voices[i].loop_count = -1;
+            voices[i].world_position = {i % 3 - 1.0f, 0.0f};
+            pointers.push_back(&voices[i]);
+        }
+
+        Renderer renderer(kRate);
+        NullSink sink(kRate, kUpdateFrames);
+        const auto elapsed = measure<std::chrono::microseconds>([&] {
+            while (sink.frames_written() < static_cast<size_t>(kRate))
+            {
+                renderer.render(pointers.data(),
+                                pointers.size(),
+                                out.data(),
+                                kUpdateFrames);
+                sink.write(out.data(), sink.available());
+            }
+        });
+
+        printf("%3zu voices: %8.3f ms per second of audio (%.0fx realtime)\n",
+               count,
+               elapsed / 1000.0,
+               1e6 / elapsed);
+    }
+}
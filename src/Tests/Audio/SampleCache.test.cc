@@ -0,0 +1,265 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Platform/Macros.h"
+#if defined(RAINBOW_AUDIO_AL) || defined(RAINBOW_AUDIO_SOFTWARE)
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Audio/SampleCache.h"
+#include "FileSystem/File.h"
+#include "FileSystem/FileSystem.h"
+
+using rainbow::File;
+using rainbow::audio::IAudioFile;
+using rainbow::audio::SampleCache;
+using rainbow::audio::Samples;
+using rainbow::czstring;
+using rainbow::filesystem::Path;
+
+namespace
+{
+    constexpr char kSampleCacheTestPath[] = "rainbow-test-sample-cache";
+    constexpr int kRate = 8000;
+
+    std::atomic<int> g_open_count{0};
+
+    /// <summary>Treats any file as raw 16-bit mono samples.</summary>
+    class RawAudioFile final : public IAudioFile
+    {
+    public:
+        explicit RawAudioFile(czstring path) : file_(File::open_asset(path))
+        {
+        }
+
+        // IAudioFile implementation.
+
+        auto channels() const -> int override { return 1; }
+        auto rate() const -> int override { return kRate; }
+
+        void rewind() override { file_.seek(0, SEEK_SET); }
+        void seek_frame(size_t frame) override
+        {
+            file_.seek(frame * sizeof(int16_t), SEEK_SET);
+        }
+
+        // IFile implementation.
+
+        auto size() const -> size_t override { return file_.size(); }
+
+        auto read(void* dst, size_t size) -> size_t override
+        {
+            return file_.read(dst, size);
+        }
+
+        auto seek(int64_t offset, int origin) -> int override
+        {
+            return file_.seek(offset, origin);
+        }
+
+        auto write(const void*, size_t) -> size_t override { return 0; }
+        /*explicit*/ operator bool() const override
+        {
+            return file_.is_open();
+        }
+
+    private:
+        File file_;
+    };
+
+    auto open_raw(czstring path) -> std::unique_ptr<IAudioFile>
+    {
+        ++g_open_count;
+        return std::make_unique<RawAudioFile>(path);
+    }
+
+    class SampleCacheTest : public testing::Test
+    {
+    public:
+        SampleCacheTest()
+            : cache_(&open_raw),
+              assets_path_(rainbow::filesystem::assets_path())
+        {
+        }
+
+        void SetUp() override
+        {
+            g_open_count = 0;
+
+            std::error_code error;
+            directory_ = rainbow::filesystem::relative(kSampleCacheTestPath);
+            rainbow::filesystem::create_directories(directory_, error);
+            rainbow::filesystem::set_assets_path(directory_.c_str());
+        }
+
+        void TearDown() override
+        {
+            std::error_code error;
+            for (auto&& file : files_)
+                rainbow::filesystem::remove(file.c_str(), error);
+            rainbow::filesystem::remove(directory_, error);
+            rainbow::filesystem::set_assets_path(assets_path_.c_str());
+        }
+
+    protected:
+        SampleCache cache_;
+
+        /// <summary>
+        ///   Writes <paramref name="frames"/> samples, all set to
+        ///   <paramref name="value"/>, to <paramref name="name"/>.
+        /// </summary>
+        void write(czstring name, size_t frames, int16_t value)
+        {
+            auto path = directory_;
+            path /= name;
+            files_.push_back(path.string());
+
+            const std::vector<int16_t> pcm(frames, value);
+            FILE* fd = fopen(path.c_str(), "wb");
+            [fd] { ASSERT_NE(nullptr, fd); }();
+            fwrite(pcm.data(), sizeof(pcm[0]), pcm.size(), fd);
+            fclose(fd);
+        }
+
+    private:
+        Path directory_;
+        std::string assets_path_;
+        std::vector<std::string> files_;
+    };
+}
+
+TEST_F(SampleCacheTest, DecodesFiles)
+{
+    write("a.raw", 100, 1000);
+
+    auto samples = cache_.acquire("a.raw");
+
+    ASSERT_TRUE(samples);
+    ASSERT_EQ(1, samples->channels);
+    ASSERT_EQ(kRate, samples->rate);
+    ASSERT_EQ(100u, samples->frames());
+    ASSERT_EQ(200u, samples->size);
+    ASSERT_EQ(200u, cache_.size());
+    for (auto sample : samples->pcm)
+        ASSERT_EQ(1000, sample);
+}
+
+TEST_F(SampleCacheTest, ReturnsNothingForMissingFiles)
+{
+    ASSERT_FALSE(cache_.acquire("missing.raw"));
+    ASSERT_EQ(0u, cache_.count());
+}
+
+TEST_F(SampleCacheTest, DeduplicatesIdenticalFiles)
+{
+    write("a.raw", 100, 1000);
+    write("b.raw", 100, 1000);
+    write("c.raw", 100, 2000);
+
+    auto a = cache_.acquire("a.raw");
+    auto b = cache_.acquire("b.raw");
+    auto c = cache_.acquire("c.raw");
+
+    ASSERT_EQ(a.get(), b.get());
+    ASSERT_NE(a.get(), c.get());
+    ASSERT_EQ(2, g_open_count);
+    ASSERT_EQ(2u, cache_.count());
+    ASSERT_EQ(400u, cache_.size());
+
+    ASSERT_EQ(a.get(), cache_.acquire("a.raw").get());
+    ASSERT_EQ(2, g_open_count);
+}
+
+TEST_F(SampleCacheTest, EvictsLeastRecentlyUsedWhenOverBudget)
+{
+    write("a.raw", 100, 1);
+    write("b.raw", 100, 2);
+    write("c.raw", 100, 3);
+
+    std::vector<int16_t> evicted;
+    cache_.set_evictor(
+        [&evicted](Samples& samples) { evicted.push_back(samples.pcm[0]); });
+    cache_.set_budget(400);
+
+    Samples* a = cache_.acquire("a.raw").get();
+    cache_.acquire("b.raw");
+    cache_.acquire("a.raw");
+
+    ASSERT_EQ(400u, cache_.size());
+    ASSERT_TRUE(evicted.empty());
+
+    // b.raw was used less recently than a.raw
+    cache_.acquire("c.raw");
+
+    ASSERT_EQ(1u, evicted.size());
+    ASSERT_EQ(2, evicted[0]);
+    ASSERT_EQ(400u, cache_.size());
+    ASSERT_EQ(a, cache_.acquire("a.raw").get());
+    ASSERT_EQ(3, g_open_count);
+
+    cache_.acquire("b.raw");
+
+    ASSERT_EQ(4, g_open_count);
+}
+
+TEST_F(SampleCacheTest, NeverEvictsSamplesInUse)
+{
+    write("a.raw", 100, 1);
+    write("b.raw", 100, 2);
+
+    cache_.set_budget(0);
+
+    auto a = cache_.acquire("a.raw");
+    auto b = cache_.acquire("b.raw");
+
+    ASSERT_EQ(2u, cache_.count());
+    ASSERT_EQ(400u, cache_.size());
+
+    a.reset();
+    cache_.trim();
+
+    ASSERT_EQ(1u, cache_.count());
+    ASSERT_EQ(200u, cache_.size());
+
+    b.reset();
+    cache_.trim();
+
+    ASSERT_EQ(0u, cache_.count());
+    ASSERT_EQ(0u, cache_.size());
+}
+
+TEST_F(SampleCacheTest, PreloadsFilesInParallel)
+{
+    write("a.raw", 1000, 1);
+    write("b.raw", 1000, 1);
+    write("c.raw", 1000, 2);
+    write("d.raw", 1000, 3);
+
+    cache_.acquire("d.raw");
+
+    ASSERT_EQ(1, g_open_count);
+
+    const czstring paths[]{
+        "a.raw", "b.raw", "c.raw", "d.raw", "missing.raw"};
+    cache_.preload(paths);
+
+    // a.raw and b.raw may have been decoded concurrently, but are only kept
+    // once.
+    ASSERT_LE(3, g_open_count);
+    ASSERT_GE(4, g_open_count);
+    ASSERT_EQ(3u, cache_.count());
+    ASSERT_EQ(6000u, cache_.size());
+
+    const int open_count = g_open_count;
+    ASSERT_EQ(cache_.acquire("a.raw").get(), cache_.acquire("b.raw").get());
+    ASSERT_TRUE(cache_.acquire("c.raw"));
+    ASSERT_EQ(open_count, g_open_count);
+}
+
+#endif  // RAINBOW_AUDIO_AL || RAINBOW_AUDIO_SOFTWARE
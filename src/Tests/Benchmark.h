@@ -0,0 +1,62 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef TESTS_BENCHMARK_H_
+#define TESTS_BENCHMARK_H_
+
+#include <chrono>
+#include <utility>
+
+/// <summary>
+///   Benchmarks are kept in their own test suites, named after the unit
+///   under test with a <c>DISABLED_</c> prefix and a <c>Benchmark</c> suffix,
+///   so that they never run with the correctness tests. Run them with
+///   <c>--gtest_filter=*Benchmark* --gtest_also_run_disabled_tests</c>.
+/// </summary>
+namespace rainbow { namespace test
+{
+    /// <summary>Accumulates the time spent in timed sections.</summary>
+    template <typename Duration = std::chrono::nanoseconds>
+    class Stopwatch
+    {
+    public:
+        /// <summary>Returns the accumulated time.</summary>
+        auto elapsed() const
+        {
+            return static_cast<long long>(
+                std::chrono::duration_cast<Duration>(elapsed_).count());
+        }
+
+        /// <summary>Resets the accumulated time.</summary>
+        void reset() { elapsed_ = {}; }
+
+        /// <summary>
+        ///   Calls <paramref name="f"/>, adding the time it takes to the
+        ///   accumulated time.
+        /// </summary>
+        template <typename F>
+        void time(F&& f)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            std::forward<F>(f)();
+            elapsed_ += std::chrono::steady_clock::now() - start;
+        }
+
+    private:
+        std::chrono::steady_clock::duration elapsed_{};
+    };
+
+    /// <summary>
+    ///   Returns the time it takes to call <paramref name="f"/>.
+    /// </summary>
+    template <typename Duration = std::chrono::nanoseconds, typename F>
+    auto measure(F&& f)
+    {
+        Stopwatch<Duration> stopwatch;
+        stopwatch.time(std::forward<F>(f));
+        return stopwatch.elapsed();
+    }
+}}  // namespace rainbow::test
+
+#endif
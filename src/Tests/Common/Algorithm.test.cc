@@ -118,6 +118,17 @@ TEST(AlgorithmTest, RoundsDownToNearestPowerOfTwo)
     }
 }
 
+TEST(AlgorithmTest, HashesWithFNV1a)
+{
+    ASSERT_EQ(rainbow::kFnv1aOffsetBasis, rainbow::fnv1a("", 0));
+    ASSERT_EQ(0xaf63dc4c8601ec8cull, rainbow::fnv1a("a", 1));
+    ASSERT_EQ(0x85944171f73967e8ull, rainbow::fnv1a("foobar", 6));
+
+    // Hashing in chunks gives the same result.
+    ASSERT_EQ(rainbow::fnv1a("foobar", 6),
+              rainbow::fnv1a("bar", 3, rainbow::fnv1a("foo", 3)));
+}
+
 TEST(AlgorithmTest, ApproximatesZeroFloat)
 {
     auto definitely_not_zero = rainbow::test::not_fn(rainbow::is_almost_zero);
@@ -0,0 +1,314 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Graphics/BlockCompression.h"
+#include "Tests/Benchmark.h"
+#include "Threading/ThreadPool.h"
+
+using rainbow::BlockFormat;
+using rainbow::ThreadPool;
+using rainbow::test::measure;
+
+namespace
+{
+    void unpack_565(uint16_t c, int (&rgb)[3])
+    {
+        const int r = (c >> 11) & 0x1f;
+        const int g = (c >> 5) & 0x3f;
+        const int b = c & 0x1f;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    void decode_color(const uint8_t* block, bool bc1, uint8_t (&out)[16][4])
+    {
+        const uint16_t c0 = block[0] | (block[1] << 8);
+        const uint16_t c1 = block[2] | (block[3] << 8);
+
+        const bool is_opaque = !bc1 || c0 > c1;
+
+        int palette[4][3];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (int i = 0; i < 3; ++i)
+        {
+            if (is_opaque)
+            {
+                palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+                palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+            }
+            else
+            {
+                palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+                palette[3][i] = 0;
+            }
+        }
+
+        for (int p = 0; p < 16; ++p)
+        {
+            const int index = (block[4 + p / 4] >> ((p % 4) * 2)) & 3;
+            for (int i = 0; i < 3; ++i)
+                out[p][i] = static_cast<uint8_t>(palette[index][i]);
+            out[p][3] = is_opaque || index < 3 ? 0xff : 0x00;
+        }
+    }
+
+    void decode_alpha(const uint8_t* block, uint8_t (&out)[16][4])
+    {
+        const int a0 = block[0];
+        const int a1 = block[1];
+        int palette[8]{a0, a1};
+        for (int i = 2; i < 8; ++i)
+        {
+            palette[i] = a0 > a1 ? ((8 - i) * a0 + (i - 1) * a1) / 7
+                                 : i < 6 ? ((6 - i) * a0 + (i - 1) * a1) / 5
+                                         : i == 6 ? 0 : 255;
+        }
+
+        uint64_t indices = 0;
+        for (int i = 0; i < 6; ++i)
+            indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+        for (int p = 0; p < 16; ++p)
+            out[p][3] = static_cast<uint8_t>(palette[(indices >> (p * 3)) & 7]);
+    }
+
+    /// <summary>Decompresses BC1 or BC3 blocks into an RGBA8 image.</summary>
+    auto decompress(BlockFormat format,
+                    const uint8_t* blocks,
+                    uint32_t width,
+                    uint32_t height)
+    {
+        std::vector<uint8_t> rgba(width * height * 4);
+        const uint32_t blocks_x = (width + 3) / 4;
+        const uint32_t blocks_y = (height + 3) / 4;
+        for (uint32_t by = 0; by < blocks_y; ++by)
+        {
+            for (uint32_t bx = 0; bx < blocks_x; ++bx)
+            {
+                uint8_t pixels[16][4];
+                if (format == BlockFormat::BC3)
+                {
+                    decode_color(blocks + 8, false, pixels);
+                    decode_alpha(blocks, pixels);
+                    blocks += 16;
+                }
+                else
+                {
+                    decode_color(blocks, true, pixels);
+                    blocks += 8;
+                }
+
+                for (uint32_t p = 0; p < 16; ++p)
+                {
+                    const uint32_t x = bx * 4 + p % 4;
+                    const uint32_t y = by * 4 + p / 4;
+                    if (x < width && y < height)
+                        std::copy_n(pixels[p], 4, &rgba[(y * width + x) * 4]);
+                }
+            }
+        }
+        return rgba;
+    }
+
+    /// <summary>
+    ///   Returns an image of smooth gradients with a little noise, resembling
+    ///   typical sprite art more than pure noise does.
+    /// </summary>
+    auto make_image(uint32_t width, uint32_t height, bool transparent)
+    {
+        std::vector<uint8_t> rgba(width * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint8_t* pixel = &rgba[(y * width + x) * 4];
+                const uint32_t noise = (x * 7 + y * 13) % 8;
+                pixel[0] = static_cast<uint8_t>(x * 247 / width + noise);
+                pixel[1] = static_cast<uint8_t>(y * 247 / height + noise);
+                pixel[2] = static_cast<uint8_t>((x + y) * 127 / width);
+                pixel[3] = transparent ? static_cast<uint8_t>(x * 255 / width)
+                                       : 0xff;
+            }
+        }
+        return rgba;
+    }
+
+    /// <summary>
+    ///   Returns the peak signal-to-noise ratio over channels [<paramref
+    ///   name="first"/>, <paramref name="last"/>).
+    /// </summary>
+    auto psnr(const std::vector<uint8_t>& a,
+              const std::vector<uint8_t>& b,
+              int first,
+              int last)
+    {
+        double error = 0.0;
+        for (size_t i = 0; i < a.size(); i += 4)
+        {
+            for (int j = first; j < last; ++j)
+                error += std::pow(a[i + j] - b[i + j], 2.0);
+        }
+        const double mse = error / (a.size() / 4 * (last - first));
+        return mse == 0.0 ? 100.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+    }
+
+    auto compress(BlockFormat format,
+                  const std::vector<uint8_t>& rgba,
+                  uint32_t width,
+                  uint32_t height,
+                  ThreadPool* pool = nullptr)
+    {
+        std::vector<uint8_t> blocks(
+            rainbow::block_compressed_size(format, width, height));
+        rainbow::compress_blocks(
+            format, rgba.data(), width, height, blocks.data(), pool);
+        return blocks;
+    }
+}
+
+TEST(BlockCompressionTest, ComputesCompressedSize)
+{
+    ASSERT_EQ(8u, rainbow::block_compressed_size(BlockFormat::BC1, 4, 4));
+    ASSERT_EQ(16u, rainbow::block_compressed_size(BlockFormat::BC3, 4, 4));
+    ASSERT_EQ(32u, rainbow::block_compressed_size(BlockFormat::BC1, 5, 7));
+    ASSERT_EQ(128u * 128 / 2,
+              rainbow::block_compressed_size(BlockFormat::BC1, 128, 128));
+    ASSERT_EQ(128u * 128,
+              rainbow::block_compressed_size(BlockFormat::BC3, 128, 128));
+}
+
+TEST(BlockCompressionTest, ReproducesSolidColors)
+{
+    // Colours exactly representable in RGB565.
+    const uint8_t colors[][4]{
+        {0x00, 0x00, 0x00, 0xff},
+        {0xff, 0xff, 0xff, 0xff},
+        {0xff, 0x00, 0x00, 0xff},
+        {0x84, 0x82, 0x84, 0xff},
+    };
+    for (auto&& color : colors)
+    {
+        std::vector<uint8_t> rgba(8 * 8 * 4);
+        for (size_t i = 0; i < rgba.size(); i += 4)
+            std::copy_n(color, 4, &rgba[i]);
+
+        const auto blocks = compress(BlockFormat::BC1, rgba, 8, 8);
+        ASSERT_EQ(rgba, decompress(BlockFormat::BC1, blocks.data(), 8, 8));
+    }
+}
+
+TEST(BlockCompressionTest, ReproducesTwoColorBlocks)
+{
+    std::vector<uint8_t> rgba(4 * 4 * 4);
+    for (size_t i = 0; i < rgba.size(); i += 4)
+    {
+        const uint8_t value = (i / 4) % 3 == 0 ? 0xff : 0x00;
+        rgba[i] = value;
+        rgba[i + 1] = value;
+        rgba[i + 2] = value;
+        rgba[i + 3] = 0xff;
+    }
+
+    const auto blocks = compress(BlockFormat::BC1, rgba, 4, 4);
+    ASSERT_EQ(rgba, decompress(BlockFormat::BC1, blocks.data(), 4, 4));
+}
+
+TEST(BlockCompressionTest, PreservesAlpha)
+{
+    constexpr uint32_t kSize = 16;
+
+    const auto rgba = make_image(kSize, kSize, true);
+    const auto blocks = compress(BlockFormat::BC3, rgba, kSize, kSize);
+    const auto decoded =
+        decompress(BlockFormat::BC3, blocks.data(), kSize, kSize);
+
+    for (size_t i = 3; i < rgba.size(); i += 4)
+        ASSERT_NEAR(rgba[i], decoded[i], 3) << "at pixel " << i / 4;
+}
+
+TEST(BlockCompressionTest, PadsPartialBlocks)
+{
+    constexpr uint32_t kWidth = 6;
+    constexpr uint32_t kHeight = 5;
+
+    std::vector<uint8_t> rgba(kWidth * kHeight * 4);
+    for (uint32_t y = 0; y < kHeight; ++y)
+    {
+        for (uint32_t x = 0; x < kWidth; ++x)
+        {
+            uint8_t* pixel = &rgba[(y * kWidth + x) * 4];
+            pixel[0] = x < 4 ? 0xff : 0x00;
+            pixel[1] = 0x00;
+            pixel[2] = x < 4 ? 0x00 : 0xff;
+            pixel[3] = 0xff;
+        }
+    }
+
+    const auto blocks = compress(BlockFormat::BC1, rgba, kWidth, kHeight);
+
+    ASSERT_EQ(32u, blocks.size());
+    ASSERT_EQ(rgba,
+              decompress(BlockFormat::BC1, blocks.data(), kWidth, kHeight));
+}
+
+TEST(BlockCompressionTest, CompressesSameInParallel)
+{
+    constexpr uint32_t kSize = 64;
+
+    ThreadPool pool(3);
+    for (auto format : {BlockFormat::BC1, BlockFormat::BC3})
+    {
+        const auto rgba = make_image(kSize, kSize, format == BlockFormat::BC3);
+        ASSERT_EQ(compress(format, rgba, kSize, kSize),
+                  compress(format, rgba, kSize, kSize, &pool));
+    }
+}
+
+// Measures encoding throughput, single-threaded and across all hardware
+// threads, and the quality of the result.
+TEST(DISABLED_BlockCompressionBenchmark, Compress)
+{
+    using std::chrono::microseconds;
+
+    constexpr uint32_t kSize = 1024;
+
+    ThreadPool pool(ThreadPool::default_worker_count());
+    for (auto format : {BlockFormat::BC1, BlockFormat::BC3})
+    {
+        const bool is_bc3 = format == BlockFormat::BC3;
+        const auto rgba = make_image(kSize, kSize, is_bc3);
+
+        std::vector<uint8_t> blocks;
+        const auto serial = measure<microseconds>(
+            [&] { blocks = compress(format, rgba, kSize, kSize); });
+        const auto parallel = measure<microseconds>(
+            [&] { compress(format, rgba, kSize, kSize, &pool); });
+
+        const auto decoded =
+            decompress(format, blocks.data(), kSize, kSize);
+        printf("%s %ux%u: %6.1f Mpx/s (%u threads: %6.1f Mpx/s), "
+               "PSNR %.2f dB",
+               is_bc3 ? "BC3" : "BC1",
+               kSize,
+               kSize,
+               kSize * kSize / static_cast<double>(serial),
+               pool.worker_count() + 1,
+               kSize * kSize / static_cast<double>(parallel),
+               psnr(rgba, decoded, 0, 3));
+
+        // BC1 carries no alpha channel to measure.
+        if (is_bc3)
+            printf(" (alpha: %.2f dB)\n", psnr(rgba, decoded, 3, 4));
+        else
+            printf(" (alpha: n/a)\n");
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <gtest/gtest.h>
+
+#include "Graphics/DistanceField.h"
+
+using rainbow::Vec2u;
+
+namespace
+{
+    constexpr uint32_t kSize = 16;
+    constexpr uint32_t kSpread = 4;
+
+    /// <summary>
+    ///   Returns a bitmap with a filled square in the middle, a quarter of the
+    ///   bitmap wide.
+    /// </summary>
+    auto make_square()
+    {
+        auto bitmap = std::make_unique<uint8_t[]>(kSize * kSize);
+        for (uint32_t y = 0; y < kSize; ++y)
+        {
+            for (uint32_t x = 0; x < kSize; ++x)
+            {
+                const bool inside = x >= kSize / 4 && x < kSize * 3 / 4 &&
+                                    y >= kSize / 4 && y < kSize * 3 / 4;
+                bitmap[y * kSize + x] = inside ? 0xff : 0x00;
+            }
+        }
+        return bitmap;
+    }
+}
+
+TEST(DistanceFieldTest, PadsFieldBySpread)
+{
+    const auto bitmap = make_square();
+    Vec2u size;
+    rainbow::make_distance_field(
+        bitmap.get(), {kSize, kSize}, kSpread, 1, size);
+
+    ASSERT_EQ(kSize + kSpread * 2, size.x);
+    ASSERT_EQ(kSize + kSpread * 2, size.y);
+
+    rainbow::make_distance_field(
+        bitmap.get(), {kSize, kSize}, kSpread, 4, size);
+
+    ASSERT_EQ((kSize + kSpread * 2 * 4 + 3) / 4, size.x);
+    ASSERT_EQ((kSize + kSpread * 2 * 4 + 3) / 4, size.y);
+}
+
+TEST(DistanceFieldTest, EncodesDistanceToEdge)
+{
+    const auto bitmap = make_square();
+    Vec2u size;
+    const auto field = rainbow::make_distance_field(
+        bitmap.get(), {kSize, kSize}, kSpread, 1, size);
+
+    // The square spans [4, 12) in the bitmap, and [8, 16) in the field.
+    const uint32_t row = size.x * (size.y / 2);
+    const uint32_t edge = kSpread + kSize / 4;
+
+    ASSERT_EQ(0x00, field[row]);
+    ASSERT_LT(field[row + edge - 1], 0x80);
+    ASSERT_GT(field[row + edge], 0x80);
+
+    // Values increase monotonically towards the centre of the square.
+    for (uint32_t x = 1; x <= size.x / 2; ++x)
+        ASSERT_LE(field[row + x - 1], field[row + x]);
+
+    // Distances are symmetric across the edge.
+    ASSERT_EQ(0xff - field[row + edge - 1], field[row + edge]);
+    ASSERT_EQ(0xff - field[row + edge - 2], field[row + edge + 1]);
+}
+
+TEST(DistanceFieldTest, EmptyBitmapIsOutside)
+{
+    const uint8_t bitmap[kSize * kSize]{};
+    Vec2u size;
+    const auto field = rainbow::make_distance_field(
+        bitmap, {kSize, kSize}, kSpread, 2, size);
+
+    for (uint32_t i = 0; i < size.x * size.y; ++i)
+        ASSERT_EQ(0x00, field[i]) << "at index " << i;
+}
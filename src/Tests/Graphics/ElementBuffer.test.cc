@@ -0,0 +1,50 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <gtest/gtest.h>
+
+#include "Graphics/ElementBuffer.h"
+#include "Graphics/Renderer.h"
+
+using rainbow::graphics::generate_quad_indices;
+using rainbow::graphics::kMaxSpritesUint16;
+
+namespace
+{
+    template <typename T>
+    void verify_quad_indices(const T* indices, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const size_t vertex = i * 4;
+            const T* quad = indices + i * 6;
+            ASSERT_EQ(vertex, quad[0]);
+            ASSERT_EQ(vertex + 1, quad[1]);
+            ASSERT_EQ(vertex + 2, quad[2]);
+            ASSERT_EQ(vertex + 2, quad[3]);
+            ASSERT_EQ(vertex + 3, quad[4]);
+            ASSERT_EQ(vertex, quad[5]);
+        }
+    }
+}
+
+TEST(ElementBufferTest, Generates16BitQuadIndices)
+{
+    auto indices = std::make_unique<uint16_t[]>(kMaxSpritesUint16 * 6);
+    generate_quad_indices(indices.get(), kMaxSpritesUint16);
+
+    verify_quad_indices(indices.get(), kMaxSpritesUint16);
+    ASSERT_EQ(0xffff, indices[kMaxSpritesUint16 * 6 - 2]);
+}
+
+TEST(ElementBufferTest, Generates32BitQuadIndices)
+{
+    constexpr size_t kSpriteCount = kMaxSpritesUint16 * 4;
+
+    auto indices = std::make_unique<uint32_t[]>(kSpriteCount * 6);
+    generate_quad_indices(indices.get(), kSpriteCount);
+
+    verify_quad_indices(indices.get(), kSpriteCount);
+    ASSERT_EQ(kSpriteCount * 4 - 1, indices[kSpriteCount * 6 - 2]);
+}
@@ -6,13 +6,27 @@
 
 #include "Graphics/Drawable.h"
 #include "Graphics/RenderQueue.h"
+#include "Graphics/Renderer.h"
+#include "Graphics/SpriteBatch.h"
+#include "Graphics/TextureAtlas.h"
+#include "Tests/Benchmark.h"
+#include "Tests/TestHelpers.h"
+#include "Threading/ThreadPool.h"
 
+using rainbow::Rect;
+using rainbow::SpriteBatch;
+using rainbow::SpriteVertex;
+using rainbow::TextureAtlas;
+using rainbow::Vec2f;
 using rainbow::graphics::RenderQueue;
+using rainbow::test::Stopwatch;
 
 namespace
 {
     constexpr uint64_t kDeltaTime = 16;
 
+    const Rect kViewport{-1024.0f, -1024.0f, 1024.0f, 1024.0f};
+
     class TestDrawable : public rainbow::IDrawable
     {
     public:
@@ -144,3 +158,406 @@ TEST(RenderQueueTest, UpdatesOnlyEnabledUnits)
     for (auto&& drawable : drawables)
         ASSERT_EQ(0, drawable.draw_count());
 }
+
+TEST(RenderQueueTest, MergesAdjacentUnitsSharingState)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test}};
+    for (auto&& batch : batches)
+        batch.create_sprite(1, 1);
+    batches[1].create_sprite(1, 1);
+
+    TestDrawable drawable;
+    RenderQueue queue{
+        batches[0], batches[1], batches[2], drawable, batches[3]};
+    rainbow::graphics::update(queue, kDeltaTime);
+    auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_TRUE(batch.is_merged());
+    ASSERT_EQ(0u, batch.first);
+    ASSERT_EQ(3u, batch.last);
+    ASSERT_EQ(3u, batch.unit_count);
+    ASSERT_EQ(4u * 4, batch.vertex_count);
+
+    batch = rainbow::graphics::next_draw_batch(queue, batch.last, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(3u, batch.first);
+    ASSERT_EQ(4u, batch.last);
+
+    batch = rainbow::graphics::next_draw_batch(queue, batch.last, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(4u, batch.first);
+    ASSERT_EQ(5u, batch.last);
+    ASSERT_EQ(1u, batch.unit_count);
+}
+
+TEST(RenderQueueTest, MergesNoMoreThan16BitIndicesAddress)
+{
+    constexpr uint32_t kQuadsPerBatch = 256;
+    constexpr uint32_t kBatchCount =
+        rainbow::graphics::kMaxSpritesUint16 / kQuadsPerBatch;
+
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    std::vector<SpriteBatch> batches;
+    for (uint32_t i = 0; i < kBatchCount + 1; ++i)
+        batches.emplace_back(test);
+
+    RenderQueue queue;
+    for (auto&& batch : batches)
+    {
+        for (uint32_t i = 0; i < kQuadsPerBatch; ++i)
+            batch.create_sprite(1, 1);
+        queue.emplace_back(batch);
+    }
+    rainbow::graphics::update(queue, kDeltaTime);
+    auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_EQ(kBatchCount, batch.last);
+    ASSERT_EQ(rainbow::graphics::kMaxSpritesUint16 * 4, batch.vertex_count);
+
+    batch = rainbow::graphics::next_draw_batch(queue, batch.last, kViewport);
+
+    ASSERT_EQ(kBatchCount, batch.first);
+    ASSERT_EQ(kBatchCount + 1, batch.last);
+}
+
+TEST(RenderQueueTest, DoesNotMergeUnitsWithDifferentPrograms)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test}};
+    for (auto&& batch : batches)
+        batch.create_sprite(1, 1);
+
+    RenderQueue queue{batches[0], batches[1], batches[2]};
+    queue[2].set_program(42);
+    rainbow::graphics::update(queue, kDeltaTime);
+    auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_TRUE(batch.is_merged());
+    ASSERT_EQ(2u, batch.last);
+
+    batch = rainbow::graphics::next_draw_batch(queue, batch.last, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(2u, batch.first);
+    ASSERT_EQ(3u, batch.last);
+}
+
+TEST(RenderQueueTest, SkipsDisabledAndEmptyUnitsWhenMerging)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test}};
+    batches[0].create_sprite(1, 1);
+    batches[1].create_sprite(1, 1);
+    batches[3].create_sprite(1, 1);
+
+    RenderQueue queue{batches[0], batches[1], batches[2], batches[3]};
+    queue[1].disable();
+    rainbow::graphics::update(queue, kDeltaTime);
+    const auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_TRUE(batch.is_merged());
+    ASSERT_EQ(4u, batch.last);
+    ASSERT_EQ(2u, batch.unit_count);
+    ASSERT_EQ(2u * 4, batch.vertex_count);
+}
+
+TEST(RenderQueueTest, DoesNotMergeLargeUnits)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test}};
+    batches[0].create_sprite(1, 1);
+    for (int i = 0; i < 1024; ++i)
+        batches[1].create_sprite(1, 1);
+
+    RenderQueue queue{batches[0], batches[1]};
+    rainbow::graphics::update(queue, kDeltaTime);
+    auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(1u, batch.last);
+
+    batch = rainbow::graphics::next_draw_batch(queue, batch.last, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(2u, batch.last);
+}
+
+TEST(RenderQueueTest, SkipsCulledUnitsWhenMerging)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test}};
+    for (auto&& batch : batches)
+        batch.create_sprite(2, 2);
+    batches[1].move(Vec2f{4096.0f, 0.0f});
+
+    RenderQueue queue{batches[0], batches[1], batches[2]};
+    rainbow::graphics::update(queue, kDeltaTime);
+    const auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_TRUE(batch.is_merged());
+    ASSERT_EQ(3u, batch.last);
+    ASSERT_EQ(2u, batch.unit_count);
+    ASSERT_EQ(2u * 4, batch.vertex_count);
+}
+
+TEST(RenderQueueTest, SkipsHiddenBatchesWhenMerging)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test}};
+    for (auto&& batch : batches)
+        batch.create_sprite(1, 1);
+    batches[1].create_sprite(1, 1);
+    batches[1].set_visible(false);
+
+    RenderQueue queue{batches[0], batches[1], batches[2]};
+    rainbow::graphics::update(queue, kDeltaTime);
+    auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_TRUE(batch.is_merged());
+    ASSERT_EQ(3u, batch.last);
+    ASSERT_EQ(2u, batch.unit_count);
+    ASSERT_EQ(2u * 4, batch.vertex_count);
+
+    // Hidden batches are skipped even if they could not have been merged.
+    batches[1].set_cull_mode(SpriteBatch::CullMode::Sprite);
+    rainbow::graphics::update(queue, kDeltaTime);
+    batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_TRUE(batch.is_merged());
+    ASSERT_EQ(3u, batch.last);
+    ASSERT_EQ(2u, batch.unit_count);
+}
+
+TEST(RenderQueueTest, DoesNotMergeBatchesCullingSprites)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test}};
+    for (auto&& batch : batches)
+        batch.create_sprite(1, 1);
+    batches[1].set_cull_mode(SpriteBatch::CullMode::Sprite);
+
+    RenderQueue queue{batches[0], batches[1]};
+    rainbow::graphics::update(queue, kDeltaTime);
+    auto batch = rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(1u, batch.last);
+
+    batch = rainbow::graphics::next_draw_batch(queue, batch.last, kViewport);
+
+    ASSERT_FALSE(batch.is_merged());
+    ASSERT_EQ(2u, batch.last);
+}
+
+TEST(RenderQueueTest, StreamsMergedUnitsOnlyWhenTheyChange)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    SpriteBatch batches[]{SpriteBatch{test},
+                          SpriteBatch{test},
+                          SpriteBatch{test}};
+    for (auto&& batch : batches)
+        batch.create_sprite(1, 1);
+
+    RenderQueue queue{batches[0], batches[1], batches[2]};
+    std::vector<rainbow::graphics::detail::MergedUnit> units;
+    auto needs_stream = [&queue, &units] {
+        rainbow::graphics::update(queue, kDeltaTime);
+        const auto batch =
+            rainbow::graphics::next_draw_batch(queue, 0, kViewport);
+        return rainbow::graphics::detail::update_merged_units(
+            queue, batch, kViewport, units);
+    };
+
+    ASSERT_TRUE(needs_stream());
+    ASSERT_EQ(3u, units.size());
+    ASSERT_FALSE(needs_stream());
+
+    batches[1].move(Vec2f{1.0f, 1.0f});
+
+    ASSERT_TRUE(needs_stream());
+    ASSERT_FALSE(needs_stream());
+
+    batches[2].create_sprite(1, 1);
+
+    ASSERT_TRUE(needs_stream());
+    ASSERT_FALSE(needs_stream());
+
+    queue[1].disable();
+
+    ASSERT_TRUE(needs_stream());
+    ASSERT_EQ(2u, units.size());
+    ASSERT_FALSE(needs_stream());
+
+    batches[2].move(Vec2f{4096.0f, 0.0f});
+
+    ASSERT_TRUE(needs_stream());
+    ASSERT_EQ(1u, units.size());
+}
+
+TEST(RenderQueueTest, UpdatesSpriteBatchesInParallel)
+{
+    constexpr uint32_t kBatchCount = 16;
+    constexpr uint32_t kSpriteCount = 100;
+
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    std::vector<SpriteBatch> serial;
+    std::vector<SpriteBatch> parallel;
+    for (uint32_t i = 0; i < kBatchCount; ++i)
+    {
+        serial.emplace_back(test);
+        parallel.emplace_back(test);
+    }
+
+    RenderQueue serial_queue;
+    RenderQueue parallel_queue;
+    TestDrawable drawables[2];
+    for (uint32_t i = 0; i < kBatchCount; ++i)
+    {
+        for (uint32_t j = 0; j < kSpriteCount; ++j)
+        {
+            const Vec2f position(i * kSpriteCount + j, j);
+            serial[i].create_sprite(2, 2)->set_position(position);
+            parallel[i].create_sprite(2, 2)->set_position(position);
+        }
+        serial_queue.emplace_back(serial[i]);
+        parallel_queue.emplace_back(parallel[i]);
+    }
+    parallel_queue.emplace_back(drawables[0]);
+    parallel_queue[3].disable();
+    serial_queue.emplace_back(drawables[1]);
+    serial_queue[3].disable();
+
+    for (uint32_t workers = 0; workers <= 4; ++workers)
+    {
+        rainbow::ThreadPool pool(workers);
+        for (uint32_t i = 0; i < kBatchCount; ++i)
+        {
+            serial[i].move(Vec2f::One);
+            parallel[i].move(Vec2f::One);
+        }
+
+        rainbow::graphics::update(serial_queue, kDeltaTime);
+        rainbow::graphics::update(parallel_queue, kDeltaTime, pool);
+
+        ASSERT_EQ(drawables[1].update_count(), drawables[0].update_count());
+        for (uint32_t i = 0; i < kBatchCount; ++i)
+        {
+            const SpriteVertex* expected = serial[i].vertices();
+            const SpriteVertex* actual = parallel[i].vertices();
+            for (uint32_t j = 0; j < kSpriteCount * 4; ++j)
+                ASSERT_EQ(expected[j].position, actual[j].position);
+        }
+    }
+}
+
+TEST(RenderQueueTest, ResolvesSharedPendingAtlasOnce)
+{
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    auto atlas =
+        rainbow::make_shared<TextureAtlas>(test, TextureAtlas::Async{});
+    atlas->add_region(0, 0, 32, 32);
+
+    SpriteBatch batches[]{SpriteBatch{test}, SpriteBatch{test}};
+    for (auto&& batch : batches)
+    {
+        batch.set_texture(atlas);
+        for (int i = 0; i < 4; ++i)
+            batch.create_sprite(2, 2)->set_texture(0);
+    }
+
+    RenderQueue queue{batches[0], batches[1]};
+    rainbow::ThreadPool pool(2);
+    rainbow::graphics::update(queue, kDeltaTime, pool);
+
+    ASSERT_FALSE(atlas->is_ready());
+
+    atlas->finish_loading();
+    rainbow::graphics::update(queue, kDeltaTime, pool);
+    rainbow::graphics::update(queue, kDeltaTime, pool);
+
+    // Regions must be normalised exactly once, however many batches share
+    // the atlas.
+    const Vec2f uv(0.5f, 0.5f);
+    ASSERT_EQ(uv, (*atlas)[0].vx[1]);
+    for (auto&& batch : batches)
+    {
+        const SpriteVertex* vertices = batch.vertices();
+        for (uint32_t i = 0; i < batch.size() * 4; ++i)
+        {
+            const Vec2f& texcoord = vertices[i].texcoord;
+            ASSERT_TRUE(texcoord.x == 0.0f || texcoord.x == uv.x);
+            ASSERT_TRUE(texcoord.y == 0.0f || texcoord.y == uv.y);
+        }
+    }
+}
+
+// Measures updating batches whose sprites all move every frame, serially and
+// on one up to all hardware threads. The calling thread counts as one.
+TEST(DISABLED_RenderQueueBenchmark, UpdateInParallel)
+{
+    constexpr uint32_t kBatchCount = 64;
+    constexpr uint32_t kSpriteCount = 1024;
+    constexpr int kFrames = 100;
+
+    const rainbow::ISolemnlySwearThatIAmOnlyTesting test{};
+    std::vector<SpriteBatch> batches;
+    for (uint32_t i = 0; i < kBatchCount; ++i)
+        batches.emplace_back(test);
+
+    RenderQueue queue;
+    for (auto&& batch : batches)
+    {
+        batch.reserve(kSpriteCount);
+        for (uint32_t i = 0; i < kSpriteCount; ++i)
+            batch.create_sprite(2, 2)->set_position(Vec2f(i, i));
+        queue.emplace_back(batch);
+    }
+
+    auto move_all = [&batches] {
+        for (auto&& batch : batches)
+            batch.move(Vec2f::One);
+    };
+
+    Stopwatch<> serial;
+    for (int frame = 0; frame < kFrames; ++frame)
+    {
+        move_all();
+        serial.time([&queue] { rainbow::graphics::update(queue, kDeltaTime); });
+    }
+    printf("    serial: %9lld ns/frame\n", serial.elapsed() / kFrames);
+
+    const uint32_t max_workers = rainbow::ThreadPool::default_worker_count();
+    for (uint32_t workers = 0; workers <= max_workers; ++workers)
+    {
+        rainbow::ThreadPool pool(workers);
+        Stopwatch<> parallel;
+        for (int frame = 0; frame < kFrames; ++frame)
+        {
+            move_all();
+            parallel.time([&queue, &pool] {
+                rainbow::graphics::update(queue, kDeltaTime, pool);
+            });
+        }
+        printf("%2u threads: %9lld ns/frame (%.2fx)\n",
+               workers + 1,
+               parallel.elapsed() / kFrames,
+               static_cast<double>(serial.elapsed()) / parallel.elapsed());
+    }
+}
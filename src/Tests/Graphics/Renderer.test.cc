@@ -0,0 +1,53 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <gtest/gtest.h>
+
+#include "Graphics/Renderer.h"
+
+using rainbow::graphics::detail::parse_gl_version;
+
+TEST(GLVersionTest, ParsesOpenGLVersions)
+{
+    auto version = parse_gl_version("3.3.0 NVIDIA 390.77");
+
+    ASSERT_EQ(3, version.major);
+    ASSERT_EQ(3, version.minor);
+    ASSERT_FALSE(version.is_es);
+
+    version = parse_gl_version("4.6 (Core Profile) Mesa 18.0.5");
+
+    ASSERT_EQ(4, version.major);
+    ASSERT_EQ(6, version.minor);
+    ASSERT_FALSE(version.is_es);
+
+    version = parse_gl_version("OpenGL ES 3.0 V@269.0 (GIT@I1e6f2c8a56)");
+
+    ASSERT_EQ(3, version.major);
+    ASSERT_EQ(0, version.minor);
+    ASSERT_TRUE(version.is_es);
+
+    version = parse_gl_version("OpenGL ES 2.0 (WebGL 1.0)");
+
+    ASSERT_EQ(2, version.major);
+    ASSERT_EQ(0, version.minor);
+    ASSERT_TRUE(version.is_es);
+}
+
+TEST(GLVersionTest, RejectsUnknownOpenGLVersions)
+{
+    auto version = parse_gl_version(nullptr);
+
+    ASSERT_EQ(0, version.major);
+    ASSERT_FALSE(version.is_es);
+
+    version = parse_gl_version("OpenGL ES-CM 1.1");
+
+    ASSERT_EQ(0, version.major);
+    ASSERT_EQ(0, version.minor);
+
+    version = parse_gl_version("");
+
+    ASSERT_EQ(0, version.major);
+}
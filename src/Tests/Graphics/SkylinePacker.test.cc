@@ -0,0 +1,119 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/Random.h"
+#include "Graphics/SkylinePacker.h"
+
+using rainbow::SkylinePacker;
+using rainbow::Vec2u;
+
+namespace
+{
+    struct Box
+    {
+        Vec2u position;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    bool overlaps(const Box& a, const Box& b)
+    {
+        return a.position.x < b.position.x + b.width &&
+               b.position.x < a.position.x + a.width &&
+               a.position.y < b.position.y + b.height &&
+               b.position.y < a.position.y + a.height;
+    }
+}
+
+TEST(SkylinePackerTest, FillsPageWithEqualRectangles)
+{
+    SkylinePacker packer(64, 64);
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        Vec2u position;
+        ASSERT_TRUE(packer.pack(16, 16, position));
+        ASSERT_EQ(0u, position.x % 16);
+        ASSERT_EQ(0u, position.y % 16);
+    }
+
+    Vec2u position;
+    ASSERT_FALSE(packer.pack(1, 1, position));
+
+    packer.clear();
+
+    ASSERT_TRUE(packer.pack(64, 64, position));
+    ASSERT_EQ(Vec2u::Zero, position);
+}
+
+TEST(SkylinePackerTest, RejectsRectanglesThatDoNotFit)
+{
+    SkylinePacker packer(32, 16);
+    Vec2u position;
+
+    ASSERT_FALSE(packer.pack(0, 1, position));
+    ASSERT_FALSE(packer.pack(1, 0, position));
+    ASSERT_FALSE(packer.pack(33, 1, position));
+    ASSERT_FALSE(packer.pack(1, 17, position));
+    ASSERT_TRUE(packer.pack(32, 10, position));
+    ASSERT_FALSE(packer.pack(1, 7, position));
+    ASSERT_TRUE(packer.pack(32, 6, position));
+    ASSERT_EQ(10u, position.y);
+}
+
+TEST(SkylinePackerTest, GrowsWithoutMovingRectangles)
+{
+    SkylinePacker packer(16, 16);
+    Vec2u position;
+
+    ASSERT_TRUE(packer.pack(16, 8, position));
+    ASSERT_TRUE(packer.pack(16, 8, position));
+    ASSERT_FALSE(packer.pack(8, 8, position));
+
+    packer.grow(32, 16);
+
+    ASSERT_EQ(32u, packer.width());
+    ASSERT_TRUE(packer.pack(16, 16, position));
+    ASSERT_EQ(Vec2u(16, 0), position);
+    ASSERT_FALSE(packer.pack(1, 1, position));
+
+    packer.grow(32, 24);
+
+    ASSERT_TRUE(packer.pack(32, 8, position));
+    ASSERT_EQ(Vec2u(0, 16), position);
+}
+
+TEST(SkylinePackerTest, PacksWithoutOverlapping)
+{
+    constexpr uint32_t kSize = 256;
+
+    rainbow::Random random;
+    random.seed(42);
+
+    SkylinePacker packer(kSize, kSize);
+    std::vector<Box> boxes;
+    for (int i = 0; i < 500; ++i)
+    {
+        Box box{{}, random(1u, 33u), random(1u, 33u)};
+        if (!packer.pack(box.width, box.height, box.position))
+            continue;
+
+        ASSERT_LE(box.position.x + box.width, kSize);
+        ASSERT_LE(box.position.y + box.height, kSize);
+        for (auto&& other : boxes)
+            ASSERT_FALSE(overlaps(box, other));
+
+        boxes.push_back(box);
+    }
+
+    // Random rectangles up to 1/8 of the sides should cover most of the area.
+    uint32_t area = 0;
+    for (auto&& box : boxes)
+        area += box.width * box.height;
+
+    ASSERT_GT(area, kSize * kSize * 3 / 4);
+}
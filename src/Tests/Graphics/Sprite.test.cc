@@ -5,12 +5,14 @@
 #include <gtest/gtest.h>
 
 #include "Graphics/Sprite.h"
+#include "Graphics/SpriteInstance.h"
 #include "Graphics/TextureAtlas.h"
 #include "Tests/TestHelpers.h"
 
 using rainbow::Color;
 using rainbow::SharedPtr;
 using rainbow::Sprite;
+using rainbow::SpriteInstance;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
 using rainbow::TextureAtlas;
@@ -655,6 +657,70 @@ TEST(SpriteTest, UpdatesOnlyOnChange)
     ASSERT_FALSE(sprite.update(vertex_array, *texture));
 }
 
+TEST(SpriteTest, InstancesExpandToSameVertices)
+{
+    auto texture = create_texture();
+    const unsigned int region = texture->add_region(8, 16, 24, 32);
+
+    Sprite sprite(24, 32);
+    sprite.set_texture(region);
+    sprite.set_color(Color(0x11, 0x22, 0x33, 0x44));
+
+    auto verify = [&sprite, &texture] {
+        SpriteVertex expected[4];
+        SpriteInstance instance;
+        SpriteVertex actual[4];
+        sprite.invalidate();
+        ASSERT_TRUE(sprite.update(instance));
+        ASSERT_FALSE(sprite.update(instance));
+        sprite.invalidate();
+        ASSERT_TRUE(sprite.update(expected, *texture));
+        rainbow::expand(instance, *texture, actual);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            ASSERT_EQ(expected[i].color, actual[i].color);
+            ASSERT_NEAR(expected[i].texcoord.x, actual[i].texcoord.x, 1e-6f);
+            ASSERT_NEAR(expected[i].texcoord.y, actual[i].texcoord.y, 1e-6f);
+            ASSERT_NEAR(expected[i].position.x, actual[i].position.x, 1e-3f);
+            ASSERT_NEAR(expected[i].position.y, actual[i].position.y, 1e-3f);
+        }
+    };
+
+    verify();
+
+    sprite.set_position(Vec2f(100, -50));
+    verify();
+
+    sprite.set_pivot(Vec2f(0.25f, 0.75f));
+    verify();
+
+    sprite.set_scale(Vec2f(1.5f, 2.0f));
+    verify();
+
+    sprite.set_rotation(0.7f);
+    verify();
+
+    sprite.flip();
+    verify();
+
+    sprite.mirror();
+    verify();
+
+    sprite.flip();
+    verify();
+
+    sprite.hide();
+
+    // Hidden sprites collapse into a point instead of being zeroed out.
+    SpriteInstance instance;
+    SpriteVertex vertices[4];
+    ASSERT_TRUE(sprite.update(instance));
+    rainbow::expand(instance, *texture, vertices);
+    for (auto&& vertex : vertices)
+        ASSERT_EQ(sprite.position(), vertex.position);
+}
+
 TEST(SpriteTest, ManuallyConstructedRefsAreInvalid)
 {
     ASSERT_FALSE(SpriteRef{});
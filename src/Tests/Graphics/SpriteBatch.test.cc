@@ -4,15 +4,22 @@
 
 #include <gtest/gtest.h>
 
+#include "Common/Random.h"
+#include "Graphics/Renderer.h"
 #include "Graphics/SpriteBatch.h"
+#include "Tests/Benchmark.h"
 #include "Tests/TestHelpers.h"
 
+using rainbow::Color;
+using rainbow::PackedSpriteVertex;
 using rainbow::Sprite;
 using rainbow::SpriteBatch;
 using rainbow::SpriteRef;
 using rainbow::SpriteVertex;
 using rainbow::TextureAtlas;
 using rainbow::Vec2f;
+using rainbow::VertexFormat;
+using rainbow::test::Stopwatch;
 
 namespace
 {
@@ -211,56 +218,165 @@ TEST(SpriteBatchTest, IsVisible)
     ASSERT_EQ(0u, batch3.vertex_count());
 }
 
-TEST(SpriteBatchTest, ExcessSpritesAreDiscarded)
+TEST(SpriteBatchTest, GrowsOnDemand)
 {
     SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
-    uint32_t capacity = batch.capacity();
+    const uint32_t capacity = batch.capacity();
+    SpriteRef refs[9];
     for (uint32_t i = 0; i < capacity; ++i)
-        batch.create_sprite(i + 1, i + 1);
+    {
+        refs[i] = batch.create_sprite(i + 1, i + 1);
+        refs[i]->set_id(i + 1);
+    }
     update(batch);
 
     ASSERT_EQ(capacity, batch.size());
 
-    auto&& vertices = batch.vertices();
-    for (uint32_t i = 0; i < batch.size(); ++i)
+    batch.bring_to_front(refs[0]);
+    for (uint32_t i = capacity; i < rainbow::array_size(refs); ++i)
     {
-        const float s = (i + 1) * 0.5f;
-        const uint32_t j = i * 4;
-        ASSERT_EQ(Vec2f(-s, -s), vertices[j].position);
-        ASSERT_EQ(Vec2f(s, -s), vertices[j + 1].position);
-        ASSERT_EQ(Vec2f(s, s), vertices[j + 2].position);
-        ASSERT_EQ(Vec2f(-s, s), vertices[j + 3].position);
+        refs[i] = batch.create_sprite(i + 1, i + 1);
+        refs[i]->set_id(i + 1);
     }
 
-    batch.create_sprite(capacity + 1, capacity + 1);
+    ASSERT_LT(capacity, batch.capacity());
+    ASSERT_EQ(rainbow::array_size(refs), batch.size());
 
-    ASSERT_EQ(capacity, batch.size());
+    for (uint32_t i = 0; i < rainbow::array_size(refs); ++i)
+    {
+        ASSERT_EQ(static_cast<int>(i + 1), refs[i]->id());
+        ASSERT_EQ(i + 1, refs[i]->width());
+    }
 
-    for (uint32_t i = 0; i < batch.size(); ++i)
+    update(batch);
+
+    verify_batch_integrity(batch);
+}
+
+TEST(SpriteBatchTest, HoldsMoreSpritesThan16BitIndicesCanAddress)
+{
+    constexpr uint32_t kSpriteCount =
+        rainbow::graphics::kMaxSpritesUint16 * 4 + 1;
+
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    for (uint32_t i = 0; i < kSpriteCount; ++i)
+        batch.create_sprite(2, 2)->set_position(Vec2f(i, i));
+    update(batch);
+
+    ASSERT_EQ(kSpriteCount, batch.size());
+    ASSERT_EQ(kSpriteCount * 6, batch.vertex_count());
+
+    const SpriteVertex* vertices = batch.vertices();
+    for (uint32_t i = 0; i < kSpriteCount; ++i)
     {
-        const float s = (i + 1) * 0.5f;
-        const uint32_t j = i * 4;
-        ASSERT_EQ(Vec2f(-s, -s), vertices[j].position);
-        ASSERT_EQ(Vec2f(s, -s), vertices[j + 1].position);
-        ASSERT_EQ(Vec2f(s, s), vertices[j + 2].position);
-        ASSERT_EQ(Vec2f(-s, s), vertices[j + 3].position);
+        const auto sprite = batch.sprites() + i;
+        ASSERT_EQ(vertices + i * 4, sprite->vertex_array());
+        verify_sprite_vertices(*sprite, vertices + i * 4, Vec2f(i, i));
     }
+}
 
-    batch.create_sprite(capacity + 1, capacity + 1);
-    batch.create_sprite(capacity + 1, capacity + 1);
-    batch.create_sprite(capacity + 1, capacity + 1);
+TEST(SpriteBatchTest, UploadsOnlyDirtySprites)
+{
+    auto& bytes_uploaded =
+        rainbow::graphics::detail::g_bytes_uploaded_accumulator;
 
-    ASSERT_EQ(capacity, batch.size());
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    SpriteRef refs[8];
+    for (auto&& ref : refs)
+        ref = batch.create_sprite(2, 2);
 
-    for (uint32_t i = 0; i < batch.size(); ++i)
+    bytes_uploaded = 0;
+    batch.update();
+
+    const size_t sprite_size = 4 * sizeof(SpriteVertex);
+    ASSERT_EQ(rainbow::array_size(refs) * sprite_size, bytes_uploaded);
+
+    bytes_uploaded = 0;
+    batch.update();
+
+    ASSERT_EQ(0u, bytes_uploaded);
+
+    refs[3]->move(Vec2f::One);
+    batch.update();
+
+    ASSERT_EQ(sprite_size, bytes_uploaded);
+    verify_sprite_vertices(*refs[3], batch.vertices() + 3 * 4, Vec2f::One);
+
+    bytes_uploaded = 0;
+    refs[2]->move(Vec2f::One);
+    refs[5]->move(Vec2f::One);
+    batch.update();
+
+    ASSERT_EQ(4 * sprite_size, bytes_uploaded);
+
+    bytes_uploaded = 0;
+    batch.create_sprite(2, 2);
+    batch.update();
+
+    ASSERT_EQ((rainbow::array_size(refs) + 1) * sprite_size, bytes_uploaded);
+}
+
+TEST(SpriteBatchTest, PacksVertices)
+{
+    const SpriteVertex vertices[]{
+        {Color{0x11, 0x22, 0x33, 0x44}, {0.0f, 1.0f}, {-1.5f, 2.5f}},
+        {Color{}, {0.5f, 0.25f}, {1e6f, -1e6f}},
+        {Color{}, {-0.1f, 1.1f}, {0.0f, 0.0f}},
+    };
+    PackedSpriteVertex packed[rainbow::array_size(vertices)];
+    rainbow::pack(vertices, rainbow::array_size(vertices), packed);
+
+    for (size_t i = 0; i < rainbow::array_size(vertices); ++i)
     {
-        const float s = (i + 1) * 0.5f;
-        const uint32_t j = i * 4;
-        ASSERT_EQ(Vec2f(-s, -s), vertices[j].position);
-        ASSERT_EQ(Vec2f(s, -s), vertices[j + 1].position);
-        ASSERT_EQ(Vec2f(s, s), vertices[j + 2].position);
-        ASSERT_EQ(Vec2f(-s, s), vertices[j + 3].position);
+        ASSERT_EQ(vertices[i].color, packed[i].color);
+        ASSERT_EQ(vertices[i].position, packed[i].position);
     }
+
+    ASSERT_EQ(0u, packed[0].texcoord[0]);
+    ASSERT_EQ(0xffffu, packed[0].texcoord[1]);
+    ASSERT_EQ(0x8000u, packed[1].texcoord[0]);
+    ASSERT_EQ(0x4000u, packed[1].texcoord[1]);
+    ASSERT_EQ(0u, packed[2].texcoord[0]);
+    ASSERT_EQ(0xffffu, packed[2].texcoord[1]);
+}
+
+TEST(SpriteBatchTest, UploadsPackedVertices)
+{
+    auto& bytes_uploaded =
+        rainbow::graphics::detail::g_bytes_uploaded_accumulator;
+
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    SpriteRef refs[4];
+    for (auto&& ref : refs)
+        ref = batch.create_sprite(2, 2);
+
+    bytes_uploaded = 0;
+    batch.update();
+
+    const size_t sprite_size = 4 * sizeof(SpriteVertex);
+    ASSERT_EQ(rainbow::array_size(refs) * sprite_size, bytes_uploaded);
+
+    batch.set_vertex_format(VertexFormat::Packed);
+
+    ASSERT_EQ(VertexFormat::Packed, batch.vertex_format());
+
+    bytes_uploaded = 0;
+    batch.update();
+
+    const size_t packed_size = 4 * sizeof(PackedSpriteVertex);
+    ASSERT_EQ(rainbow::array_size(refs) * packed_size, bytes_uploaded);
+
+    bytes_uploaded = 0;
+    refs[1]->move(Vec2f::One);
+    batch.update();
+
+    ASSERT_EQ(packed_size, bytes_uploaded);
+
+    batch.set_vertex_format(VertexFormat::Float);
+    bytes_uploaded = 0;
+    batch.update();
+
+    ASSERT_EQ(rainbow::array_size(refs) * sprite_size, bytes_uploaded);
 }
 
 TEST_F(SpriteBatchOperationsTest, SpritesShareASingleBuffer)
@@ -438,3 +554,270 @@ TEST_F(SpriteBatchOperationsTest, SwapsSprites)
 
     verify_batch_integrity(batch);
 }
+
+TEST(SpriteBatchTest, ComputesBoundsOnUpdate)
+{
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    batch.create_sprite(2, 2)->set_position(Vec2f{-4.0f, 2.0f});
+    batch.create_sprite(4, 2)->set_position(Vec2f{8.0f, -6.0f});
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(-5.0f, -7.0f, 10.0f, 3.0f), batch.bounds());
+
+    batch.move(Vec2f::One);
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(-4.0f, -6.0f, 11.0f, 4.0f), batch.bounds());
+}
+
+TEST(SpriteBatchTest, ExcludesHiddenSpritesFromBounds)
+{
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    auto a = batch.create_sprite(2, 2);
+    auto b = batch.create_sprite(2, 2);
+    a->set_position(Vec2f{100.0f, 100.0f});
+    b->set_position(Vec2f{200.0f, 200.0f});
+    b->hide();
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(99.0f, 99.0f, 101.0f, 101.0f), batch.bounds());
+
+    b->show();
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(99.0f, 99.0f, 201.0f, 201.0f), batch.bounds());
+
+    a->hide();
+    b->hide();
+    batch.update();
+
+    ASSERT_FALSE(batch.bounds().intersects(rainbow::Rect{
+        -1024.0f, -1024.0f, 1024.0f, 1024.0f}));
+}
+
+TEST(SpriteBatchTest, ShrinksBoundsWhenEdgeSpriteMovesInward)
+{
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    auto a = batch.create_sprite(2, 2);
+    auto b = batch.create_sprite(2, 2);
+    auto c = batch.create_sprite(2, 2);
+    a->set_position(Vec2f{0.0f, 0.0f});
+    b->set_position(Vec2f{10.0f, 0.0f});
+    c->set_position(Vec2f{20.0f, 0.0f});
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(-1.0f, -1.0f, 21.0f, 1.0f), batch.bounds());
+
+    // Moving a sprite that does not define an edge keeps the bounds.
+    b->move(Vec2f{0.0f, 0.5f});
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(-1.0f, -1.0f, 21.0f, 1.5f), batch.bounds());
+
+    c->set_position(Vec2f{5.0f, 0.0f});
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(-1.0f, -1.0f, 11.0f, 1.5f), batch.bounds());
+
+    batch.erase(b);
+    batch.update();
+
+    ASSERT_EQ(rainbow::Rect(-1.0f, -1.0f, 6.0f, 1.0f), batch.bounds());
+}
+
+TEST(SpriteBatchTest, CullsSpritesOutsideViewport)
+{
+    const rainbow::Rect viewport{0.0f, 0.0f, 100.0f, 100.0f};
+    auto& bytes_uploaded =
+        rainbow::graphics::detail::g_bytes_uploaded_accumulator;
+
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    SpriteRef refs[4];
+    for (auto&& ref : refs)
+        ref = batch.create_sprite(2, 2);
+    refs[0]->set_position(Vec2f{50.0f, 50.0f});
+    refs[1]->set_position(Vec2f{-50.0f, 50.0f});
+    refs[2]->set_position(Vec2f{99.0f, 99.0f});
+    refs[3]->set_position(Vec2f{50.0f, 150.0f});
+
+    batch.set_cull_mode(SpriteBatch::CullMode::Sprite);
+    bytes_uploaded = 0;
+    batch.update();
+
+    ASSERT_EQ(0u, bytes_uploaded);
+
+    batch.cull(viewport);
+
+    const size_t sprite_size = 4 * sizeof(SpriteVertex);
+    ASSERT_EQ(2u * 6, batch.vertex_count());
+    ASSERT_EQ(2 * sprite_size, bytes_uploaded);
+
+    bytes_uploaded = 0;
+    batch.update();
+    batch.cull(viewport);
+
+    ASSERT_EQ(0u, bytes_uploaded);
+
+    refs[1]->move(Vec2f{100.0f, 0.0f});
+    batch.update();
+    batch.cull(viewport);
+
+    ASSERT_EQ(3u * 6, batch.vertex_count());
+    ASSERT_EQ(3 * sprite_size, bytes_uploaded);
+
+    bytes_uploaded = 0;
+    batch.cull(rainbow::Rect{0.0f, 100.0f, 100.0f, 200.0f});
+
+    ASSERT_EQ(2u * 6, batch.vertex_count());
+    ASSERT_EQ(2 * sprite_size, bytes_uploaded);
+
+    batch.set_cull_mode(SpriteBatch::CullMode::Batch);
+
+    ASSERT_EQ(4u * 6, batch.vertex_count());
+}
+
+TEST(SpriteBatchTest, SortsSpritesByKey)
+{
+    auto& bytes_uploaded =
+        rainbow::graphics::detail::g_bytes_uploaded_accumulator;
+
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    SpriteRef refs[5];
+    for (auto&& ref : refs)
+        ref = batch.create_sprite(2, 2);
+    set_sprite_ids(refs);
+
+    refs[0]->set_sort_key(3.0f);
+    refs[1]->set_sort_key(-1.0f);
+    refs[2]->set_sort_key(3.0f);
+    refs[3]->set_sort_key(0.0f);
+    refs[4]->set_sort_key(-2.5f);
+    batch.set_sort_order(SpriteBatch::SortOrder::SortKey);
+    batch.update();
+
+    const int expected[]{5, 2, 4, 1, 3};
+    for (uint32_t i = 0; i < batch.size(); ++i)
+        ASSERT_EQ(expected[i], batch.begin()[i].id());
+
+    for (int i = 0; i < 5; ++i)
+        ASSERT_EQ(i + 1, refs[i]->id());
+
+    bytes_uploaded = 0;
+    batch.update();
+
+    ASSERT_EQ(0u, bytes_uploaded);
+
+    refs[1]->set_sort_key(4.0f);
+    batch.update();
+
+    const int resorted[]{5, 4, 1, 3, 2};
+    for (uint32_t i = 0; i < batch.size(); ++i)
+        ASSERT_EQ(resorted[i], batch.begin()[i].id());
+
+    batch.set_sort_order(SpriteBatch::SortOrder::None);
+    refs[1]->set_sort_key(-4.0f);
+    batch.update();
+
+    for (uint32_t i = 0; i < batch.size(); ++i)
+        ASSERT_EQ(resorted[i], batch.begin()[i].id());
+}
+
+TEST(SpriteBatchTest, SortsSpritesByPositionY)
+{
+    SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    SpriteRef refs[4];
+    for (auto&& ref : refs)
+        ref = batch.create_sprite(2, 2);
+    set_sprite_ids(refs);
+
+    refs[0]->set_position(Vec2f{0.0f, 10.0f});
+    refs[1]->set_position(Vec2f{0.0f, 30.0f});
+    refs[2]->set_position(Vec2f{0.0f, -5.0f});
+    refs[3]->set_position(Vec2f{0.0f, 20.0f});
+    batch.set_sort_order(SpriteBatch::SortOrder::PositionY);
+    batch.update();
+
+    const int expected[]{2, 4, 1, 3};
+    for (uint32_t i = 0; i < batch.size(); ++i)
+    {
+        ASSERT_EQ(expected[i], batch.begin()[i].id());
+        verify_sprite_vertices(batch.begin()[i],
+                               batch.vertices() + i * 4,
+                               batch.begin()[i].position());
+    }
+}
+
+// Measures the cost of re-sorting every sprite every frame.
+TEST(DISABLED_SpriteBatchBenchmark, FullResort)
+{
+    constexpr int kFrames = 100;
+
+    rainbow::Random random;
+    random.seed();
+    for (uint32_t count : {1024u, 4096u, 16384u})
+    {
+        SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+        batch.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+            batch.create_sprite(2, 2);
+        batch.set_sort_order(SpriteBatch::SortOrder::PositionY);
+
+        Stopwatch<> stopwatch;
+        for (int frame = 0; frame < kFrames; ++frame)
+        {
+            for (auto&& sprite : batch)
+                sprite.set_position(Vec2f{0.0f, random(-1000.0f, 1000.0f)});
+
+            stopwatch.time([&batch] { batch.update(); });
+        }
+
+        const auto per_frame = stopwatch.elapsed() / kFrames;
+        printf("%6u sprites: %8lld ns/frame, %4lld ns/sprite\n",
+               count,
+               per_frame,
+               per_frame / count);
+    }
+}
+
+// Compares bytes uploaded and CPU time per frame for either vertex format,
+// with a varying share of sprites moving every frame.
+TEST(DISABLED_SpriteBatchBenchmark, VertexFormats)
+{
+    constexpr uint32_t kCount = 4096;
+    constexpr int kFrames = 100;
+
+    auto& bytes_uploaded =
+        rainbow::graphics::detail::g_bytes_uploaded_accumulator;
+
+    rainbow::Random random;
+    random.seed();
+    for (auto format : {VertexFormat::Float, VertexFormat::Packed})
+    {
+        for (uint32_t moving : {0u, kCount / 10, kCount})
+        {
+            SpriteBatch batch(rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+            batch.reserve(kCount);
+            for (uint32_t i = 0; i < kCount; ++i)
+                batch.create_sprite(2, 2);
+            batch.set_vertex_format(format);
+            batch.update();
+
+            bytes_uploaded = 0;
+            Stopwatch<> stopwatch;
+            for (int frame = 0; frame < kFrames; ++frame)
+            {
+                for (uint32_t i = 0; i < moving; ++i)
+                    batch[i].set_position(Vec2f{random(100.0f), 0.0f});
+
+                stopwatch.time([&batch] { batch.update(); });
+            }
+
+            printf("%6s, %5u/%u moving: %8zu bytes/frame, %8lld ns/frame\n",
+                   format == VertexFormat::Float ? "float" : "packed",
+                   moving,
+                   kCount,
+                   bytes_uploaded / kFrames,
+                   stopwatch.elapsed() / kFrames);
+        }
+    }
+}
@@ -0,0 +1,256 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Graphics/TextLayout.h"
+#include "Tests/Benchmark.h"
+
+using rainbow::TextLayout;
+using rainbow::test::measure;
+
+namespace
+{
+    constexpr float kAdvance = 10.0f;
+    constexpr float kKerningAV = -2.0f;
+    constexpr float kLeft = 1.0f;
+
+    /// <summary>Monospace font that only kerns "AV".</summary>
+    struct MonospaceFont
+    {
+        struct Glyph
+        {
+            float advance;
+            float left;
+        };
+
+        Glyph glyph{kAdvance, kLeft};
+
+        bool get_glyph(uint32_t, Glyph& out) const
+        {
+            out = glyph;
+            return true;
+        }
+
+        auto kerning(uint32_t left, uint32_t right) const
+        {
+            return left == 'A' && right == 'V' ? kKerningAV : 0.0f;
+        }
+    };
+
+    void verify_line(const TextLayout& layout,
+                     size_t line,
+                     uint32_t first,
+                     uint32_t last,
+                     float width)
+    {
+        ASSERT_LT(line, layout.lines().size());
+
+        const auto& l = layout.lines()[line];
+        ASSERT_EQ(first, l.first);
+        ASSERT_EQ(last, l.last);
+        ASSERT_FLOAT_EQ(width, l.width);
+    }
+
+    void verify_same_layout(const TextLayout& expected,
+                            const TextLayout& actual)
+    {
+        ASSERT_EQ(expected.glyphs().size(), actual.glyphs().size());
+        for (size_t i = 0; i < expected.glyphs().size(); ++i)
+        {
+            const auto& a = expected.glyphs()[i];
+            const auto& b = actual.glyphs()[i];
+            ASSERT_EQ(a.code, b.code) << "at glyph " << i;
+            ASSERT_EQ(a.offset, b.offset) << "at glyph " << i;
+            ASSERT_FLOAT_EQ(a.x, b.x) << "at glyph " << i;
+        }
+
+        ASSERT_EQ(expected.lines().size(), actual.lines().size());
+        for (size_t i = 0; i < expected.lines().size(); ++i)
+        {
+            const auto& a = expected.lines()[i];
+            verify_line(actual, i, a.first, a.last, a.width);
+            ASSERT_EQ(a.offset, actual.lines()[i].offset) << "at line " << i;
+        }
+    }
+}
+
+TEST(TextLayoutTest, LaysOutEmptyText)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "", 0.0f);
+
+    ASSERT_TRUE(layout.glyphs().empty());
+    ASSERT_EQ(1u, layout.lines().size());
+    verify_line(layout, 0, 0, 0, 0.0f);
+}
+
+TEST(TextLayoutTest, AppliesKerning)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "AVA", 0.0f);
+
+    const auto& glyphs = layout.glyphs();
+
+    ASSERT_EQ(3u, glyphs.size());
+    ASSERT_FLOAT_EQ(kLeft, glyphs[0].x);
+    ASSERT_FLOAT_EQ(kAdvance + kKerningAV + kLeft, glyphs[1].x);
+    ASSERT_FLOAT_EQ(kAdvance * 2 + kKerningAV + kLeft, glyphs[2].x);
+    verify_line(layout, 0, 0, 3, kAdvance * 3 + kKerningAV);
+}
+
+TEST(TextLayoutTest, BreaksLinesAtLineFeeds)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "ab\nc\n", 0.0f);
+
+    const auto& glyphs = layout.glyphs();
+
+    ASSERT_EQ(3u, glyphs.size());
+    ASSERT_EQ(3u, layout.lines().size());
+    verify_line(layout, 0, 0, 2, kAdvance * 2);
+    verify_line(layout, 1, 2, 3, kAdvance);
+    verify_line(layout, 2, 3, 3, 0.0f);
+    ASSERT_FLOAT_EQ(kLeft, glyphs[2].x);
+}
+
+TEST(TextLayoutTest, WrapsWordsAtMaxWidth)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "ab cd ef", kAdvance * 6);
+
+    const auto& glyphs = layout.glyphs();
+
+    ASSERT_EQ(8u, glyphs.size());
+    ASSERT_EQ(2u, layout.lines().size());
+
+    // "ab cd " fits on the first line, excluding the trailing space.
+    verify_line(layout, 0, 0, 6, kAdvance * 5);
+    verify_line(layout, 1, 6, 8, kAdvance * 2);
+    ASSERT_FLOAT_EQ(kLeft, glyphs[6].x);
+    ASSERT_FLOAT_EQ(kAdvance + kLeft, glyphs[7].x);
+}
+
+TEST(TextLayoutTest, BreaksLongWordsBetweenCharacters)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "abcdefg", kAdvance * 3);
+
+    ASSERT_EQ(3u, layout.lines().size());
+    verify_line(layout, 0, 0, 3, kAdvance * 3);
+    verify_line(layout, 1, 3, 6, kAdvance * 3);
+    verify_line(layout, 2, 6, 7, kAdvance);
+    ASSERT_FLOAT_EQ(kLeft, layout.glyphs()[3].x);
+}
+
+TEST(TextLayoutTest, LetsSpacesHangPastMaxWidth)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "abc   d", kAdvance * 3);
+
+    ASSERT_EQ(2u, layout.lines().size());
+    verify_line(layout, 0, 0, 6, kAdvance * 3);
+    verify_line(layout, 1, 6, 7, kAdvance);
+}
+
+TEST(TextLayoutTest, RelaysOutOnlyChangedLines)
+{
+    MonospaceFont font;
+    TextLayout layout(font, "ab\ncd\nef", 0.0f);
+
+    ASSERT_EQ(1u, layout.relayout(font, "ab\ncX\nef", 4));
+    ASSERT_EQ(3u, layout.lines().size());
+    ASSERT_EQ(uint32_t{'X'}, layout.glyphs()[3].code);
+    ASSERT_EQ(4u, layout.glyphs()[3].offset);
+}
+
+TEST(TextLayoutTest, RelayoutMatchesFullLayout)
+{
+    struct Edit
+    {
+        const char* before;
+        const char* after;
+        float max_width;
+    };
+
+    const Edit edits[]{
+        {"", "abc", 0.0f},
+        {"abc", "abcdef", 0.0f},
+        {"abc\ndef", "abc\nde", 0.0f},
+        {"abc\ndef", "abcdef", 0.0f},
+        {"abcdef", "abc\ndef", 0.0f},
+        {"AV", "AVAV", 0.0f},
+        {"ab cd", "ab cd ef gh", kAdvance * 6},
+        {"ab cd ef gh", "ab cd", kAdvance * 6},
+        {"ab cd ef", "ab c ef", kAdvance * 6},
+        {"ab cd efgh", "ab cd e", kAdvance * 6},
+        {"abcdefg", "abcdefghij", kAdvance * 3},
+        {"ab abc", "ab abcdefghij", kAdvance * 3},
+        {"ab cd\nef gh ij", "ab cd\nef g ij kl", kAdvance * 6},
+    };
+
+    MonospaceFont font;
+    for (auto&& edit : edits)
+    {
+        SCOPED_TRACE(std::string{edit.before} + " -> " + edit.after);
+
+        uint32_t offset = 0;
+        while (edit.before[offset] != '\0' &&
+               edit.before[offset] == edit.after[offset])
+        {
+            ++offset;
+        }
+
+        TextLayout layout(font, edit.before, edit.max_width);
+        layout.relayout(font, edit.after, offset);
+        verify_same_layout(TextLayout(font, edit.after, edit.max_width),
+                           layout);
+    }
+}
+
+// Measures appending a character at a time to a text of 2,000 characters,
+// laying out only the last line against laying out the whole text.
+TEST(DISABLED_TextLayoutBenchmark, Append)
+{
+    using std::chrono::microseconds;
+
+    constexpr uint32_t kLength = 2000;
+
+    std::string text;
+    for (uint32_t i = 0; i < kLength; ++i)
+        text += i % 64 == 63 ? '\n' : i % 8 == 7 ? ' ' : 'a' + i % 26;
+
+    for (float max_width : {0.0f, kAdvance * 40})
+    {
+        MonospaceFont font;
+        std::string appended;
+
+        TextLayout layout(font, "", max_width);
+        const auto incremental = measure<microseconds>([&] {
+            for (uint32_t i = 0; i < kLength; ++i)
+            {
+                appended += text[i];
+                layout.relayout(font, appended.c_str(), i);
+            }
+        });
+
+        appended.clear();
+        const auto full = measure<microseconds>([&] {
+            for (uint32_t i = 0; i < kLength; ++i)
+            {
+                appended += text[i];
+                TextLayout full(font, appended.c_str(), max_width);
+            }
+        });
+
+        verify_same_layout(TextLayout(font, text.c_str(), max_width), layout);
+        printf("max width %4.0f: incremental %6lld us (full: %8lld us)\n",
+               max_width,
+               incremental,
+               full);
+    }
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Graphics/TextureTable.h"
+#include "Tests/Benchmark.h"
+
+using rainbow::graphics::detail::Texture;
+using rainbow::graphics::detail::TextureTable;
+using rainbow::test::measure;
+
+namespace
+{
+    auto make_id(uint32_t i) { return "texture" + std::to_string(i); }
+
+    auto& emplace_evictable(TextureTable& table,
+                            uint32_t name,
+                            uint32_t last_used)
+    {
+        auto& texture = table.emplace(make_id(name), name);
+        texture.size = 100;
+        texture.last_used = last_used;
+        texture.reload = [](rainbow::graphics::TextureManager&,
+                            const rainbow::graphics::Texture&) {};
+        return texture;
+    }
+
+    auto names(const std::vector<Texture*>& textures)
+    {
+        std::vector<uint32_t> names;
+        for (auto texture : textures)
+            names.push_back(texture->name);
+        return names;
+    }
+}
+
+TEST(TextureTableTest, FindsRecordsByIdAndName)
+{
+    TextureTable table;
+
+    ASSERT_EQ(nullptr, table.find("texture1"));
+    ASSERT_EQ(nullptr, table.find(1));
+
+    for (uint32_t i = 1; i <= 8; ++i)
+        table.emplace(make_id(i), i * 10);
+
+    ASSERT_EQ(8u, table.size());
+
+    for (uint32_t i = 1; i <= 8; ++i)
+    {
+        auto by_id = table.find(make_id(i));
+        ASSERT_NE(nullptr, by_id);
+        ASSERT_EQ(by_id, table.find(i * 10));
+        ASSERT_EQ(make_id(i), by_id->id);
+        ASSERT_EQ(i * 10, by_id->name);
+    }
+
+    ASSERT_EQ(nullptr, table.find("texture9"));
+    ASSERT_EQ(nullptr, table.find(90));
+}
+
+TEST(TextureTableTest, ErasesUnusedRecords)
+{
+    TextureTable table;
+    for (uint32_t i = 1; i <= 8; ++i)
+        table.emplace(make_id(i), i).use_count = i % 3 == 0 ? 0 : 1;
+
+    std::vector<uint32_t> erased;
+    table.erase_unused(
+        [&erased](const Texture& texture) { erased.push_back(texture.name); });
+    std::sort(erased.begin(), erased.end());
+
+    ASSERT_EQ((std::vector<uint32_t>{3, 6}), erased);
+    ASSERT_EQ(6u, table.size());
+
+    // Records moved into freed slots must still be found.
+    for (uint32_t i = 1; i <= 8; ++i)
+    {
+        if (i % 3 == 0)
+        {
+            ASSERT_EQ(nullptr, table.find(make_id(i)));
+            ASSERT_EQ(nullptr, table.find(i));
+        }
+        else
+        {
+            ASSERT_NE(nullptr, table.find(make_id(i)));
+            ASSERT_EQ(i, table.find(make_id(i))->name);
+            ASSERT_EQ(i, table.find(i)->name);
+        }
+    }
+
+    table.emplace(make_id(3), 3);
+
+    ASSERT_EQ(7u, table.size());
+    ASSERT_EQ(3u, table.find(make_id(3))->name);
+}
+
+TEST(TextureTableTest, EvictsLeastRecentlyUsedFirst)
+{
+    TextureTable table;
+    emplace_evictable(table, 1, 5);
+    emplace_evictable(table, 2, 1);
+    emplace_evictable(table, 3, 3);
+    emplace_evictable(table, 4, 2);
+
+    std::vector<Texture*> selected;
+    select_evictions(table, 10, 0, 150, selected);
+
+    ASSERT_EQ((std::vector<uint32_t>{2, 4}), names(selected));
+
+    select_evictions(table, 10, 0, 1000, selected);
+
+    ASSERT_EQ((std::vector<uint32_t>{2, 4, 3, 1}), names(selected));
+
+    select_evictions(table, 10, 0, 0, selected);
+
+    ASSERT_TRUE(selected.empty());
+}
+
+TEST(TextureTableTest, EvictsOnlyAfterDelay)
+{
+    TextureTable table;
+    emplace_evictable(table, 1, 4);
+    emplace_evictable(table, 2, 5);
+    emplace_evictable(table, 3, 6);
+
+    std::vector<Texture*> selected;
+    select_evictions(table, 10, 5, 1000, selected);
+
+    ASSERT_EQ((std::vector<uint32_t>{1, 2}), names(selected));
+
+    select_evictions(table, 11, 5, 1000, selected);
+
+    ASSERT_EQ((std::vector<uint32_t>{1, 2, 3}), names(selected));
+
+    // Frame counters may wrap around.
+    for (auto&& texture : table)
+        texture.last_used -= 8;
+    select_evictions(table, 2, 5, 1000, selected);
+
+    ASSERT_EQ((std::vector<uint32_t>{1, 2}), names(selected));
+}
+
+TEST(TextureTableTest, NeverEvictsTexturesInUseOrLoading)
+{
+    TextureTable table;
+    emplace_evictable(table, 1, 10);
+    emplace_evictable(table, 2, 0).pending = 1;
+    emplace_evictable(table, 3, 0).reload = nullptr;
+    emplace_evictable(table, 4, 0).resident = false;
+    emplace_evictable(table, 5, 9);
+
+    std::vector<Texture*> selected;
+    select_evictions(table, 10, 0, 1000, selected);
+
+    ASSERT_EQ((std::vector<uint32_t>{5}), names(selected));
+    ASSERT_FALSE(is_evictable(*table.find(1), 10, 0));
+    ASSERT_TRUE(is_evictable(*table.find(1), 11, 0));
+}
+
+// Measures the bookkeeping behind creating, copying and destroying
+// textures, compared to scanning a vector as TextureManager used to.
+TEST(DISABLED_TextureTableBenchmark, CreateRetainRelease)
+{
+    constexpr uint32_t kIterations = 100000;
+
+    for (uint32_t count : {10u, 100u, 1000u})
+    {
+        TextureTable table;
+        std::vector<Texture> textures;
+        for (uint32_t i = 1; i <= count; ++i)
+        {
+            table.emplace(make_id(i), i);
+            textures.emplace_back(make_id(i), i);
+        }
+
+        std::vector<std::string> ids;
+        for (uint32_t i = 0; i < kIterations; ++i)
+            ids.push_back(make_id(i % count + 1));
+
+        const auto table_create = measure([&] {
+            for (auto&& id : ids)
+            {
+                auto texture = table.find(id);
+                ++texture->use_count;
+            }
+        });
+
+        const auto table_retain = measure([&] {
+            for (uint32_t i = 0; i < kIterations; ++i)
+            {
+                const uint32_t name = i % count + 1;
+                ++table.find(name)->use_count;
+                --table.find(name)->use_count;
+            }
+        });
+
+        const auto scan_create = measure([&] {
+            for (auto&& id : ids)
+            {
+                auto texture = std::find_if(
+                    textures.begin(), textures.end(), [&id](const Texture& t) {
+                        return t.id == id;
+                    });
+                ++texture->use_count;
+            }
+        });
+
+        const auto scan_retain = measure([&] {
+            for (uint32_t i = 0; i < kIterations; ++i)
+            {
+                const uint32_t name = i % count + 1;
+                auto by_name = [name](const Texture& t) {
+                    return t.name == name;
+                };
+                ++std::find_if(textures.begin(), textures.end(), by_name)
+                      ->use_count;
+                --std::find_if(textures.begin(), textures.end(), by_name)
+                      ->use_count;
+            }
+        });
+
+        printf("%4u textures: create %4lld ns (scan: %6lld ns), "
+               "retain+release %4lld ns (scan: %6lld ns)\n",
+               count,
+               table_create / kIterations,
+               scan_create / kIterations,
+               table_retain / kIterations,
+               scan_retain / kIterations);
+    }
+}
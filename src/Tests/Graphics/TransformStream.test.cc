@@ -0,0 +1,160 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <gtest/gtest.h>
+
+#include "Common/Random.h"
+#include "Graphics/Sprite.h"
+#include "Graphics/TextureAtlas.h"
+#include "Graphics/TransformStream.h"
+#include "Math/Transform.h"
+#include "Tests/TestHelpers.h"
+
+using rainbow::Sprite;
+using rainbow::SpriteVertex;
+using rainbow::TransformStream;
+using rainbow::Vec2f;
+
+namespace
+{
+    constexpr uint32_t kSpriteCount = 103;
+
+    class TransformStreamTest : public ::testing::Test
+    {
+    public:
+        TransformStreamTest()
+            : sprites(std::make_unique<Sprite[]>(kSpriteCount)),
+              expected(std::make_unique<SpriteVertex[]>(kSpriteCount * 4)),
+              actual(std::make_unique<SpriteVertex[]>(kSpriteCount * 4)),
+              stream(kSpriteCount)
+        {
+        }
+
+    protected:
+        std::unique_ptr<Sprite[]> sprites;
+        std::unique_ptr<SpriteVertex[]> expected;
+        std::unique_ptr<SpriteVertex[]> actual;
+        TransformStream stream;
+
+        void SetUp() override
+        {
+            rainbow::random.seed(kSpriteCount);
+            for (uint32_t i = 0; i < kSpriteCount; ++i)
+            {
+                Sprite& sprite = sprites[i];
+                sprite = Sprite(rainbow::random(1u, 512u),
+                                rainbow::random(1u, 512u));
+                sprite.set_position(Vec2f(rainbow::random(-1024.0f, 1024.0f),
+                                          rainbow::random(-1024.0f, 1024.0f)));
+                sprite.set_pivot(
+                    Vec2f(rainbow::random(0.0f, 1.0f),
+                          rainbow::random(0.0f, 1.0f)));
+                sprite.set_scale(Vec2f(rainbow::random(0.1f, 4.0f),
+                                       rainbow::random(0.1f, 4.0f)));
+                if (i % 3 != 0)
+                    sprite.set_rotation(rainbow::random(-6.0f, 6.0f));
+
+                rainbow::transform(
+                    sprite,
+                    ArraySpan<SpriteVertex>{expected.get() + i * 4, 4});
+                stream.push(sprite, actual.get() + i * 4);
+            }
+        }
+
+        void verify_vertices(uint32_t count) const
+        {
+            for (uint32_t i = 0; i < count * 4; ++i)
+            {
+                ASSERT_FLOAT_EQ(expected[i].position.x, actual[i].position.x);
+                ASSERT_FLOAT_EQ(expected[i].position.y, actual[i].position.y);
+            }
+        }
+    };
+}
+
+TEST_F(TransformStreamTest, QueuesSprites)
+{
+    ASSERT_EQ(kSpriteCount, stream.capacity());
+    ASSERT_EQ(kSpriteCount, stream.size());
+
+    stream.clear();
+
+    ASSERT_EQ(kSpriteCount, stream.capacity());
+    ASSERT_EQ(0u, stream.size());
+}
+
+TEST_F(TransformStreamTest, TransformsLikeScalarReference)
+{
+    stream.flush_scalar();
+
+    ASSERT_EQ(0u, stream.size());
+    verify_vertices(kSpriteCount);
+}
+
+TEST_F(TransformStreamTest, TransformsLikeSIMDKernel)
+{
+    stream.flush();
+
+    ASSERT_EQ(0u, stream.size());
+    verify_vertices(kSpriteCount);
+}
+
+TEST_F(TransformStreamTest, TransformsRemainder)
+{
+    for (uint32_t count = 1; count < 8; ++count)
+    {
+        stream.clear();
+        std::fill_n(actual.get(), kSpriteCount * 4, SpriteVertex{});
+        for (uint32_t i = 0; i < count; ++i)
+            stream.push(sprites[i], actual.get() + i * 4);
+        stream.flush();
+
+        verify_vertices(count);
+        ASSERT_EQ(Vec2f::Zero, actual[count * 4].position);
+    }
+}
+
+TEST_F(TransformStreamTest, MovesStream)
+{
+    TransformStream moved(std::move(stream));
+
+    ASSERT_EQ(kSpriteCount, moved.capacity());
+    ASSERT_EQ(kSpriteCount, moved.size());
+    ASSERT_EQ(0u, stream.capacity());
+    ASSERT_EQ(0u, stream.size());
+
+    moved.flush();
+
+    verify_vertices(kSpriteCount);
+}
+
+TEST(TransformStreamSpriteTest, DefersTransformationUntilFlush)
+{
+    auto atlas = rainbow::make_shared<rainbow::TextureAtlas>(
+        rainbow::ISolemnlySwearThatIAmOnlyTesting{});
+    atlas->add_region(0, 0, 1, 1);
+
+    TransformStream stream(1);
+    Sprite sprite{2, 2};
+    sprite.set_position(Vec2f::One);
+    SpriteVertex vertex_array[4];
+
+    ASSERT_TRUE(sprite.update(vertex_array, *atlas, stream));
+    ASSERT_EQ(1u, stream.size());
+    ASSERT_EQ(Vec2f::Zero, vertex_array[0].position);
+
+    stream.flush();
+
+    ASSERT_EQ(Vec2f(0.0f, 0.0f), vertex_array[0].position);
+    ASSERT_EQ(Vec2f(2.0f, 0.0f), vertex_array[1].position);
+    ASSERT_EQ(Vec2f(2.0f, 2.0f), vertex_array[2].position);
+    ASSERT_EQ(Vec2f(0.0f, 2.0f), vertex_array[3].position);
+
+    sprite.move(Vec2f::One);
+
+    ASSERT_TRUE(sprite.update(vertex_array, *atlas, stream));
+    ASSERT_EQ(0u, stream.size());
+    ASSERT_EQ(Vec2f(1.0f, 1.0f), vertex_array[0].position);
+    ASSERT_EQ(Vec2f(3.0f, 3.0f), vertex_array[2].position);
+}
@@ -58,3 +58,17 @@ TEST(GeometryTest, ReturnsRectangleVertices)
     ASSERT_EQ(Rect(), rect0);
     ASSERT_EQ(Rect(1, 1, 1, 1), rect1);
 }
+
+TEST(GeometryTest, RectanglesIntersect)
+{
+    const Rect rect{0, 0, 10, 10};
+
+    ASSERT_TRUE(rect.intersects(rect));
+    ASSERT_TRUE(rect.intersects({2, 2, 8, 8}));
+    ASSERT_TRUE(Rect(2, 2, 8, 8).intersects(rect));
+    ASSERT_TRUE(rect.intersects({-5, -5, 5, 5}));
+    ASSERT_TRUE(rect.intersects({10, 10, 20, 20}));
+    ASSERT_FALSE(rect.intersects({11, 0, 20, 10}));
+    ASSERT_FALSE(rect.intersects({0, 11, 10, 20}));
+    ASSERT_FALSE(rect.intersects({-20, -20, -1, -1}));
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Memory/BufferPool.h"
+
+using rainbow::BufferPool;
+
+TEST(BufferPoolTest, ReusesReleasedBuffers)
+{
+    BufferPool pool(1024);
+
+    uint8_t* data = nullptr;
+    {
+        auto buffer = pool.acquire(256);
+        ASSERT_TRUE(buffer);
+        ASSERT_EQ(256u, buffer.size());
+        ASSERT_EQ(0u, pool.idle_count());
+
+        data = buffer.data();
+    }
+
+    ASSERT_EQ(1u, pool.idle_count());
+    ASSERT_EQ(256u, pool.idle_size());
+
+    auto buffer = pool.acquire(200);
+    ASSERT_EQ(data, buffer.data());
+    ASSERT_EQ(200u, buffer.size());
+    ASSERT_EQ(0u, pool.idle_count());
+    ASSERT_EQ(0u, pool.idle_size());
+}
+
+TEST(BufferPoolTest, PicksSmallestFittingBuffer)
+{
+    BufferPool pool(1024);
+
+    uint8_t* medium = nullptr;
+    {
+        auto small = pool.acquire(64);
+        auto large = pool.acquire(192);
+        auto buffer = pool.acquire(128);
+        medium = buffer.data();
+    }
+
+    ASSERT_EQ(3u, pool.idle_count());
+
+    auto buffer = pool.acquire(100);
+    ASSERT_EQ(medium, buffer.data());
+    ASSERT_EQ(2u, pool.idle_count());
+}
+
+TEST(BufferPoolTest, DoesNotHandOutMuchLargerBuffers)
+{
+    BufferPool pool(1024);
+
+    pool.acquire(512);
+    ASSERT_EQ(1u, pool.idle_count());
+
+    auto buffer = pool.acquire(64);
+    ASSERT_EQ(1u, pool.idle_count());
+    ASSERT_EQ(512u, pool.idle_size());
+}
+
+TEST(BufferPoolTest, FreesOldestBuffersWhenOverLimit)
+{
+    BufferPool pool(256);
+
+    {
+        auto first = pool.acquire(128);
+        auto second = pool.acquire(128);
+        auto third = pool.acquire(96);
+        auto too_large = pool.acquire(512);
+
+        first.release();
+        ASSERT_FALSE(first);
+        second.release();
+        third.release();
+        too_large.release();
+    }
+
+    ASSERT_EQ(2u, pool.idle_count());
+    ASSERT_EQ(224u, pool.idle_size());
+
+    pool.clear();
+
+    ASSERT_EQ(0u, pool.idle_count());
+    ASSERT_EQ(0u, pool.idle_size());
+}
+
+TEST(BufferPoolTest, MovesOwnership)
+{
+    BufferPool pool(1024);
+
+    auto buffer = pool.acquire(64);
+    uint8_t* data = buffer.data();
+
+    BufferPool::Buffer moved(std::move(buffer));
+    ASSERT_FALSE(buffer);
+    ASSERT_EQ(data, moved.data());
+    ASSERT_EQ(64u, moved.size());
+
+    buffer = std::move(moved);
+    ASSERT_FALSE(moved);
+    ASSERT_EQ(data, buffer.data());
+    ASSERT_EQ(0u, pool.idle_count());
+
+    buffer = pool.acquire(32);
+    ASSERT_EQ(1u, pool.idle_count());
+    ASSERT_EQ(64u, pool.idle_size());
+}
+
+TEST(BufferPoolTest, IsThreadSafe)
+{
+    constexpr int kIterations = 1000;
+    constexpr size_t kMaxIdleSize = 64 * 1024;
+
+    BufferPool pool(kMaxIdleSize);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&pool, i] {
+            for (int j = 0; j < kIterations; ++j)
+            {
+                auto buffer = pool.acquire(1024 + (i + j) % 512);
+                buffer.data()[buffer.size() - 1] = static_cast<uint8_t>(j);
+            }
+        });
+    }
+    for (auto&& thread : threads)
+        thread.join();
+
+    ASSERT_GT(pool.idle_count(), 0u);
+    ASSERT_LE(pool.idle_size(), kMaxIdleSize);
+}
@@ -2,8 +2,11 @@
 // Distributed under the MIT License.
 // (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
 
+#include <numeric>
+
 #include <gtest/gtest.h>
 
+#include "Common/Algorithm.h"
 #include "Common/Random.h"
 #include "Memory/StableArray.h"
 
@@ -141,6 +144,32 @@ TEST(StableArrayTest, IteratorsAreStableAfterMoves)
         ASSERT_EQ(i, array[i].id);
 }
 
+TEST(StableArrayTest, IteratorsAreStableAfterResize)
+{
+    StableArray<SizableStruct<5>> array(6);
+    for_each(array, [i = 0](auto&& s) mutable { s.id = i++; });
+
+    array.move(1, 4);  // -> 0 2 3 4 1 5
+    array.resize(9, array.size());
+
+    ASSERT_EQ(9u, array.size());
+    ASSERT_EQ(0u, array.data()[0].id);
+    ASSERT_EQ(2u, array.data()[1].id);
+    ASSERT_EQ(3u, array.data()[2].id);
+    ASSERT_EQ(4u, array.data()[3].id);
+    ASSERT_EQ(1u, array.data()[4].id);
+    ASSERT_EQ(5u, array.data()[5].id);
+
+    for (uint32_t i = 6; i < array.size(); ++i)
+        array.data()[i].id = i;
+
+    for (uint32_t i = 0; i < array.size(); ++i)
+    {
+        ASSERT_EQ(i, array[i].id);
+        ASSERT_EQ(array.data()[i].id, array[array.find_iterator(i)].id);
+    }
+}
+
 TEST(StableArrayTest, IteratorsAreStableAfterSwaps)
 {
     StableArray<SizableStruct<5>> array(6);
@@ -201,3 +230,43 @@ TEST(StableArrayTest, IteratorsAreStableAfterSwaps)
             ASSERT_EQ(i, array[i].id);
     }
 }
+
+TEST(StableArrayTest, IteratorsAreStableAfterReorder)
+{
+    StableArray<SizableStruct<5>> array(8);
+    for_each(array, [i = 0](auto&& s) mutable { s.id = i++; });
+
+    uint32_t order[]{3, 0, 1, 2, 5, 4};
+    array.reorder(order, rainbow::array_size(order));  // -> 3 0 1 2 5 4 6 7
+
+    ASSERT_EQ(3u, array.data()[0].id);
+    ASSERT_EQ(0u, array.data()[1].id);
+    ASSERT_EQ(1u, array.data()[2].id);
+    ASSERT_EQ(2u, array.data()[3].id);
+    ASSERT_EQ(5u, array.data()[4].id);
+    ASSERT_EQ(4u, array.data()[5].id);
+    ASSERT_EQ(6u, array.data()[6].id);
+    ASSERT_EQ(7u, array.data()[7].id);
+
+    for (uint32_t i = 0; i < array.size(); ++i)
+    {
+        ASSERT_EQ(i, array[i].id);
+        ASSERT_EQ(array.data()[i].id, array[array.find_iterator(i)].id);
+    }
+
+    rainbow::Random random;
+    random.seed();
+    uint32_t permutation[8];
+    for (uint32_t p = 0; p < 100; ++p)
+    {
+        std::iota(std::begin(permutation), std::end(permutation), 0);
+        for (uint32_t i = array.size() - 1; i > 0; --i)
+            std::swap(permutation[i], permutation[random(i + 1)]);
+        array.reorder(permutation, array.size());
+        for (uint32_t i = 0; i < array.size(); ++i)
+        {
+            ASSERT_EQ(i, array[i].id);
+            ASSERT_EQ(array.data()[i].id, array.find_iterator(i));
+        }
+    }
+}
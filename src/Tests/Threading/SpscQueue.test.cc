@@ -0,0 +1,93 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Threading/SpscQueue.h"
+
+using rainbow::SpscQueue;
+
+TEST(SpscQueueTest, PopsInOrder)
+{
+    SpscQueue<int, 4> queue;
+
+    ASSERT_TRUE(queue.empty());
+
+    int value = -1;
+    ASSERT_FALSE(queue.pop(value));
+    ASSERT_EQ(-1, value);
+
+    for (int i = 0; i < 3; ++i)
+        ASSERT_TRUE(queue.push(i));
+
+    ASSERT_FALSE(queue.empty());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_TRUE(queue.pop(value));
+        ASSERT_EQ(i, value);
+    }
+
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, RejectsPushesWhenFull)
+{
+    SpscQueue<int, 4> queue;
+
+    ASSERT_EQ(4u, queue.capacity());
+
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(queue.push(i));
+
+    ASSERT_FALSE(queue.push(4));
+
+    int value = -1;
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(0, value);
+    ASSERT_TRUE(queue.push(4));
+
+    for (int i = 1; i < 5; ++i)
+    {
+        ASSERT_TRUE(queue.pop(value));
+        ASSERT_EQ(i, value);
+    }
+    ASSERT_FALSE(queue.pop(value));
+}
+
+TEST(SpscQueueTest, PassesValuesBetweenThreads)
+{
+    constexpr int kCount = 100000;
+
+    SpscQueue<int, 64> queue;
+    std::thread producer([&queue] {
+        for (int i = 0; i < kCount; ++i)
+        {
+            while (!queue.push(i))
+                std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    bool in_order = true;
+    while (expected < kCount)
+    {
+        int value;
+        if (!queue.pop(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        in_order = in_order && value == expected;
+        ++expected;
+    }
+
+    producer.join();
+
+    ASSERT_TRUE(in_order);
+    ASSERT_TRUE(queue.empty());
+}
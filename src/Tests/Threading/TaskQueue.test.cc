@@ -0,0 +1,94 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Threading/TaskQueue.h"
+
+using rainbow::TaskQueue;
+
+TEST(TaskQueueTest, RunsTasksOnWorkers)
+{
+    const auto caller = std::this_thread::get_id();
+    std::mutex mutex;
+    std::condition_variable done;
+    std::atomic<int> count(0);
+    std::atomic<bool> ran_on_caller(false);
+    {
+        TaskQueue queue(2);
+
+        ASSERT_EQ(2u, queue.worker_count());
+
+        for (int i = 0; i < 100; ++i)
+        {
+            queue.post([&] {
+                if (std::this_thread::get_id() == caller)
+                    ran_on_caller = true;
+                std::lock_guard<std::mutex> lock(mutex);
+                ++count;
+                done.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&count] { return count == 100; });
+    }
+
+    ASSERT_EQ(100, count);
+    ASSERT_FALSE(ran_on_caller);
+}
+
+TEST(TaskQueueTest, RunsTasksInOrderWithOneWorker)
+{
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<int> order;
+    TaskQueue queue(1);
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.post([&, i] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+            done.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&order] { return order.size() == 10; });
+
+    for (int i = 0; i < 10; ++i)
+        ASSERT_EQ(i, order[i]);
+}
+
+TEST(TaskQueueTest, DiscardsPendingTasksOnDestruction)
+{
+    std::atomic<int> count(0);
+    {
+        TaskQueue queue(1);
+        std::atomic<bool> started(false);
+        queue.post([&] {
+            started = true;
+
+            // Keep the only worker busy until the queue is being destroyed.
+            while (queue.size() > 0)
+                std::this_thread::yield();
+
+            ++count;
+        });
+        for (int i = 0; i < 10; ++i)
+            queue.post([&count] { ++count; });
+
+        while (!started)
+            std::this_thread::yield();
+
+        ASSERT_EQ(10u, queue.size());
+    }
+
+    ASSERT_EQ(1, count);
+}
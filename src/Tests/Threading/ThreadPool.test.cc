@@ -0,0 +1,87 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include <atomic>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "Threading/ThreadPool.h"
+
+using rainbow::ThreadPool;
+
+namespace
+{
+    constexpr uint32_t kMaxWorkers = 4;
+
+    void verify_parallel_for(ThreadPool& pool, uint32_t count)
+    {
+        auto visits = std::make_unique<std::atomic<int>[]>(count);
+        for (uint32_t i = 0; i < count; ++i)
+            visits[i] = 0;
+
+        pool.parallel_for(count, [&visits](uint32_t i) { ++visits[i]; });
+
+        for (uint32_t i = 0; i < count; ++i)
+            ASSERT_EQ(1, visits[i]) << "at index " << i;
+    }
+}
+
+TEST(ThreadPoolTest, RunsOnCallingThreadWithoutWorkers)
+{
+    ThreadPool pool(0);
+
+    ASSERT_EQ(0u, pool.worker_count());
+
+    const auto caller = std::this_thread::get_id();
+    uint32_t count = 0;
+    pool.parallel_for(100, [caller, &count](uint32_t) {
+        ASSERT_EQ(caller, std::this_thread::get_id());
+        ++count;
+    });
+
+    ASSERT_EQ(100u, count);
+}
+
+TEST(ThreadPoolTest, VisitsEveryIndexExactlyOnce)
+{
+    for (uint32_t workers = 0; workers <= kMaxWorkers; ++workers)
+    {
+        ThreadPool pool(workers);
+
+        ASSERT_EQ(workers, pool.worker_count());
+
+        for (uint32_t count : {0u, 1u, 3u, 17u, 1000u})
+            verify_parallel_for(pool, count);
+    }
+}
+
+TEST(ThreadPoolTest, SpreadsWorkAcrossThreads)
+{
+    ThreadPool pool(kMaxWorkers);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<uint32_t> started(0);
+    pool.parallel_for(kMaxWorkers + 1, [&](uint32_t) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+
+        // Hold every thread until all indices have started, forcing the
+        // indices to be spread across all threads.
+        ++started;
+        while (started < kMaxWorkers + 1)
+            std::this_thread::yield();
+    });
+
+    ASSERT_EQ(kMaxWorkers + 1, threads.size());
+}
+
+TEST(ThreadPoolTest, IsReusable)
+{
+    ThreadPool pool(2);
+    for (int i = 0; i < 100; ++i)
+        verify_parallel_for(pool, 64);
+}
@@ -160,7 +160,7 @@ namespace rainbow { namespace imgui
         io.UserData = renderable;
 
         auto texture_manager = TextureManager::Get();
-        const TextureFilter filter = texture_manager->mag_filter();
+        const TextureFilter filter = texture_manager->min_filter();
         texture_manager->set_filter(TextureFilter::Nearest);
         renderable->texture() = texture_manager->create(
             "rainbow://dear_imgui/ProggyClean.ttf",
@@ -0,0 +1,86 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef THREADING_SPSCQUEUE_H_
+#define THREADING_SPSCQUEUE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>
+    ///   Bounded, lock-free, first-in first-out queue for passing values from
+    ///   one producer thread to one consumer thread.
+    /// </summary>
+    /// <remarks>
+    ///   Only one thread may push, and only one thread may pop. Neither side
+    ///   ever blocks; pushing to a full queue fails instead.
+    /// </remarks>
+    template <typename T, size_t N>
+    class SpscQueue : private NonCopyable<SpscQueue<T, N>>
+    {
+        static_assert(N > 0 && (N & (N - 1)) == 0,
+                      "Capacity must be a power of two");
+
+    public:
+        SpscQueue() : head_(0), tail_(0) {}
+
+        static constexpr auto capacity() { return N; }
+
+        /// <summary>Returns whether the queue is empty.</summary>
+        /// <remarks>Only exact when called from the consumer.</remarks>
+        bool empty() const
+        {
+            return head_.load(std::memory_order_relaxed) ==
+                   tail_.load(std::memory_order_acquire);
+        }
+
+        /// <summary>
+        ///   Removes the value at the front of the queue, if any. Must only
+        ///   be called from the consumer.
+        /// </summary>
+        /// <returns><c>true</c> if a value was popped.</returns>
+        bool pop(T& value)
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire))
+                return false;
+
+            value = std::move(items_[head & (N - 1)]);
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// <summary>
+        ///   Adds a value to the back of the queue. Must only be called from
+        ///   the producer.
+        /// </summary>
+        /// <returns><c>false</c> if the queue is full.</returns>
+        bool push(T value)
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == N)
+                return false;
+
+            items_[tail & (N - 1)] = std::move(value);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        /// <summary>Keeps the indices on separate cache lines.</summary>
+        static constexpr size_t kCacheLineSize = 64;
+
+        std::array<T, N> items_;
+        alignas(kCacheLineSize) std::atomic<size_t> head_;  ///< Next to pop.
+        alignas(kCacheLineSize) std::atomic<size_t> tail_;  ///< Next to push.
+    };
+}
+
+#endif
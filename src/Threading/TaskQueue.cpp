@@ -0,0 +1,64 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/TaskQueue.h"
+
+#include "Common/Logging.h"
+
+using rainbow::TaskQueue;
+
+TaskQueue::TaskQueue(uint32_t worker_count) : shutdown_(false)
+{
+    R_ASSERT(worker_count > 0, "Task queue needs at least one worker");
+
+    workers_.reserve(worker_count);
+    for (uint32_t i = 0; i < worker_count; ++i)
+        workers_.emplace_back([this] { work(); });
+}
+
+TaskQueue::~TaskQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+        tasks_.clear();
+    }
+    task_available_.notify_all();
+    for (auto&& worker : workers_)
+        worker.join();
+}
+
+auto TaskQueue::size() -> size_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void TaskQueue::post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    task_available_.notify_one();
+}
+
+void TaskQueue::work()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_available_.wait(
+                lock, [this] { return shutdown_ || !tasks_.empty(); });
+            if (shutdown_)
+                return;
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef THREADING_TASKQUEUE_H_
+#define THREADING_TASKQUEUE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>
+    ///   First-in, first-out queue of tasks run in the background.
+    /// </summary>
+    /// <remarks>
+    ///   Unlike <see cref="ThreadPool"/>, the submitting thread never waits
+    ///   for, or takes part in, running the tasks. Tasks that have not
+    ///   started by the time the queue is destroyed are discarded.
+    /// </remarks>
+    class TaskQueue : private NonCopyable<TaskQueue>
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /// <summary>Creates a task queue.</summary>
+        /// <param name="worker_count">
+        ///   Number of workers to spawn. Must be greater than zero.
+        /// </param>
+        explicit TaskQueue(uint32_t worker_count);
+        ~TaskQueue();
+
+        /// <summary>Returns the number of tasks not yet started.</summary>
+        auto size() -> size_t;
+
+        auto worker_count() const
+        {
+            return static_cast<uint32_t>(workers_.size());
+        }
+
+        /// <summary>Queues a task and returns immediately.</summary>
+        void post(Task task);
+
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<Task> tasks_;
+        std::mutex mutex_;
+        std::condition_variable task_available_;
+        bool shutdown_;
+
+        void work();
+    };
+}
+
+#endif
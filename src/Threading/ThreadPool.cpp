@@ -0,0 +1,140 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#include "Threading/ThreadPool.h"
+
+#include <algorithm>
+
+using rainbow::ThreadPool;
+
+namespace
+{
+    /// <summary>
+    ///   Number of jobs per queue a range is split into. More jobs balance
+    ///   better when the cost per index varies, at the cost of overhead.
+    /// </summary>
+    constexpr uint32_t kJobsPerQueue = 4;
+}
+
+auto ThreadPool::default_worker_count() -> uint32_t
+{
+    const uint32_t concurrency = std::thread::hardware_concurrency();
+    return concurrency > 1 ? concurrency - 1 : 0;
+}
+
+ThreadPool::ThreadPool(uint32_t worker_count)
+    : queue_count_(worker_count + 1),
+      queues_(std::make_unique<JobQueue[]>(queue_count_)), queued_(0),
+      shutdown_(false)
+{
+    workers_.reserve(worker_count);
+    for (uint32_t i = 0; i < worker_count; ++i)
+        workers_.emplace_back([this, i] { work(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    work_available_.notify_all();
+    for (auto&& worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::run(uint32_t count, Invoke invoke, const void* context)
+{
+    if (count == 0)
+        return;
+
+    if (queue_count_ == 1)
+    {
+        invoke(context, 0, count);
+        return;
+    }
+
+    const uint32_t job_count = std::min(count, queue_count_ * kJobsPerQueue);
+    std::atomic<uint32_t> pending(job_count);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_ += job_count;
+    }
+
+    for (uint32_t i = 0; i < job_count; ++i)
+    {
+        const uint64_t n = count;
+        const auto first = static_cast<uint32_t>(n * i / job_count);
+        const auto last = static_cast<uint32_t>(n * (i + 1) / job_count);
+        const Job job{invoke, context, first, last, &pending};
+        queues_[i % queue_count_].push(job);
+    }
+    work_available_.notify_all();
+
+    // The calling thread owns the last queue.
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        if (!run_one(queue_count_ - 1))
+            std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::run_one(uint32_t queue)
+{
+    Job job;
+    bool found = queues_[queue].pop(job);
+    for (uint32_t i = 1; !found && i < queue_count_; ++i)
+        found = queues_[(queue + i) % queue_count_].steal(job);
+
+    if (!found)
+        return false;
+
+    --queued_;
+    job.invoke(job.context, job.first, job.last);
+    job.pending->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void ThreadPool::work(uint32_t queue)
+{
+    while (true)
+    {
+        if (run_one(queue))
+            continue;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_available_.wait(lock, [this] { return shutdown_ || queued_ > 0; });
+        if (shutdown_)
+            return;
+    }
+}
+
+bool ThreadPool::JobQueue::pop(Job& job)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (jobs_.empty())
+        return false;
+
+    job = jobs_.back();
+    jobs_.pop_back();
+    return true;
+}
+
+void ThreadPool::JobQueue::push(const Job& job)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(job);
+}
+
+bool ThreadPool::JobQueue::steal(Job& job)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (jobs_.empty())
+        return false;
+
+    job = jobs_.front();
+    jobs_.pop_front();
+    return true;
+}
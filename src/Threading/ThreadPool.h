@@ -0,0 +1,104 @@
+// Copyright (c) 2010-present Bifrost Entertainment AS and Tommy Nguyen
+// Distributed under the MIT License.
+// (See accompanying file LICENSE or copy at http://opensource.org/licenses/MIT)
+
+#ifndef THREADING_THREADPOOL_H_
+#define THREADING_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Common/NonCopyable.h"
+
+namespace rainbow
+{
+    /// <summary>Work-stealing pool of worker threads.</summary>
+    /// <remarks>
+    ///   Every worker owns a job queue. Workers take jobs from the back of
+    ///   their own queue, and steal from the front of the others' when theirs
+    ///   runs dry. The thread submitting work also takes part until all of
+    ///   its jobs are done.
+    /// </remarks>
+    class ThreadPool : private NonCopyable<ThreadPool>
+    {
+    public:
+        /// <summary>
+        ///   Returns the number of workers that, together with the calling
+        ///   thread, keeps all hardware threads busy.
+        /// </summary>
+        static auto default_worker_count() -> uint32_t;
+
+        /// <summary>Creates a pool of worker threads.</summary>
+        /// <param name="worker_count">
+        ///   Number of workers to spawn. With no workers, all jobs run on the
+        ///   calling thread.
+        /// </param>
+        explicit ThreadPool(uint32_t worker_count);
+        ~ThreadPool();
+
+        auto worker_count() const { return queue_count_ - 1; }
+
+        /// <summary>
+        ///   Calls <paramref name="func"/> for every index in [0,
+        ///   <paramref name="count"/>), split across workers. Returns when
+        ///   all calls have returned.
+        /// </summary>
+        template <typename F>
+        void parallel_for(uint32_t count, F&& func)
+        {
+            using Func = std::remove_reference_t<F>;
+            run(count,
+                [](const void* context, uint32_t first, uint32_t last) {
+                    auto& f = *static_cast<Func*>(const_cast<void*>(context));
+                    for (uint32_t i = first; i < last; ++i)
+                        f(i);
+                },
+                &func);
+        }
+
+    private:
+        using Invoke = void (*)(const void*, uint32_t, uint32_t);
+
+        struct Job
+        {
+            Invoke invoke;
+            const void* context;
+            uint32_t first;
+            uint32_t last;
+            std::atomic<uint32_t>* pending;
+        };
+
+        class JobQueue
+        {
+        public:
+            bool pop(Job& job);
+            void push(const Job& job);
+            bool steal(Job& job);
+
+        private:
+            std::mutex mutex_;
+            std::deque<Job> jobs_;
+        };
+
+        const uint32_t queue_count_;          ///< Per worker, plus the caller.
+        std::unique_ptr<JobQueue[]> queues_;
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable work_available_;
+        std::atomic<uint32_t> queued_;        ///< Number of jobs not yet taken.
+        bool shutdown_;
+
+        void run(uint32_t count, Invoke invoke, const void* context);
+        bool run_one(uint32_t queue);
+        void work(uint32_t queue);
+    };
+}
+
+#endif
@@ -51,6 +51,7 @@ case $1 in
     echo "  -DUSE_HEIMDALL=1         Enable Heimdall debugging facilities"
     echo "  -DUSE_LUA_SCRIPT=1       Enable Lua scripting"
     echo "  -DUSE_PHYSICS=1          Enable physics module (Box2D)"
+    echo "  -DUSE_SOFTWARE_MIXER=1   Mix audio in software instead of OpenAL"
     echo "  -DUSE_SPINE=1            Enable Spine runtime"
     echo
     echo "CMake options are passed directly to CMake so you can set variables like"